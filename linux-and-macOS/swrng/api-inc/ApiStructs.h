@@ -44,6 +44,49 @@ typedef struct {
 	int downloadSpeedKBsec;
 } DeviceStatistics;
 
+/* Number of latency histogram buckets, bucket i counts the latencies from 2^i up to 2^(i+1) nanoseconds */
+#define SWRNG_LATENCY_BUCKETS (32)
+
+typedef struct {
+
+	/* Number of latencies recorded */
+	uint64_t count;
+
+	/* Sum and maximum of the latencies recorded in nanoseconds */
+	uint64_t totalNanos;
+	uint64_t maxNanos;
+
+	/* Number of latencies per bucket, the last bucket also counts the longer latencies */
+	uint64_t buckets[SWRNG_LATENCY_BUCKETS];
+} LatencyHistogram;
+
+typedef struct {
+
+	/* Total number of random bytes and data blocks delivered */
+	uint64_t numBytes;
+	uint64_t numBlocks;
+
+	/* Total number of download re-transmissions and device read timeouts */
+	uint64_t numRetries;
+	uint64_t numTimeouts;
+
+	/* Total number of repetition count and adaptive proportion test failures */
+	uint64_t numRctFailures;
+	uint64_t numAptFailures;
+
+	/* Moving average of the download throughput in bytes per second, 0 when idle */
+	double bytesPerSec;
+
+	/* Time spent waiting for each data block from the device */
+	LatencyHistogram usbLatency;
+
+	/* Time spent running the statistical tests on each data block */
+	LatencyHistogram healthTestLatency;
+
+	/* Time spent post processing each data block */
+	LatencyHistogram conditioningLatency;
+} DeviceLiveStatistics;
+
 typedef struct {
 	/* Device serial number (ASCIIZ) */
 	char value[16];
@@ -0,0 +1,57 @@
+/*
+ * CpuFeatures.h
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class detects, at run time, the CPU instruction set extensions used for accelerating
+ post processing and health testing of random data.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef CPUFEATURES_H_
+#define CPUFEATURES_H_
+
+namespace swiftrng {
+
+class CpuFeatures {
+public:
+	static const CpuFeatures& get_instance();
+	bool has_sha_ni() const {return m_sha_ni;}
+	bool has_avx2() const {return m_avx2;}
+	bool has_avx512f() const {return m_avx512f;}
+	bool has_avx512dq() const {return m_avx512dq;}
+	bool has_avx512bw() const {return m_avx512bw;}
+
+private:
+	CpuFeatures();
+	void detect();
+
+private:
+	// SHA extensions together with SSE4.1 used by the SHA-256 rounds
+	bool m_sha_ni {false};
+
+	// AVX2 supported by the CPU and enabled by the OS
+	bool m_avx2 {false};
+
+	// AVX-512 foundation supported by the CPU and enabled by the OS
+	bool m_avx512f {false};
+
+	// AVX-512 double word and quad word instructions
+	bool m_avx512dq {false};
+
+	// AVX-512 byte and word instructions
+	bool m_avx512bw {false};
+};
+
+} /* namespace swiftrng */
+
+#endif /* CPUFEATURES_H_ */
@@ -0,0 +1,100 @@
+/*
+ * DeviceMonitor.h
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class watches for SwiftRNG devices being plugged in and removed. Devices accessed through libusb
+ are reported by libusb hotplug notifications. On Linux, devices accessed through the CDC USB interface
+ are reported by the udev netlink events of their tty nodes, sent once udev has created the
+ /dev/serial/by-id links used for finding them. The events are delivered from background threads.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef DEVICEMONITOR_H_
+#define DEVICEMONITOR_H_
+
+#include <thread>
+#include <atomic>
+
+#if defined _WIN32
+	#include "libusb.h"
+#elif defined __FreeBSD__
+	#include <libusb.h>
+#else
+	#include <libusb-1.0/libusb.h>
+#endif
+
+#include <UsbDeviceIds.h>
+
+namespace swiftrng {
+
+// Called from a monitor thread when a device is plugged in (`arrived` is true) or removed
+typedef void (*DeviceEventCallback)(void *arg, bool arrived);
+
+class DeviceMonitor {
+public:
+	DeviceMonitor() = default;
+	DeviceMonitor(const DeviceMonitor &) = delete;
+	DeviceMonitor& operator=(const DeviceMonitor &) = delete;
+	virtual ~DeviceMonitor();
+	int start(DeviceEventCallback callback, void *arg);
+	void stop();
+	bool is_running() const;
+
+private:
+	bool start_usb_hotplug();
+	void usb_hotplug_run();
+	static int LIBUSB_CALL usb_hotplug_event(libusb_context *ctx, libusb_device *device,
+			libusb_hotplug_event event, void *user_data);
+#ifdef __linux__
+	bool start_udev_monitor();
+	void udev_monitor_run();
+	void process_udev_message(const char *msg, int msg_len);
+	static bool is_swiftrng_usb_id(const char *vendor_id, const char *product_id);
+#endif
+	void deregister_usb_hotplug();
+
+private:
+	// Milliseconds the libusb event thread waits for an event before checking for a stop request
+	static const int c_usb_event_timeout_millis {500};
+
+	DeviceEventCallback m_callback {nullptr};
+	void *m_callback_arg {nullptr};
+	std::atomic<bool> m_stop_requested {false};
+
+	libusb_context *m_libusb_luctx {nullptr};
+	// One hotplug callback per SwiftRNG USB id, the first `m_num_hotplug_handles` are registered
+	libusb_hotplug_callback_handle m_hotplug_handles[c_num_swiftrng_usb_ids] {};
+	int m_num_hotplug_handles {0};
+	bool m_usb_hotplug_running {false};
+	std::thread m_usb_thread;
+
+#ifdef __linux__
+	// Netlink multicast group of the events udev sends after processing the kernel events
+	static const unsigned c_udev_monitor_group {2};
+
+	// Largest udev message received
+	static const int c_max_udev_msg_size {8192};
+
+	// Socket receiving the udev events, -1 when not open
+	int m_udev_fd {-1};
+
+	// Pipe written to by `stop()` for waking up the udev monitor thread
+	int m_wakeup_pipe[2] {-1, -1};
+	bool m_udev_monitor_running {false};
+	std::thread m_udev_thread;
+#endif
+};
+
+} /* namespace swiftrng */
+
+#endif /* DEVICEMONITOR_H_ */
@@ -0,0 +1,170 @@
+/*
+ * EntropyConditioner.h
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class implements the post processing methods (SHA-256, SHA-512 and xorshift64) used for conditioning
+ blocks of random data received from SwiftRNG devices. It keeps no state between calls, hashing state
+ is held by the context structures passed by the caller, so the single instance may be used concurrently
+ by any number of threads, each one with its own context. No device is needed for using it.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef ENTROPYCONDITIONER_H_
+#define ENTROPYCONDITIONER_H_
+
+#include <cstdint>
+#include <PostProcessingKernels.h>
+
+namespace swiftrng {
+
+// A structure used for generating SHA-256 hash
+struct Sha256Context {
+	uint32_t a;
+	uint32_t b;
+	uint32_t c;
+	uint32_t d;
+	uint32_t e;
+	uint32_t f;
+	uint32_t g;
+	uint32_t h;
+	uint32_t h0;
+	uint32_t h1;
+	uint32_t h2;
+	uint32_t h3;
+	uint32_t h4;
+	uint32_t h5;
+	uint32_t h6;
+	uint32_t h7;
+	uint32_t tmp1;
+	uint32_t tmp2;
+	uint32_t w[64];
+};
+
+// A structure used for generating SHA-512 hash
+struct Sha512Context {
+	uint64_t a;
+	uint64_t b;
+	uint64_t c;
+	uint64_t d;
+	uint64_t e;
+	uint64_t f;
+	uint64_t g;
+	uint64_t h;
+	uint64_t h0;
+	uint64_t h1;
+	uint64_t h2;
+	uint64_t h3;
+	uint64_t h4;
+	uint64_t h5;
+	uint64_t h6;
+	uint64_t h7;
+	uint64_t tmp1;
+	uint64_t tmp2;
+	uint64_t w[80];
+};
+
+// Conditioning state of one thread
+struct ConditionerContext {
+	Sha256Context sha256;
+	Sha512Context sha512;
+	// Serial number stamped into the first chunk of the next data block conditioned with SHA-256
+	uint32_t blockSerialNumber;
+};
+
+class EntropyConditioner {
+public:
+	static const EntropyConditioner& get_instance();
+	int condition_block(ConditionerContext &ctxt, const unsigned char *in, unsigned char *out, int method_id) const;
+	void sha256_hashChunks(Sha256Context &ctxt, const uint32_t *src, uint32_t serial_number, uint32_t *dst, int num_chunks) const;
+	void sha512_hashChunks(Sha512Context &ctxt, const uint64_t *src, uint64_t *dst, int num_chunks) const;
+	void xorshift64_postProcess(uint8_t *buffer, int num_elements) const;
+	int sha256_generateHash(Sha256Context &ctxt, const uint32_t *src, int16_t len, uint32_t *dst) const;
+	int sha512_generateHash(Sha512Context &ctxt, const uint64_t *src, int16_t len, uint64_t *dst) const;
+	int sha256_selfTest() const;
+	int sha512_selfTest() const;
+	int xorshift64_selfTest() const;
+	int failed_selfTest_method_id() const { return m_failed_selfTest_method_id; }
+
+	// Method id for using SHA-256 for post processing
+	static const int c_sha256_method_id {0};
+
+	// Method id for using XORSHIFT64 for post processing
+	static const int c_xorshift64_method_id {1};
+
+	// Method id for using SHA-512 for post processing
+	static const int c_sha512_method_id {2};
+
+	// Size of the data blocks conditioned by `condition_block()`, both input and output
+	static const int c_block_size_bytes {16000};
+
+	// Number of data words in each hashed chunk
+	static const int c_chunk_num_words {8};
+
+	// Number of chunks in a data block: 8 x 32 bit words for SHA-256 and 8 x 64 bit words for SHA-512
+	static const int c_sha256_num_chunks {c_block_size_bytes / (c_chunk_num_words * 4)};
+	static const int c_sha512_num_chunks {c_block_size_bytes / (c_chunk_num_words * 8)};
+
+	// Max number of chunks hashed in parallel by the multi-buffer implementations
+	static const int c_max_hash_lanes {16};
+
+private:
+	EntropyConditioner();
+	void sha256_initialize(Sha256Context &ctxt) const;
+	void sha512_initialize(Sha512Context &ctxt) const;
+	void sha256_hashCurrentBlock(Sha256Context &ctxt) const;
+	void sha512_hashCurrentBlock(Sha512Context &ctxt) const;
+	int sha256_multiBufferSelfTest() const;
+	int sha512_multiBufferSelfTest() const;
+	int xorshift64_simdSelfTest() const;
+	uint64_t xorshift64_postProcessWord(uint64_t raw_word) const;
+	uint32_t sha256_ch(uint32_t *x, uint32_t *y, uint32_t *z) const;
+	uint32_t sha256_maj(const uint32_t *x, const uint32_t *y, const uint32_t *z) const;
+	uint32_t sha256_sum0(const uint32_t *x) const;
+	uint32_t sha256_sum1(const uint32_t *x) const;
+	uint32_t sha256_sigma0(const uint32_t *x) const;
+	uint32_t sha256_sigma1(const uint32_t *x) const;
+	uint64_t sha512_ch(const uint64_t *x, const uint64_t *y, const uint64_t *z) const;
+	uint64_t sha512_maj(const uint64_t *x, const uint64_t *y, const uint64_t *z) const;
+	uint64_t sha512_sum0(const uint64_t *x) const;
+	uint64_t sha512_sum1(const uint64_t *x) const;
+	uint64_t sha512_sigma0(const uint64_t *x) const;
+	uint64_t sha512_sigma1(const uint64_t *x) const;
+	uint32_t rotr32(uint32_t sb, uint32_t w) const { return ((w) >> (sb)) | ((w) << (32-(sb))); }
+	uint64_t rotr64(uint64_t sb, uint64_t w) const { return ((w) >> (sb)) | ((w) << (64-(sb))); }
+
+private:
+	// The size of one block of data words used with SHA-256 hashing
+	static const uint8_t c_max_data_block_size_words {16};
+
+	// Room for the words of one chunk to hash, including the SHA-256 serial number
+	static const int c_max_hash_input_words {16};
+
+	// CPU specific SHA-256 block compression, nullptr when the portable implementation is used
+	Sha256TransformFn m_sha256_transform {nullptr};
+
+	// CPU specific multi-buffer SHA-256 hashing of whole chunks, nullptr when chunks are hashed one by one
+	Sha256StampedHashFn m_sha256_stamped_hash {nullptr};
+
+	// CPU specific multi-buffer SHA-512 hashing of whole chunks, nullptr when chunks are hashed one by one
+	Sha512MultiHashFn m_sha512_multi_hash {nullptr};
+
+	// CPU specific xorshift64 post processing of several words at once, nullptr when words are processed one by one
+	Xorshift64Fn m_xorshift64_kernel {nullptr};
+
+	// Post processing method id of the first self-test failed when the instance was created, -1 if all passed
+	int m_failed_selfTest_method_id {-1};
+};
+
+} /* namespace swiftrng */
+
+#endif /* ENTROPYCONDITIONER_H_ */
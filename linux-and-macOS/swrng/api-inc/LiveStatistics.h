@@ -0,0 +1,102 @@
+/*
+ * LiveStatistics.h
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class keeps the live statistics of a SwiftRNG device: counters, nanosecond latency histograms
+ of the download stages and the current throughput. The statistics are updated by the thread using
+ the device and may be read at the same time from any other thread without locking.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef LIVESTATISTICS_H_
+#define LIVESTATISTICS_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include <ApiStructs.h>
+
+namespace swiftrng {
+
+class LiveStatistics {
+public:
+	LiveStatistics() = default;
+	LiveStatistics(const LiveStatistics &) = delete;
+	LiveStatistics& operator=(const LiveStatistics &) = delete;
+
+	static uint64_t now_nanos();
+
+	void add_block(uint64_t num_bytes);
+	void add_retry() { increment(m_num_retries, 1); }
+	void add_timeout() { increment(m_num_timeouts, 1); }
+	void add_rct_failures(uint64_t num_failures) { increment(m_num_rct_failures, num_failures); }
+	void add_apt_failures(uint64_t num_failures) { increment(m_num_apt_failures, num_failures); }
+	void record_usb_latency(uint64_t begin_nanos) { m_usb_latency.record(now_nanos() - begin_nanos); }
+	void record_health_test_latency(uint64_t begin_nanos) { m_health_test_latency.record(now_nanos() - begin_nanos); }
+	void record_conditioning_latency(uint64_t begin_nanos) { m_conditioning_latency.record(now_nanos() - begin_nanos); }
+	void snapshot(DeviceLiveStatistics *stats) const;
+	void reset();
+
+private:
+	class Histogram {
+	public:
+		void record(uint64_t nanos);
+		void snapshot(LatencyHistogram *histogram) const;
+		void reset();
+
+	private:
+		std::atomic<uint64_t> m_count {0};
+		std::atomic<uint64_t> m_total_nanos {0};
+		std::atomic<uint64_t> m_max_nanos {0};
+		std::atomic<uint64_t> m_buckets[SWRNG_LATENCY_BUCKETS] {};
+	};
+
+	// There is one writer, so the counters are updated without read-modify-write instructions
+	static void increment(std::atomic<uint64_t> &counter, uint64_t value) {
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	void update_throughput(uint64_t now);
+
+private:
+	// Minimum nanoseconds over which the throughput is measured before folding it into the moving average
+	static const uint64_t c_rate_window_nanos {100000000};
+
+	// Nanoseconds without a block after which the device is considered idle and its throughput reported as 0
+	static const uint64_t c_idle_nanos {1000000000};
+
+	// Weight of the latest measured throughput in the moving average
+	static constexpr double c_rate_weight {0.125};
+
+	std::atomic<uint64_t> m_num_bytes {0};
+	std::atomic<uint64_t> m_num_blocks {0};
+	std::atomic<uint64_t> m_num_retries {0};
+	std::atomic<uint64_t> m_num_timeouts {0};
+	std::atomic<uint64_t> m_num_rct_failures {0};
+	std::atomic<uint64_t> m_num_apt_failures {0};
+	Histogram m_usb_latency;
+	Histogram m_health_test_latency;
+	Histogram m_conditioning_latency;
+
+	// Moving average of the throughput in bytes per second and when the last block was added
+	std::atomic<double> m_bytes_per_sec {0};
+	std::atomic<uint64_t> m_last_block_nanos {0};
+
+	// Throughput measurement window, only accessed by the writer
+	uint64_t m_window_begin_nanos {0};
+	uint64_t m_window_bytes {0};
+};
+
+} /* namespace swiftrng */
+
+#endif /* LIVESTATISTICS_H_ */
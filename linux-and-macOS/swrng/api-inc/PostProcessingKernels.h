@@ -0,0 +1,91 @@
+/*
+ * PostProcessingKernels.h
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ CPU specific implementations used for post processing and health testing random data blocks.
+ The kernels must only be called when CpuFeatures reports the instruction set extensions they rely on.
+
+ This code may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef POSTPROCESSINGKERNELS_H_
+#define POSTPROCESSINGKERNELS_H_
+
+#include <cstdint>
+
+namespace swiftrng {
+
+// SHA-256 round constants, FIPS PUB 180-4 section 4.2.2
+extern const uint32_t c_sha256_round_constants[64];
+
+// SHA-512 round constants, FIPS PUB 180-4 section 4.2.3
+extern const uint64_t c_sha512_round_constants[80];
+
+// SHA-256 compression of a 16 word message block into the 8 word `state` (H0 through H7)
+typedef void (*Sha256TransformFn)(uint32_t *state, const uint32_t *block);
+
+// SHA-256 compression using the x86 SHA extensions
+void sha256_transform_sha_ni(uint32_t *state, const uint32_t *block);
+
+// Hash consecutive 8 word messages, each followed by a serial number word (`serial_number` + message index),
+// into 8 word digests. Returns how many messages were hashed, a multiple of the number of lanes.
+typedef int (*Sha256StampedHashFn)(const uint32_t *src, uint32_t serial_number, uint32_t *dst, int num_msgs);
+
+// 8 lane multi-buffer SHA-256 using AVX2
+int sha256_hash_stamped_avx2(const uint32_t *src, uint32_t serial_number, uint32_t *dst, int num_msgs);
+
+// 16 lane multi-buffer SHA-256 using AVX-512
+int sha256_hash_stamped_avx512(const uint32_t *src, uint32_t serial_number, uint32_t *dst, int num_msgs);
+
+// Hash consecutive 8 word messages into 8 word SHA-512 digests.
+// Returns how many messages were hashed, a multiple of the number of lanes.
+typedef int (*Sha512MultiHashFn)(const uint64_t *src, uint64_t *dst, int num_msgs);
+
+// 4 lane multi-buffer SHA-512 using AVX2
+int sha512_hash_avx2(const uint64_t *src, uint64_t *dst, int num_msgs);
+
+// 8 lane multi-buffer SHA-512 using AVX-512
+int sha512_hash_avx512(const uint64_t *src, uint64_t *dst, int num_msgs);
+
+// Xorshift64 post processing of 64 bit words in place.
+// Returns how many words were processed, a multiple of the number of lanes.
+typedef int (*Xorshift64Fn)(uint8_t *buffer, int num_words);
+
+// 4 lane xorshift64 using AVX2
+int xorshift64_avx2(uint8_t *buffer, int num_words);
+
+// 8 lane xorshift64 using AVX-512
+int xorshift64_avx512(uint8_t *buffer, int num_words);
+
+// Bit j of masks[k] is set when src[64 * k + j] equals the byte preceding it, src[-1] must be readable.
+// Returns how many bytes were compared, a multiple of 64.
+typedef int (*RepeatMaskFn)(const uint8_t *src, int num_bytes, uint64_t *masks);
+
+// Repeat masks using AVX2
+int repeat_masks_avx2(const uint8_t *src, int num_bytes, uint64_t *masks);
+
+// Repeat masks using AVX-512
+int repeat_masks_avx512(const uint8_t *src, int num_bytes, uint64_t *masks);
+
+// Count how many of the first `num_bytes` (at most 64) bytes at `src` equal `sample`.
+// All 64 bytes at `src` must be readable.
+typedef int (*SampleMatchCountFn)(const uint8_t *src, int num_bytes, uint8_t sample);
+
+// Sample match count using AVX2
+int count_sample_matches_avx2(const uint8_t *src, int num_bytes, uint8_t sample);
+
+// Sample match count using AVX-512
+int count_sample_matches_avx512(const uint8_t *src, int num_bytes, uint8_t sample);
+
+} /* namespace swiftrng */
+
+#endif /* POSTPROCESSINGKERNELS_H_ */
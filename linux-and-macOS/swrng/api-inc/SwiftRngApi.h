@@ -27,8 +27,20 @@
 #include <iostream>
 #include <sstream>
 #include <cerrno>
+#include <cstdlib>
+#include <utility>
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <ApiStructs.h>
+#include <CpuFeatures.h>
+#include <PostProcessingKernels.h>
+#include <EntropyConditioner.h>
+#include <LiveStatistics.h>
+#include <UsbDeviceIds.h>
 
 #if defined _WIN32
 	#include "libusb.h"
@@ -55,6 +67,7 @@ public:
 	int get_raw_data_block(NoiseSourceRawData *noise_source_raw_data, int noise_source_num);
 	int get_frequency_tables(FrequencyTables *frequency_tables);
 	int get_device_list(DeviceInfoList *dev_info_list);
+	int get_device_count(int *device_count);
 	int get_model(DeviceModel *model);
 	int get_version(DeviceVersion *version);
 	int get_version_number(double *version);
@@ -71,16 +84,32 @@ public:
 	int enable_post_processing(int post_processing_method_id);
 	int enable_statistical_tests();
 	DeviceStatistics* generate_device_statistics();
+	int get_live_statistics(DeviceLiveStatistics *stats) const;
 	const char* get_last_error_message();
 	std::string get_last_error_log() const {return m_last_error_log_oss.str();}
 	void enable_printing_error_messages();
 	int get_max_apt_failures_per_block(uint16_t *max_apt_failures_per_block) const;
 	int get_max_rct_failures_per_block(uint16_t *max_rct_failures_per_block) const;
+	int enable_download_pipeline(int pipeline_depth);
+	int disable_download_pipeline();
+	int enable_post_processing_workers(int num_workers);
+	int disable_post_processing_workers();
+	int set_bulk_request_blocks(int num_blocks);
 
 
 	virtual	~SwiftRngApi();
 
 
+protected:
+	// Post processing of data blocks without a device, for subclasses testing the post processing threads
+	void sha256_initializeSerialNumber(uint32_t init_value);
+	void hash_block_chunks(const char *src, char *dst);
+	char* alloc_block_buffer();
+	void free_block_buffer(char *buffer);
+	void set_post_processing_method(int post_processing_method_id) {m_post_processing_method_id = post_processing_method_id;}
+	uint32_t get_block_serial_number() const {return m_conditioner_ctxt.blockSerialNumber;}
+	int get_pp_pending() const {return m_pp_pending;}
+
 private:
 	bool is_context_initialized() const { return m_is_initialized; }
 	void initialize();
@@ -91,53 +120,39 @@ private:
 	void apt_initialize();
 	void apt_restart();
 
-	void sha256_initialize();
-	void sha512_initialize();
-	void sha256_stampSerialNumber(uint32_t *input_block);
-	void sha256_initializeSerialNumber(uint32_t init_value);
-	int sha512_generateHash(const uint64_t *src, int16_t len, uint64_t *dst);
-	void sha512_hashCurrentBlock();
-	uint64_t sha512_sigma1(const uint64_t *x);
-	int sha256_selfTest();
-	int sha512_selfTest();
-	int xorshift64_selfTest();
-	uint32_t sha256_ch(uint32_t *x, uint32_t *y, uint32_t *z);
-	uint32_t sha256_maj(const uint32_t *x, const uint32_t *y, const uint32_t *z);
-	uint32_t sha256_sum0(const uint32_t *x);
-	uint32_t sha256_sum1(const uint32_t *x);
-	uint32_t sha256_sigma0(const uint32_t *x);
-	uint32_t sha256_sigma1(const uint32_t *x);
-	uint64_t sha512_ch(const uint64_t *x, const uint64_t *y, const uint64_t *z);
-	uint64_t sha512_maj(const uint64_t *x, const uint64_t *y, const uint64_t *z);
-	uint64_t sha512_sum0(const uint64_t *x);
-	uint64_t sha512_sum1(const uint64_t *x);
-	uint64_t sha512_sigma0(const uint64_t *x);
-	void sha256_hashCurrentBlock();
-	int sha256_generateHash(const uint32_t *src, int16_t len, uint32_t *dst);
+	void hash_chunk_share(ConditionerContext &ctxt, int share_idx, int num_shares);
+	void pp_worker_run(int worker_idx);
+	void pp_workers_stop();
 	void print_err_msg(const std::string &err_msg);
 	int handle_device_version();
-	void clr_rcv_buff();
-	uint64_t xorshift64_postProcessWord(uint64_t raw_word) const;
-	void xorshift64_postProcessWords(uint64_t *buffer, int num_elements);
-	void xorshift64_postProcess(uint8_t *buffer, int num_elements);
+	void clr_rcv_buff(int max_reads = 3);
 	int snd_rcv_usb_data(const char *snd, int size_snd, char *rcv, int size_rcv, int op_timeout_secs);
 	int chip_read_data(char *buff, int length, int op_timeout_secs);
+	int rcv_rnd_block();
+	int pipeline_start();
+	void pipeline_cancel();
+	void pipeline_drain_transfers();
+	void pipeline_free_transfers();
+	int pipeline_submit_slot(int slot_idx);
+	int pipeline_rcv_block();
+	static void LIBUSB_CALL pipeline_transfer_cb(struct libusb_transfer *transfer);
 	void ctxt_reset();
 	int get_entropy_bytes();
 	int rcv_rnd_bytes();
-	void test_samples();
+	int rcv_entropy(unsigned char *buffer, long length);
+	int rcv_bulk_blocks(unsigned char *dst, int num_blocks);
+	int get_stat_tests_status();
+	void test_samples(const char *block);
+	void rct_test_sample(uint8_t value);
+	void apt_test_sample(uint8_t value);
+	void apt_complete_window(uint8_t value);
+	void rct_test_block(const uint8_t *samples, int num_samples);
+	void apt_test_block(const uint8_t *samples, int num_samples);
+	int health_tests_simdSelfTest();
 	void update_dev_info_list(DeviceInfoList* dev_info_list, int *curt_found_dev_num) const;
-	uint32_t rotr32(uint32_t sb, uint32_t w) const { return ((w) >> (sb)) | ((w) << (32-(sb))); }
-	uint64_t rotr64(uint64_t sb, uint64_t w) const { return ((w) >> (sb)) | ((w) << (64-(sb))); }
 
 private:
 
-	// USB vendor id for SwiftRNG devices
-	const int c_usb_vendor_id {0x1fc9};
-
-	// USB product id exclusively used with older SwiftRNG device
-	const int c_usb_product_id {0x8110};
-
 #if defined _WIN32
 	// There could be many CDC COM devices connected, limit the amount of devices to search
 	static const int c_max_cdc_com_ports {80};
@@ -187,52 +202,58 @@ private:
 	// Max amount of bytes to limit by the API when downloading random bytes from device
 	const int c_max_request_size_bytes {100000L};
 
-	// A structure used for generating SHA-256 hash
-	struct {
-		uint32_t a;
-		uint32_t b;
-		uint32_t c;
-		uint32_t d;
-		uint32_t e;
-		uint32_t f;
-		uint32_t g;
-		uint32_t h;
-		uint32_t h0;
-		uint32_t h1;
-		uint32_t h2;
-		uint32_t h3;
-		uint32_t h4;
-		uint32_t h5;
-		uint32_t h6;
-		uint32_t h7;
-		uint32_t tmp1;
-		uint32_t tmp2;
-		uint32_t w[64];
-		uint32_t blockSerialNumber;
-	} m_sha256_ctxt;
-
-	// A structure used for generating SHA-512 hash
-	struct {
-		uint64_t a;
-		uint64_t b;
-		uint64_t c;
-		uint64_t d;
-		uint64_t e;
-		uint64_t f;
-		uint64_t g;
-		uint64_t h;
-		uint64_t h0;
-		uint64_t h1;
-		uint64_t h2;
-		uint64_t h3;
-		uint64_t h4;
-		uint64_t h5;
-		uint64_t h6;
-		uint64_t h7;
-		uint64_t tmp1;
-		uint64_t tmp2;
-		uint64_t w[80];
-	} m_sha512_ctxt;
+	// Max number of 'x' requests that can be in flight when the download pipeline is enabled
+	static const int c_max_pipeline_depth {8};
+
+	// Max number of random data blocks requested at once when receiving whole blocks into the caller buffer
+	static const int c_max_bulk_request_blocks {8};
+
+	// How many random data blocks to request at once when receiving whole blocks into the caller buffer
+	int m_bulk_request_blocks {1};
+
+	// Alignment of the random data block buffers, suitable for the widest vector loads and stores
+	static const size_t c_block_buffer_alignment {64};
+
+	// Conditioning of the received data blocks, shared by all instances
+	const EntropyConditioner &m_conditioner {EntropyConditioner::get_instance()};
+
+	// Hashing state and block serial number used by the caller thread for post processing
+	ConditionerContext m_conditioner_ctxt;
+
+	// CPU specific sample comparisons for the health tests, nullptr when samples are tested one by one
+	RepeatMaskFn m_repeat_mask_kernel {nullptr};
+	SampleMatchCountFn m_sample_match_kernel {nullptr};
+
+	// Max number of threads helping the caller thread to hash the chunks of a data block
+	static const int c_max_pp_workers {16};
+
+	// A post processing thread with its own hashing state
+	struct PostProcessingWorker {
+		std::thread thread;
+		ConditionerContext ctxt;
+	};
+
+	// Post processing threads, `m_num_pp_workers` entries, nullptr when the chunks are hashed by the caller thread only
+	PostProcessingWorker *m_pp_workers {nullptr};
+	int m_num_pp_workers {0};
+
+	// Hand off of the current data block between the caller thread and the post processing threads
+	std::mutex m_pp_mutex;
+	std::condition_variable m_pp_work_cv;
+	std::condition_variable m_pp_done_cv;
+
+	// Data block being hashed and its destination
+	const char *m_pp_src {nullptr};
+	char *m_pp_dst {nullptr};
+
+	// Incremented for each data block handed off to the post processing threads
+	uint64_t m_pp_generation {0};
+
+	// Number of post processing threads still hashing their share of the current data block
+	int m_pp_pending {0};
+
+	// Set to true for terminating the post processing threads
+	bool m_pp_stop {false};
 
 	// Repetition Count Test data
 	struct {
@@ -274,7 +295,7 @@ private:
 	bool m_device_open = false;
 
 	// Random output buffer
-	char *m_buff_rnd_out;
+	char *m_buff_rnd_out {nullptr};
 
 	// Current index for the m_buff_rnd_out buffer
 	int m_cur_rng_out_idx {c_rnd_out_buff_size};
@@ -285,26 +306,34 @@ private:
 	// A buffer for sending commands to USB device
 	unsigned char m_bulk_out_buffer[16];
 
-	// Random input buffer used with hashing or post processing
-	char *m_buff_rnd_in;
+	// A pipeline slot used for keeping one random data block request in flight
+	struct PipelineSlot {
+		// Asynchronous libusb transfers for the 'x' command and for the data block that follows
+		struct libusb_transfer *out_transfer;
+		struct libusb_transfer *in_transfer;
+		// Buffer receiving the data block and the status byte
+		char *in_buffer;
+		// Number of transfers of this slot submitted and not completed yet
+		int in_flight_transfers;
+	};
 
-	// The source of one block of data to hash with SHA-256
-	uint32_t *m_src_to_hash_32;
+	// Download pipeline slots, only `m_pipeline_depth` entries are in use
+	PipelineSlot m_pipeline_slots[c_max_pipeline_depth];
 
-	// The size of one block of data words used with SHA-256 hashing
-	const uint8_t m_max_data_block_size_words {16};
+	// How many 'x' requests to keep in flight, 0 when the download pipeline is disabled
+	int m_pipeline_depth {0};
 
-	// Initialization data for SHA-256 (FIPS PUB 180-4)
-	const uint32_t *c_sha256_k {nullptr};
-	const uint32_t *c_sha256_test_seq_1 {nullptr};
-	const uint32_t *c_sha256_expt_hash_seq_1 {nullptr};
+	// True when requests have been sent ahead to the device for the pipeline
+	bool m_pipeline_active {false};
 
-	// The source of one block of data to hash with SHA-512
-	uint64_t *m_src_to_hash_64;
+	// Index of the pipeline slot that will deliver the next data block (libusb only)
+	int m_pipeline_head {0};
 
-	// Initialization data for SHA-512 (FIPS PUB 180-4)
-	const uint64_t *c_sha512_k {nullptr};
-	const uint64_t *c_sha512_expt_hash_seq1 {nullptr};
+	// Number of 'x' requests sent ahead to a USB CDC device that have not been received yet
+	int m_pipeline_outstanding {0};
+
+	// Random input buffer used with hashing or post processing
+	char *m_buff_rnd_in {nullptr};
 
 	// How many statistical test failures allowed per data block (16000 random bytes)
 	uint8_t m_num_failures_threshold {4};
@@ -318,6 +347,9 @@ private:
 	// A storage for maintaining statistics such as how many bytes retrieved from USB device, transfer speed, e.t.c
 	DeviceStatistics m_device_stats;
 
+	// Counters and latency histograms of the downloads, readable from other threads while downloading
+	LiveStatistics m_live_stats;
+
 	// A storage for holding the last error message. Many operations, when failed, will store the error message in this buffer.
 	// The error text message can be retrieved with `get_last_error_message()` method.
 	std::ostringstream m_last_error_log_oss;
@@ -28,6 +28,8 @@
 #include <sys/types.h>
 #include <sys/file.h>
 #include <ctype.h>
+#include <dirent.h>
+#include <stdlib.h>
 #include <sstream>
 
 #ifdef __FreeBSD__
@@ -55,7 +57,7 @@ private:
 	void purge_comm_data() const;
 
 private:
-	static const int c_max_devices = 25;
+	static const int c_max_devices = 127;
 	static const int c_max_size_device_name = 128;
 	int m_fd {-1};
 	int m_lock;
@@ -0,0 +1,51 @@
+/*
+ * UsbDeviceIds.h
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file defines the USB vendor and product ids of the SwiftRNG devices. They must be kept the same
+ as the ids listed in the udev rules (80-swiftrng-usb-access.rules).
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef USBDEVICEIDS_H_
+#define USBDEVICEIDS_H_
+
+#include <cstdint>
+
+namespace swiftrng {
+
+struct UsbDeviceId {
+	uint16_t vendor_id;
+	uint16_t product_id;
+};
+
+// USB ids of all the SwiftRNG devices
+static const UsbDeviceId c_swiftrng_usb_ids[] {
+	// Older SwiftRNG devices, accessed through libusb
+	{0x1fc9, 0x8110},
+	// SwiftRNG devices accessed through the CDC USB interface
+	{0x1fc9, 0x8111},
+	{0x3975, 0x0001},
+	{0x3975, 0x0002},
+	{0x3975, 0x0003},
+	{0x3975, 0x0004}
+};
+
+static const int c_num_swiftrng_usb_ids {sizeof(c_swiftrng_usb_ids) / sizeof(c_swiftrng_usb_ids[0])};
+
+// USB ids of the SwiftRNG devices accessed through libusb
+static const UsbDeviceId &c_libusb_swiftrng_usb_id {c_swiftrng_usb_ids[0]};
+
+} /* namespace swiftrng */
+
+#endif /* USBDEVICEIDS_H_ */
@@ -0,0 +1,199 @@
+/**
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ This file defines the client API and the protocol of the entropy server, which distributes random bytes
+ downloaded from a cluster of SwiftRNG devices to local processes over a Unix domain socket.
+
+ */
+
+/**
+ *    @file entropy-server-api.h
+ *    @version 1.0
+ *
+ *    @brief The entropy server client API and protocol.
+ *
+ * Each request is a SwrngServerRequest: a command id and the number of bytes expected in the reply,
+ * between 1 and SWRNG_SERVER_MAX_REPLY_BYTES. The server replies with exactly that many bytes,
+ * or closes the connection if the request cannot be served. The command ids are the ones used by
+ * the Windows entropy servers over named pipes, except for CMD_RING_ATTACH_ID: its reply carries
+ * the file descriptors of the shared memory ring.
+ */
+#ifndef ENTROPY_SERVER_API_H_
+#define ENTROPY_SERVER_API_H_
+
+#include <stdint.h>
+#include <ApiStructs.h>
+#include <entropy-server-ring.h>
+
+/* Socket the server listens on unless configured otherwise, in a directory created by the server */
+#define SWRNG_SERVER_DEFAULT_SOCKET_DIR "/run/swiftrng"
+#define SWRNG_SERVER_DEFAULT_SOCKET_PATH SWRNG_SERVER_DEFAULT_SOCKET_DIR "/entropy.sock"
+
+/* Max number of bytes per request */
+#define SWRNG_SERVER_MAX_REPLY_BYTES (100000)
+
+/* Command ids */
+#define CMD_ENTROPY_RETRIEVE_ID 0
+#define CMD_DIAG_ID 1
+#define CMD_DEV_SER_NUM_ID 2
+#define CMD_DEV_MODEL_ID 3
+#define CMD_DEV_MINOR_VERSION_ID 4
+#define CMD_DEV_MAJOR_VERSION_ID 5
+#define CMD_SERV_MINOR_VERSION_ID 6
+#define CMD_SERV_MAJOR_VERSION_ID 7
+#define CMD_NOISE_SRC_ONE_ID 8
+#define CMD_NOISE_SRC_TWO_ID 9
+#define CMD_RING_ATTACH_ID 10
+
+/* Number of bytes of the serial number and the model replies, padded with spaces */
+#define SWRNG_SERVER_SER_NUM_BYTES (15)
+#define SWRNG_SERVER_MODEL_BYTES (15)
+
+typedef struct {
+	uint32_t cmd;
+	uint32_t cbReqData;
+} SwrngServerRequest;
+
+/* Define a type for referencing a connection to the entropy server */
+typedef struct {
+	int sig_begin;
+
+	/* Connected socket, -1 when not connected */
+	int fd;
+
+	/* Path of the server socket */
+	char socket_path[108];
+
+	/* Last error message */
+	char last_err_msg[256];
+
+	int sig_end;
+} SwrngServerConnection;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Initialize a connection context, it must be called before any other call using the context.
+* The context connects to the server on first use, and again on the next use after a failure.
+* A context may only be used by one thread at a time.
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param socketPath - path of the server socket, NULL for the default path
+* @return int - 0 when initialized successfully
+*/
+int swrngInitializeServerConnection(SwrngServerConnection *conn, const char *socketPath);
+
+/**
+* Connect to the entropy server if not connected yet
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @return int - 0 when connected
+*/
+int swrngConnectServer(SwrngServerConnection *conn);
+
+/**
+* Close the connection to the entropy server
+*
+* @param conn - pointer to SwrngServerConnection structure
+*/
+void swrngDisconnectServer(SwrngServerConnection *conn);
+
+/**
+* Retrieve random bytes from the entropy server. Large requests are split into requests of up to
+* SWRNG_SERVER_MAX_REPLY_BYTES bytes.
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param buffer - pointer to the data receive buffer
+* @param length - how many bytes expected to receive
+* @return int - 0 when the bytes were received
+*/
+int swrngGetServerEntropy(SwrngServerConnection *conn, unsigned char *buffer, long length);
+
+/**
+* Retrieve test bytes from the entropy server for checking the communication with it.
+* Each byte, starting with 0, is the previous byte value incremented.
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param buffer - pointer to the data receive buffer
+* @param length - how many bytes expected to receive, up to SWRNG_SERVER_MAX_REPLY_BYTES
+* @return int - 0 when the bytes were received
+*/
+int swrngGetServerTestBytes(SwrngServerConnection *conn, unsigned char *buffer, long length);
+
+/**
+* Retrieve the serial number of the first device used by the entropy server
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param serialNumber - pointer to the structure receiving the serial number
+* @return int - 0 when the serial number was received
+*/
+int swrngGetServerDeviceSerialNumber(SwrngServerConnection *conn, DeviceSerialNumber *serialNumber);
+
+/**
+* Retrieve the model of the first device used by the entropy server
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param model - pointer to the structure receiving the model
+* @return int - 0 when the model was received
+*/
+int swrngGetServerDeviceModel(SwrngServerConnection *conn, DeviceModel *model);
+
+/**
+* Retrieve the version of the first device used by the entropy server
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param majorVersion - pointer to the major version number
+* @param minorVersion - pointer to the minor version number
+* @return int - 0 when the version was received
+*/
+int swrngGetServerDeviceVersion(SwrngServerConnection *conn, int *majorVersion, int *minorVersion);
+
+/**
+* Retrieve the version of the entropy server
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param majorVersion - pointer to the major version number
+* @param minorVersion - pointer to the minor version number
+* @return int - 0 when the version was received
+*/
+int swrngGetServerVersion(SwrngServerConnection *conn, int *majorVersion, int *minorVersion);
+
+/**
+* Attach the shared memory ring of the entropy server, see entropy-server-ring.h.
+* The ring stays usable after disconnecting, until detached. The server closes the connection of
+* the clients not allowed to attach the ring. Every attached client can read every byte in the ring.
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param ring - pointer to the SwrngServerRing structure to initialize
+* @return int - 0 when attached
+*/
+int swrngAttachServerRing(SwrngServerConnection *conn, SwrngServerRing *ring);
+
+/**
+* Detach the shared memory ring of the entropy server
+*
+* @param ring - pointer to SwrngServerRing structure
+*/
+void swrngDetachServerRing(SwrngServerRing *ring);
+
+/**
+* Retrieve the last error message.
+* The caller should make a copy of the error message returned immediately after calling this function.
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @return - pointer to the error message
+*/
+const char* swrngGetServerLastErrorMessage(SwrngServerConnection *conn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENTROPY_SERVER_API_H_ */
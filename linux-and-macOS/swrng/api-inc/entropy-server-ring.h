@@ -0,0 +1,180 @@
+/**
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ This file defines the shared memory ring of the entropy server, used by local processes for retrieving
+ random bytes without a system call when the bytes are already available.
+
+ */
+
+/**
+ *    @file entropy-server-ring.h
+ *    @version 1.0
+ *
+ *    @brief The entropy server shared memory ring, Linux only.
+ *
+ * The server publishes blocks of random bytes into a ring of SWRNG_SERVER_RING_NUM_BLOCKS blocks.
+ * The ring is made of three memory files passed to the clients over the server socket,
+ * see swrngAttachServerRing():
+ * - the blocks, written by the server and mapped read-only by the clients;
+ * - the ring state with the block sequence numbers, also written by the server and mapped read-only;
+ * - the claims, the only part the clients write to, mapped read-write.
+ * The server seals the files it writes to against writing through any other mapping or descriptor.
+ *
+ * A client claims the bytes it needs with a single atomic increment of the claim position, so each byte
+ * is handed out once. The server overwrites a block only after all its bytes were claimed. A client that
+ * is too slow copying the bytes it claimed finds the block overwritten and claims other bytes instead.
+ * The futex words are used for waiting, by the clients when the ring is empty and by the server when full.
+ *
+ * Every attached client can read every byte in the ring, including the bytes claimed by the other clients,
+ * and can disturb the claims of the other clients. Attach only clients trusted with each other's random
+ * bytes; the server hands out the ring to the clients running as root or as the user of the server, and
+ * to the clients whose primary group is allowed with its --ring-group option. The other clients retrieve
+ * random bytes over the socket, where each client receives only its own bytes.
+ */
+#ifndef ENTROPY_SERVER_RING_H_
+#define ENTROPY_SERVER_RING_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define SWRNG_SERVER_RING_MAGIC (0x53575247U)
+#define SWRNG_SERVER_RING_VERSION (1)
+
+/* Number of bytes of a ring block */
+#define SWRNG_SERVER_RING_BLOCK_SIZE (16384)
+
+/* Number of blocks in the ring */
+#define SWRNG_SERVER_RING_NUM_BLOCKS (256)
+
+/* Number of memory files of the ring: the claims, the ring state and the blocks */
+#define SWRNG_SERVER_RING_NUM_FILES (3)
+
+/* The ring state written by the server only, each part in its own cache line */
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t block_size;
+	uint32_t num_blocks;
+
+	/* Number of blocks published by the server */
+	__attribute__((aligned(64))) volatile uint64_t write_pos;
+
+	/* Incremented by the server after publishing a block */
+	volatile uint32_t data_futex;
+
+	/* 1 when the server waits on `space_futex` */
+	volatile uint32_t space_waiter;
+
+	/* Block number plus one stored in each ring entry, 0 while the server writes the entry */
+	__attribute__((aligned(64))) volatile uint64_t block_seq[SWRNG_SERVER_RING_NUM_BLOCKS];
+} SwrngServerRingState;
+
+/* The positions and the futex words written by the clients, each in its own cache line */
+typedef struct {
+	/* Position of the next byte to claim by the clients */
+	volatile uint64_t claim_pos;
+
+	/* Number of clients waiting on `data_futex` */
+	__attribute__((aligned(64))) volatile uint32_t num_data_waiters;
+
+	/* Incremented by the clients for waking up the server waiting for the ring to have space */
+	__attribute__((aligned(64))) volatile uint32_t space_futex;
+} SwrngServerRingClaims;
+
+/* Define a type for referencing the ring attached by a client */
+typedef struct {
+	/* Ring state, mapped read-only */
+	const SwrngServerRingState *state;
+
+	/* Claims of the clients, mapped read-write */
+	SwrngServerRingClaims *claims;
+
+	/* Ring blocks, mapped read-only */
+	const unsigned char *data;
+
+	/* Connection to the server, used for finding out if the server is still running */
+	int server_fd;
+} SwrngServerRing;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Wait for the server to publish a block or to stop. Called by swrngGetServerRingEntropy() only.
+*
+* @param ring - pointer to SwrngServerRing structure
+* @param blockNum - block number waited for
+* @return int - 0 when the block may be published, -1 when the server stopped
+*/
+int swrngWaitServerRing(SwrngServerRing *ring, uint64_t blockNum);
+
+/**
+* Wake up the server waiting for the ring to have space. Called by swrngGetServerRingEntropy() only.
+*
+* @param ring - pointer to SwrngServerRing structure
+*/
+void swrngWakeServerRing(SwrngServerRing *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+* Retrieve random bytes from the ring attached with swrngAttachServerRing(). No system call is made
+* when the bytes are available. It may be called concurrently from several threads and processes,
+* each receiving distinct random bytes.
+*
+* @param ring - pointer to SwrngServerRing structure
+* @param buffer - pointer to the data receive buffer
+* @param length - how many bytes expected to receive
+* @return int - 0 when the bytes were received, -1 when the server stopped
+*/
+static inline int swrngGetServerRingEntropy(SwrngServerRing *ring, unsigned char *buffer, size_t length) {
+	const SwrngServerRingState *state = ring->state;
+	const uint64_t blockSize = SWRNG_SERVER_RING_BLOCK_SIZE;
+
+	while (length > 0) {
+		uint64_t pos = __atomic_fetch_add(&ring->claims->claim_pos, (uint64_t)length, __ATOMIC_SEQ_CST);
+		if ((pos + length) / blockSize != pos / blockSize && __atomic_load_n(&state->space_waiter, __ATOMIC_SEQ_CST)) {
+			swrngWakeServerRing(ring);
+		}
+
+		size_t copied = 0;
+		while (copied < length) {
+			uint64_t blockNum = (pos + copied) / blockSize;
+			uint64_t offset = (pos + copied) % blockSize;
+			size_t chunk = length - copied < blockSize - offset ? length - copied : (size_t)(blockSize - offset);
+			const volatile uint64_t *seq = &state->block_seq[blockNum % SWRNG_SERVER_RING_NUM_BLOCKS];
+
+			uint64_t cur = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+			if (cur != blockNum + 1) {
+				if (cur > blockNum + 1 || __atomic_load_n(&state->write_pos, __ATOMIC_ACQUIRE) > blockNum) {
+					/* Overwritten already, claim other bytes for the rest */
+					break;
+				}
+				if (swrngWaitServerRing(ring, blockNum) != 0) {
+					return -1;
+				}
+				continue;
+			}
+			memcpy(buffer + copied, ring->data + (blockNum % SWRNG_SERVER_RING_NUM_BLOCKS) * blockSize + offset, chunk);
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(seq, __ATOMIC_RELAXED) != blockNum + 1) {
+				/* The server overwrote the block while copying */
+				break;
+			}
+			copied += chunk;
+		}
+		buffer += copied;
+		length -= copied;
+	}
+	return 0;
+}
+
+#endif /* ENTROPY_SERVER_RING_H_ */
@@ -54,6 +54,60 @@
 #endif
 
 
+/* Max number of devices in a cluster */
+#define SWRNG_CL_MAX_SIZE (64)
+
+/* Max number of CPUs a download thread can be pinned to */
+#define SWRNG_CL_MAX_CPUS (1024)
+
+/**
+ * A set of CPUs, bit N % 64 of `bits[N / 64]` stands for CPU N. An empty set stands for any CPU.
+ */
+typedef struct {
+	uint64_t bits[SWRNG_CL_MAX_CPUS / 64];
+} SwrngCLCpuSet;
+
+/**
+ * Synchronization primitives used by the cluster threads
+ */
+#if defined(_WIN32)
+typedef CRITICAL_SECTION SwrngCLMutex;
+typedef CONDITION_VARIABLE SwrngCLCond;
+typedef SRWLOCK SwrngCLRWLock;
+#else
+typedef pthread_mutex_t SwrngCLMutex;
+typedef pthread_cond_t SwrngCLCond;
+typedef pthread_rwlock_t SwrngCLRWLock;
+#endif
+
+/**
+ * A condition that counts its notifications. Waiters take the count before checking what they
+ * wait for, so a notification sent in between is never missed.
+ */
+typedef struct {
+	SwrngCLMutex mutex;
+	SwrngCLCond synch;
+
+	/* Incremented with each notification */
+	unsigned long seq;
+} SwrngCLEvent;
+
+/**
+ * A slot of the cluster entropy ring
+ */
+typedef struct {
+	/* Ring position `pos` when free for the producer claiming `pos`, `pos` + 1 once filled */
+	volatile uint64_t seq;
+
+	/* Number of slot bytes already copied out by the consumers */
+	volatile uint64_t consumed;
+
+	/* Random bytes of the slot */
+	unsigned char *data;
+} SwrngCLSlot;
+
+struct SwrngCLContext_s;
+
 /**
  * Thread context structure
  */
@@ -62,16 +116,31 @@ typedef struct {
 	/* A context reference to a single device */
 	SwrngContext ctxt;
 
-	/* Thread handle and synchronization variables */
+	/* Thread handle */
 #if defined(_WIN32)
 	HANDLE dwnl_thread;
-	HANDLE dwnl_thread_event;
 #else
 	pthread_t dwnl_thread;
-	pthread_mutex_t dwnl_mutex;
-	pthread_cond_t dwnl_synch;
 #endif
 
+	/* The cluster the thread downloads for */
+	struct SwrngCLContext_s *cl_ctxt;
+
+	/* 1 - `ctxt` holds an open device, 0 - the device failed or no device was found for the slot yet */
+	int dev_open;
+
+	/* 1 - the thread opens a device as the cluster opens, concurrently with the other threads, 0 - otherwise */
+	int open_on_start;
+
+	/* When to look for a device next, in seconds of a monotonic clock */
+	double next_probe_secs;
+
+	/* Until when a failed look up is retried shortly, set when a device is plugged in */
+	double hotplug_deadline_secs;
+
+	/* 1 - thread must not start new device operations while the devices are reconfigured, 0 - otherwise */
+	int dwnl_suspended;
+
 	/* 1 - thread is marked for destruction, 0 - otherwise */
 	volatile int destroy_dwnl_thread_req;
 
@@ -81,15 +150,24 @@ typedef struct {
 	/* 1 - thread is in a good state, 0 - thread encountered a device error */
 	volatile int dwnl_status;
 
-	/* A pointer to a memory location used for retrieving random byte stream from the device */
-	unsigned char *thread_device_data_buffer;
+	/* Buffer the thread downloads into, swapped with the buffer of the ring slot it fills */
+	unsigned char *spare_buffer;
+
+	/* 1 - `spare_buffer` holds random bytes waiting for a free ring slot, 0 - otherwise */
+	int spare_filled;
+
+	/* Moving average of the device download rate in bytes per second, 0 until the first download completes */
+	double dwnl_rate;
+
+	/* Number of random bytes the thread published to the ring since the cluster opened */
+	uint64_t dwnl_bytes;
 
 } SwrngThreadContext;
 
 /**
  * Cluster context structure
  */
-typedef struct {
+typedef struct SwrngCLContext_s {
 	/* Used for context sanity check */
 	int sig_begin_data;
 
@@ -108,17 +186,73 @@ typedef struct {
 	/* 1 - if cluster was successfully open, 0 - otherwise */
 	int is_cluster_open;
 
-	/* Preferred cluster size - number of devices in a cluster */
+	/* Preferred cluster size - number of device slots, the empty slots keep looking for devices */
 	int cluster_size;
 
-	/* Actual cluster size - actual number of devices in a cluster */
-	int actual_cluster_size;
+	/* Actual cluster size - number of devices currently open in the cluster */
+	volatile int actual_cluster_size;
+
+	/* Number of devices found when the cluster opened */
+	int open_num_devs;
 
-	/* Final TRNG output buffer for cluster */
+	/* Next device number to open as the cluster opens, claimed by the download threads */
+	volatile uint64_t open_next_dev_num;
+
+	/* Number of download threads still opening a device as the cluster opens */
+	int open_pending;
+
+	/* Storage for the ring slots and the download thread buffers, its pages are first touched by the download threads */
 	unsigned char *out_data_buff;
 
-	/* Current index used with `out_data_buff` */
-	int cur_out_data_buff_idx;
+	/* Size of `out_data_buff` in bytes */
+	size_t out_data_buff_size;
+
+	/* Entropy ring shared by all download threads and consumers */
+	SwrngCLSlot *ring_slots;
+
+	/* Number of entries in `ring_slots` */
+	int ring_num_slots;
+
+	/* Next ring position to fill, claimed by the download threads */
+	volatile uint64_t ring_write_pos;
+
+	/* Next ring byte to copy out, claimed by the consumers */
+	volatile uint64_t ring_read_pos;
+
+	/* Number of consumers that gave up waiting and wait for discarding the ring bytes. The bytes they claimed
+	 * are never copied out, so the other consumers stop waiting for ring slots and retry after the reset. */
+	volatile uint64_t ring_resets_pending;
+
+	/* Wakes up consumers when a ring slot is filled or a download thread fails */
+	SwrngCLEvent ready_event;
+
+	/* Wakes up download threads when their state changes, guards the thread states. Counts the ring slots freed. */
+	SwrngCLEvent space_event;
+
+	/* Signaled with `space_event.mutex` held when a download thread completes a device operation */
+	SwrngCLCond idle_synch;
+
+	/* Signaled with `space_event.mutex` held once for each ring slot freed, or broadcast when the thread states
+	 * change, wakes up the download threads waiting for a free ring slot */
+	SwrngCLCond full_synch;
+
+	/* Shared by the consumers, held exclusively while the cluster is opened, closed or reconfigured */
+	SwrngCLRWLock cl_lock;
+
+	/* Held by the download thread looking for a device */
+	SwrngCLMutex probe_mutex;
+
+	/* Reports the devices plugged in, so the empty slots look for them right away */
+	SwrngDeviceMonitorContext dev_monitor;
+
+	/* 1 - `dev_monitor` is running, 0 - device events are not available and the empty slots only poll */
+	int dev_monitor_running;
+
+	/* Error code of the latest download thread error, 0 if none */
+	int dwnl_err_status;
+
+	/* Error message of the latest download thread error */
+	char dwnl_err_msg[256];
 
 	/* Power profile number of the cluster */
 	int ppn_number;
@@ -126,10 +260,10 @@ typedef struct {
 	/* 1 - if the power profile number changed for the cluster, 0 - otherwise */
 	int ppn_changed;
 
-	/* How many times cluster recovered from errors */
+	/* How many times a cluster device failed and was dropped */
 	long num_cl_failover_events;
 
-	/* How many times cluster attempted to resize */
+	/* How many times an empty slot looked for a device */
 	long num_cl_resize_events;
 
 	/* Time when cluster open successfully */
@@ -144,6 +278,12 @@ typedef struct {
 	/* -1 if not in use, 0 for SHA256 (default), 1 for xorshift64 (devices with versions 1.2 and up), 2 for SHA512 */
 	int post_processing_method_id;
 
+	/* Live statistics the devices dropped from the cluster since it opened had collected, guarded by `space_event.mutex` */
+	DeviceLiveStatistics retired_stats;
+
+	/* CPUs the download thread of each slot runs on, kept when the cluster is closed and open again */
+	SwrngCLCpuSet thread_cpus[SWRNG_CL_MAX_SIZE];
+
 	/* Used for context sanity check */
 	int sig_end_block;
 } SwrngCLContext;
@@ -165,7 +305,9 @@ extern "C" {
 int swrngInitializeCLContext(SwrngCLContext *ctxt);
 
 /**
-* Open SwiftRNG USB cluster.
+* Open SwiftRNG USB cluster. The devices available are open, the slots left empty up to the preferred
+* cluster size are filled as soon as more devices are plugged in, or within a few seconds when the
+* host does not report device events.
 *
 * @param ctxt - pointer to SwrngCLContext structure
 * @param int cluster_size - preferred cluster size
@@ -205,7 +347,8 @@ int swrngGetCLSize(const SwrngCLContext *ctxt);
 
 /**
 * Retrieve number of cluster fail-over events. That number will be incremented each
-* time the cluster is trying to recover as a result of device errors.
+* time a device fails and is dropped from the cluster. The other devices keep serving
+* while the failed one is looked for again in the background.
 * @param ctxt - pointer to SwrngCLContext structure
 * @return - number of cluster fail-over events
 */
@@ -213,14 +356,55 @@ long swrngGetCLFailoverEventCount(const SwrngCLContext *ctxt);
 
 /**
 * Retrieve number of cluster resize attempts. That number will be incremented each
-* time the cluster is trying to resize to reach the preferred size.
+* time the cluster is looking for a device in the background to reach the preferred size.
 * @param ctxt - pointer to SwrngCLContext structure
 * @return - number of cluster resize attempts
 */
 long swrngGetCLResizeAttemptCount(const SwrngCLContext *ctxt);
 
 /**
-* A function to retrieve random bytes from a cluster of SwiftRNG devices
+* Retrieve the measured download rate of a cluster device, a moving average over its recent downloads.
+* The devices share the work, so each one contributes random bytes in proportion to its rate.
+* @param ctxt - pointer to SwrngCLContext structure
+* @param devIdx - device index, 0 through swrngGetCLSize() - 1
+* @return - download rate in bytes per second, 0 if not measured yet or the device index is invalid
+*/
+double swrngGetCLDeviceDownloadRate(SwrngCLContext *ctxt, int devIdx);
+
+/**
+* Retrieve the number of random bytes a cluster device contributed since the cluster opened
+* @param ctxt - pointer to SwrngCLContext structure
+* @param devIdx - device index, 0 through swrngGetCLSize() - 1
+* @return - number of bytes contributed, 0 if the device index is invalid
+*/
+uint64_t swrngGetCLDeviceByteCount(SwrngCLContext *ctxt, int devIdx);
+
+/**
+* Retrieve the live statistics of a cluster device: counters, nanosecond latency histograms of the download stages
+* and the current throughput. It may be called while the cluster is downloading, the statistics are read without
+* waiting for the downloads in progress.
+* @param ctxt - pointer to SwrngCLContext structure
+* @param devIdx - device index, 0 through swrngGetCLSize() - 1
+* @param stats - pointer to the structure receiving the statistics
+* @return int - 0 when the statistics were retrieved, -1 if the device index is invalid
+*/
+int swrngGetCLDeviceLiveStatistics(SwrngCLContext *ctxt, int devIdx, DeviceLiveStatistics *stats);
+
+/**
+* Retrieve the live statistics of the cluster, the totals of its current devices and of the devices
+* dropped since it opened. The throughput is the sum of the current device throughputs.
+* It may be called while the cluster is downloading, the statistics are read without waiting for the downloads in progress.
+* @param ctxt - pointer to SwrngCLContext structure
+* @param stats - pointer to the structure receiving the statistics
+* @return int - 0 when the statistics were retrieved
+*/
+int swrngGetCLLiveStatistics(SwrngCLContext *ctxt, DeviceLiveStatistics *stats);
+
+/**
+* A function to retrieve random bytes from a cluster of SwiftRNG devices.
+* It may be called concurrently from several threads, each receiving distinct random bytes.
+* The bytes are copied into the buffer by the calling thread, so on NUMA hosts a buffer allocated
+* and first written by the reading thread stays on the NUMA node of that thread.
 *
 * @param ctxt - pointer to SwrngCLContext structure
 * @param unsigned char *buffer - a pointer to the data receive buffer
@@ -230,6 +414,30 @@ long swrngGetCLResizeAttemptCount(const SwrngCLContext *ctxt);
 */
 int swrngGetCLEntropy(SwrngCLContext *ctxt, unsigned char *buffer, long length);
 
+/**
+* Pin the download thread of a cluster slot to a set of CPUs. The thread downloads from the device of the slot
+* and conditions its random bytes, the ring buffers it fills first are allocated on the NUMA node it runs on.
+* May be called before the cluster is open, the setting is kept when the cluster is closed and open again.
+* Only supported on Linux.
+*
+* @param ctxt - pointer to SwrngCLContext structure, initialized with swrngInitializeCLContext()
+* @param slot - slot number, 0 through the cluster size - 1
+* @param cpuList - CPU numbers and ranges separated by commas, for example "0-3,8", NULL to run on any CPU
+* @return int - 0 when processed successfully
+*/
+int swrngSetCLThreadCpus(SwrngCLContext *ctxt, int slot, const char *cpuList);
+
+/**
+* Pin the download thread of a cluster slot to the CPUs of a NUMA node, as swrngSetCLThreadCpus() does.
+* Only supported on Linux.
+*
+* @param ctxt - pointer to SwrngCLContext structure, initialized with swrngInitializeCLContext()
+* @param slot - slot number, 0 through the cluster size - 1
+* @param numaNode - NUMA node number, -1 to run on any CPU
+* @return int - 0 when processed successfully
+*/
+int swrngSetCLThreadNumaNode(SwrngCLContext *ctxt, int slot, int numaNode);
+
 /**
 * Set power profile for each device in the cluster
 *
@@ -0,0 +1,179 @@
+/**
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ This file defines the parts shared by the daemons serving random bytes from a cluster of SwiftRNG devices,
+ entropy-cl-server and swrng-cuse.
+
+ */
+
+/**
+ *    @file swrng-cl-daemon.h
+ *    @version 1.0
+ *
+ *    @brief Cluster settings, cluster recovery and prefetching for the cluster daemons, Linux only.
+ *
+ * The cluster settings are parsed from the command line options common to the daemons. A prefetch thread
+ * keeps a buffer filled with random bytes from the cluster, opening the cluster again when no device is left.
+ * The daemons take the bytes from the buffer holding the prefetch lock, which they may also use for guarding
+ * their own lists of requests waiting for random bytes.
+ */
+#ifndef SWRNG_CL_DAEMON_H_
+#define SWRNG_CL_DAEMON_H_
+
+#include <swrng-cl-api.h>
+
+/* Seconds to wait before opening the cluster again when no device is left */
+#define SWRNG_CL_DAEMON_REOPEN_WAIT_SECS 1
+
+/* Called by the prefetch thread after adding random bytes, without holding the prefetch lock */
+typedef void (*SwrngCLDaemonBytesAdded)(void *arg);
+
+/* Define a type for referencing the cluster and the prefetch buffer of a daemon */
+typedef struct {
+	/* Cluster settings, from the command line options */
+	int cl_size;
+	int pp_num;
+	const char *pp_method;
+	int pp_method_id;
+	int post_processing_enabled;
+	int statistical_tests_enabled;
+
+	/* Displays the usage of the daemon when an option is missing its value */
+	void (*display_usage)(void);
+
+	SwrngCLContext cxt;
+
+	/* Incremented each time the cluster is opened again, so only one of the threads reading from it does that */
+	int cluster_generation;
+	pthread_mutex_t cluster_mutex;
+
+	/* Set for stopping the daemon, may be set from a signal handler */
+	volatile int stop_requested;
+
+	/*
+	 * The prefetch buffer, filled in chunks by the prefetch thread.
+	 * The positions and the number of bytes available are guarded by the prefetch lock.
+	 */
+	unsigned char *prefetch_buff;
+	size_t prefetch_buff_size;
+	size_t prefetch_chunk_size;
+	size_t prefetch_head;
+	size_t prefetch_tail;
+	size_t prefetch_available;
+	int prefetch_stopped;
+	pthread_mutex_t prefetch_mutex;
+	pthread_cond_t prefetch_space_cond;
+	pthread_t prefetch_thread;
+	SwrngCLDaemonBytesAdded bytes_added;
+	void *bytes_added_arg;
+} SwrngCLDaemon;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Initialize the daemon context with the default settings, it must be called before any other call using it
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param displayUsage - displays the usage of the daemon
+* @return int - 0 when initialized successfully
+*/
+int swrngInitializeCLDaemon(SwrngCLDaemon *dmn, void (*displayUsage)(void));
+
+/**
+* Validate command line argument count, displaying the usage when an option is missing its value
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param curIdx - index of the option value
+* @param actArgumentCount - number of parameters
+* @return int - 1 if the option value is present
+*/
+int swrngValidateCLDaemonArgumentCount(SwrngCLDaemon *dmn, int curIdx, int actArgumentCount);
+
+/**
+* Parse a command line option of the cluster settings: -cs, -ppn, -ppm, -dpp or -dst
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param idx - pointer to the current parameter number, moved past the option when parsed
+* @param argc - number of parameters
+* @param argv - parameters
+* @return int - 1 when parsed, 0 when it is not a cluster option, -1 when invalid
+*/
+int swrngParseCLDaemonArgument(SwrngCLDaemon *dmn, int *idx, int argc, char **argv);
+
+/**
+* Open the device cluster and apply the settings
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param reportErrors - 1 for printing the errors
+* @return int - 0 when run successfully
+*/
+int swrngOpenCLDaemonCluster(SwrngCLDaemon *dmn, int reportErrors);
+
+/**
+* Retrieve random bytes from the cluster, opening the cluster again when no device is left.
+* Only the first of the threads finding the cluster failed opens it again, the others wait for it.
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param dst - destination buffer
+* @param length - number of bytes to retrieve
+* @return int - 0 when retrieved, -1 when the daemon is stopping
+*/
+int swrngRetrieveCLDaemonBytes(SwrngCLDaemon *dmn, unsigned char *dst, long length);
+
+/**
+* Start the prefetch thread
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param buffSize - size of the prefetch buffer, a multiple of the chunk size
+* @param chunkSize - number of bytes retrieved from the cluster at once
+* @param bytesAdded - called after adding random bytes, NULL if not needed
+* @param arg - argument passed to `bytesAdded`
+* @return int - 0 when started
+*/
+int swrngStartCLDaemonPrefetch(SwrngCLDaemon *dmn, size_t buffSize, size_t chunkSize,
+		SwrngCLDaemonBytesAdded bytesAdded, void *arg);
+
+/**
+* Stop the prefetch thread and wait for it, the prefetched bytes stay available
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+*/
+void swrngStopCLDaemonPrefetch(SwrngCLDaemon *dmn);
+
+/**
+* Take random bytes from the prefetch buffer. Must be called holding the prefetch lock.
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param dst - destination buffer
+* @param length - max number of bytes to take
+* @return size_t - number of bytes taken
+*/
+size_t swrngTakeCLDaemonBytes(SwrngCLDaemon *dmn, unsigned char *dst, size_t length);
+
+/**
+* Request the daemon to stop, safe to call from a signal handler
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+*/
+void swrngRequestCLDaemonStop(SwrngCLDaemon *dmn);
+
+/**
+* Check if the daemon was requested to stop
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @return int - 1 when requested to stop
+*/
+int swrngIsCLDaemonStopRequested(SwrngCLDaemon *dmn);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWRNG_CL_DAEMON_H_ */
@@ -0,0 +1,96 @@
+/**
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ This file defines the API for writing downloaded random bytes out to a file, a named pipe or the standard output.
+
+ */
+
+/**
+ *    @file swrng-output.h
+ *    @version 1.0
+ *
+ *    @brief Writes random bytes out without copying them more than needed.
+ *
+ * The caller fills the buffer returned by swrngGetOutputBuffer() and passes the number of bytes filled
+ * to swrngWriteOutput(). On Linux, the pages of the buffer are handed to pipes and named pipes with
+ * vmsplice(), and regular files are written with O_DIRECT, bypassing the page cache. Other outputs
+ * and other platforms use buffered file streams.
+ */
+#ifndef SWRNG_OUTPUT_H_
+#define SWRNG_OUTPUT_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+/* Output modes */
+#define SWRNG_OUTPUT_STREAM 0
+#define SWRNG_OUTPUT_PIPE 1
+#define SWRNG_OUTPUT_DIRECT 2
+
+/* Define a type for referencing an open output */
+typedef struct {
+	int mode;
+
+	/* File stream, used in SWRNG_OUTPUT_STREAM mode only */
+	FILE *file;
+
+	/* File descriptor, used in the other modes */
+	int fd;
+
+	/* Page aligned buffer filled by the caller and its size */
+	unsigned char *buffer;
+	size_t bufferSize;
+
+	size_t pageSize;
+} SwrngOutput;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+* Open the output for writing random bytes, truncating a regular file
+*
+* @param out - pointer to SwrngOutput structure
+* @param pathName - file path name, ignored when writing to the standard output
+* @param toStandardOutput - 1 for writing to the standard output
+* @param maxLength - max number of bytes written at once
+* @return int - 0 when opened successfully
+*/
+int swrngOpenOutput(SwrngOutput *out, const char *pathName, int toStandardOutput, size_t maxLength);
+
+/**
+* Retrieve the buffer to fill before calling swrngWriteOutput(). It has room for one byte past
+* the max number of bytes written at once. Its content is not preserved by swrngWriteOutput().
+*
+* @param out - pointer to SwrngOutput structure
+* @return unsigned char* - the buffer
+*/
+unsigned char* swrngGetOutputBuffer(SwrngOutput *out);
+
+/**
+* Write bytes out from the beginning of the output buffer
+*
+* @param out - pointer to SwrngOutput structure
+* @param length - number of bytes to write, up to the max number of bytes set when opening
+* @return int - 0 when written successfully
+*/
+int swrngWriteOutput(SwrngOutput *out, size_t length);
+
+/**
+* Close the output and release the buffer
+*
+* @param out - pointer to SwrngOutput structure
+*/
+void swrngCloseOutput(SwrngOutput *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SWRNG_OUTPUT_H_ */
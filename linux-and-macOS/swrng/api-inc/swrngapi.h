@@ -34,6 +34,26 @@ typedef struct SwrngContext {
 	uint32_t sig_end;
 } SwrngContext;
 
+/* Define a type for referencing the conditioning state of one thread, used without a device */
+typedef struct SwrngConditionerContext {
+	uint32_t sig_begin;
+	void *ctxt;
+	uint32_t sig_end;
+} SwrngConditionerContext;
+
+/* Define a type for referencing a monitor of SwiftRNG devices being plugged in and removed */
+typedef struct SwrngDeviceMonitorContext {
+	uint32_t sig_begin;
+	void *monitor;
+	uint32_t sig_end;
+} SwrngDeviceMonitorContext;
+
+/* Called from a monitor thread when a device is plugged in (arrived = 1) or removed (arrived = 0) */
+typedef void (*SwrngDeviceEventCallback)(void *arg, int arrived);
+
+/* Number of bytes conditioned at once by swrngConditionBlock() */
+#define SWRNG_CONDITIONER_BLOCK_SIZE (16000)
+
 /**
 * Initialize SwrngContext context. The context must be initialized before making any other API calls.
 *
@@ -142,6 +162,17 @@ int swrngGetFrequencyTables(SwrngContext *ctxt, FrequencyTables *frequency_table
 */
 int swrngGetDeviceList(SwrngContext *ctxt, DeviceInfoList *dev_info_list);
 
+/**
+* Count the SwiftRNG devices currently plugged into USB ports, without opening them.
+* Devices are numbered by swrngOpen() in the same order, including the ones already in use.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param int* device_count - pointer to the number of devices found
+* @return int - value 0 when counted successfully, otherwise the error code
+*
+*/
+int swrngGetDeviceCount(SwrngContext *ctxt, int *device_count);
+
 /**
 * Retrieve SwiftRNG device model number. This call will fail when there is no SwiftRNG device
 * currently connected or when the device is already in use.
@@ -305,6 +336,17 @@ int swrngEnableStatisticalTests(SwrngContext *ctxt);
 */
 DeviceStatistics* swrngGenerateDeviceStatistics(SwrngContext *ctxt);
 
+/**
+* Retrieve the live statistics of the downloads since the device was open or the statistics were reset:
+* counters, nanosecond latency histograms of the download stages and the current throughput.
+* It may be called from another thread while the device is downloading, it does not lock or wait for the downloads in progress.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param stats - pointer to the structure receiving the statistics
+* @return int - 0 when the statistics were retrieved
+*/
+int swrngGetLiveStatistics(SwrngContext *ctxt, DeviceLiveStatistics *stats);
+
 /**
 * Retrieve the last error message.
 * The caller should make a copy of the error message returned immediately after calling this function.
@@ -339,6 +381,111 @@ int swrngGetMaxAptFailuresPerBlock(SwrngContext *ctxt, uint16_t *max_apt_failure
 */
 int swrngGetMaxRctFailuresPerBlock(SwrngContext *ctxt, uint16_t *max_rct_failures_per_block);
 
+/**
+* Enable the download pipeline. When enabled, up to `pipeline_depth` random data block requests are kept
+* in flight so that USB transfers overlap with statistical tests and post processing.
+* Call this function after device is successfully open.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param pipeline_depth - number of data block requests to keep in flight, 2 through 8
+*
+* @return int - 0 when the download pipeline was successfully enabled, otherwise the error code
+*/
+int swrngEnableDownloadPipeline(SwrngContext *ctxt, int pipeline_depth);
+
+/**
+* Disable the download pipeline. The download pipeline is initially disabled.
+*
+* @param ctxt - pointer to SwrngContext structure
+*
+* @return int - 0 when the download pipeline was successfully disabled, otherwise the error code
+*/
+int swrngDisableDownloadPipeline(SwrngContext *ctxt);
+
+/**
+* Enable hashing the chunks of each data block on several threads when SHA-256 or SHA-512
+* post processing is used. The produced random bytes are the same as without the additional threads.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param num_workers - number of threads helping the caller thread, between 1 and 16
+*
+* @return int - 0 when the post processing threads were successfully started, otherwise the error code
+*/
+int swrngEnablePostProcessingWorkers(SwrngContext *ctxt, int num_workers);
+
+/**
+* Stop the post processing threads. The post processing threads are initially disabled.
+*
+* @param ctxt - pointer to SwrngContext structure
+*
+* @return int - 0 when the post processing threads were successfully stopped, otherwise the error code
+*/
+int swrngDisablePostProcessingWorkers(SwrngContext *ctxt);
+
+/**
+* Set how many 16000 byte blocks are requested from the device at once when whole blocks are
+* received straight into the caller buffer. Larger values speed up downloads with swrngGetEntropyEx.
+* Only one block is requested at a time initially.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param num_blocks - number of blocks per request, between 1 and 8
+*
+* @return int - 0 when the bulk request size was successfully set, otherwise the error code
+*/
+int swrngSetBulkRequestBlocks(SwrngContext *ctxt, int num_blocks);
+
+/**
+* Initialize SwrngConditionerContext context used for conditioning blocks of random bytes without a device.
+* Each thread conditioning blocks concurrently must use its own context.
+*
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @param serial_number - serial number stamped into the first chunk hashed with SHA-256
+* @return 0 - if context initialized successfully, -1 if context is null or memory could not be allocated
+*/
+int swrngInitializeConditionerContext(SwrngConditionerContext *ctxt, uint32_t serial_number);
+
+/**
+* Destroy SwrngConditionerContext context.
+*
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @return 0 - if context destroyed successfully
+*/
+int swrngDestroyConditionerContext(SwrngConditionerContext *ctxt);
+
+/**
+* Condition one block of SWRNG_CONDITIONER_BLOCK_SIZE random bytes with the given post processing method,
+* producing the same output as a device using that method.
+*
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @param in - pointer to SWRNG_CONDITIONER_BLOCK_SIZE raw random bytes
+* @param out - pointer to a buffer receiving SWRNG_CONDITIONER_BLOCK_SIZE conditioned bytes
+* @param post_processing_method_id - 0 for SHA256, 1 for xorshift64, 2 for SHA512
+* @return int - 0 when successful, otherwise the error code
+*/
+int swrngConditionBlock(SwrngConditionerContext *ctxt, const unsigned char *in, unsigned char *out,
+		int post_processing_method_id);
+
+/**
+* Start watching for SwiftRNG devices being plugged in and removed, using the libusb hotplug notifications
+* and, on Linux, the udev events of the CDC devices. The callback may be invoked from more than one thread
+* and more than once for the same device, it must return quickly.
+*
+* @param ctxt - pointer to SwrngDeviceMonitorContext structure
+* @param callback - function invoked when a device is plugged in or removed
+* @param arg - argument passed to the callback
+* @return int - 0 when the monitor started, -1 if device events are not available on the host
+*/
+int swrngStartDeviceMonitor(SwrngDeviceMonitorContext *ctxt, SwrngDeviceEventCallback callback, void *arg);
+
+/**
+* Stop watching for devices and destroy the SwrngDeviceMonitorContext context.
+* Waits for the callbacks in progress to complete.
+*
+* @param ctxt - pointer to SwrngDeviceMonitorContext structure
+* @return int - 0 when the monitor stopped successfully
+*/
+int swrngStopDeviceMonitor(SwrngDeviceMonitorContext *ctxt);
+
 
 
 #ifdef __cplusplus
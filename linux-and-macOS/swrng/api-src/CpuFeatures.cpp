@@ -0,0 +1,79 @@
+/*
+ * CpuFeatures.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class detects, at run time, the CPU instruction set extensions used for accelerating
+ post processing of random data.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <CpuFeatures.h>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <cpuid.h>
+ #define SWRNG_X86_CPU
+#endif
+
+namespace swiftrng {
+
+/**
+ * Retrieve the features of the CPU, detected once per process
+ *
+ * @return const CpuFeatures& - detected CPU features
+ */
+const CpuFeatures& CpuFeatures::get_instance() {
+	static const CpuFeatures cpu_features;
+	return cpu_features;
+}
+
+CpuFeatures::CpuFeatures() {
+	detect();
+}
+
+/**
+ * Query CPUID and the OS enabled register state. Everything stays disabled on non x86 CPUs.
+ */
+void CpuFeatures::detect() {
+#ifdef SWRNG_X86_CPU
+	unsigned int eax, ebx, ecx, edx;
+	uint32_t xcr0 = 0;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+		return;
+	}
+	bool sse41 = (ecx & (1u << 19)) != 0;
+	bool osxsave = (ecx & (1u << 27)) != 0;
+	bool avx = (ecx & (1u << 28)) != 0;
+
+	if (osxsave) {
+		// xgetbv with ECX = 0, encoded as bytes to not depend on the -mxsave compiler option
+		uint32_t xcr0_high;
+		__asm__ volatile (".byte 0x0f, 0x01, 0xd0" : "=a" (xcr0), "=d" (xcr0_high) : "c" (0));
+	}
+	// XMM and YMM state, plus opmask and ZMM state for AVX-512
+	bool os_avx = osxsave && (xcr0 & 0x06) == 0x06;
+	bool os_avx512 = os_avx && (xcr0 & 0xe0) == 0xe0;
+
+	if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+		return;
+	}
+	m_sha_ni = sse41 && (ebx & (1u << 29)) != 0;
+	m_avx2 = avx && os_avx && (ebx & (1u << 5)) != 0;
+	m_avx512f = os_avx512 && (ebx & (1u << 16)) != 0;
+	m_avx512dq = m_avx512f && (ebx & (1u << 17)) != 0;
+	m_avx512bw = m_avx512f && (ebx & (1u << 30)) != 0;
+#endif
+}
+
+} /* namespace swiftrng */
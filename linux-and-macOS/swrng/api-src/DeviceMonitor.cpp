@@ -0,0 +1,325 @@
+/*
+ * DeviceMonitor.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class watches for SwiftRNG devices being plugged in and removed.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <system_error>
+#include <DeviceMonitor.h>
+
+#ifdef __linux__
+	#include <unistd.h>
+	#include <fcntl.h>
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <linux/netlink.h>
+#endif
+
+namespace swiftrng {
+
+const int DeviceMonitor::c_usb_event_timeout_millis;
+#ifdef __linux__
+const unsigned DeviceMonitor::c_udev_monitor_group;
+const int DeviceMonitor::c_max_udev_msg_size;
+
+// Prefix of the messages sent by udev, the kernel messages are ignored as the device links are not created yet
+static const char c_udev_msg_prefix[] = "libudev";
+#endif
+
+DeviceMonitor::~DeviceMonitor() {
+	stop();
+}
+
+/**
+* Start watching for devices being plugged in and removed.
+* The callback may be invoked from more than one thread and more than once for the same device.
+*
+* @param callback - function invoked when a device is plugged in or removed
+* @param arg - argument passed to the callback
+* @return int - 0 when at least one kind of device events is watched, -1 if hotplug events are not available
+*/
+int DeviceMonitor::start(DeviceEventCallback callback, void *arg) {
+	if (is_running() || callback == nullptr) {
+		return -1;
+	}
+	// Release what is left from a failed start
+	stop();
+	m_callback = callback;
+	m_callback_arg = arg;
+	m_stop_requested = false;
+
+	start_usb_hotplug();
+#ifdef __linux__
+	start_udev_monitor();
+#endif
+	return is_running() ? 0 : -1;
+}
+
+/**
+* Stop watching for devices. Waits for the callbacks in progress to complete.
+*/
+void DeviceMonitor::stop() {
+	m_stop_requested = true;
+
+	if (m_usb_hotplug_running) {
+		// Deregistering wakes up the event thread
+		deregister_usb_hotplug();
+		m_usb_thread.join();
+		m_usb_hotplug_running = false;
+	}
+	if (m_libusb_luctx != nullptr) {
+		libusb_exit(m_libusb_luctx);
+		m_libusb_luctx = nullptr;
+	}
+
+#ifdef __linux__
+	if (m_udev_monitor_running) {
+		char c = 0;
+		if (write(m_wakeup_pipe[1], &c, 1) < 0) {
+			// The thread still stops on the next udev event
+		}
+		m_udev_thread.join();
+		m_udev_monitor_running = false;
+	}
+	for (int &fd : m_wakeup_pipe) {
+		if (fd != -1) {
+			close(fd);
+			fd = -1;
+		}
+	}
+	if (m_udev_fd != -1) {
+		close(m_udev_fd);
+		m_udev_fd = -1;
+	}
+#endif
+}
+
+/**
+* Check if device events are watched
+*
+* @return bool - true when at least one kind of device events is watched
+*/
+bool DeviceMonitor::is_running() const {
+#ifdef __linux__
+	return m_usb_hotplug_running || m_udev_monitor_running;
+#else
+	return m_usb_hotplug_running;
+#endif
+}
+
+/**
+* Register for libusb hotplug notifications of all SwiftRNG USB ids, served by a dedicated libusb context and thread
+*
+* @return bool - true when the notifications are available and registered
+*/
+bool DeviceMonitor::start_usb_hotplug() {
+	if (libusb_init(&m_libusb_luctx) != 0) {
+		m_libusb_luctx = nullptr;
+		return false;
+	}
+	if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+		return false;
+	}
+	for (const UsbDeviceId &id : c_swiftrng_usb_ids) {
+		int r = libusb_hotplug_register_callback(m_libusb_luctx,
+				(libusb_hotplug_event)(LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT),
+				(libusb_hotplug_flag)0, id.vendor_id, id.product_id, LIBUSB_HOTPLUG_MATCH_ANY,
+				usb_hotplug_event, this, &m_hotplug_handles[m_num_hotplug_handles]);
+		if (r != LIBUSB_SUCCESS) {
+			deregister_usb_hotplug();
+			return false;
+		}
+		m_num_hotplug_handles++;
+	}
+	try {
+		m_usb_thread = std::thread(&DeviceMonitor::usb_hotplug_run, this);
+	} catch (const std::system_error &) {
+		deregister_usb_hotplug();
+		return false;
+	}
+	m_usb_hotplug_running = true;
+	return true;
+}
+
+/**
+* Deregister the libusb hotplug callbacks registered so far
+*/
+void DeviceMonitor::deregister_usb_hotplug() {
+	for (int i = 0; i < m_num_hotplug_handles; i++) {
+		libusb_hotplug_deregister_callback(m_libusb_luctx, m_hotplug_handles[i]);
+	}
+	m_num_hotplug_handles = 0;
+}
+
+/**
+* Handle the libusb events of the monitor context until a stop is requested
+*/
+void DeviceMonitor::usb_hotplug_run() {
+	struct timeval tv;
+	while (!m_stop_requested) {
+		tv.tv_sec = c_usb_event_timeout_millis / 1000;
+		tv.tv_usec = (c_usb_event_timeout_millis % 1000) * 1000;
+		libusb_handle_events_timeout_completed(m_libusb_luctx, &tv, nullptr);
+	}
+}
+
+/**
+* libusb hotplug callback, forwards the event to the monitor callback
+*
+* @return int - 0 to stay registered
+*/
+int LIBUSB_CALL DeviceMonitor::usb_hotplug_event(libusb_context *, libusb_device *,
+		libusb_hotplug_event event, void *user_data) {
+	auto monitor = (DeviceMonitor*)user_data;
+	if (!monitor->m_stop_requested) {
+		monitor->m_callback(monitor->m_callback_arg, event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED);
+	}
+	return 0;
+}
+
+#ifdef __linux__
+
+/**
+* Subscribe to the udev netlink events, watched by a dedicated thread
+*
+* @return bool - true when subscribed
+*/
+bool DeviceMonitor::start_udev_monitor() {
+	m_udev_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+	if (m_udev_fd == -1) {
+		return false;
+	}
+	struct sockaddr_nl addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = c_udev_monitor_group;
+	if (bind(m_udev_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || pipe(m_wakeup_pipe) != 0) {
+		return false;
+	}
+	try {
+		m_udev_thread = std::thread(&DeviceMonitor::udev_monitor_run, this);
+	} catch (const std::system_error &) {
+		return false;
+	}
+	m_udev_monitor_running = true;
+	return true;
+}
+
+/**
+* Receive the udev events until a stop is requested
+*/
+void DeviceMonitor::udev_monitor_run() {
+	char msg[c_max_udev_msg_size];
+	struct pollfd fds[2];
+	fds[0].fd = m_udev_fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = m_wakeup_pipe[0];
+	fds[1].events = POLLIN;
+
+	while (!m_stop_requested) {
+		if (poll(fds, 2, -1) < 0) {
+			continue;
+		}
+		if (m_stop_requested || (fds[1].revents & POLLIN)) {
+			break;
+		}
+		if (fds[0].revents & POLLIN) {
+			ssize_t len = recv(m_udev_fd, msg, sizeof(msg), MSG_DONTWAIT);
+			if (len > 0) {
+				process_udev_message(msg, (int)len);
+			}
+		}
+	}
+}
+
+/**
+* Invoke the monitor callback if a udev message reports a SwiftRNG tty node added or removed.
+* The properties of a message are NUL terminated KEY=VALUE strings following the libudev header.
+*
+* @param msg - pointer to the message
+* @param msg_len - message length in bytes
+*/
+void DeviceMonitor::process_udev_message(const char *msg, int msg_len) {
+	// The header starts with the prefix, followed by the magic, the header size, the offset and length of the properties
+	const int c_properties_off_pos = 16;
+	const int c_properties_len_pos = 20;
+	uint32_t properties_off;
+	uint32_t properties_len;
+
+	if (msg_len < c_properties_len_pos + 4 || memcmp(msg, c_udev_msg_prefix, sizeof(c_udev_msg_prefix)) != 0) {
+		return;
+	}
+	memcpy(&properties_off, msg + c_properties_off_pos, sizeof(properties_off));
+	memcpy(&properties_len, msg + c_properties_len_pos, sizeof(properties_len));
+	if (properties_off >= (uint32_t)msg_len || properties_len == 0 || properties_len > (uint32_t)msg_len - properties_off
+			|| msg[properties_off + properties_len - 1] != '\0') {
+		return;
+	}
+
+	bool is_tty = false;
+	const char *vendor_id = nullptr;
+	const char *product_id = nullptr;
+	int action = -1;
+	const char *end = msg + properties_off + properties_len;
+	for (const char *prop = msg + properties_off; prop < end; prop += strlen(prop) + 1) {
+		if (strcmp(prop, "SUBSYSTEM=tty") == 0) {
+			is_tty = true;
+		} else if (strcmp(prop, "ACTION=add") == 0) {
+			action = 1;
+		} else if (strcmp(prop, "ACTION=remove") == 0) {
+			action = 0;
+		} else if (strncmp(prop, "ID_VENDOR_ID=", strlen("ID_VENDOR_ID=")) == 0) {
+			vendor_id = prop + strlen("ID_VENDOR_ID=");
+		} else if (strncmp(prop, "ID_MODEL_ID=", strlen("ID_MODEL_ID=")) == 0) {
+			product_id = prop + strlen("ID_MODEL_ID=");
+		}
+	}
+	if (is_tty && action != -1 && is_swiftrng_usb_id(vendor_id, product_id) && !m_stop_requested) {
+		m_callback(m_callback_arg, action == 1);
+	}
+}
+
+/**
+* Check if the USB ids of a udev message belong to a SwiftRNG device
+*
+* @param vendor_id - value of the ID_VENDOR_ID property, four hex digits, nullptr if missing
+* @param product_id - value of the ID_MODEL_ID property, four hex digits, nullptr if missing
+* @return bool - true for a SwiftRNG device
+*/
+bool DeviceMonitor::is_swiftrng_usb_id(const char *vendor_id, const char *product_id) {
+	if (vendor_id == nullptr || product_id == nullptr) {
+		return false;
+	}
+	char *vendor_end;
+	char *product_end;
+	unsigned long vendor = strtoul(vendor_id, &vendor_end, 16);
+	unsigned long product = strtoul(product_id, &product_end, 16);
+	if (*vendor_id == '\0' || *vendor_end != '\0' || *product_id == '\0' || *product_end != '\0') {
+		return false;
+	}
+	for (const UsbDeviceId &id : c_swiftrng_usb_ids) {
+		if (id.vendor_id == vendor && id.product_id == product) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#endif
+
+} /* namespace swiftrng */
@@ -0,0 +1,798 @@
+/*
+ * EntropyConditioner.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class implements the post processing methods used for conditioning blocks of random data
+ received from SwiftRNG devices.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <cstring>
+#include <EntropyConditioner.h>
+#include <CpuFeatures.h>
+#include <ApiStructs.h>
+
+namespace swiftrng {
+
+const int EntropyConditioner::c_sha256_method_id;
+const int EntropyConditioner::c_xorshift64_method_id;
+const int EntropyConditioner::c_sha512_method_id;
+const int EntropyConditioner::c_block_size_bytes;
+const int EntropyConditioner::c_chunk_num_words;
+const int EntropyConditioner::c_sha256_num_chunks;
+const int EntropyConditioner::c_sha512_num_chunks;
+const int EntropyConditioner::c_max_hash_lanes;
+
+// SHA-256 self test message and its expected hash
+static const uint32_t c_sha256_test_seq_1[11] = {
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+	0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0x428a2f98,
+	0x71374491, 0xb5c0fbcf
+};
+
+static const uint32_t c_sha256_expt_hash_seq_1[8] = {
+	0x114c3052, 0x76410592, 0xc024566b,
+	0xa492b1a2, 0xb0559389, 0xb7c41156, 0x2ec8d6c3, 0x3dcb02dd
+};
+
+// Expected SHA-512 hash of the self test message
+static const uint64_t c_sha512_expt_hash_seq1[8] = {
+	0x6cbce8f347e8d1b3, 0xd3517b27fdc4ee1c, 0x71d8406ab54e2335,
+	0xf3a39732fa0009d2, 0x2193c41677d18504, 0xe90b4c1138c32e7c, 0xc1aa7500597ba99c, 0xacd525ef2c44e9dc
+};
+
+/**
+ * Retrieve the single instance, the CPU specific implementations are selected and verified on first use
+ *
+ * @return const EntropyConditioner& - reference to the instance
+ */
+const EntropyConditioner& EntropyConditioner::get_instance() {
+	static const EntropyConditioner instance;
+	return instance;
+}
+
+EntropyConditioner::EntropyConditioner() {
+	const CpuFeatures &cpu_features = CpuFeatures::get_instance();
+	if (cpu_features.has_sha_ni()) {
+		m_sha256_transform = sha256_transform_sha_ni;
+	}
+	// 16 lanes outperform the SHA extensions, 8 lanes are used only on CPUs without them
+	if (cpu_features.has_avx512f()) {
+		m_sha256_stamped_hash = sha256_hash_stamped_avx512;
+	} else if (cpu_features.has_avx2() && !cpu_features.has_sha_ni()) {
+		m_sha256_stamped_hash = sha256_hash_stamped_avx2;
+	}
+	if (cpu_features.has_avx512f()) {
+		m_sha512_multi_hash = sha512_hash_avx512;
+	} else if (cpu_features.has_avx2()) {
+		m_sha512_multi_hash = sha512_hash_avx2;
+	}
+	if (cpu_features.has_avx512dq()) {
+		m_xorshift64_kernel = xorshift64_avx512;
+	} else if (cpu_features.has_avx2()) {
+		m_xorshift64_kernel = xorshift64_avx2;
+	}
+
+	// Fall back to the portable implementations when a CPU specific one produces unexpected results
+	if (m_sha256_transform != nullptr && sha256_selfTest() != SWRNG_SUCCESS) {
+		m_sha256_transform = nullptr;
+	}
+	if (m_sha256_stamped_hash != nullptr && sha256_multiBufferSelfTest() != SWRNG_SUCCESS) {
+		m_sha256_stamped_hash = nullptr;
+	}
+	if (m_sha512_multi_hash != nullptr && sha512_multiBufferSelfTest() != SWRNG_SUCCESS) {
+		m_sha512_multi_hash = nullptr;
+	}
+	if (m_xorshift64_kernel != nullptr && xorshift64_simdSelfTest() != SWRNG_SUCCESS) {
+		m_xorshift64_kernel = nullptr;
+	}
+
+	// The implementations in use do not change, so the self-tests run once per process
+	if (sha256_selfTest() != SWRNG_SUCCESS) {
+		m_failed_selfTest_method_id = c_sha256_method_id;
+	} else if (sha512_selfTest() != SWRNG_SUCCESS) {
+		m_failed_selfTest_method_id = c_sha512_method_id;
+	} else if (xorshift64_selfTest() != SWRNG_SUCCESS) {
+		m_failed_selfTest_method_id = c_xorshift64_method_id;
+	}
+}
+
+/**
+ * Condition one block of `c_block_size_bytes` random bytes. Safe to call concurrently
+ * as long as each thread uses its own context.
+ *
+ * @param ConditionerContext& ctxt - conditioning state of the calling thread
+ * @param const unsigned char* in - pointer to the raw random bytes, no alignment required
+ * @param unsigned char* out - pointer to the conditioned bytes, may be the same as `in` for xorshift64 only
+ * @param int method_id - post processing method: 0 - SHA-256, 1 - xorshift64, 2 - SHA-512
+ * @return int - 0 when successful, -1 for an unknown method
+ */
+int EntropyConditioner::condition_block(ConditionerContext &ctxt, const unsigned char *in, unsigned char *out,
+		int method_id) const {
+	if (method_id == c_sha256_method_id) {
+		sha256_hashChunks(ctxt.sha256, (const uint32_t *)in, ctxt.blockSerialNumber, (uint32_t *)out, c_sha256_num_chunks);
+		ctxt.blockSerialNumber += (uint32_t)c_sha256_num_chunks;
+	} else if (method_id == c_sha512_method_id) {
+		sha512_hashChunks(ctxt.sha512, (const uint64_t *)in, (uint64_t *)out, c_sha512_num_chunks);
+	} else if (method_id == c_xorshift64_method_id) {
+		if (out != in) {
+			memcpy(out, in, c_block_size_bytes);
+		}
+		xorshift64_postProcess(out, c_block_size_bytes);
+	} else {
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Hash consecutive chunks of 8 words with SHA-256, each chunk stamped with
+ * `serial_number` plus the chunk index
+ *
+ * @param Sha256Context& ctxt - hashing state to use
+ * @param const uint32_t* src - pointer to the chunks to hash
+ * @param uint32_t serial_number - serial number of the first chunk
+ * @param uint32_t* dst - pointer to the 8 word hashes
+ * @param int num_chunks - number of chunks to hash
+ */
+void EntropyConditioner::sha256_hashChunks(Sha256Context &ctxt, const uint32_t *src, uint32_t serial_number,
+		uint32_t *dst, int num_chunks) const {
+	uint32_t src_to_hash[c_max_hash_input_words];
+	int chunk = 0;
+
+	if (m_sha256_stamped_hash != nullptr) {
+		// Hash chunks in parallel lanes, each one stamped with its own serial number
+		chunk = m_sha256_stamped_hash(src, serial_number, dst, num_chunks);
+	}
+	// Hash the remaining chunks
+	for (; chunk < num_chunks; chunk++) {
+		memcpy(src_to_hash, src + chunk * c_chunk_num_words, c_chunk_num_words * sizeof(uint32_t));
+		src_to_hash[c_chunk_num_words] = serial_number + (uint32_t)chunk;
+		sha256_generateHash(ctxt, src_to_hash, (int16_t)(c_chunk_num_words + 1), dst + chunk * c_chunk_num_words);
+	}
+}
+
+/**
+ * Hash consecutive chunks of 8 words with SHA-512
+ *
+ * @param Sha512Context& ctxt - hashing state to use
+ * @param const uint64_t* src - pointer to the chunks to hash
+ * @param uint64_t* dst - pointer to the 8 word hashes
+ * @param int num_chunks - number of chunks to hash
+ */
+void EntropyConditioner::sha512_hashChunks(Sha512Context &ctxt, const uint64_t *src, uint64_t *dst,
+		int num_chunks) const {
+	int chunk = 0;
+
+	if (m_sha512_multi_hash != nullptr) {
+		// Hash chunks in parallel lanes
+		chunk = m_sha512_multi_hash(src, dst, num_chunks);
+	}
+	// Hash the remaining chunks
+	for (; chunk < num_chunks; chunk++) {
+		sha512_generateHash(ctxt, src + chunk * c_chunk_num_words, (int16_t)c_chunk_num_words,
+				dst + chunk * c_chunk_num_words);
+	}
+}
+
+/**
+* Apply Xorshift64 in place to each 64 bit word of the buffer
+*
+* @param buffer - pointer to input data buffer, no alignment required
+* @param num_elements - number of elements in the input buffer
+*/
+void EntropyConditioner::xorshift64_postProcess(uint8_t *buffer, int num_elements) const {
+	int num_words = num_elements / 8;
+	int i = 0;
+
+	if (m_xorshift64_kernel != nullptr) {
+		i = m_xorshift64_kernel(buffer, num_words);
+	}
+	// Process the remaining words, copying them to not rely on the buffer alignment
+	for (; i < num_words; i++) {
+		uint64_t word;
+		memcpy(&word, buffer + i * 8, sizeof(word));
+		word = xorshift64_postProcessWord(word);
+		memcpy(buffer + i * 8, &word, sizeof(word));
+	}
+}
+
+/**
+* Apply Xorshift64 (Marsaglia's PPRNG method) to the raw word
+* @param raw_word - word to post process
+*/
+uint64_t EntropyConditioner::xorshift64_postProcessWord(uint64_t raw_word) const {
+	uint64_t trueWord = raw_word;
+
+	trueWord ^= trueWord >> 12;
+	trueWord ^= trueWord << 25;
+	trueWord ^= trueWord >> 27;
+	return trueWord * UINT64_C(2685821657736338717);
+}
+
+/**
+ * Initialize the SHA256 data
+ *
+ * @param Sha256Context& ctxt - hashing state to initialize
+ */
+void EntropyConditioner::sha256_initialize(Sha256Context &ctxt) const {
+	// Initialize H0, H1, H2, H3, H4, H5, H6 and H7
+	ctxt.h0 = 0x6a09e667;
+	ctxt.h1 = 0xbb67ae85;
+	ctxt.h2 = 0x3c6ef372;
+	ctxt.h3 = 0xa54ff53a;
+	ctxt.h4 = 0x510e527f;
+	ctxt.h5 = 0x9b05688c;
+	ctxt.h6 = 0x1f83d9ab;
+	ctxt.h7 = 0x5be0cd19;
+}
+
+/**
+ * Initialize the SHA512 data
+ *
+ * @param Sha512Context& ctxt - hashing state to initialize
+ */
+void EntropyConditioner::sha512_initialize(Sha512Context &ctxt) const {
+	// Initialize H0, H1, H2, H3, H4, H5, H6 and H7
+	ctxt.h0 = 0x6a09e667f3bcc908;
+	ctxt.h1 = 0xbb67ae8584caa73b;
+	ctxt.h2 = 0x3c6ef372fe94f82b;
+	ctxt.h3 = 0xa54ff53a5f1d36f1;
+	ctxt.h4 = 0x510e527fade682d1;
+	ctxt.h5 = 0x9b05688c2b3e6c1f;
+	ctxt.h6 = 0x1f83d9abfb41bd6b;
+	ctxt.h7 = 0x5be0cd19137e2179;
+
+	for (int i = 0; i < 15; i++) {
+		ctxt.w[i] = 0;
+	}
+}
+
+/**
+ * Generate SHA512 value.
+ *
+ * @param Sha512Context& ctxt - hashing state to use
+ * @param uint64_t* src - pointer to an array of 64 bit words used as hash input
+ * @param uint64_t* dst - pointer to an array of 8 X 64 bit words used as hash output
+ * @param int16_t len - number of 64 bit words available in array pointed by 'src'
+ *
+ * @return int 0 for successful operation, -1 for invalid parameters
+ *
+ */
+int EntropyConditioner::sha512_generateHash(Sha512Context &ctxt, const uint64_t *src, int16_t len, uint64_t *dst) const {
+
+	if (len <= 0 || len > 14) {
+		return -1;
+	}
+
+	sha512_initialize(ctxt);
+
+	int i = 0;
+	for (; i < len; i++) {
+		ctxt.w[i] = src[i];
+	}
+	ctxt.w[i] = 0x8000000000000000;
+	ctxt.w[15] = len * 64;
+
+
+	sha512_hashCurrentBlock(ctxt);
+
+	// Save the results
+	dst[0] = ctxt.h0;
+	dst[1] = ctxt.h1;
+	dst[2] = ctxt.h2;
+	dst[3] = ctxt.h3;
+	dst[4] = ctxt.h4;
+	dst[5] = ctxt.h5;
+	dst[6] = ctxt.h6;
+	dst[7] = ctxt.h7;
+
+	return 0;
+}
+
+/**
+ * Generate SHA256 value.
+ *
+ * @param Sha256Context& ctxt - hashing state to use
+ * @param uint32_t* src - pointer to an array of 32 bit words used as hash input
+ * @param uint32_t* dst - pointer to an array of 8 X 32 bit words used as hash output
+ * @param int16_t len - number of 32 bit words available in array pointed by 'src'
+ *
+ * @return int 0 for successful operation, -1 for invalid parameters
+ *
+ */
+int EntropyConditioner::sha256_generateHash(Sha256Context &ctxt, const uint32_t *src, int16_t len, uint32_t *dst) const {
+
+	uint16_t blockNum;
+	uint8_t ui8;
+	int32_t initialMessageSize;
+	uint16_t numCompleteDataBlocks;
+	uint16_t reminder;
+	uint16_t srcOffset;
+	uint8_t needAdditionalBlock;
+	uint8_t needToAddOneMarker;
+
+	if (len <= 0) {
+		return -1;
+	}
+
+	sha256_initialize(ctxt);
+
+	initialMessageSize = len * 8 * 4;
+	numCompleteDataBlocks = len / c_max_data_block_size_words;
+	reminder = len % c_max_data_block_size_words;
+
+	// Process complete blocks
+	for (blockNum = 0; blockNum < numCompleteDataBlocks; blockNum++) {
+		srcOffset = blockNum * c_max_data_block_size_words;
+		for (ui8 = 0; ui8 < c_max_data_block_size_words; ui8++) {
+			ctxt.w[ui8] = src[ui8 + srcOffset];
+		}
+		// Hash the current block
+		sha256_hashCurrentBlock(ctxt);
+	}
+
+	srcOffset = numCompleteDataBlocks * c_max_data_block_size_words;
+	needAdditionalBlock = 1;
+	needToAddOneMarker = 1;
+	if (reminder > 0) {
+		// Process the last data block if any
+		ui8 = 0;
+		for (; ui8 < reminder; ui8++) {
+			ctxt.w[ui8] = src[ui8 + srcOffset];
+		}
+		// Append '1' to the message
+		ctxt.w[ui8++] = 0x80000000;
+		needToAddOneMarker = 0;
+		if (ui8 < c_max_data_block_size_words - 1) {
+			for (; ui8 < c_max_data_block_size_words - 2; ui8++) {
+				// Fill with zeros
+				ctxt.w[ui8] = 0x0;
+			}
+			// add the message size to the current block
+			ctxt.w[ui8++] = 0x0;
+			ctxt.w[ui8] = initialMessageSize;
+			sha256_hashCurrentBlock(ctxt);
+			needAdditionalBlock = 0;
+		} else {
+			// Fill the rest with '0'
+			// Will need to create another block
+			ctxt.w[ui8] = 0x0;
+			sha256_hashCurrentBlock(ctxt);
+		}
+	}
+
+	if (needAdditionalBlock) {
+		ui8 = 0;
+		if (needToAddOneMarker) {
+			ctxt.w[ui8++] = 0x80000000;
+		}
+		for (; ui8 < c_max_data_block_size_words - 2; ui8++) {
+			ctxt.w[ui8] = 0x0;
+		}
+		ctxt.w[ui8++] = 0x0;
+		ctxt.w[ui8] = initialMessageSize;
+		sha256_hashCurrentBlock(ctxt);
+	}
+
+	// Save the results
+	dst[0] = ctxt.h0;
+	dst[1] = ctxt.h1;
+	dst[2] = ctxt.h2;
+	dst[3] = ctxt.h3;
+	dst[4] = ctxt.h4;
+	dst[5] = ctxt.h5;
+	dst[6] = ctxt.h6;
+	dst[7] = ctxt.h7;
+
+	return 0;
+}
+
+/**
+ * Hash current block
+ *
+ * @param Sha512Context& ctxt - hashing state holding the current block
+ */
+void EntropyConditioner::sha512_hashCurrentBlock(Sha512Context &ctxt) const {
+
+	// Process elements 16...79
+	for (uint8_t t = 16; t <= 79; t++) {
+		ctxt.w[t] = sha512_sigma1(&ctxt.w[t-2]) + ctxt.w[t-7] + sha512_sigma0(&ctxt.w[t-15]) + ctxt.w[t-16];
+	}
+
+	// Initialize variables
+	ctxt.a = ctxt.h0;
+	ctxt.b = ctxt.h1;
+	ctxt.c = ctxt.h2;
+	ctxt.d = ctxt.h3;
+	ctxt.e = ctxt.h4;
+	ctxt.f = ctxt.h5;
+	ctxt.g = ctxt.h6;
+	ctxt.h = ctxt.h7;
+
+	// Process elements 0...79
+	for (uint8_t t = 0; t <= 79; t++) {
+		ctxt.tmp1 = ctxt.h + sha512_sum1(&ctxt.e) + sha512_ch(&ctxt.e, &ctxt.f, &ctxt.g) + c_sha512_round_constants[t] + ctxt.w[t];
+		ctxt.tmp2 = sha512_sum0(&ctxt.a) + sha512_maj(&ctxt.a, &ctxt.b, &ctxt.c);
+		ctxt.h = ctxt.g;
+		ctxt.g = ctxt.f;
+		ctxt.f = ctxt.e;
+		ctxt.e = ctxt.d + ctxt.tmp1;
+		ctxt.d = ctxt.c;
+		ctxt.c = ctxt.b;
+		ctxt.b = ctxt.a;
+		ctxt.a = ctxt.tmp1 + ctxt.tmp2;
+	}
+
+	// Calculate the final hash for the block
+	ctxt.h0 += ctxt.a;
+	ctxt.h1 += ctxt.b;
+	ctxt.h2 += ctxt.c;
+	ctxt.h3 += ctxt.d;
+	ctxt.h4 += ctxt.e;
+	ctxt.h5 += ctxt.f;
+	ctxt.h6 += ctxt.g;
+	ctxt.h7 += ctxt.h;
+}
+
+/**
+ * Hash current block
+ *
+ * @param Sha256Context& ctxt - hashing state holding the current block
+ */
+void EntropyConditioner::sha256_hashCurrentBlock(Sha256Context &ctxt) const {
+	if (m_sha256_transform != nullptr) {
+		uint32_t state[8] = {ctxt.h0, ctxt.h1, ctxt.h2, ctxt.h3,
+				ctxt.h4, ctxt.h5, ctxt.h6, ctxt.h7};
+		m_sha256_transform(state, ctxt.w);
+		ctxt.h0 = state[0];
+		ctxt.h1 = state[1];
+		ctxt.h2 = state[2];
+		ctxt.h3 = state[3];
+		ctxt.h4 = state[4];
+		ctxt.h5 = state[5];
+		ctxt.h6 = state[6];
+		ctxt.h7 = state[7];
+		return;
+	}
+
+	// Process elements 16...63
+	for (uint8_t t = 16; t <= 63; t++) {
+		ctxt.w[t] = sha256_sigma1(&ctxt.w[t - 2]) + ctxt.w[t - 7] + sha256_sigma0(
+				&ctxt.w[t - 15]) + ctxt.w[t - 16];
+	}
+
+	// Initialize variables
+	ctxt.a = ctxt.h0;
+	ctxt.b = ctxt.h1;
+	ctxt.c = ctxt.h2;
+	ctxt.d = ctxt.h3;
+	ctxt.e = ctxt.h4;
+	ctxt.f = ctxt.h5;
+	ctxt.g = ctxt.h6;
+	ctxt.h = ctxt.h7;
+
+	// Process elements 0...63
+	for (uint8_t t = 0; t <= 63; t++) {
+		ctxt.tmp1 = ctxt.h + sha256_sum1(&ctxt.e) + sha256_ch(&ctxt.e, &ctxt.f, &ctxt.g)
+				+ c_sha256_round_constants[t] + ctxt.w[t];
+		ctxt.tmp2 = sha256_sum0(&ctxt.a) + sha256_maj(&ctxt.a, &ctxt.b, &ctxt.c);
+		ctxt.h = ctxt.g;
+		ctxt.g = ctxt.f;
+		ctxt.f = ctxt.e;
+		ctxt.e = ctxt.d + ctxt.tmp1;
+		ctxt.d = ctxt.c;
+		ctxt.c = ctxt.b;
+		ctxt.b = ctxt.a;
+		ctxt.a = ctxt.tmp1 + ctxt.tmp2;
+	}
+
+	// Calculate the final hash for the block
+	ctxt.h0 += ctxt.a;
+	ctxt.h1 += ctxt.b;
+	ctxt.h2 += ctxt.c;
+	ctxt.h3 += ctxt.d;
+	ctxt.h4 += ctxt.e;
+	ctxt.h5 += ctxt.f;
+	ctxt.h6 += ctxt.g;
+	ctxt.h7 += ctxt.h;
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.2 formula (4.2)
+ *
+ * @param uint32_t* x pointer to variable x
+ * @param uint32_t* y pointer to variable y
+ * @param uint32_t* z pointer to variable z
+ * $return uint32_t Ch value
+ *
+ */
+uint32_t EntropyConditioner::sha256_ch(uint32_t *x, uint32_t *y, uint32_t *z) const {
+	return ((*x) & (*y)) ^ (~(*x) & (*z));
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.2 formula (4.3)
+ *
+ * @param uint32_t* x pointer to variable x
+ * @param uint32_t* y pointer to variable y
+ * @param uint32_t* z pointer to variable z
+ * $return uint32_t Maj value
+ *
+ */
+uint32_t EntropyConditioner::sha256_maj(const uint32_t *x, const uint32_t *y, const uint32_t *z) const {
+	return ((*x) & (*y)) ^ ((*x) & (*z)) ^ ((*y) & (*z));
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.2 formula (4.4)
+ *
+ * @param uint32_t* x pointer to variable x
+ * $return uint32_t Sum0 value
+ *
+ */
+uint32_t EntropyConditioner::sha256_sum0(const uint32_t *x) const {
+	return rotr32(2, *x) ^ rotr32(13, *x) ^ rotr32(22, *x);
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.2 formula (4.5)
+ *
+ * @param uint32_t* x pointer to variable x
+ * $return uint32_t Sum1 value
+ *
+ */
+uint32_t EntropyConditioner::sha256_sum1(const uint32_t *x) const {
+	return rotr32(6, *x) ^ rotr32(11, *x) ^ rotr32(25, *x);
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.2 formula (4.6)
+ *
+ * @param uint32_t* x pointer to variable x
+ * $return uint32_t sigma0 value
+ *
+ */
+uint32_t EntropyConditioner::sha256_sigma0(const uint32_t *x) const {
+	return rotr32(7, *x) ^ rotr32(18, *x) ^ ((*x) >> 3);
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.2 formula (4.7)
+ *
+ * @param uint32_t* x pointer to variable x
+ * $return uint32_t sigma1 value
+ *
+ */
+uint32_t EntropyConditioner::sha256_sigma1(const uint32_t *x) const {
+	return rotr32(17, *x) ^ rotr32(19, *x) ^ ((*x) >> 10);
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.3 formula (4.8)
+ *
+ * @param uint64_t* x pointer to variable x
+ * @param uint64_t* y pointer to variable y
+ * @param uint64_t* z pointer to variable z
+ * $return uint64_t ch value
+ *
+ */
+uint64_t EntropyConditioner::sha512_ch(const uint64_t *x, const uint64_t *y, const uint64_t *z) const {
+	return  ((*x) & (*y)) ^ (~(*x) & (*z));
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.3 formula (4.9)
+ *
+ * @param uint64_t* x pointer to variable x
+ * @param uint64_t* y pointer to variable y
+ * @param uint64_t* z pointer to variable z
+ * $return uint64_t maj value
+ *
+ */
+uint64_t EntropyConditioner::sha512_maj(const uint64_t *x, const uint64_t *y, const uint64_t *z) const {
+	return ((*x) & (*y)) ^ ((*x) & (*z)) ^ ((*y) & (*z));
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.3 formula (4.10)
+ *
+ * @param uint64_t* x pointer to variable x
+ * $return uint64_t sum0 value
+ *
+ */
+uint64_t EntropyConditioner::sha512_sum0(const uint64_t *x) const {
+	return rotr64(28, *x) ^ rotr64(34, *x) ^ rotr64(39, *x);
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.3 formula (4.11)
+ *
+ * @param uint64_t* x pointer to variable x
+ * $return uint64_t sum1 value
+ *
+ */
+uint64_t EntropyConditioner::sha512_sum1(const uint64_t *x) const {
+	return rotr64(14, *x) ^ rotr64(18, *x) ^ rotr64(41, *x);
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.3 formula (4.12)
+ *
+ * @param uint64_t* x pointer to variable x
+ * $return uint64_t sigma0 value
+ *
+ */
+uint64_t EntropyConditioner::sha512_sigma0(const uint64_t *x) const {
+	return rotr64(1, *x) ^ rotr64(8, *x) ^ ((*x) >> 7);
+}
+
+/**
+ * FIPS PUB 180-4 section 4.1.3 formula (4.13)
+ *
+ * @param uint64_t* x pointer to variable x
+ * $return uint64_t sigma1 value
+ *
+ */
+uint64_t EntropyConditioner::sha512_sigma1(const uint64_t *x) const {
+	return rotr64(19, *x) ^ rotr64(61, *x) ^ ((*x) >> 6);
+}
+
+/*
+ * A function for running the self test for the SHA256 post processing method
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int EntropyConditioner::sha256_selfTest() const {
+	Sha256Context ctxt;
+	uint32_t results[8];
+	int retVal;
+
+	retVal = sha256_generateHash(ctxt, c_sha256_test_seq_1, (uint16_t) 11, (uint32_t*) results);
+	if (retVal == 0) {
+		// Compare the expected with actual results
+		retVal = memcmp(results, c_sha256_expt_hash_seq_1, sizeof(results));
+	}
+	return retVal;
+}
+
+/*
+ * A function for verifying that the multi-buffer SHA256 implementation produces the same
+ * hashes, including the serial number stamping, as the implementation hashing one chunk at a time
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int EntropyConditioner::sha256_multiBufferSelfTest() const {
+	Sha256Context ctxt;
+	uint32_t src[c_max_hash_lanes * 8];
+	uint32_t msg[9];
+	uint32_t results[c_max_hash_lanes * 8];
+	uint32_t expected[8];
+	// Make the serial numbers wrap around within the test
+	const uint32_t serial_number = 0xfffffff8;
+
+	for (int i = 0; i < c_max_hash_lanes * 8; i++) {
+		src[i] = c_sha256_round_constants[i & 63] ^ (uint32_t)i;
+	}
+
+	int num_hashed = m_sha256_stamped_hash(src, serial_number, results, c_max_hash_lanes);
+	if (num_hashed != c_max_hash_lanes) {
+		return -1;
+	}
+
+	for (int i = 0; i < num_hashed; i++) {
+		memcpy(msg, src + i * 8, 8 * sizeof(uint32_t));
+		msg[8] = serial_number + (uint32_t)i;
+		sha256_generateHash(ctxt, msg, (int16_t)9, expected);
+		if (memcmp(results + i * 8, expected, sizeof(expected)) != 0) {
+			return -1;
+		}
+	}
+	return SWRNG_SUCCESS;
+}
+
+/*
+ * A function for running the self test for the SHA512 post processing method
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int EntropyConditioner::sha512_selfTest() const {
+	Sha512Context ctxt;
+	uint64_t results[8];
+	int retVal;
+
+	retVal = sha512_generateHash(ctxt, (const uint64_t *)"8765432187654321876543218765432187654321876543218765432187654321",
+			(uint16_t) 8, (uint64_t*) results);
+	if (retVal == 0) {
+		// Compare the expected with actual results
+		retVal = memcmp(results, c_sha512_expt_hash_seq1, sizeof(results));
+	}
+	return retVal;
+}
+
+/*
+ * A function for running the SHA512 self test on every lane of the multi-buffer SHA512 implementation
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int EntropyConditioner::sha512_multiBufferSelfTest() const {
+	uint64_t src[c_max_hash_lanes * 8];
+	uint64_t results[c_max_hash_lanes * 8];
+
+	for (int i = 0; i < c_max_hash_lanes; i++) {
+		memcpy(src + i * 8, "8765432187654321876543218765432187654321876543218765432187654321", 8 * sizeof(uint64_t));
+	}
+
+	int num_hashed = m_sha512_multi_hash(src, results, c_max_hash_lanes);
+	if (num_hashed != c_max_hash_lanes) {
+		return -1;
+	}
+
+	for (int i = 0; i < num_hashed; i++) {
+		if (memcmp(results + i * 8, c_sha512_expt_hash_seq1, 8 * sizeof(uint64_t)) != 0) {
+			return -1;
+		}
+	}
+	return SWRNG_SUCCESS;
+}
+
+/*
+ * A function for running the self test for the xorshift64 post processing method
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int EntropyConditioner::xorshift64_selfTest() const {
+	uint64_t rawWord = 0x1212121212121212;
+	uint64_t testWord = 0x2322d6d77d8b7b55;
+	xorshift64_postProcess((uint8_t*)&rawWord, 8);
+
+	if (rawWord == testWord) {
+		return SWRNG_SUCCESS;
+	} else {
+		return -1;
+	}
+}
+
+/*
+ * A function for running the Xorshift64 self test on every lane of the vectorized Xorshift64 implementation
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int EntropyConditioner::xorshift64_simdSelfTest() const {
+	uint64_t words[c_max_hash_lanes];
+	const uint64_t rawWord = 0x1212121212121212;
+	const uint64_t testWord = 0x2322d6d77d8b7b55;
+
+	for (int i = 0; i < c_max_hash_lanes; i++) {
+		words[i] = rawWord;
+	}
+
+	if (m_xorshift64_kernel((uint8_t *)words, c_max_hash_lanes) != c_max_hash_lanes) {
+		return -1;
+	}
+
+	for (int i = 0; i < c_max_hash_lanes; i++) {
+		if (words[i] != testWord) {
+			return -1;
+		}
+	}
+	return SWRNG_SUCCESS;
+}
+
+} /* namespace swiftrng */
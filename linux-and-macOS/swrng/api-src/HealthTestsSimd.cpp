@@ -0,0 +1,149 @@
+/*
+ * HealthTestsSimd.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ Byte comparisons of 64 samples at once used by the 'repetition count' and 'adaptive proportion' health tests.
+
+ This code may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <PostProcessingKernels.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+#endif
+
+namespace swiftrng {
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#if defined(__GNUC__) && !defined(__clang__)
+ // GCC reports the self initialized `undefined` vectors of its own AVX-512 intrinsics
+ #pragma GCC diagnostic ignored "-Wuninitialized"
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/**
+ * Compare each byte with the byte preceding it, 64 bytes per iteration
+ *
+ * @param const uint8_t* src - pointer to the bytes to compare, src[-1] must be readable
+ * @param int num_bytes - number of bytes at src
+ * @param uint64_t* masks - pointer to one mask per 64 bytes compared
+ * @return int - number of bytes compared, a multiple of 64
+ */
+__attribute__((target("avx2")))
+int repeat_masks_avx2(const uint8_t *src, int num_bytes, uint64_t *masks) {
+	int i = 0;
+
+	for (; i + 64 <= num_bytes; i += 64) {
+		__m256i cur_lo = _mm256_loadu_si256((const __m256i *)(src + i));
+		__m256i cur_hi = _mm256_loadu_si256((const __m256i *)(src + i + 32));
+		__m256i prev_lo = _mm256_loadu_si256((const __m256i *)(src + i - 1));
+		__m256i prev_hi = _mm256_loadu_si256((const __m256i *)(src + i + 31));
+		uint32_t lo = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(cur_lo, prev_lo));
+		uint32_t hi = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(cur_hi, prev_hi));
+		masks[i / 64] = ((uint64_t)hi << 32) | lo;
+	}
+	return i;
+}
+
+/**
+ * Compare each byte with the byte preceding it, 64 bytes per iteration
+ *
+ * @param const uint8_t* src - pointer to the bytes to compare, src[-1] must be readable
+ * @param int num_bytes - number of bytes at src
+ * @param uint64_t* masks - pointer to one mask per 64 bytes compared
+ * @return int - number of bytes compared, a multiple of 64
+ */
+__attribute__((target("avx512f,avx512bw")))
+int repeat_masks_avx512(const uint8_t *src, int num_bytes, uint64_t *masks) {
+	int i = 0;
+
+	for (; i + 64 <= num_bytes; i += 64) {
+		__m512i cur = _mm512_loadu_si512((const void *)(src + i));
+		__m512i prev = _mm512_loadu_si512((const void *)(src + i - 1));
+		masks[i / 64] = _mm512_cmpeq_epi8_mask(cur, prev);
+	}
+	return i;
+}
+
+/**
+ * Count the bytes equal to the sample
+ *
+ * @param const uint8_t* src - pointer to 64 readable bytes
+ * @param int num_bytes - how many of the bytes to compare, at most 64
+ * @param uint8_t sample - the value to compare with
+ * @return int - number of bytes equal to the sample
+ */
+__attribute__((target("avx2")))
+int count_sample_matches_avx2(const uint8_t *src, int num_bytes, uint8_t sample) {
+	const __m256i index_lo = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+			16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+	const __m256i index_hi = _mm256_add_epi8(index_lo, _mm256_set1_epi8(32));
+	const __m256i limit = _mm256_set1_epi8((char)num_bytes);
+	const __m256i value = _mm256_set1_epi8((char)sample);
+	const __m256i one = _mm256_set1_epi8(1);
+
+	// 1 for each matching byte within the first `num_bytes`, summed with the absolute differences from zero
+	__m256i lo = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)src), value),
+			_mm256_cmpgt_epi8(limit, index_lo));
+	__m256i hi = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(src + 32)), value),
+			_mm256_cmpgt_epi8(limit, index_hi));
+	__m256i ones = _mm256_add_epi8(_mm256_and_si256(lo, one), _mm256_and_si256(hi, one));
+	__m256i sums = _mm256_sad_epu8(ones, _mm256_setzero_si256());
+	__m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+	sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+	return _mm_cvtsi128_si32(sum);
+}
+
+/**
+ * Count the bytes equal to the sample
+ *
+ * @param const uint8_t* src - pointer to 64 readable bytes
+ * @param int num_bytes - how many of the bytes to compare, at most 64
+ * @param uint8_t sample - the value to compare with
+ * @return int - number of bytes equal to the sample
+ */
+__attribute__((target("avx512f,avx512bw")))
+int count_sample_matches_avx512(const uint8_t *src, int num_bytes, uint8_t sample) {
+	__mmask64 in_range = num_bytes >= 64 ? ~(__mmask64)0 : (((__mmask64)1 << num_bytes) - 1);
+	__mmask64 matches = _mm512_mask_cmpeq_epi8_mask(in_range, _mm512_loadu_si512((const void *)src),
+			_mm512_set1_epi8((char)sample));
+	__m512i sums = _mm512_sad_epu8(_mm512_maskz_set1_epi8(matches, 1), _mm512_setzero_si512());
+	return (int)_mm512_reduce_add_epi64(sums);
+}
+
+#else
+
+int repeat_masks_avx2(const uint8_t *, int, uint64_t *) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+int repeat_masks_avx512(const uint8_t *, int, uint64_t *) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+int count_sample_matches_avx2(const uint8_t *, int, uint8_t) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+int count_sample_matches_avx512(const uint8_t *, int, uint8_t) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+#endif
+
+} /* namespace swiftrng */
@@ -0,0 +1,161 @@
+/*
+ * LiveStatistics.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This class keeps the live statistics of a SwiftRNG device.
+
+ This class may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <chrono>
+#include <LiveStatistics.h>
+
+namespace swiftrng {
+
+const uint64_t LiveStatistics::c_rate_window_nanos;
+const uint64_t LiveStatistics::c_idle_nanos;
+constexpr double LiveStatistics::c_rate_weight;
+
+/**
+* Read the monotonic clock used for timing the download stages
+*
+* @return uint64_t - current time in nanoseconds
+*/
+uint64_t LiveStatistics::now_nanos() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+* Count a data block delivered and update the throughput
+*
+* @param num_bytes - number of random bytes in the block
+*/
+void LiveStatistics::add_block(uint64_t num_bytes) {
+	increment(m_num_bytes, num_bytes);
+	increment(m_num_blocks, 1);
+	m_window_bytes += num_bytes;
+	update_throughput(now_nanos());
+}
+
+/**
+* Fold the throughput of the current window into the moving average once the window is long enough.
+* A window spanning an idle period is discarded, so the average reflects the downloads only.
+*
+* @param now - current time in nanoseconds
+*/
+void LiveStatistics::update_throughput(uint64_t now) {
+	uint64_t last_block_nanos = m_last_block_nanos.load(std::memory_order_relaxed);
+	m_last_block_nanos.store(now, std::memory_order_relaxed);
+	if (m_window_begin_nanos == 0 || now - last_block_nanos > c_idle_nanos) {
+		m_window_begin_nanos = now;
+		m_window_bytes = 0;
+		return;
+	}
+
+	uint64_t elapsed_nanos = now - m_window_begin_nanos;
+	if (elapsed_nanos < c_rate_window_nanos) {
+		return;
+	}
+	double rate = (double)m_window_bytes * 1e9 / (double)elapsed_nanos;
+	double avg_rate = m_bytes_per_sec.load(std::memory_order_relaxed);
+	m_bytes_per_sec.store(avg_rate == 0 ? rate : avg_rate + c_rate_weight * (rate - avg_rate), std::memory_order_relaxed);
+	m_window_begin_nanos = now;
+	m_window_bytes = 0;
+}
+
+/**
+* Copy the statistics. Each value is read atomically, the values are updated while they are being copied.
+*
+* @param stats - pointer to the structure receiving the statistics
+*/
+void LiveStatistics::snapshot(DeviceLiveStatistics *stats) const {
+	stats->numBytes = m_num_bytes.load(std::memory_order_relaxed);
+	stats->numBlocks = m_num_blocks.load(std::memory_order_relaxed);
+	stats->numRetries = m_num_retries.load(std::memory_order_relaxed);
+	stats->numTimeouts = m_num_timeouts.load(std::memory_order_relaxed);
+	stats->numRctFailures = m_num_rct_failures.load(std::memory_order_relaxed);
+	stats->numAptFailures = m_num_apt_failures.load(std::memory_order_relaxed);
+	stats->bytesPerSec = 0;
+	uint64_t last_block_nanos = m_last_block_nanos.load(std::memory_order_relaxed);
+	if (last_block_nanos != 0 && now_nanos() - last_block_nanos <= c_idle_nanos) {
+		stats->bytesPerSec = m_bytes_per_sec.load(std::memory_order_relaxed);
+	}
+	m_usb_latency.snapshot(&stats->usbLatency);
+	m_health_test_latency.snapshot(&stats->healthTestLatency);
+	m_conditioning_latency.snapshot(&stats->conditioningLatency);
+}
+
+/**
+* Clear the statistics. Called by the writer.
+*/
+void LiveStatistics::reset() {
+	m_num_bytes = 0;
+	m_num_blocks = 0;
+	m_num_retries = 0;
+	m_num_timeouts = 0;
+	m_num_rct_failures = 0;
+	m_num_apt_failures = 0;
+	m_usb_latency.reset();
+	m_health_test_latency.reset();
+	m_conditioning_latency.reset();
+	m_bytes_per_sec = 0;
+	m_last_block_nanos = 0;
+	m_window_begin_nanos = 0;
+	m_window_bytes = 0;
+}
+
+/**
+* Record a latency
+*
+* @param nanos - the latency in nanoseconds
+*/
+void LiveStatistics::Histogram::record(uint64_t nanos) {
+	int bucket = nanos < 2 ? 0 : 63 - __builtin_clzll(nanos);
+	if (bucket >= SWRNG_LATENCY_BUCKETS) {
+		bucket = SWRNG_LATENCY_BUCKETS - 1;
+	}
+	increment(m_buckets[bucket], 1);
+	increment(m_total_nanos, nanos);
+	if (nanos > m_max_nanos.load(std::memory_order_relaxed)) {
+		m_max_nanos.store(nanos, std::memory_order_relaxed);
+	}
+	increment(m_count, 1);
+}
+
+/**
+* Copy the histogram
+*
+* @param histogram - pointer to the structure receiving the histogram
+*/
+void LiveStatistics::Histogram::snapshot(LatencyHistogram *histogram) const {
+	histogram->count = m_count.load(std::memory_order_relaxed);
+	histogram->totalNanos = m_total_nanos.load(std::memory_order_relaxed);
+	histogram->maxNanos = m_max_nanos.load(std::memory_order_relaxed);
+	for (int i = 0; i < SWRNG_LATENCY_BUCKETS; i++) {
+		histogram->buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+	}
+}
+
+/**
+* Clear the histogram
+*/
+void LiveStatistics::Histogram::reset() {
+	m_count = 0;
+	m_total_nanos = 0;
+	m_max_nanos = 0;
+	for (auto &bucket : m_buckets) {
+		bucket = 0;
+	}
+}
+
+} /* namespace swiftrng */
@@ -0,0 +1,273 @@
+/*
+ * Sha256MultiBuffer.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ Multi-buffer SHA-256 for post processing: each vector lane hashes an independent message made of
+ 8 random data words and a serial number word, which always fits into a single padded message block.
+
+ This code may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <PostProcessingKernels.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+#endif
+
+namespace swiftrng {
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#if defined(__GNUC__) && !defined(__clang__)
+ // GCC reports the self initialized `undefined` vectors of its own AVX-512 intrinsics
+ #pragma GCC diagnostic ignored "-Wuninitialized"
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// Number of data words in each message, the serial number word follows them
+static const int c_msg_data_words = 8;
+
+// Padding of a 9 word message: the '1' marker, zeros and the message size in bits
+static const uint32_t c_msg_padding[7] = {0x80000000, 0, 0, 0, 0, 0, 9 * 32};
+
+static const uint32_t c_sha256_h[8] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/**
+ * Transpose an 8 x 8 matrix of 32 bit words held in 8 AVX2 registers
+ */
+__attribute__((target("avx2")))
+static inline void transpose_8x8(__m256i *r) {
+	__m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+	__m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+	__m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+	__m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+	__m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+	__m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+	__m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+	__m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+
+	__m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+	__m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+	__m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+	__m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+	__m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+	__m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+	__m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+	__m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+	r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+	r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+	r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+	r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+	r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+	r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+	r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+	r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i ror_avx2(__m256i x, int n) {
+	return _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n));
+}
+
+/**
+ * Hash 8 messages, one per lane
+ *
+ * @param const uint32_t* src - pointer to 8 consecutive messages of 8 data words
+ * @param uint32_t serial_number - serial number of the first message
+ * @param uint32_t* dst - pointer to 8 consecutive digests of 8 words
+ */
+__attribute__((target("avx2")))
+static void sha256_hash_8_lanes(const uint32_t *src, uint32_t serial_number, uint32_t *dst) {
+	__m256i w[16];
+	__m256i s[8];
+
+	for (int j = 0; j < 8; j++) {
+		w[j] = _mm256_loadu_si256((const __m256i *)(src + j * c_msg_data_words));
+	}
+	// Lane j receives message j
+	transpose_8x8(w);
+	w[8] = _mm256_add_epi32(_mm256_set1_epi32((int)serial_number), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+	for (int j = 0; j < 7; j++) {
+		w[9 + j] = _mm256_set1_epi32((int)c_msg_padding[j]);
+	}
+
+	for (int j = 0; j < 8; j++) {
+		s[j] = _mm256_set1_epi32((int)c_sha256_h[j]);
+	}
+	__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+	for (int t = 0; t < 64; t++) {
+		__m256i wt;
+		if (t < 16) {
+			wt = w[t];
+		} else {
+			// The schedule is kept in a ring of the last 16 words
+			__m256i w2 = w[(t - 2) & 15];
+			__m256i w15 = w[(t - 15) & 15];
+			__m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(ror_avx2(w2, 17), ror_avx2(w2, 19)), _mm256_srli_epi32(w2, 10));
+			__m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(ror_avx2(w15, 7), ror_avx2(w15, 18)), _mm256_srli_epi32(w15, 3));
+			wt = _mm256_add_epi32(_mm256_add_epi32(sigma1, w[(t - 7) & 15]), _mm256_add_epi32(sigma0, w[t & 15]));
+			w[t & 15] = wt;
+		}
+		__m256i sum1 = _mm256_xor_si256(_mm256_xor_si256(ror_avx2(e, 6), ror_avx2(e, 11)), ror_avx2(e, 25));
+		__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i tmp1 = _mm256_add_epi32(_mm256_add_epi32(h, sum1), _mm256_add_epi32(ch, wt));
+		tmp1 = _mm256_add_epi32(tmp1, _mm256_set1_epi32((int)c_sha256_round_constants[t]));
+		__m256i sum0 = _mm256_xor_si256(_mm256_xor_si256(ror_avx2(a, 2), ror_avx2(a, 13)), ror_avx2(a, 22));
+		__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+		__m256i tmp2 = _mm256_add_epi32(sum0, maj);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi32(d, tmp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi32(tmp1, tmp2);
+	}
+
+	s[0] = _mm256_add_epi32(s[0], a);
+	s[1] = _mm256_add_epi32(s[1], b);
+	s[2] = _mm256_add_epi32(s[2], c);
+	s[3] = _mm256_add_epi32(s[3], d);
+	s[4] = _mm256_add_epi32(s[4], e);
+	s[5] = _mm256_add_epi32(s[5], f);
+	s[6] = _mm256_add_epi32(s[6], g);
+	s[7] = _mm256_add_epi32(s[7], h);
+
+	// Row j back to the digest of lane j
+	transpose_8x8(s);
+	for (int j = 0; j < 8; j++) {
+		_mm256_storeu_si256((__m256i *)(dst + j * 8), s[j]);
+	}
+}
+
+/**
+ * Hash 16 messages, one per lane
+ *
+ * @param const uint32_t* src - pointer to 16 consecutive messages of 8 data words
+ * @param uint32_t serial_number - serial number of the first message
+ * @param uint32_t* dst - pointer to 16 consecutive digests of 8 words
+ */
+__attribute__((target("avx2,avx512f")))
+static void sha256_hash_16_lanes(const uint32_t *src, uint32_t serial_number, uint32_t *dst) {
+	__m256i lo[8];
+	__m256i hi[8];
+	__m512i w[16];
+	__m512i s[8];
+
+	// Messages 0..7 go to the lower half of the lanes, 8..15 to the upper half
+	for (int j = 0; j < 8; j++) {
+		lo[j] = _mm256_loadu_si256((const __m256i *)(src + j * c_msg_data_words));
+		hi[j] = _mm256_loadu_si256((const __m256i *)(src + (j + 8) * c_msg_data_words));
+	}
+	transpose_8x8(lo);
+	transpose_8x8(hi);
+	for (int j = 0; j < 8; j++) {
+		w[j] = _mm512_inserti64x4(_mm512_castsi256_si512(lo[j]), hi[j], 1);
+	}
+	w[8] = _mm512_add_epi32(_mm512_set1_epi32((int)serial_number),
+			_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+	for (int j = 0; j < 7; j++) {
+		w[9 + j] = _mm512_set1_epi32((int)c_msg_padding[j]);
+	}
+
+	for (int j = 0; j < 8; j++) {
+		s[j] = _mm512_set1_epi32((int)c_sha256_h[j]);
+	}
+	__m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+	for (int t = 0; t < 64; t++) {
+		__m512i wt;
+		if (t < 16) {
+			wt = w[t];
+		} else {
+			__m512i w2 = w[(t - 2) & 15];
+			__m512i w15 = w[(t - 15) & 15];
+			__m512i sigma1 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(w2, 17), _mm512_ror_epi32(w2, 19), _mm512_srli_epi32(w2, 10), 0x96);
+			__m512i sigma0 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(w15, 7), _mm512_ror_epi32(w15, 18), _mm512_srli_epi32(w15, 3), 0x96);
+			wt = _mm512_add_epi32(_mm512_add_epi32(sigma1, w[(t - 7) & 15]), _mm512_add_epi32(sigma0, w[t & 15]));
+			w[t & 15] = wt;
+		}
+		// 0x96 is a three way xor, 0xCA is Ch(e, f, g) and 0xE8 is Maj(a, b, c)
+		__m512i sum1 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(e, 6), _mm512_ror_epi32(e, 11), _mm512_ror_epi32(e, 25), 0x96);
+		__m512i ch = _mm512_ternarylogic_epi32(e, f, g, 0xCA);
+		__m512i tmp1 = _mm512_add_epi32(_mm512_add_epi32(h, sum1), _mm512_add_epi32(ch, wt));
+		tmp1 = _mm512_add_epi32(tmp1, _mm512_set1_epi32((int)c_sha256_round_constants[t]));
+		__m512i sum0 = _mm512_ternarylogic_epi32(_mm512_ror_epi32(a, 2), _mm512_ror_epi32(a, 13), _mm512_ror_epi32(a, 22), 0x96);
+		__m512i maj = _mm512_ternarylogic_epi32(a, b, c, 0xE8);
+		__m512i tmp2 = _mm512_add_epi32(sum0, maj);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm512_add_epi32(d, tmp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm512_add_epi32(tmp1, tmp2);
+	}
+
+	s[0] = _mm512_add_epi32(s[0], a);
+	s[1] = _mm512_add_epi32(s[1], b);
+	s[2] = _mm512_add_epi32(s[2], c);
+	s[3] = _mm512_add_epi32(s[3], d);
+	s[4] = _mm512_add_epi32(s[4], e);
+	s[5] = _mm512_add_epi32(s[5], f);
+	s[6] = _mm512_add_epi32(s[6], g);
+	s[7] = _mm512_add_epi32(s[7], h);
+
+	for (int j = 0; j < 8; j++) {
+		lo[j] = _mm512_castsi512_si256(s[j]);
+		hi[j] = _mm512_extracti64x4_epi64(s[j], 1);
+	}
+	transpose_8x8(lo);
+	transpose_8x8(hi);
+	for (int j = 0; j < 8; j++) {
+		_mm256_storeu_si256((__m256i *)(dst + j * 8), lo[j]);
+		_mm256_storeu_si256((__m256i *)(dst + (j + 8) * 8), hi[j]);
+	}
+}
+
+int sha256_hash_stamped_avx2(const uint32_t *src, uint32_t serial_number, uint32_t *dst, int num_msgs) {
+	int i = 0;
+	for (; i + 8 <= num_msgs; i += 8) {
+		sha256_hash_8_lanes(src + i * c_msg_data_words, serial_number + (uint32_t)i, dst + i * 8);
+	}
+	return i;
+}
+
+int sha256_hash_stamped_avx512(const uint32_t *src, uint32_t serial_number, uint32_t *dst, int num_msgs) {
+	int i = 0;
+	for (; i + 16 <= num_msgs; i += 16) {
+		sha256_hash_16_lanes(src + i * c_msg_data_words, serial_number + (uint32_t)i, dst + i * 8);
+	}
+	return i;
+}
+
+#else
+
+int sha256_hash_stamped_avx2(const uint32_t *, uint32_t, uint32_t *, int) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+int sha256_hash_stamped_avx512(const uint32_t *, uint32_t, uint32_t *, int) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+#endif
+
+} /* namespace swiftrng */
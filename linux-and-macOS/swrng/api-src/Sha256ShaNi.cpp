@@ -0,0 +1,107 @@
+/*
+ * Sha256ShaNi.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ SHA-256 block compression implemented with the x86 SHA extensions (sha256rnds2, sha256msg1, sha256msg2).
+
+ This code may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <PostProcessingKernels.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+#endif
+
+namespace swiftrng {
+
+alignas(16) const uint32_t c_sha256_round_constants[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * Compress one message block. The message words are already in native order,
+ * so no byte swapping is needed when loading them.
+ *
+ * @param uint32_t* state - pointer to H0 through H7, updated in place
+ * @param const uint32_t* block - pointer to 16 message words
+ */
+__attribute__((target("sha,sse4.1")))
+void sha256_transform_sha_ni(uint32_t *state, const uint32_t *block) {
+	__m128i msg[4];
+	__m128i tmp;
+	__m128i cur;
+
+	// Rearrange H0..H7 into the ABEF / CDGH layout expected by sha256rnds2
+	tmp = _mm_loadu_si128((const __m128i *)&state[0]);
+	__m128i state1 = _mm_loadu_si128((const __m128i *)&state[4]);
+	tmp = _mm_shuffle_epi32(tmp, 0xB1);
+	state1 = _mm_shuffle_epi32(state1, 0x1B);
+	__m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+	state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+	const __m128i abef_save = state0;
+	const __m128i cdgh_save = state1;
+
+	for (int i = 0; i < 4; i++) {
+		msg[i] = _mm_loadu_si128((const __m128i *)&block[i * 4]);
+	}
+
+	// Each iteration runs 4 rounds and advances the message schedule
+	for (int g = 0; g < 16; g++) {
+		cur = msg[g & 3];
+		tmp = _mm_add_epi32(cur, _mm_load_si128((const __m128i *)&c_sha256_round_constants[g * 4]));
+		state1 = _mm_sha256rnds2_epu32(state1, state0, tmp);
+		if (g >= 3 && g <= 14) {
+			__m128i &next = msg[(g + 1) & 3];
+			next = _mm_add_epi32(next, _mm_alignr_epi8(cur, msg[(g + 3) & 3], 4));
+			next = _mm_sha256msg2_epu32(next, cur);
+		}
+		tmp = _mm_shuffle_epi32(tmp, 0x0E);
+		state0 = _mm_sha256rnds2_epu32(state0, state1, tmp);
+		if (g >= 1 && g <= 12) {
+			__m128i &prev = msg[(g + 3) & 3];
+			prev = _mm_sha256msg1_epu32(prev, cur);
+		}
+	}
+
+	state0 = _mm_add_epi32(state0, abef_save);
+	state1 = _mm_add_epi32(state1, cdgh_save);
+
+	// Back to the H0..H7 layout
+	tmp = _mm_shuffle_epi32(state0, 0x1B);
+	state1 = _mm_shuffle_epi32(state1, 0xB1);
+	state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+	state1 = _mm_alignr_epi8(state1, tmp, 8);
+
+	_mm_storeu_si128((__m128i *)&state[0], state0);
+	_mm_storeu_si128((__m128i *)&state[4], state1);
+}
+
+#else
+
+void sha256_transform_sha_ni(uint32_t *, const uint32_t *) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+}
+
+#endif
+
+} /* namespace swiftrng */
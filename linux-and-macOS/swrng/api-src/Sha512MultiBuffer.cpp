@@ -0,0 +1,266 @@
+/*
+ * Sha512MultiBuffer.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ Multi-buffer SHA-512 for post processing: each vector lane hashes an independent message of
+ 8 random data words, which always fits into a single padded message block.
+
+ This code may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <PostProcessingKernels.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+#endif
+
+namespace swiftrng {
+
+// SHA-512 round constants, FIPS PUB 180-4 section 4.2.3
+const uint64_t c_sha512_round_constants[80] = {
+	0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc,
+	0x3956c25bf348b538, 0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118,
+	0xd807aa98a3030242, 0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+	0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235, 0xc19bf174cf692694,
+	0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+	0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+	0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4,
+	0xc6e00bf33da88fc2, 0xd5a79147930aa725, 0x06ca6351e003826f, 0x142929670a0e6e70,
+	0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+	0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
+	0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30,
+	0xd192e819d6ef5218, 0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+	0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8,
+	0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3,
+	0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+	0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b,
+	0xca273eceea26619c, 0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178,
+	0x06f067aa72176fba, 0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+	0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc, 0x431d67c49c100d4c,
+	0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#if defined(__GNUC__) && !defined(__clang__)
+ // GCC reports the self initialized `undefined` vectors of its own AVX-512 intrinsics
+ #pragma GCC diagnostic ignored "-Wuninitialized"
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// Number of data words in each message
+static const int c_msg_data_words = 8;
+
+// Padding of an 8 word message: the '1' marker, zeros and the message size in bits
+static const uint64_t c_msg_padding[8] = {0x8000000000000000, 0, 0, 0, 0, 0, 0, 8 * 64};
+
+static const uint64_t c_sha512_h[8] = {
+	0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+	0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+};
+
+/**
+ * Transpose a 4 x 4 matrix of 64 bit words held in 4 AVX2 registers
+ */
+__attribute__((target("avx2")))
+static inline void transpose_4x4(__m256i *r) {
+	__m256i t0 = _mm256_unpacklo_epi64(r[0], r[1]);
+	__m256i t1 = _mm256_unpackhi_epi64(r[0], r[1]);
+	__m256i t2 = _mm256_unpacklo_epi64(r[2], r[3]);
+	__m256i t3 = _mm256_unpackhi_epi64(r[2], r[3]);
+
+	r[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+	r[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+	r[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+	r[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i ror64_avx2(__m256i x, int n) {
+	return _mm256_or_si256(_mm256_srli_epi64(x, n), _mm256_slli_epi64(x, 64 - n));
+}
+
+/**
+ * Hash 4 messages, one per lane
+ *
+ * @param const uint64_t* src - pointer to 4 consecutive messages of 8 data words
+ * @param uint64_t* dst - pointer to 4 consecutive digests of 8 words
+ */
+__attribute__((target("avx2")))
+static void sha512_hash_4_lanes(const uint64_t *src, uint64_t *dst) {
+	__m256i w[16];
+	__m256i s[8];
+
+	// Lane j receives message j, words 0..3 and 4..7 are transposed separately
+	for (int half = 0; half < 2; half++) {
+		for (int j = 0; j < 4; j++) {
+			w[half * 4 + j] = _mm256_loadu_si256((const __m256i *)(src + j * c_msg_data_words + half * 4));
+		}
+		transpose_4x4(&w[half * 4]);
+	}
+	for (int j = 0; j < 8; j++) {
+		w[8 + j] = _mm256_set1_epi64x((long long)c_msg_padding[j]);
+	}
+
+	for (int j = 0; j < 8; j++) {
+		s[j] = _mm256_set1_epi64x((long long)c_sha512_h[j]);
+	}
+	__m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+	for (int t = 0; t < 80; t++) {
+		__m256i wt;
+		if (t < 16) {
+			wt = w[t];
+		} else {
+			// The schedule is kept in a ring of the last 16 words
+			__m256i w2 = w[(t - 2) & 15];
+			__m256i w15 = w[(t - 15) & 15];
+			__m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(ror64_avx2(w2, 19), ror64_avx2(w2, 61)), _mm256_srli_epi64(w2, 6));
+			__m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(ror64_avx2(w15, 1), ror64_avx2(w15, 8)), _mm256_srli_epi64(w15, 7));
+			wt = _mm256_add_epi64(_mm256_add_epi64(sigma1, w[(t - 7) & 15]), _mm256_add_epi64(sigma0, w[t & 15]));
+			w[t & 15] = wt;
+		}
+		__m256i sum1 = _mm256_xor_si256(_mm256_xor_si256(ror64_avx2(e, 14), ror64_avx2(e, 18)), ror64_avx2(e, 41));
+		__m256i ch = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+		__m256i tmp1 = _mm256_add_epi64(_mm256_add_epi64(h, sum1), _mm256_add_epi64(ch, wt));
+		tmp1 = _mm256_add_epi64(tmp1, _mm256_set1_epi64x((long long)c_sha512_round_constants[t]));
+		__m256i sum0 = _mm256_xor_si256(_mm256_xor_si256(ror64_avx2(a, 28), ror64_avx2(a, 34)), ror64_avx2(a, 39));
+		__m256i maj = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(c, _mm256_or_si256(a, b)));
+		__m256i tmp2 = _mm256_add_epi64(sum0, maj);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm256_add_epi64(d, tmp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm256_add_epi64(tmp1, tmp2);
+	}
+
+	s[0] = _mm256_add_epi64(s[0], a);
+	s[1] = _mm256_add_epi64(s[1], b);
+	s[2] = _mm256_add_epi64(s[2], c);
+	s[3] = _mm256_add_epi64(s[3], d);
+	s[4] = _mm256_add_epi64(s[4], e);
+	s[5] = _mm256_add_epi64(s[5], f);
+	s[6] = _mm256_add_epi64(s[6], g);
+	s[7] = _mm256_add_epi64(s[7], h);
+
+	// Back to the digest of each lane
+	for (int half = 0; half < 2; half++) {
+		transpose_4x4(&s[half * 4]);
+		for (int j = 0; j < 4; j++) {
+			_mm256_storeu_si256((__m256i *)(dst + j * 8 + half * 4), s[half * 4 + j]);
+		}
+	}
+}
+
+/**
+ * Hash 8 messages, one per lane
+ *
+ * @param const uint64_t* src - pointer to 8 consecutive messages of 8 data words
+ * @param uint64_t* dst - pointer to 8 consecutive digests of 8 words
+ */
+__attribute__((target("avx512f")))
+static void sha512_hash_8_lanes(const uint64_t *src, uint64_t *dst) {
+	__m512i w[16];
+	__m512i s[8];
+	// Offset of the first word of each message, in words
+	const __m512i msg_offsets = _mm512_setr_epi64(0, 8, 16, 24, 32, 40, 48, 56);
+
+	for (int j = 0; j < 8; j++) {
+		w[j] = _mm512_i64gather_epi64(msg_offsets, (const void *)(src + j), 8);
+	}
+	for (int j = 0; j < 8; j++) {
+		w[8 + j] = _mm512_set1_epi64((long long)c_msg_padding[j]);
+	}
+
+	for (int j = 0; j < 8; j++) {
+		s[j] = _mm512_set1_epi64((long long)c_sha512_h[j]);
+	}
+	__m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+
+	for (int t = 0; t < 80; t++) {
+		__m512i wt;
+		if (t < 16) {
+			wt = w[t];
+		} else {
+			__m512i w2 = w[(t - 2) & 15];
+			__m512i w15 = w[(t - 15) & 15];
+			__m512i sigma1 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(w2, 19), _mm512_ror_epi64(w2, 61), _mm512_srli_epi64(w2, 6), 0x96);
+			__m512i sigma0 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(w15, 1), _mm512_ror_epi64(w15, 8), _mm512_srli_epi64(w15, 7), 0x96);
+			wt = _mm512_add_epi64(_mm512_add_epi64(sigma1, w[(t - 7) & 15]), _mm512_add_epi64(sigma0, w[t & 15]));
+			w[t & 15] = wt;
+		}
+		// 0x96 is a three way xor, 0xCA is Ch(e, f, g) and 0xE8 is Maj(a, b, c)
+		__m512i sum1 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(e, 14), _mm512_ror_epi64(e, 18), _mm512_ror_epi64(e, 41), 0x96);
+		__m512i ch = _mm512_ternarylogic_epi64(e, f, g, 0xCA);
+		__m512i tmp1 = _mm512_add_epi64(_mm512_add_epi64(h, sum1), _mm512_add_epi64(ch, wt));
+		tmp1 = _mm512_add_epi64(tmp1, _mm512_set1_epi64((long long)c_sha512_round_constants[t]));
+		__m512i sum0 = _mm512_ternarylogic_epi64(_mm512_ror_epi64(a, 28), _mm512_ror_epi64(a, 34), _mm512_ror_epi64(a, 39), 0x96);
+		__m512i maj = _mm512_ternarylogic_epi64(a, b, c, 0xE8);
+		__m512i tmp2 = _mm512_add_epi64(sum0, maj);
+		h = g;
+		g = f;
+		f = e;
+		e = _mm512_add_epi64(d, tmp1);
+		d = c;
+		c = b;
+		b = a;
+		a = _mm512_add_epi64(tmp1, tmp2);
+	}
+
+	s[0] = _mm512_add_epi64(s[0], a);
+	s[1] = _mm512_add_epi64(s[1], b);
+	s[2] = _mm512_add_epi64(s[2], c);
+	s[3] = _mm512_add_epi64(s[3], d);
+	s[4] = _mm512_add_epi64(s[4], e);
+	s[5] = _mm512_add_epi64(s[5], f);
+	s[6] = _mm512_add_epi64(s[6], g);
+	s[7] = _mm512_add_epi64(s[7], h);
+
+	for (int j = 0; j < 8; j++) {
+		_mm512_i64scatter_epi64((void *)(dst + j), msg_offsets, s[j], 8);
+	}
+}
+
+int sha512_hash_avx2(const uint64_t *src, uint64_t *dst, int num_msgs) {
+	int i = 0;
+	for (; i + 4 <= num_msgs; i += 4) {
+		sha512_hash_4_lanes(src + i * c_msg_data_words, dst + i * 8);
+	}
+	return i;
+}
+
+int sha512_hash_avx512(const uint64_t *src, uint64_t *dst, int num_msgs) {
+	int i = 0;
+	for (; i + 8 <= num_msgs; i += 8) {
+		sha512_hash_8_lanes(src + i * c_msg_data_words, dst + i * 8);
+	}
+	return i;
+}
+
+#else
+
+int sha512_hash_avx2(const uint64_t *, uint64_t *, int) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+int sha512_hash_avx512(const uint64_t *, uint64_t *, int) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+#endif
+
+} /* namespace swiftrng */
@@ -37,85 +37,27 @@ void SwiftRngApi::initialize() {
 
 	std::memset(&m_device_stats, 0, sizeof(DeviceStatistics));
 	std::memset(&m_cur_device_version, 0, sizeof(DeviceVersion));
-
-	c_sha256_k = new (nothrow) uint32_t [64] {
-		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-		0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-		0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-		0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-		0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-		0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-		0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-		0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-		0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-		0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-		0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-		0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-	};
-
-	if (c_sha256_k == nullptr) {
-		return;
-	}
-
-	c_sha256_test_seq_1 = new (nothrow) uint32_t [11] {
-		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-		0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0x428a2f98,
-		0x71374491, 0xb5c0fbcf
-	};
-
-	if (c_sha256_test_seq_1 == nullptr) {
-		return;
-	}
-
-
-	c_sha256_expt_hash_seq_1 = new (nothrow) uint32_t [8] {
-		0x114c3052, 0x76410592, 0xc024566b,
-		0xa492b1a2, 0xb0559389, 0xb7c41156, 0x2ec8d6c3, 0x3dcb02dd
-	};
-
-	if (c_sha256_expt_hash_seq_1 == nullptr) {
-		return;
-	}
-
-
-	c_sha512_k = new (nothrow) uint64_t [80] {
-		0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc,
-		0x3956c25bf348b538, 0x59f111f1b605d019, 0x923f82a4af194f9b, 0xab1c5ed5da6d8118,
-		0xd807aa98a3030242, 0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
-		0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235, 0xc19bf174cf692694,
-		0xe49b69c19ef14ad2, 0xefbe4786384f25e3, 0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
-		0x2de92c6f592b0275, 0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
-		0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f, 0xbf597fc7beef0ee4,
-		0xc6e00bf33da88fc2, 0xd5a79147930aa725, 0x06ca6351e003826f, 0x142929670a0e6e70,
-		0x27b70a8546d22ffc, 0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
-		0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6, 0x92722c851482353b,
-		0xa2bfe8a14cf10364, 0xa81a664bbc423001, 0xc24b8b70d0f89791, 0xc76c51a30654be30,
-		0xd192e819d6ef5218, 0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
-		0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8,
-		0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb, 0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3,
-		0x748f82ee5defb2fc, 0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
-		0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915, 0xc67178f2e372532b,
-		0xca273eceea26619c, 0xd186b8c721c0c207, 0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178,
-		0x06f067aa72176fba, 0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
-		0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc, 0x431d67c49c100d4c,
-		0x4cc5d4becb3e42b6, 0x597f299cfc657e2a, 0x5fcb6fab3ad6faec, 0x6c44198c4a475817
-	};
-
-	if (c_sha512_k == nullptr) {
-		return;
-	}
-
-	c_sha512_expt_hash_seq1 = new (nothrow) uint64_t [8] {
-		0x6cbce8f347e8d1b3, 0xd3517b27fdc4ee1c, 0x71d8406ab54e2335,
-		0xf3a39732fa0009d2, 0x2193c41677d18504, 0xe90b4c1138c32e7c, 0xc1aa7500597ba99c, 0xacd525ef2c44e9dc
-	};
-
-	if (c_sha512_expt_hash_seq1 == nullptr) {
-		return;
-	}
-
-	m_buff_rnd_out = new (nothrow) char[c_rnd_out_buff_size];
+	std::memset(m_pipeline_slots, 0, sizeof(m_pipeline_slots));
+
+	const CpuFeatures &cpu_features = CpuFeatures::get_instance();
+	if (cpu_features.has_avx512bw()) {
+		m_repeat_mask_kernel = repeat_masks_avx512;
+		m_sample_match_kernel = count_sample_matches_avx512;
+	} else if (cpu_features.has_avx2()) {
+		m_repeat_mask_kernel = repeat_masks_avx2;
+		m_sample_match_kernel = count_sample_matches_avx2;
+	}
+	// All instances use the same kernels, so they are verified once per process
+	static const bool health_test_kernels_pass = m_repeat_mask_kernel == nullptr
+			|| health_tests_simdSelfTest() == SWRNG_SUCCESS;
+	if (!health_test_kernels_pass) {
+		// Test the samples one by one
+		m_repeat_mask_kernel = nullptr;
+		m_sample_match_kernel = nullptr;
+	}
+
+	// Same size as `m_buff_rnd_in` so that raw blocks can be swapped in without copying
+	m_buff_rnd_out = alloc_block_buffer();
 	if (m_buff_rnd_out == nullptr) {
 		return;
 	}
@@ -125,21 +67,11 @@ void SwiftRngApi::initialize() {
 		return;
 	}
 
-	m_buff_rnd_in = new (nothrow) char [c_rnd_in_buff_size + 1];
+	m_buff_rnd_in = alloc_block_buffer();
 	if (m_buff_rnd_in == nullptr) {
 		return;
 	}
 
-	m_src_to_hash_32 = new (nothrow) uint32_t [c_min_input_num_words + 1];
-	if (m_src_to_hash_32 == nullptr) {
-		return;
-	}
-
-	m_src_to_hash_64 = new (nothrow) uint64_t[c_min_input_num_words];
-	if (m_src_to_hash_64 == nullptr) {
-		return;
-	}
-
 	m_last_error_log_char = new (nothrow) char [c_max_last_error_log_size];
 	if (m_last_error_log_char == nullptr) {
 		return;
@@ -152,6 +84,7 @@ void SwiftRngApi::initialize() {
 
 void SwiftRngApi::close_USB_lib() {
 
+	pipeline_free_transfers();
 	if (m_libusb_devh) {
 		libusb_release_interface(m_libusb_devh, 0); //release the claimed interface
 		libusb_close(m_libusb_devh);
@@ -204,6 +137,7 @@ int SwiftRngApi::open(int device_number) {
 		return -1;
 	}
 
+	pipeline_cancel();
 	if (m_usb_serial_device != nullptr) {
 		m_usb_serial_device->disconnect();
 	}
@@ -231,17 +165,14 @@ int SwiftRngApi::open(int device_number) {
 	apt_initialize();
 
 	sha256_initializeSerialNumber((uint32_t)m_device_stats.beginTime);
-	if (sha256_selfTest() != SWRNG_SUCCESS) {
+	switch (m_conditioner.failed_selfTest_method_id()) {
+	case EntropyConditioner::c_sha256_method_id:
 		print_err_msg("SHA256 post processing logic failed the self-test");
 		return -EPERM;
-	}
-
-	if (sha512_selfTest() != SWRNG_SUCCESS) {
+	case EntropyConditioner::c_sha512_method_id:
 		print_err_msg("SHA512 post processing logic failed the self-test");
 		return -EPERM;
-	}
-
-	if (xorshift64_selfTest() != SWRNG_SUCCESS) {
+	case EntropyConditioner::c_xorshift64_method_id:
 		print_err_msg("Xorshift64 post processing logic failed the self-test");
 		return -EPERM;
 	}
@@ -314,7 +245,7 @@ int SwiftRngApi::open(int device_number) {
 		}
 		uint16_t idVendorCur = desc.idVendor;
 		uint16_t idProductCur = desc.idProduct;
-		if (idVendorCur == c_usb_vendor_id && idProductCur == c_usb_product_id) {
+		if (idVendorCur == c_libusb_swiftrng_usb_id.vendor_id && idProductCur == c_libusb_swiftrng_usb_id.product_id) {
 			if (++curFoundDevNum == actualDeviceNum) {
 				ret = libusb_open(m_libusb_dev, &m_libusb_devh);
 				switch (ret) {
@@ -371,6 +302,7 @@ int SwiftRngApi::close() {
 		return -1;
 	}
 
+	pipeline_cancel();
 	if (m_usb_serial_device != nullptr) {
 		m_usb_serial_device->disconnect();
 		delete m_usb_serial_device;
@@ -382,6 +314,7 @@ int SwiftRngApi::close() {
 }
 
 void SwiftRngApi::ctxt_reset() {
+	pipeline_cancel();
 	if (m_usb_serial_device != nullptr) {
 		m_usb_serial_device->disconnect();
 	}
@@ -428,64 +361,42 @@ int SwiftRngApi::get_entropy_bytes() {
  */
 int SwiftRngApi::rcv_rnd_bytes() {
 	int retval;
-	uint32_t *dst32, *src32;
-	uint64_t *dst64, *src64;
+	uint64_t begin_nanos;
 
 	if (!m_device_open) {
 		return -EPERM;
 	}
 
-	m_bulk_out_buffer[0] = 'x';
-
-	retval = snd_rcv_usb_data((char *)m_bulk_out_buffer, 1, m_buff_rnd_in,
-			c_rnd_in_buff_size, c_usb_read_timeout_secs);
+	begin_nanos = LiveStatistics::now_nanos();
+	retval = rcv_rnd_block();
 	if (retval == SWRNG_SUCCESS) {
+		m_live_stats.record_usb_latency(begin_nanos);
 		if (m_stat_tests_enabled == true) {
 			rct_restart();
 			apt_restart();
-			test_samples();
+			test_samples(m_buff_rnd_in);
 		}
 		if (m_post_processing_enabled == true) {
-			if (m_post_processing_method_id == c_sha256_pp_method_id) {
-				dst32 = (uint32_t *)m_buff_rnd_out;
-				src32 = (uint32_t *)m_buff_rnd_in;
-				for (int i = 0; i < c_rnd_in_buff_size / c_word_size_bytes; i
-						+= c_min_input_num_words) {
-					for (int j = 0; j < c_min_input_num_words; j++) {
-						m_src_to_hash_32[j] = src32[i + j];
-					}
-					sha256_stampSerialNumber(m_src_to_hash_32);
-					sha256_generateHash(m_src_to_hash_32, (int16_t)(c_min_input_num_words + 1), dst32);
-					dst32 += c_out_num_words;
-				}
-			} else if (m_post_processing_method_id == c_sha512_pp_method_id) {
-				dst64 = (uint64_t *)m_buff_rnd_out;
-				src64 = (uint64_t *)m_buff_rnd_in;
-				for (int i = 0; i < c_rnd_in_buff_size / (c_word_size_bytes * 2); i
-						+= c_min_input_num_words) {
-					for (int j = 0; j < c_min_input_num_words; j++) {
-						m_src_to_hash_64[j] = src64[i + j];
-					}
-					sha512_generateHash(m_src_to_hash_64, (int16_t)c_min_input_num_words, dst64);
-					dst64 += c_out_num_words;
-				}
+			begin_nanos = LiveStatistics::now_nanos();
+			if (m_post_processing_method_id == c_sha256_pp_method_id
+					|| m_post_processing_method_id == c_sha512_pp_method_id) {
+				hash_block_chunks(m_buff_rnd_in, m_buff_rnd_out);
 			} else if (m_post_processing_method_id == c_xorshift64_pp_method_id) {
-				memcpy(m_buff_rnd_out, m_buff_rnd_in, c_rnd_out_buff_size);
-				xorshift64_postProcess((uint8_t *)m_buff_rnd_out, c_rnd_out_buff_size);
+				m_conditioner.xorshift64_postProcess((uint8_t *)m_buff_rnd_in, c_rnd_out_buff_size);
+				std::swap(m_buff_rnd_out, m_buff_rnd_in);
 			} else {
 				print_err_msg(c_pp_op_not_supported_msg);
 				return -1;
 			}
+			m_live_stats.record_conditioning_latency(begin_nanos);
 		} else {
-			memcpy(m_buff_rnd_out, m_buff_rnd_in, c_rnd_out_buff_size);
+			// Raw bytes are served from the received block as is
+			std::swap(m_buff_rnd_out, m_buff_rnd_in);
 		}
 		m_cur_rng_out_idx = 0;
-		if (m_rct.statusByte != SWRNG_SUCCESS) {
-			print_err_msg("Repetition Count Test failure");
-			retval = -EPERM;
-		} else if (m_apt.statusByte != SWRNG_SUCCESS) {
-			print_err_msg("Adaptive Proportion Test failure");
-			retval = -EPERM;
+		retval = get_stat_tests_status();
+		if (retval == SWRNG_SUCCESS) {
+			m_live_stats.add_block(c_rnd_out_buff_size);
 		}
 	}
 
@@ -493,95 +404,717 @@ int SwiftRngApi::rcv_rnd_bytes() {
 }
 
 /**
- * A function for testing a block of random bytes using 'repetition count'
- * and 'adaptive proportion' tests
+ * Hash the chunks of a received data block with the current post processing method,
+ * sharing the work with the post processing threads when enabled
  *
+ * @param const char *src - received data block
+ * @param char *dst - destination for the hashed data block, must not overlap `src`
  */
-void SwiftRngApi::test_samples() {
-	uint8_t value;
-	for (int i = 0; i < c_rnd_out_buff_size; i++) {
-		value = m_buff_rnd_in[i];
-
-		//
-		// Run 'repetition count' test
-		//
-		if (!m_rct.isInitialized) {
-			m_rct.isInitialized = true;
-			m_rct.lastSample = value;
-		} else {
-			if (m_rct.lastSample == value) {
-				m_rct.curRepetitions++;
-				if (m_rct.curRepetitions >= m_rct.maxRepetitions) {
-					m_rct.curRepetitions = 1;
-					if (++m_rct.failureCount > m_num_failures_threshold) {
-						if (m_rct.statusByte == 0) {
-							m_rct.statusByte = m_rct.signature;
-						}
-					}
+void SwiftRngApi::hash_block_chunks(const char *src, char *dst) {
+	if (m_num_pp_workers == 0) {
+		m_conditioner.condition_block(m_conditioner_ctxt, (const unsigned char *)src,
+				(unsigned char *)dst, m_post_processing_method_id);
+		return;
+	}
 
-					if (m_rct.failureCount > m_max_rct_failures_per_block) {
-						// Record the maximum failures per block for reporting
-						m_max_rct_failures_per_block = m_rct.failureCount;
-					}
+	{
+		std::lock_guard<std::mutex> lock(m_pp_mutex);
+		m_pp_src = src;
+		m_pp_dst = dst;
+		m_pp_pending = m_num_pp_workers;
+		m_pp_generation++;
+	}
+	m_pp_work_cv.notify_all();
 
-					#ifdef inDebugMode
-					if (m_rct.failureCount >= 1) {
-						fprintf(stderr, "rct.failureCount: %d value: %d\n", m_rct.failureCount, value);
-					}
-					#endif
-				}
+	// The caller thread hashes the first share
+	hash_chunk_share(m_conditioner_ctxt, 0, m_num_pp_workers + 1);
+
+	std::unique_lock<std::mutex> lock(m_pp_mutex);
+	m_pp_done_cv.wait(lock, [this] { return m_pp_pending == 0; });
+
+	if (m_post_processing_method_id == c_sha256_pp_method_id) {
+		m_conditioner_ctxt.blockSerialNumber += (uint32_t)EntropyConditioner::c_sha256_num_chunks;
+	}
+}
+
+/**
+ * Hash one share of the chunks of the data block handed off by `hash_block_chunks`. Shares are sized in multiples of
+ * `c_max_hash_lanes` so that the multi-buffer implementations hash full sets of lanes.
+ *
+ * @param ConditionerContext& ctxt - hashing state to use
+ * @param int share_idx - which share to hash, from 0 to `num_shares` - 1
+ * @param int num_shares - number of shares the chunks are split into
+ */
+void SwiftRngApi::hash_chunk_share(ConditionerContext &ctxt, int share_idx, int num_shares) {
+	const int lanes = EntropyConditioner::c_max_hash_lanes;
+	const int chunk_words = EntropyConditioner::c_chunk_num_words;
+	int num_chunks = EntropyConditioner::c_sha256_num_chunks;
+	if (m_post_processing_method_id == c_sha512_pp_method_id) {
+		num_chunks = EntropyConditioner::c_sha512_num_chunks;
+	}
+
+	int share_size = (num_chunks + num_shares - 1) / num_shares;
+	share_size = (share_size + lanes - 1) / lanes * lanes;
+	int begin_chunk = std::min(share_idx * share_size, num_chunks);
+	int end_chunk = std::min(begin_chunk + share_size, num_chunks);
+
+	if (m_post_processing_method_id == c_sha256_pp_method_id) {
+		m_conditioner.sha256_hashChunks(ctxt.sha256, (const uint32_t *)m_pp_src + begin_chunk * chunk_words,
+				m_conditioner_ctxt.blockSerialNumber + (uint32_t)begin_chunk,
+				(uint32_t *)m_pp_dst + begin_chunk * chunk_words, end_chunk - begin_chunk);
+	} else {
+		m_conditioner.sha512_hashChunks(ctxt.sha512, (const uint64_t *)m_pp_src + begin_chunk * chunk_words,
+				(uint64_t *)m_pp_dst + begin_chunk * chunk_words, end_chunk - begin_chunk);
+	}
+}
+
+/**
+ * Main loop of a post processing thread, hashing its share of each data block handed off by the caller thread
+ *
+ * @param int worker_idx - index of the thread in `m_pp_workers`
+ */
+void SwiftRngApi::pp_worker_run(int worker_idx) {
+	PostProcessingWorker &worker = m_pp_workers[worker_idx];
+	// The generation starts over each time the threads are started, see pp_workers_stop()
+	uint64_t generation = 0;
+
+	std::unique_lock<std::mutex> lock(m_pp_mutex);
+	while (true) {
+		m_pp_work_cv.wait(lock, [this, &generation] { return m_pp_stop || m_pp_generation != generation; });
+		if (m_pp_stop) {
+			return;
+		}
+		generation = m_pp_generation;
+		int num_shares = m_num_pp_workers + 1;
+		lock.unlock();
+
+		hash_chunk_share(worker.ctxt, worker_idx + 1, num_shares);
+
+		lock.lock();
+		if (--m_pp_pending == 0) {
+			m_pp_done_cv.notify_one();
+		}
+	}
+}
+
+/**
+ * Terminate the post processing threads, if any, and release them
+ *
+ */
+void SwiftRngApi::pp_workers_stop() {
+	if (m_pp_workers == nullptr) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_pp_mutex);
+		m_pp_stop = true;
+	}
+	m_pp_work_cv.notify_all();
+
+	for (int i = 0; i < m_num_pp_workers; i++) {
+		if (m_pp_workers[i].thread.joinable()) {
+			m_pp_workers[i].thread.join();
+		}
+	}
+	delete [] m_pp_workers;
+	m_pp_workers = nullptr;
+
+	std::lock_guard<std::mutex> lock(m_pp_mutex);
+	m_num_pp_workers = 0;
+	m_pp_generation = 0;
+	m_pp_pending = 0;
+	m_pp_stop = false;
+}
+
+/**
+ * A function to receive consecutive random data blocks directly into the caller buffer.
+ * The 'x' requests for all the blocks are sent ahead, so the device keeps generating while
+ * each received block is tested and post processed in place.
+ *
+ * @param unsigned char *dst - destination with room for `num_blocks` * `c_rnd_in_buff_size` + 1 bytes,
+ * the status byte of each block lands where the next bytes go
+ * @param int num_blocks - number of blocks to receive, between 1 and `m_bulk_request_blocks`
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int SwiftRngApi::rcv_bulk_blocks(unsigned char *dst, int num_blocks) {
+	int retval = SWRNG_SUCCESS;
+	int num_requested = 0;
+	int actual_cnt;
+	uint64_t begin_nanos;
+
+	if (!m_device_open) {
+		return -EPERM;
+	}
 
+	m_bulk_out_buffer[0] = 'x';
+	if (num_blocks > 1) {
+		pipeline_cancel();
+		for (; num_requested < num_blocks; num_requested++) {
+			if (m_usb_serial_device->is_connected()) {
+				retval = m_usb_serial_device->send_command(m_bulk_out_buffer, 1, &actual_cnt);
 			} else {
-				m_rct.lastSample = value;
-				m_rct.curRepetitions = 1;
+				retval = libusb_bulk_transfer(m_libusb_devh, c_bulk_ep_out, m_bulk_out_buffer, 1, &actual_cnt, 100);
+			}
+			if (retval != SWRNG_SUCCESS || actual_cnt != 1) {
+				break;
 			}
 		}
+	}
 
-		//
-		// Run 'adaptive proportion' test
-		//
-		if (!m_apt.isInitialized) {
-			m_apt.isInitialized = true;
-			m_apt.firstSample = value;
-			m_apt.curRepetitions = 0;
-			m_apt.curSamples = 0;
+	for (int i = 0; i < num_blocks; i++) {
+		char *block = (char *)dst + (long)i * c_rnd_in_buff_size;
+
+		retval = -EFAULT;
+		begin_nanos = LiveStatistics::now_nanos();
+		if (i < num_requested) {
+			retval = chip_read_data(block, c_rnd_in_buff_size + 1, c_usb_read_timeout_secs);
+			if (retval == SWRNG_SUCCESS && block[c_rnd_in_buff_size] != 0) {
+				retval = -EFAULT;
+			}
+		}
+		if (retval == SWRNG_SUCCESS) {
+			m_device_stats.numGenBytes += c_rnd_in_buff_size;
 		} else {
-			if (++m_apt.curSamples >= m_apt.windowSize) {
-				m_apt.isInitialized = false;
-				if (m_apt.curRepetitions > m_apt.cutoffValue) {
-					// Check to see if we have reached the failure threshold
-					if (++m_apt.cycleFailures > m_num_failures_threshold) {
-						if (m_apt.statusByte == 0) {
-							m_apt.statusByte = m_apt.signature;
-						}
-					}
-					if (m_apt.cycleFailures > m_max_apt_failures_per_block) {
-						// Record the maximum failures per block for reporting
-						m_max_apt_failures_per_block = m_apt.cycleFailures;
+			if (i < num_requested) {
+				// Drop the rest of the requests in flight, the remaining blocks are requested one at a time
+				m_device_stats.totalRetries++;
+				m_live_stats.add_retry();
+				clr_rcv_buff(num_requested - i);
+				num_requested = 0;
+			}
+			retval = snd_rcv_usb_data((char *)m_bulk_out_buffer, 1, block, c_rnd_in_buff_size, c_usb_read_timeout_secs);
+			if (retval != SWRNG_SUCCESS) {
+				return retval;
+			}
+		}
+		m_live_stats.record_usb_latency(begin_nanos);
+
+		if (m_stat_tests_enabled == true) {
+			rct_restart();
+			apt_restart();
+			test_samples(block);
+		}
+		retval = get_stat_tests_status();
+		if (retval != SWRNG_SUCCESS) {
+			if (i + 1 < num_requested) {
+				clr_rcv_buff(num_requested - i - 1);
+			}
+			return retval;
+		}
+
+		if (m_post_processing_enabled == true) {
+			begin_nanos = LiveStatistics::now_nanos();
+			if (m_post_processing_method_id == c_sha256_pp_method_id
+					|| m_post_processing_method_id == c_sha512_pp_method_id) {
+				memcpy(m_buff_rnd_in, block, c_rnd_in_buff_size);
+				hash_block_chunks(m_buff_rnd_in, block);
+			} else if (m_post_processing_method_id == c_xorshift64_pp_method_id) {
+				m_conditioner.xorshift64_postProcess((uint8_t *)block, c_rnd_out_buff_size);
+			} else {
+				if (i + 1 < num_requested) {
+					clr_rcv_buff(num_requested - i - 1);
+				}
+				print_err_msg(c_pp_op_not_supported_msg);
+				return -1;
+			}
+			m_live_stats.record_conditioning_latency(begin_nanos);
+		}
+		m_live_stats.add_block(c_rnd_out_buff_size);
+	}
+
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Check the outcome of the statistical tests
+ *
+ * @return 0 - when no statistical test failed, otherwise the error code (a negative number)
+ *
+ */
+int SwiftRngApi::get_stat_tests_status() {
+	if (m_rct.statusByte != SWRNG_SUCCESS) {
+		print_err_msg("Repetition Count Test failure");
+		return -EPERM;
+	}
+	if (m_apt.statusByte != SWRNG_SUCCESS) {
+		print_err_msg("Adaptive Proportion Test failure");
+		return -EPERM;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Receive the next random data block into `m_buff_rnd_in`. When the download pipeline is enabled,
+ * the block is taken from the requests already in flight and a new request is issued right away,
+ * so the device keeps generating while the block is tested and post processed.
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int SwiftRngApi::rcv_rnd_block() {
+	int retval;
+
+	if (m_pipeline_depth > 1) {
+		retval = SWRNG_SUCCESS;
+		if (!m_pipeline_active) {
+			retval = pipeline_start();
+		}
+		if (retval == SWRNG_SUCCESS) {
+			retval = pipeline_rcv_block();
+			if (retval == SWRNG_SUCCESS) {
+				return retval;
+			}
+		}
+#ifdef inDebugMode
+		fprintf(stderr, "Download pipeline error %d, falling back to a single request.\n", retval);
+#endif
+		// Discard the requests in flight and retry with a regular request, the pipeline restarts on the next block
+		m_device_stats.totalRetries++;
+		m_live_stats.add_retry();
+		pipeline_cancel();
+	}
+
+	m_bulk_out_buffer[0] = 'x';
+	return snd_rcv_usb_data((char *)m_bulk_out_buffer, 1, m_buff_rnd_in,
+			c_rnd_in_buff_size, c_usb_read_timeout_secs);
+}
+
+/**
+ * Send `m_pipeline_depth` random data block requests ahead to the device
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int SwiftRngApi::pipeline_start() {
+	int retval;
+	int actual_cnt;
+
+	m_pipeline_active = true;
+	m_pipeline_head = 0;
+	m_pipeline_outstanding = 0;
+	std::memset(m_bulk_out_buffer, 'x', m_pipeline_depth);
+
+	if (m_usb_serial_device->is_connected()) {
+		retval = m_usb_serial_device->send_command(m_bulk_out_buffer, m_pipeline_depth, &actual_cnt);
+		if (retval == SWRNG_SUCCESS && actual_cnt != m_pipeline_depth) {
+			retval = -EFAULT;
+		}
+		if (retval == SWRNG_SUCCESS) {
+			m_pipeline_outstanding = m_pipeline_depth;
+		}
+		return retval;
+	}
+
+	for (int i = 0; i < m_pipeline_depth; i++) {
+		retval = pipeline_submit_slot(i);
+		if (retval != SWRNG_SUCCESS) {
+			return retval;
+		}
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Submit the 'x' command and the data block read for a pipeline slot
+ *
+ * @param int slot_idx - pipeline slot index
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int SwiftRngApi::pipeline_submit_slot(int slot_idx) {
+	PipelineSlot &slot = m_pipeline_slots[slot_idx];
+	// A request waits behind all the blocks requested ahead of it
+	unsigned int timeout_mlsecs = (unsigned int)(c_usb_read_timeout_secs * 1000 * m_pipeline_depth);
+	int retval;
+
+	if (slot.out_transfer == nullptr) {
+		slot.out_transfer = libusb_alloc_transfer(0);
+	}
+	if (slot.in_transfer == nullptr) {
+		slot.in_transfer = libusb_alloc_transfer(0);
+	}
+	if (slot.out_transfer == nullptr || slot.in_transfer == nullptr) {
+		return LIBUSB_ERROR_NO_MEM;
+	}
+
+	libusb_fill_bulk_transfer(slot.out_transfer, m_libusb_devh, c_bulk_ep_out, m_bulk_out_buffer, 1,
+			pipeline_transfer_cb, &slot, timeout_mlsecs);
+	libusb_fill_bulk_transfer(slot.in_transfer, m_libusb_devh, c_bulk_ep_in, (unsigned char *)slot.in_buffer,
+			c_rnd_in_buff_size + 1, pipeline_transfer_cb, &slot, timeout_mlsecs);
+
+	retval = libusb_submit_transfer(slot.out_transfer);
+	if (retval != SWRNG_SUCCESS) {
+		return retval;
+	}
+	slot.in_flight_transfers++;
+
+	retval = libusb_submit_transfer(slot.in_transfer);
+	if (retval != SWRNG_SUCCESS) {
+		return retval;
+	}
+	slot.in_flight_transfers++;
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Completion callback for the pipeline libusb transfers
+ *
+ * @param struct libusb_transfer *transfer - completed transfer
+ */
+void LIBUSB_CALL SwiftRngApi::pipeline_transfer_cb(struct libusb_transfer *transfer) {
+	PipelineSlot *slot = (PipelineSlot *)transfer->user_data;
+	slot->in_flight_transfers--;
+}
+
+/**
+ * Receive the next data block of the pipeline into `m_buff_rnd_in` and request another one
+ *
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int SwiftRngApi::pipeline_rcv_block() {
+	int retval;
+	int actual_cnt;
+	time_t start;
+
+	if (m_usb_serial_device->is_connected()) {
+		retval = chip_read_data(m_buff_rnd_in, c_rnd_in_buff_size + 1, c_usb_read_timeout_secs);
+		m_pipeline_outstanding--;
+		if (retval != SWRNG_SUCCESS) {
+			return retval;
+		}
+		if (m_buff_rnd_in[c_rnd_in_buff_size] != 0) {
+			return -EFAULT;
+		}
+
+		// Top up the requests in flight before the block gets processed
+		m_bulk_out_buffer[0] = 'x';
+		retval = m_usb_serial_device->send_command(m_bulk_out_buffer, 1, &actual_cnt);
+		if (retval != SWRNG_SUCCESS) {
+			return retval;
+		}
+		if (actual_cnt != 1) {
+			return -EFAULT;
+		}
+		m_pipeline_outstanding++;
+		m_device_stats.numGenBytes += c_rnd_in_buff_size;
+		return SWRNG_SUCCESS;
+	}
+
+	PipelineSlot &slot = m_pipeline_slots[m_pipeline_head];
+	start = time(nullptr);
+	while (slot.in_flight_transfers > 0) {
+		struct timeval tv = {0, c_usb_bulk_read_timeout_mlsecs * 1000};
+		retval = libusb_handle_events_timeout_completed(m_libusb_luctx, &tv, nullptr);
+		if (retval != SWRNG_SUCCESS && retval != LIBUSB_ERROR_INTERRUPTED) {
+			return retval;
+		}
+		if (slot.in_flight_transfers > 0 && time(nullptr) - start > c_usb_read_timeout_secs * m_pipeline_depth) {
+			m_live_stats.add_timeout();
+			return -ETIMEDOUT;
+		}
+	}
+
+	if (slot.out_transfer->status != LIBUSB_TRANSFER_COMPLETED
+			|| slot.in_transfer->status != LIBUSB_TRANSFER_COMPLETED
+			|| slot.in_transfer->actual_length > c_rnd_in_buff_size + 1) {
+		return -EFAULT;
+	}
+
+	if (slot.in_transfer->actual_length < c_rnd_in_buff_size + 1) {
+		// A short packet ended the transfer and the rest of the block went to the transfers queued behind it,
+		// not an error: drain the pipeline and request the block again, the regular request tops up short reads
+		pipeline_cancel();
+		m_bulk_out_buffer[0] = 'x';
+		return snd_rcv_usb_data((char *)m_bulk_out_buffer, 1, m_buff_rnd_in, c_rnd_in_buff_size, c_usb_read_timeout_secs);
+	}
+
+	if (slot.in_buffer[c_rnd_in_buff_size] != 0) {
+		return -EFAULT;
+	}
+
+	// Take over the received block without copying and hand the previous buffer to the slot
+	std::swap(m_buff_rnd_in, slot.in_buffer);
+	m_device_stats.numGenBytes += c_rnd_in_buff_size;
+
+	retval = pipeline_submit_slot(m_pipeline_head);
+	m_pipeline_head = (m_pipeline_head + 1) % m_pipeline_depth;
+	if (retval != SWRNG_SUCCESS) {
+		// The block is good, the pipeline will be restarted with the next block
+		pipeline_cancel();
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Cancel the random data block requests in flight and discard the data already generated for them
+ */
+void SwiftRngApi::pipeline_cancel() {
+
+	if (!m_pipeline_active) {
+		return;
+	}
+	m_pipeline_active = false;
+
+	if (m_usb_serial_device == nullptr || !m_usb_serial_device->is_connected()) {
+		pipeline_drain_transfers();
+		if (m_libusb_devh == nullptr) {
+			return;
+		}
+	}
+	m_pipeline_outstanding = 0;
+
+	// Each read returns at most one data block, account for a block that was partially received
+	clr_rcv_buff(m_pipeline_depth + 2);
+}
+
+/**
+ * Cancel the libusb transfers in flight and wait for all of them to complete, so libusb no longer owns
+ * any transfer or slot buffer. Every transfer completes once cancelled and at the latest when its timeout expires.
+ */
+void SwiftRngApi::pipeline_drain_transfers() {
+	for (int i = 0; i < c_max_pipeline_depth; i++) {
+		if (m_pipeline_slots[i].in_flight_transfers > 0) {
+			libusb_cancel_transfer(m_pipeline_slots[i].out_transfer);
+			libusb_cancel_transfer(m_pipeline_slots[i].in_transfer);
+		}
+	}
+	for (int i = 0; i < c_max_pipeline_depth; i++) {
+		while (m_pipeline_slots[i].in_flight_transfers > 0) {
+			struct timeval tv = {0, c_usb_bulk_read_timeout_mlsecs * 1000};
+			libusb_handle_events_timeout_completed(m_libusb_luctx, &tv, nullptr);
+		}
+	}
+}
+
+/**
+ * Release the libusb transfers allocated for the download pipeline
+ */
+void SwiftRngApi::pipeline_free_transfers() {
+	pipeline_drain_transfers();
+	for (int i = 0; i < c_max_pipeline_depth; i++) {
+		PipelineSlot &slot = m_pipeline_slots[i];
+		if (slot.out_transfer != nullptr) {
+			libusb_free_transfer(slot.out_transfer);
+			slot.out_transfer = nullptr;
+		}
+		if (slot.in_transfer != nullptr) {
+			libusb_free_transfer(slot.in_transfer);
+			slot.in_transfer = nullptr;
+		}
+	}
+}
+
+/**
+ * A function for testing a block of random bytes using 'repetition count'
+ * and 'adaptive proportion' tests
+ *
+ * @param const char *block - a pointer to the block of raw random bytes
+ */
+void SwiftRngApi::test_samples(const char *block) {
+	const uint8_t *samples = (const uint8_t *)block;
+	uint64_t begin_nanos = LiveStatistics::now_nanos();
+
+	if (m_repeat_mask_kernel != nullptr && m_sample_match_kernel != nullptr) {
+		rct_test_block(samples, c_rnd_out_buff_size);
+		apt_test_block(samples, c_rnd_out_buff_size);
+	} else {
+		for (int i = 0; i < c_rnd_out_buff_size; i++) {
+			rct_test_sample(samples[i]);
+			apt_test_sample(samples[i]);
+		}
+	}
+
+	// The failure counts start over with each block
+	m_live_stats.record_health_test_latency(begin_nanos);
+	m_live_stats.add_rct_failures(m_rct.failureCount);
+	m_live_stats.add_apt_failures(m_apt.cycleFailures);
+}
+
+/**
+ * Run 'repetition count' test for one sample
+ *
+ * @param uint8_t value - the sample
+ */
+void SwiftRngApi::rct_test_sample(uint8_t value) {
+	if (!m_rct.isInitialized) {
+		m_rct.isInitialized = true;
+		m_rct.lastSample = value;
+	} else {
+		if (m_rct.lastSample == value) {
+			m_rct.curRepetitions++;
+			if (m_rct.curRepetitions >= m_rct.maxRepetitions) {
+				m_rct.curRepetitions = 1;
+				if (++m_rct.failureCount > m_num_failures_threshold) {
+					if (m_rct.statusByte == 0) {
+						m_rct.statusByte = m_rct.signature;
 					}
+				}
 
-					#ifdef inDebugMode
-					if (m_apt.cycleFailures >= 1) {
-						fprintf(stderr, "ctxt->apt.cycleFailures: %d value: %d\n", m_apt.cycleFailures, value);
-                    }
-					#endif
+				if (m_rct.failureCount > m_max_rct_failures_per_block) {
+					// Record the maximum failures per block for reporting
+					m_max_rct_failures_per_block = m_rct.failureCount;
 				}
 
-			} else {
-				if (m_apt.firstSample == value) {
-					++m_apt.curRepetitions;
+				#ifdef inDebugMode
+				if (m_rct.failureCount >= 1) {
+					fprintf(stderr, "rct.failureCount: %d value: %d\n", m_rct.failureCount, value);
 				}
+				#endif
+			}
+
+		} else {
+			m_rct.lastSample = value;
+			m_rct.curRepetitions = 1;
+		}
+	}
+}
+
+/**
+ * Run 'adaptive proportion' test for one sample
+ *
+ * @param uint8_t value - the sample
+ */
+void SwiftRngApi::apt_test_sample(uint8_t value) {
+	if (!m_apt.isInitialized) {
+		m_apt.isInitialized = true;
+		m_apt.firstSample = value;
+		m_apt.curRepetitions = 0;
+		m_apt.curSamples = 0;
+	} else {
+		if (++m_apt.curSamples >= m_apt.windowSize) {
+			apt_complete_window(value);
+		} else {
+			if (m_apt.firstSample == value) {
+				++m_apt.curRepetitions;
+			}
+		}
+	}
+}
+
+/**
+ * Evaluate the repetitions counted in the current 'adaptive proportion' test window
+ *
+ * @param uint8_t value - the sample that completed the window
+ */
+void SwiftRngApi::apt_complete_window(uint8_t value) {
+	m_apt.isInitialized = false;
+	if (m_apt.curRepetitions > m_apt.cutoffValue) {
+		// Check to see if we have reached the failure threshold
+		if (++m_apt.cycleFailures > m_num_failures_threshold) {
+			if (m_apt.statusByte == 0) {
+				m_apt.statusByte = m_apt.signature;
+			}
+		}
+		if (m_apt.cycleFailures > m_max_apt_failures_per_block) {
+			// Record the maximum failures per block for reporting
+			m_max_apt_failures_per_block = m_apt.cycleFailures;
+		}
+
+		#ifdef inDebugMode
+		if (m_apt.cycleFailures >= 1) {
+			fprintf(stderr, "ctxt->apt.cycleFailures: %d value: %d\n", m_apt.cycleFailures, value);
+		}
+		#else
+		(void)value;
+		#endif
+	}
+}
+
+/**
+ * Run 'repetition count' test for a block of samples, 64 samples at a time.
+ * Groups of samples that may contain a failure are tested one sample at a time,
+ * so the results are the same as testing every sample with rct_test_sample().
+ *
+ * @param const uint8_t *samples - a pointer to the samples
+ * @param int num_samples - number of samples
+ */
+void SwiftRngApi::rct_test_block(const uint8_t *samples, int num_samples) {
+	uint64_t masks[c_rnd_out_buff_size / 64];
+	int i = 0;
+
+	if (num_samples <= 1 || num_samples > c_rnd_out_buff_size) {
+		for (; i < num_samples; i++) {
+			rct_test_sample(samples[i]);
+		}
+		return;
+	}
+
+	// The first sample starts the test or continues it from the previous block
+	rct_test_sample(samples[i++]);
+
+	int num_compared = m_repeat_mask_kernel(samples + 1, num_samples - 1, masks);
+
+	// A failure needs a run of (maxRepetitions - 1) samples equal to the ones before them
+	int run_to_fail = m_rct.maxRepetitions > 1 ? (int)m_rct.maxRepetitions - 1 : 1;
+	for (int k = 0; k < num_compared / 64; k++, i += 64) {
+		uint64_t repeats = masks[k];
+		uint64_t runs = repeats;
+		for (int n = 1; n < run_to_fail && n < 64; n++) {
+			runs &= repeats >> n;
+		}
+		// Repeats continuing the run of the previous samples
+		int leading_repeats = ~repeats == 0 ? 64 : __builtin_ctzll(~repeats);
+		if (runs != 0 || (int)m_rct.curRepetitions - 1 + leading_repeats >= run_to_fail) {
+			for (int j = 0; j < 64; j++) {
+				rct_test_sample(samples[i + j]);
 			}
+			continue;
+		}
+		// No failure in these samples, only the run at the end of them carries over
+		m_rct.lastSample = samples[i + 63];
+		if (~repeats == 0) {
+			m_rct.curRepetitions += 64;
+		} else if (repeats >> 63) {
+			m_rct.curRepetitions = 1 + __builtin_clzll(~repeats);
+		} else {
+			m_rct.curRepetitions = 1;
 		}
+	}
+
+	for (; i < num_samples; i++) {
+		rct_test_sample(samples[i]);
+	}
+}
+
+/**
+ * Run 'adaptive proportion' test for a block of samples, one window at a time
+ * when the window fits in the 64 samples compared at once.
+ *
+ * @param const uint8_t *samples - a pointer to the samples
+ * @param int num_samples - number of samples
+ */
+void SwiftRngApi::apt_test_block(const uint8_t *samples, int num_samples) {
+	int i = 0;
 
+	// Finish the window started by the previous block
+	for (; i < num_samples && m_apt.isInitialized; i++) {
+		apt_test_sample(samples[i]);
+	}
 
+	// The first sample of a window, (windowSize - 1) compared samples and the sample completing the window
+	int num_compared = (int)m_apt.windowSize - 1;
+	int window_span = (int)m_apt.windowSize + 1;
+	if (num_compared >= 0 && num_compared <= 64) {
+		for (; i + window_span <= num_samples && i + 65 <= num_samples; i += window_span) {
+			m_apt.firstSample = samples[i];
+			m_apt.curRepetitions = (uint16_t)m_sample_match_kernel(samples + i + 1, num_compared, samples[i]);
+			m_apt.curSamples = m_apt.windowSize;
+			apt_complete_window(samples[i + window_span - 1]);
+		}
 	}
 
+	for (; i < num_samples; i++) {
+		apt_test_sample(samples[i]);
+	}
 }
 
 /**
 * This function is an enhanced version of 'get_entropy'.
-* Use it to retrieve more than 100000 random bytes in one call
+* Use it to retrieve more than 100000 random bytes in one call, the whole blocks are
+* received straight into the buffer with as many blocks per device request as set with 'set_bulk_request_blocks'
 *
 * @param unsigned char *buffer - a pointer to the data receive buffer
 * @param long length - how many bytes expected to receive
@@ -589,30 +1122,18 @@ void SwiftRngApi::test_samples() {
 *
 */
 int SwiftRngApi::get_entropy_ex(unsigned char *buffer, long length) {
-	int retval = SWRNG_SUCCESS;
-	unsigned char *dst;
-	long total_byte_blocks;
-	long leftover_bytes;
+
+	if (is_context_initialized() == false) {
+		return -1;
+	}
 
 	if (length <= 0) {
 		return -EPERM;
-	} else {
-		total_byte_blocks = length / c_max_request_size_bytes;
-		leftover_bytes = length % c_max_request_size_bytes;
-		dst = buffer;
-		for (long l = 0; l < total_byte_blocks; l++) {
-			retval = get_entropy(dst, c_max_request_size_bytes);
-			if (retval != SWRNG_SUCCESS) {
-				return retval;
-			}
-			dst += c_max_request_size_bytes;
-		}
-		if (leftover_bytes > 0) {
-			retval = get_entropy(dst, leftover_bytes);
-		}
 	}
-
-	return retval;
+	if (!m_device_open) {
+		return -ENODEV;
+	}
+	return rcv_entropy(buffer, length);
 }
 
 /**
@@ -777,7 +1298,7 @@ int SwiftRngApi::get_device_list(DeviceInfoList *dev_info_list) {
 		}
 		uint16_t idVendorCur = desc.idVendor;
 		uint16_t idProductCur = desc.idProduct;
-		if (idVendorCur == c_usb_vendor_id && idProductCur == c_usb_product_id) {
+		if (idVendorCur == c_libusb_swiftrng_usb_id.vendor_id && idProductCur == c_libusb_swiftrng_usb_id.product_id) {
 			update_dev_info_list(dev_info_list, &curFoundDevNum);
 		}
 	}
@@ -786,6 +1307,69 @@ int SwiftRngApi::get_device_list(DeviceInfoList *dev_info_list) {
 	return 0;
 }
 
+/**
+ * Count the SwiftRNG devices currently plugged into USB ports without opening them, unlike `get_device_list()`.
+ * The devices are numbered by `open()` in the same order, including the ones already in use.
+ *
+ * @param device_count - pointer to the number of devices found
+ * @return int - value 0 when counted successfully
+ *
+ */
+int SwiftRngApi::get_device_count(int *device_count) {
+
+	libusb_context *luctx;
+	libusb_device * *devs;
+	libusb_device * dev;
+
+	if (is_context_initialized() == false) {
+		return -1;
+	}
+
+	*device_count = 0;
+
+#if defined(_WIN32)
+	USBComPort usbComPort;
+	int portsConnected;
+	int ports[c_max_cdc_com_ports];
+	usbComPort.get_connected_ports(ports, c_max_cdc_com_ports, &portsConnected, (WCHAR*)c_hardware_id.c_str());
+#else
+	USBSerialDevice usbSerialDevice;
+	usbSerialDevice.scan_available_devices();
+	int portsConnected = usbSerialDevice.get_device_count();
+#endif
+
+	int r = libusb_init(&luctx);
+	if (r < 0) {
+		print_err_msg(c_libusb_init_failure_msg);
+		return r;
+	}
+	ssize_t cnt = libusb_get_device_list(luctx, &devs);
+	if (cnt < 0) {
+		libusb_exit(luctx);
+		return (int)cnt;
+	}
+	int usbDevices = 0;
+	int i = 0;
+	while ((dev = devs[i++]) != nullptr) {
+		struct libusb_device_descriptor desc;
+		r = libusb_get_device_descriptor(dev, &desc);
+		if (r < 0) {
+			libusb_free_device_list(devs, 1);
+			libusb_exit(luctx);
+			print_err_msg(c_cannot_read_device_descriptor_msg);
+			return r;
+		}
+		if (desc.idVendor == c_libusb_swiftrng_usb_id.vendor_id && desc.idProduct == c_libusb_swiftrng_usb_id.product_id) {
+			usbDevices++;
+		}
+	}
+	libusb_free_device_list(devs, 1);
+	libusb_exit(luctx);
+
+	*device_count = portsConnected + usbDevices;
+	return SWRNG_SUCCESS;
+}
+
 void SwiftRngApi::update_dev_info_list(DeviceInfoList* dev_info_list, int *curt_found_dev_num) const {
 	dev_info_list->devInfoList[*curt_found_dev_num].devNum = *curt_found_dev_num;
 	SwiftRngApi api;
@@ -1032,6 +1616,22 @@ DeviceStatistics* SwiftRngApi::generate_device_statistics() {
 	return &m_device_stats;
 }
 
+/**
+ * Retrieve the live statistics of the downloads since the device was open or the statistics were reset.
+ * Unlike the other methods, it may be called from another thread while the device is downloading,
+ * it does not lock or wait for the downloads in progress.
+ *
+ * @param DeviceLiveStatistics *stats - pointer to the structure receiving the statistics
+ * @return int - 0 when the statistics were retrieved
+ */
+int SwiftRngApi::get_live_statistics(DeviceLiveStatistics *stats) const {
+	if (is_context_initialized() == false) {
+		return -1;
+	}
+	m_live_stats.snapshot(stats);
+	return SWRNG_SUCCESS;
+}
+
 /**
 * Retrieve the last error message.
 * The caller should make a copy of the error message returned immediately after calling this function.
@@ -1062,29 +1662,183 @@ void SwiftRngApi::enable_printing_error_messages() {
 *
 * @param max_apt_failures_per_block pointer to the max number of failures
 *
-* @return int - 0 when statistical tests successfully enabled, otherwise the error code
+* @return int - 0 when statistical tests successfully enabled, otherwise the error code
+*/
+int SwiftRngApi::get_max_apt_failures_per_block(uint16_t *max_apt_failures_per_block) const {
+	if (is_context_initialized() == false) {
+		return -1;
+	}
+	*max_apt_failures_per_block = m_max_apt_failures_per_block;
+	return 0;
+}
+
+/**
+* Retrieve Max number of repetition count test failures encountered per data block
+*
+* @param max_rct_failures_per_block pointer to the max number of failures
+*
+* @return int - 0 when statistical tests successfully enabled, otherwise the error code
+*/
+int SwiftRngApi::get_max_rct_failures_per_block(uint16_t *max_rct_failures_per_block) const {
+	if (is_context_initialized() == false) {
+		return -1;
+	}
+	*max_rct_failures_per_block = m_max_rct_failures_per_block;
+	return 0;
+}
+
+/**
+* Enable the download pipeline. When enabled, up to `pipeline_depth` random data block requests are kept
+* in flight so that USB transfers overlap with statistical tests and post processing of the previous block.
+* The pipeline is paused automatically while other device commands are processed.
+*
+* @param int pipeline_depth - number of data block requests to keep in flight, 2 through 8
+* @return int - 0 when the download pipeline was successfully enabled, otherwise the error code
+*
+*/
+int SwiftRngApi::enable_download_pipeline(int pipeline_depth) {
+
+	if (is_context_initialized() == false) {
+		return -1;
+	}
+
+	if (m_device_open == false) {
+		print_err_msg(c_dev_not_open_msg);
+		return -1;
+	}
+
+	if (pipeline_depth < 2 || pipeline_depth > c_max_pipeline_depth) {
+		print_err_msg("Invalid download pipeline depth, it must be between 2 and 8");
+		return -1;
+	}
+
+	pipeline_cancel();
+	for (int i = 0; i < pipeline_depth; i++) {
+		if (m_pipeline_slots[i].in_buffer == nullptr) {
+			m_pipeline_slots[i].in_buffer = alloc_block_buffer();
+			if (m_pipeline_slots[i].in_buffer == nullptr) {
+				print_err_msg("Could not allocate download pipeline buffers");
+				return -1;
+			}
+		}
+	}
+	m_pipeline_depth = pipeline_depth;
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Disable the download pipeline, one random data block request is sent at a time.
+* The download pipeline is initially disabled.
+*
+* @return int - 0 when the download pipeline was successfully disabled, otherwise the error code
+*
+*/
+int SwiftRngApi::disable_download_pipeline() {
+
+	if (is_context_initialized() == false) {
+		return -1;
+	}
+
+	if (m_device_open == false) {
+		print_err_msg(c_dev_not_open_msg);
+		return -1;
+	}
+
+	pipeline_cancel();
+	pipeline_free_transfers();
+	m_pipeline_depth = 0;
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Enable hashing the chunks of each data block on several threads when SHA-256 or SHA-512
+* post processing is used. The caller thread hashes one share of the chunks and `num_workers`
+* additional threads, each with its own hashing state, hash the other shares.
+* The produced random bytes are the same as when the chunks are hashed by the caller thread only.
+*
+* @param int num_workers - number of additional threads, between 1 and 16
+*
+* @return int - 0 when the post processing threads were successfully started, otherwise the error code
+*
+*/
+int SwiftRngApi::enable_post_processing_workers(int num_workers) {
+
+	if (is_context_initialized() == false) {
+		return -1;
+	}
+
+	if (num_workers < 1 || num_workers > c_max_pp_workers) {
+		print_err_msg("Invalid number of post processing workers, it must be between 1 and 16");
+		return -1;
+	}
+
+	pp_workers_stop();
+
+	m_pp_workers = new (nothrow) PostProcessingWorker[num_workers];
+	if (m_pp_workers == nullptr) {
+		print_err_msg("Could not allocate post processing workers");
+		return -1;
+	}
+
+	for (int i = 0; i < num_workers; i++) {
+		try {
+			m_pp_workers[i].thread = std::thread(&SwiftRngApi::pp_worker_run, this, i);
+		} catch (const std::system_error &) {
+			{
+				std::lock_guard<std::mutex> lock(m_pp_mutex);
+				m_num_pp_workers = i;
+			}
+			pp_workers_stop();
+			print_err_msg("Could not start post processing workers");
+			return -1;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(m_pp_mutex);
+	m_num_pp_workers = num_workers;
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Disable the post processing threads, the chunks of each data block are hashed by the caller thread only.
+* The post processing threads are initially disabled.
+*
+* @return int - 0 when the post processing threads were successfully stopped, otherwise the error code
+*
 */
-int SwiftRngApi::get_max_apt_failures_per_block(uint16_t *max_apt_failures_per_block) const {
+int SwiftRngApi::disable_post_processing_workers() {
+
 	if (is_context_initialized() == false) {
 		return -1;
 	}
-	*max_apt_failures_per_block = m_max_apt_failures_per_block;
-	return 0;
+
+	pp_workers_stop();
+	return SWRNG_SUCCESS;
 }
 
 /**
-* Retrieve Max number of repetition count test failures encountered per data block
+* Set how many random data blocks are requested from the device at once when whole blocks are received
+* straight into the caller buffer. Larger values amortize the request overhead for bulk downloads.
+* Only one block is requested at a time initially.
 *
-* @param max_rct_failures_per_block pointer to the max number of failures
+* @param int num_blocks - number of 16000 byte blocks per request, between 1 and 8
+*
+* @return int - 0 when the bulk request size was successfully set, otherwise the error code
 *
-* @return int - 0 when statistical tests successfully enabled, otherwise the error code
 */
-int SwiftRngApi::get_max_rct_failures_per_block(uint16_t *max_rct_failures_per_block) const {
+int SwiftRngApi::set_bulk_request_blocks(int num_blocks) {
+
 	if (is_context_initialized() == false) {
 		return -1;
 	}
-	*max_rct_failures_per_block = m_max_rct_failures_per_block;
-	return 0;
+
+	if (num_blocks < 1 || num_blocks > c_max_bulk_request_blocks) {
+		print_err_msg("Invalid number of blocks per bulk request, it must be between 1 and 8");
+		return -1;
+	}
+
+	m_bulk_request_blocks = num_blocks;
+	return SWRNG_SUCCESS;
 }
 
 /**
@@ -1181,6 +1935,7 @@ void SwiftRngApi::reset_statistics() {
 	m_device_stats.totalRetries = 0;
 	m_device_stats.endTime = 0;
 	m_device_stats.totalTime = 0;
+	m_live_stats.reset();
 }
 
 /**
@@ -1241,53 +1996,74 @@ int SwiftRngApi::get_version_number(double *version) {
 *
 */
 int SwiftRngApi::get_entropy(unsigned char *buffer, long length) {
-	int retval = SWRNG_SUCCESS;
-	long act;
-	long total;
 
 	if (is_context_initialized() == false) {
 		return -1;
 	}
 
 	if (length > c_max_request_size_bytes || length < 0) {
-		retval = -EPERM;
-	} else if (!m_device_open) {
-		retval = -ENODEV;
-	} else {
-		total = 0;
-		do {
-			if (m_cur_rng_out_idx >= c_rnd_out_buff_size) {
-				retval = get_entropy_bytes();
+		return -EPERM;
+	}
+	if (!m_device_open) {
+		return -ENODEV;
+	}
+	return rcv_entropy(buffer, length);
+}
+
+/**
+ * Copy random bytes into the caller buffer. Whole blocks are received straight into the caller
+ * buffer, up to `m_bulk_request_blocks` of them per device round trip, when the download pipeline
+ * is disabled and there is room past them for the status byte.
+ *
+ * @param unsigned char *buffer - a pointer to the data receive buffer
+ * @param long length - how many bytes expected to receive
+ * @return 0 - successful operation, otherwise the error code (a negative number)
+ *
+ */
+int SwiftRngApi::rcv_entropy(unsigned char *buffer, long length) {
+	int retval = SWRNG_SUCCESS;
+	long act;
+	long total;
+	long num_blocks;
+
+	total = 0;
+	while (total < length) {
+		if (m_cur_rng_out_idx >= c_rnd_out_buff_size && m_pipeline_depth == 0
+				&& length - total > c_rnd_out_buff_size) {
+			num_blocks = std::min((long)m_bulk_request_blocks, (length - total - 1) / c_rnd_out_buff_size);
+			retval = rcv_bulk_blocks(buffer + total, (int)num_blocks);
+			if (retval != SWRNG_SUCCESS) {
+				break;
 			}
-			if (retval == SWRNG_SUCCESS) {
-				act = c_rnd_out_buff_size - m_cur_rng_out_idx;
-				if (act > (length - total)) {
-					act = (length - total);
-				}
-				memcpy(buffer + total, m_buff_rnd_out + m_cur_rng_out_idx, act);
-				m_cur_rng_out_idx += act;
-				total += act;
-			} else {
+			total += num_blocks * c_rnd_out_buff_size;
+			continue;
+		}
+		if (m_cur_rng_out_idx >= c_rnd_out_buff_size) {
+			retval = get_entropy_bytes();
+			if (retval != SWRNG_SUCCESS) {
 				break;
 			}
-		} while (total < length);
-#ifdef inDebugMode
-		if (total > length) {
-			fprintf(stderr, "Expected %d bytes to read and actually got %d \n", (int)length, (int)total);
 		}
-#endif
-
+		act = c_rnd_out_buff_size - m_cur_rng_out_idx;
+		if (act > (length - total)) {
+			act = (length - total);
+		}
+		memcpy(buffer + total, m_buff_rnd_out + m_cur_rng_out_idx, act);
+		m_cur_rng_out_idx += act;
+		total += act;
 	}
 	return retval;
 }
 
 /**
  * Clear potential random bytes from the receiver buffer if any
+ *
+ * @param int max_reads - max number of device reads to perform
  */
-void SwiftRngApi::clr_rcv_buff() {
+void SwiftRngApi::clr_rcv_buff(int max_reads) {
 	int transferred;
 	int retval;
-	for (int i = 0; i < 3; i++) {
+	for (int i = 0; i < max_reads; i++) {
 
 		if (m_usb_serial_device->is_connected()) {
 			retval = m_usb_serial_device->receive_data(m_bulk_in_buffer, c_rnd_in_buff_size + 1, &transferred);
@@ -1319,6 +2095,9 @@ int SwiftRngApi::snd_rcv_usb_data(const char *snd, int sizeSnd, char *rcv, int s
 	int actualc_cnt;
 	int retval = SWRNG_SUCCESS;
 
+	// Other device commands must not interleave with the pipelined 'x' requests
+	pipeline_cancel();
+
 	for (retry = 0; retry < c_usb_read_max_retry_count; retry++) {
 		if (m_usb_serial_device->is_connected()) {
 			retval = m_usb_serial_device->send_command((const unsigned char*)snd, sizeSnd, &actualc_cnt);
@@ -1342,9 +2121,11 @@ int SwiftRngApi::snd_rcv_usb_data(const char *snd, int sizeSnd, char *rcv, int s
 			fprintf(stderr, "It was an error during data communication. Cleaning up the receiving queue and continue.\n");
 		#endif
 			m_device_stats.totalRetries++;
+			m_live_stats.add_retry();
 		chip_read_data(m_buff_rnd_in, c_rnd_in_buff_size + 1, op_timeout_secs);
 	}
 	if (retry >= c_usb_read_max_retry_count && retval == SWRNG_SUCCESS) {
+		m_live_stats.add_timeout();
 		retval = -ETIMEDOUT;
 	}
 	return retval;
@@ -1371,38 +2152,39 @@ int SwiftRngApi::chip_read_data(char *buff, int length, int op_timeout_secs) {
 
 	cnt = 0;
 	do {
+		// Receive straight into the destination at the current offset
 		if (m_usb_serial_device->is_connected()) {
-			retval = m_usb_serial_device->receive_data(m_bulk_in_buffer, length, &transferred);
+			retval = m_usb_serial_device->receive_data((unsigned char *)buff + cnt, length - cnt, &transferred);
 		}
 		else {
-			retval = libusb_bulk_transfer(m_libusb_devh, c_bulk_ep_in, m_bulk_in_buffer, length, &transferred, c_usb_bulk_read_timeout_mlsecs);
+			retval = libusb_bulk_transfer(m_libusb_devh, c_bulk_ep_in, (unsigned char *)buff + cnt, length - cnt, &transferred, c_usb_bulk_read_timeout_mlsecs);
 		}
 
 #ifdef inDebugMode
 		fprintf(stderr, "chip_read_data retval %d transferred %d, length %d\n", retval, transferred, length);
 #endif
 		if (retval) {
+			if (retval == LIBUSB_ERROR_TIMEOUT) {
+				m_live_stats.add_timeout();
+			}
 			return retval;
 		}
 
-		if (transferred > length) {
+		if (transferred > length - cnt) {
 			print_err_msg("Received unexpected bytes when processing USB device request");
 			return -EFAULT;
 		}
 
 		end = time(nullptr);
 		secs_waited = end - start;
-		if (transferred > 0) {
-			for (int i = 0; i < transferred; i++) {
-				buff[cnt++] = m_bulk_in_buffer[i];
-			}
-		}
+		cnt += transferred;
 	} while (cnt < length && secs_waited < op_timeout_secs);
 
 	if (cnt != length) {
 #ifdef inDebugMode
 		fprintf(stderr, "timeout received, cnt %d\n", cnt);
 #endif
+		m_live_stats.add_timeout();
 		return -ETIMEDOUT;
 	}
 
@@ -1476,52 +2258,6 @@ int SwiftRngApi::handle_device_version() {
 }
 
 
-/**
- * Initialize the SHA256 data
- *
- */
-void SwiftRngApi::sha256_initialize() {
-	// Initialize H0, H1, H2, H3, H4, H5, H6 and H7
-	m_sha256_ctxt.h0 = 0x6a09e667;
-	m_sha256_ctxt.h1 = 0xbb67ae85;
-	m_sha256_ctxt.h2 = 0x3c6ef372;
-	m_sha256_ctxt.h3 = 0xa54ff53a;
-	m_sha256_ctxt.h4 = 0x510e527f;
-	m_sha256_ctxt.h5 = 0x9b05688c;
-	m_sha256_ctxt.h6 = 0x1f83d9ab;
-	m_sha256_ctxt.h7 = 0x5be0cd19;
-}
-
-/**
- * Initialize the SHA512 data
- *
- */
-void SwiftRngApi::sha512_initialize() {
-	// Initialize H0, H1, H2, H3, H4, H5, H6 and H7
-	m_sha512_ctxt.h0 = 0x6a09e667f3bcc908;
-	m_sha512_ctxt.h1 = 0xbb67ae8584caa73b;
-	m_sha512_ctxt.h2 = 0x3c6ef372fe94f82b;
-	m_sha512_ctxt.h3 = 0xa54ff53a5f1d36f1;
-	m_sha512_ctxt.h4 = 0x510e527fade682d1;
-	m_sha512_ctxt.h5 = 0x9b05688c2b3e6c1f;
-	m_sha512_ctxt.h6 = 0x1f83d9abfb41bd6b;
-	m_sha512_ctxt.h7 = 0x5be0cd19137e2179;
-
-	for (int i = 0; i < 15; i++) {
-		m_sha512_ctxt.w[i] = 0;
-	}
-}
-
-/**
- * Stamp a new serial number for the input data block into the last word
- *
- * @param void* input_block pointer to the input hashing block
- *
- */
-void SwiftRngApi::sha256_stampSerialNumber(uint32_t *input_block) {
-	input_block[c_min_input_num_words] = m_sha256_ctxt.blockSerialNumber++;
-}
-
 /**
  * Initialize the serial number for hashing
  *
@@ -1529,469 +2265,52 @@ void SwiftRngApi::sha256_stampSerialNumber(uint32_t *input_block) {
  *
  */
 void SwiftRngApi::sha256_initializeSerialNumber(uint32_t init_value) {
-	m_sha256_ctxt.blockSerialNumber = init_value;
-}
-
-/**
- * Generate SHA512 value.
- *
- * @param uint64_t* src - pointer to an array of 64 bit words used as hash input
- * @param uint64_t* dst - pointer to an array of 8 X 64 bit words used as hash output
- * @param int16_t len - number of 64 bit words available in array pointed by 'src'
- *
- * @return int 0 for successful operation, -1 for invalid parameters
- *
- */
-int SwiftRngApi::sha512_generateHash(const uint64_t *src, int16_t len, uint64_t *dst) {
-
-	if (len <= 0 || len > 14) {
-		return -1;
-	}
-
-	sha512_initialize();
-
-	int i = 0;
-	for (; i < len; i++) {
-		m_sha512_ctxt.w[i] = src[i];
-	}
-	m_sha512_ctxt.w[i] = 0x8000000000000000;
-	m_sha512_ctxt.w[15] = len * 64;
-
-
-	sha512_hashCurrentBlock();
-
-	// Save the results
-	dst[0] = m_sha512_ctxt.h0;
-	dst[1] = m_sha512_ctxt.h1;
-	dst[2] = m_sha512_ctxt.h2;
-	dst[3] = m_sha512_ctxt.h3;
-	dst[4] = m_sha512_ctxt.h4;
-	dst[5] = m_sha512_ctxt.h5;
-	dst[6] = m_sha512_ctxt.h6;
-	dst[7] = m_sha512_ctxt.h7;
-
-	return 0;
-}
-
-/**
- * Generate SHA256 value.
- *
- * @param uint32_t* src - pointer to an array of 32 bit words used as hash input
- * @param uint32_t* dst - pointer to an array of 8 X 32 bit words used as hash output
- * @param int16_t len - number of 32 bit words available in array pointed by 'src'
- *
- * @return int 0 for successful operation, -1 for invalid parameters
- *
- */
-int SwiftRngApi::sha256_generateHash(const uint32_t *src, int16_t len, uint32_t *dst) {
-
-	uint16_t blockNum;
-	uint8_t ui8;
-	int32_t initialMessageSize;
-	uint16_t numCompleteDataBlocks;
-	uint16_t reminder;
-	uint16_t srcOffset;
-	uint8_t needAdditionalBlock;
-	uint8_t needToAddOneMarker;
-
-	if (len <= 0) {
-		return -1;
-	}
-
-	sha256_initialize();
-
-	initialMessageSize = len * 8 * 4;
-	numCompleteDataBlocks = len / m_max_data_block_size_words;
-	reminder = len % m_max_data_block_size_words;
-
-	// Process complete blocks
-	for (blockNum = 0; blockNum < numCompleteDataBlocks; blockNum++) {
-		srcOffset = blockNum * m_max_data_block_size_words;
-		for (ui8 = 0; ui8 < m_max_data_block_size_words; ui8++) {
-			m_sha256_ctxt.w[ui8] = src[ui8 + srcOffset];
-		}
-		// Hash the current block
-		sha256_hashCurrentBlock();
-	}
-
-	srcOffset = numCompleteDataBlocks * m_max_data_block_size_words;
-	needAdditionalBlock = 1;
-	needToAddOneMarker = 1;
-	if (reminder > 0) {
-		// Process the last data block if any
-		ui8 = 0;
-		for (; ui8 < reminder; ui8++) {
-			m_sha256_ctxt.w[ui8] = src[ui8 + srcOffset];
-		}
-		// Append '1' to the message
-		m_sha256_ctxt.w[ui8++] = 0x80000000;
-		needToAddOneMarker = 0;
-		if (ui8 < m_max_data_block_size_words - 1) {
-			for (; ui8 < m_max_data_block_size_words - 2; ui8++) {
-				// Fill with zeros
-				m_sha256_ctxt.w[ui8] = 0x0;
-			}
-			// add the message size to the current block
-			m_sha256_ctxt.w[ui8++] = 0x0;
-			m_sha256_ctxt.w[ui8] = initialMessageSize;
-			sha256_hashCurrentBlock();
-			needAdditionalBlock = 0;
-		} else {
-			// Fill the rest with '0'
-			// Will need to create another block
-			m_sha256_ctxt.w[ui8] = 0x0;
-			sha256_hashCurrentBlock();
-		}
-	}
-
-	if (needAdditionalBlock) {
-		ui8 = 0;
-		if (needToAddOneMarker) {
-			m_sha256_ctxt.w[ui8++] = 0x80000000;
-		}
-		for (; ui8 < m_max_data_block_size_words - 2; ui8++) {
-			m_sha256_ctxt.w[ui8] = 0x0;
-		}
-		m_sha256_ctxt.w[ui8++] = 0x0;
-		m_sha256_ctxt.w[ui8] = initialMessageSize;
-		sha256_hashCurrentBlock();
-	}
-
-	// Save the results
-	dst[0] = m_sha256_ctxt.h0;
-	dst[1] = m_sha256_ctxt.h1;
-	dst[2] = m_sha256_ctxt.h2;
-	dst[3] = m_sha256_ctxt.h3;
-	dst[4] = m_sha256_ctxt.h4;
-	dst[5] = m_sha256_ctxt.h5;
-	dst[6] = m_sha256_ctxt.h6;
-	dst[7] = m_sha256_ctxt.h7;
-
-	return 0;
-}
-
-/**
- * Hash current block
- *
- */
-void SwiftRngApi::sha512_hashCurrentBlock() {
-
-	// Process elements 16...79
-	for (uint8_t t = 16; t <= 79; t++) {
-		m_sha512_ctxt.w[t] = sha512_sigma1(&m_sha512_ctxt.w[t-2]) + m_sha512_ctxt.w[t-7] + sha512_sigma0(&m_sha512_ctxt.w[t-15]) + m_sha512_ctxt.w[t-16];
-	}
-
-	// Initialize variables
-	m_sha512_ctxt.a = m_sha512_ctxt.h0;
-	m_sha512_ctxt.b = m_sha512_ctxt.h1;
-	m_sha512_ctxt.c = m_sha512_ctxt.h2;
-	m_sha512_ctxt.d = m_sha512_ctxt.h3;
-	m_sha512_ctxt.e = m_sha512_ctxt.h4;
-	m_sha512_ctxt.f = m_sha512_ctxt.h5;
-	m_sha512_ctxt.g = m_sha512_ctxt.h6;
-	m_sha512_ctxt.h = m_sha512_ctxt.h7;
-
-	// Process elements 0...79
-	for (uint8_t t = 0; t <= 79; t++) {
-		m_sha512_ctxt.tmp1 = m_sha512_ctxt.h + sha512_sum1(&m_sha512_ctxt.e) + sha512_ch(&m_sha512_ctxt.e, &m_sha512_ctxt.f, &m_sha512_ctxt.g) + c_sha512_k[t] + m_sha512_ctxt.w[t];
-		m_sha512_ctxt.tmp2 = sha512_sum0(&m_sha512_ctxt.a) + sha512_maj(&m_sha512_ctxt.a, &m_sha512_ctxt.b, &m_sha512_ctxt.c);
-		m_sha512_ctxt.h = m_sha512_ctxt.g;
-		m_sha512_ctxt.g = m_sha512_ctxt.f;
-		m_sha512_ctxt.f = m_sha512_ctxt.e;
-		m_sha512_ctxt.e = m_sha512_ctxt.d + m_sha512_ctxt.tmp1;
-		m_sha512_ctxt.d = m_sha512_ctxt.c;
-		m_sha512_ctxt.c = m_sha512_ctxt.b;
-		m_sha512_ctxt.b = m_sha512_ctxt.a;
-		m_sha512_ctxt.a = m_sha512_ctxt.tmp1 + m_sha512_ctxt.tmp2;
-	}
-
-	// Calculate the final hash for the block
-	m_sha512_ctxt.h0 += m_sha512_ctxt.a;
-	m_sha512_ctxt.h1 += m_sha512_ctxt.b;
-	m_sha512_ctxt.h2 += m_sha512_ctxt.c;
-	m_sha512_ctxt.h3 += m_sha512_ctxt.d;
-	m_sha512_ctxt.h4 += m_sha512_ctxt.e;
-	m_sha512_ctxt.h5 += m_sha512_ctxt.f;
-	m_sha512_ctxt.h6 += m_sha512_ctxt.g;
-	m_sha512_ctxt.h7 += m_sha512_ctxt.h;
-}
-
-/**
- * Hash current block
- *
- */
-void SwiftRngApi::sha256_hashCurrentBlock() {
-	// Process elements 16...63
-	for (uint8_t t = 16; t <= 63; t++) {
-		m_sha256_ctxt.w[t] = sha256_sigma1(&m_sha256_ctxt.w[t - 2]) + m_sha256_ctxt.w[t - 7] + sha256_sigma0(
-				&m_sha256_ctxt.w[t - 15]) + m_sha256_ctxt.w[t - 16];
-	}
-
-	// Initialize variables
-	m_sha256_ctxt.a = m_sha256_ctxt.h0;
-	m_sha256_ctxt.b = m_sha256_ctxt.h1;
-	m_sha256_ctxt.c = m_sha256_ctxt.h2;
-	m_sha256_ctxt.d = m_sha256_ctxt.h3;
-	m_sha256_ctxt.e = m_sha256_ctxt.h4;
-	m_sha256_ctxt.f = m_sha256_ctxt.h5;
-	m_sha256_ctxt.g = m_sha256_ctxt.h6;
-	m_sha256_ctxt.h = m_sha256_ctxt.h7;
-
-	// Process elements 0...63
-	for (uint8_t t = 0; t <= 63; t++) {
-		m_sha256_ctxt.tmp1 = m_sha256_ctxt.h + sha256_sum1(&m_sha256_ctxt.e) + sha256_ch(&m_sha256_ctxt.e, &m_sha256_ctxt.f, &m_sha256_ctxt.g)
-				+ c_sha256_k[t] + m_sha256_ctxt.w[t];
-		m_sha256_ctxt.tmp2 = sha256_sum0(&m_sha256_ctxt.a) + sha256_maj(&m_sha256_ctxt.a, &m_sha256_ctxt.b, &m_sha256_ctxt.c);
-		m_sha256_ctxt.h = m_sha256_ctxt.g;
-		m_sha256_ctxt.g = m_sha256_ctxt.f;
-		m_sha256_ctxt.f = m_sha256_ctxt.e;
-		m_sha256_ctxt.e = m_sha256_ctxt.d + m_sha256_ctxt.tmp1;
-		m_sha256_ctxt.d = m_sha256_ctxt.c;
-		m_sha256_ctxt.c = m_sha256_ctxt.b;
-		m_sha256_ctxt.b = m_sha256_ctxt.a;
-		m_sha256_ctxt.a = m_sha256_ctxt.tmp1 + m_sha256_ctxt.tmp2;
-	}
-
-	// Calculate the final hash for the block
-	m_sha256_ctxt.h0 += m_sha256_ctxt.a;
-	m_sha256_ctxt.h1 += m_sha256_ctxt.b;
-	m_sha256_ctxt.h2 += m_sha256_ctxt.c;
-	m_sha256_ctxt.h3 += m_sha256_ctxt.d;
-	m_sha256_ctxt.h4 += m_sha256_ctxt.e;
-	m_sha256_ctxt.h5 += m_sha256_ctxt.f;
-	m_sha256_ctxt.h6 += m_sha256_ctxt.g;
-	m_sha256_ctxt.h7 += m_sha256_ctxt.h;
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.2 formula (4.2)
- *
- * @param uint32_t* x pointer to variable x
- * @param uint32_t* y pointer to variable y
- * @param uint32_t* z pointer to variable z
- * $return uint32_t Ch value
- *
- */
-uint32_t SwiftRngApi::sha256_ch(uint32_t *x, uint32_t *y, uint32_t *z) {
-	return ((*x) & (*y)) ^ (~(*x) & (*z));
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.2 formula (4.3)
- *
- * @param uint32_t* x pointer to variable x
- * @param uint32_t* y pointer to variable y
- * @param uint32_t* z pointer to variable z
- * $return uint32_t Maj value
- *
- */
-uint32_t SwiftRngApi::sha256_maj(const uint32_t *x, const uint32_t *y, const uint32_t *z) {
-	return ((*x) & (*y)) ^ ((*x) & (*z)) ^ ((*y) & (*z));
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.2 formula (4.4)
- *
- * @param uint32_t* x pointer to variable x
- * $return uint32_t Sum0 value
- *
- */
-uint32_t SwiftRngApi::sha256_sum0(const uint32_t *x) {
-	return rotr32(2, *x) ^ rotr32(13, *x) ^ rotr32(22, *x);
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.2 formula (4.5)
- *
- * @param uint32_t* x pointer to variable x
- * $return uint32_t Sum1 value
- *
- */
-uint32_t SwiftRngApi::sha256_sum1(const uint32_t *x) {
-	return rotr32(6, *x) ^ rotr32(11, *x) ^ rotr32(25, *x);
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.2 formula (4.6)
- *
- * @param uint32_t* x pointer to variable x
- * $return uint32_t sigma0 value
- *
- */
-uint32_t SwiftRngApi::sha256_sigma0(const uint32_t *x) {
-	return rotr32(7, *x) ^ rotr32(18, *x) ^ ((*x) >> 3);
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.2 formula (4.7)
- *
- * @param uint32_t* x pointer to variable x
- * $return uint32_t sigma1 value
- *
- */
-uint32_t SwiftRngApi::sha256_sigma1(const uint32_t *x) {
-	return rotr32(17, *x) ^ rotr32(19, *x) ^ ((*x) >> 10);
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.3 formula (4.8)
- *
- * @param uint64_t* x pointer to variable x
- * @param uint64_t* y pointer to variable y
- * @param uint64_t* z pointer to variable z
- * $return uint64_t ch value
- *
- */
-uint64_t SwiftRngApi::sha512_ch(const uint64_t *x, const uint64_t *y, const uint64_t *z) {
-	return  ((*x) & (*y)) ^ (~(*x) & (*z));
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.3 formula (4.9)
- *
- * @param uint64_t* x pointer to variable x
- * @param uint64_t* y pointer to variable y
- * @param uint64_t* z pointer to variable z
- * $return uint64_t maj value
- *
- */
-uint64_t SwiftRngApi::sha512_maj(const uint64_t *x, const uint64_t *y, const uint64_t *z) {
-	return ((*x) & (*y)) ^ ((*x) & (*z)) ^ ((*y) & (*z));
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.3 formula (4.10)
- *
- * @param uint64_t* x pointer to variable x
- * $return uint64_t sum0 value
- *
- */
-uint64_t SwiftRngApi::sha512_sum0(const uint64_t *x) {
-	return rotr64(28, *x) ^ rotr64(34, *x) ^ rotr64(39, *x);
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.3 formula (4.11)
- *
- * @param uint64_t* x pointer to variable x
- * $return uint64_t sum1 value
- *
- */
-uint64_t SwiftRngApi::sha512_sum1(const uint64_t *x) {
-	return rotr64(14, *x) ^ rotr64(18, *x) ^ rotr64(41, *x);
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.3 formula (4.12)
- *
- * @param uint64_t* x pointer to variable x
- * $return uint64_t sigma0 value
- *
- */
-uint64_t SwiftRngApi::sha512_sigma0(const uint64_t *x) {
-	return rotr64(1, *x) ^ rotr64(8, *x) ^ ((*x) >> 7);
-}
-
-/**
- * FIPS PUB 180-4 section 4.1.3 formula (4.13)
- *
- * @param uint64_t* x pointer to variable x
- * $return uint64_t sigma1 value
- *
- */
-uint64_t SwiftRngApi::sha512_sigma1(const uint64_t *x) {
-	return rotr64(19, *x) ^ rotr64(61, *x) ^ ((*x) >> 6);
+	m_conditioner_ctxt.blockSerialNumber = init_value;
 }
 
 
 /*
- * A function for running the self test for the SHA256 post processing method
+ * A function for verifying the sample comparisons used for testing 64 samples at once
+ * against comparing the samples one by one
  *
  * @return 0 - successful operation, otherwise the error code (a negative number)
  *
  */
-int SwiftRngApi::sha256_selfTest() {
-	uint32_t results[8];
-	int retVal;
+int SwiftRngApi::health_tests_simdSelfTest() {
+	const int numSamples = 4 * 64 + 1;
+	uint8_t samples[numSamples];
+	uint64_t masks[4];
 
-	retVal = sha256_generateHash(c_sha256_test_seq_1, (uint16_t) 11, (uint32_t*) results);
-	if (retVal == 0) {
-		// Compare the expected with actual results
-		retVal = memcmp(results, c_sha256_expt_hash_seq_1, 8);
+	// Runs of different lengths and values repeating at different distances
+	for (int i = 0; i < numSamples; i++) {
+		samples[i] = (uint8_t)((i * i / 7) % 5);
 	}
-	return retVal;
-}
 
-/*
- * A function for running the self test for the SHA512 post processing method
- *
- * @return 0 - successful operation, otherwise the error code (a negative number)
- *
- */
-int SwiftRngApi::sha512_selfTest() {
-	uint64_t results[8];
-	int retVal;
-	if (is_context_initialized() == false) {
+	if (m_repeat_mask_kernel(samples + 1, numSamples - 1, masks) != numSamples - 1) {
 		return -1;
 	}
-
-	retVal = sha512_generateHash((const uint64_t *)"8765432187654321876543218765432187654321876543218765432187654321",
-			(uint16_t) 8, (uint64_t*) results);
-	if (retVal == 0) {
-		// Compare the expected with actual results
-		retVal = memcmp(results, c_sha512_expt_hash_seq1, 8);
-	}
-	return retVal;
-}
-
-/*
- * A function for running the self test for the xorshift64 post processing method
- *
- * @return 0 - successful operation, otherwise the error code (a negative number)
- *
- */
-int SwiftRngApi::xorshift64_selfTest() {
-	uint64_t rawWord = 0x1212121212121212;
-	uint64_t testWord = 0x2322d6d77d8b7b55;
-	xorshift64_postProcess((uint8_t*)&rawWord, 8);
-
-	if (rawWord == testWord) {
-		return SWRNG_SUCCESS;
-	} else {
-		return -1;
+	for (int i = 1; i < numSamples; i++) {
+		bool isRepeat = ((masks[(i - 1) / 64] >> ((i - 1) % 64)) & 1) != 0;
+		if (isRepeat != (samples[i] == samples[i - 1])) {
+			return -1;
+		}
 	}
-}
 
-/**
-* Apply Xorshift64 (Marsaglia's PPRNG method) to the raw word
-* @param raw_word - word to post process
-*/
-uint64_t SwiftRngApi::xorshift64_postProcessWord(uint64_t raw_word) const {
-	uint64_t trueWord = raw_word;
-
-	trueWord ^= trueWord >> 12;
-	trueWord ^= trueWord << 25;
-	trueWord ^= trueWord >> 27;
-	return trueWord * UINT64_C(2685821657736338717);
-}
-
-/**
-*
-* @param buffer - pointer to input data buffer
-* @param num_elements - number of elements in the input buffer
-*/
-void SwiftRngApi::xorshift64_postProcessWords(uint64_t *buffer, int num_elements) {
-	for(int i = 0; i < num_elements; i++) {
-		buffer[i] = xorshift64_postProcessWord(buffer[i]);
+	for (int offset = 0; offset + 64 <= numSamples; offset += 13) {
+		// Every count, the adaptive proportion test compares (windowSize - 1) samples and that leaves an odd tail
+		for (int numBytes = 0; numBytes <= 64; numBytes++) {
+			int matches = 0;
+			for (int i = 0; i < numBytes; i++) {
+				if (samples[offset + i] == samples[offset]) {
+					matches++;
+				}
+			}
+			if (m_sample_match_kernel(samples + offset, numBytes, samples[offset]) != matches) {
+				return -1;
+			}
+		}
 	}
-}
-
-/**
-* @param buffer - pointer to input data buffer
-* @param num_elements - number of elements in the input buffer
-*/
-void SwiftRngApi::xorshift64_postProcess(uint8_t *buffer, int num_elements) {
-	xorshift64_postProcessWords((uint64_t *)buffer, num_elements / 8);
+	return SWRNG_SUCCESS;
 }
 
 /**
@@ -2047,50 +2366,47 @@ void SwiftRngApi::clear_last_error_msg() {
 	m_last_error_log_char[0] = '\0';
 }
 
-SwiftRngApi::~SwiftRngApi() {
-	if (c_sha256_k != nullptr) {
-		delete [] c_sha256_k;
-	}
-
-	if (c_sha256_test_seq_1 != nullptr) {
-		delete [] c_sha256_test_seq_1;
-	}
-
-	if (c_sha256_expt_hash_seq_1 != nullptr) {
-		delete [] c_sha256_expt_hash_seq_1;
+/**
+ * Allocate a buffer for a random data block and the device status byte, aligned for vector loads and stores
+ *
+ * @return char* - pointer to the buffer, nullptr when memory could not be allocated
+ */
+char* SwiftRngApi::alloc_block_buffer() {
+	void *buffer = nullptr;
+	// Round the size up to a multiple of the alignment
+	size_t size = (c_rnd_in_buff_size + c_block_buffer_alignment) & ~(c_block_buffer_alignment - 1);
+	if (posix_memalign(&buffer, c_block_buffer_alignment, size) != 0) {
+		return nullptr;
 	}
+	return (char *)buffer;
+}
 
+/**
+ * Release a buffer allocated with alloc_block_buffer()
+ *
+ * @param char* buffer - pointer to the buffer, may be nullptr
+ */
+void SwiftRngApi::free_block_buffer(char *buffer) {
+	free(buffer);
+}
 
-	if (c_sha512_k != nullptr) {
-		delete [] c_sha512_k;
-	}
-
-	if (c_sha512_expt_hash_seq1 != nullptr) {
-		delete [] c_sha512_expt_hash_seq1;
-	}
+SwiftRngApi::~SwiftRngApi() {
+	pp_workers_stop();
 
 	if (m_usb_serial_device != nullptr) {
 		delete m_usb_serial_device;
 	}
 
-	if (m_buff_rnd_out != nullptr) {
-		delete [] m_buff_rnd_out;
-	}
+	free_block_buffer(m_buff_rnd_out);
 
 	if (m_bulk_in_buffer != nullptr) {
 		delete [] m_bulk_in_buffer;
 	}
 
-	if (m_buff_rnd_in != nullptr) {
-		delete [] m_buff_rnd_in;
-	}
-
-	if (m_src_to_hash_32 != nullptr) {
-		delete [] m_src_to_hash_32;
-	}
+	free_block_buffer(m_buff_rnd_in);
 
-	if (m_src_to_hash_64 != nullptr) {
-		delete [] m_src_to_hash_64;
+	for (int i = 0; i < c_max_pipeline_depth; i++) {
+		free_block_buffer(m_pipeline_slots[i].in_buffer);
 	}
 
 	if (m_last_error_log_char != nullptr) {
@@ -20,6 +20,7 @@
  */
 #include <swrngapi.h>
 #include <SwiftRngApi.h>
+#include <DeviceMonitor.h>
 
 using namespace swiftrng;
 
@@ -43,6 +44,37 @@ static const uint32_t s_ctxt_sig_end =   0b10100011010111000101111000011011;
  */
 static bool is_context_valid(const SwrngContext *ctxt);
 
+/**
+ * Validate conditioner context.
+ *
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @return true - if context has valid markers
+ */
+static bool is_conditioner_context_valid(const SwrngConditionerContext *ctxt);
+
+/**
+ * Validate device monitor context.
+ *
+* @param ctxt - pointer to SwrngDeviceMonitorContext structure
+* @return true - if context has valid markers
+ */
+static bool is_monitor_context_valid(const SwrngDeviceMonitorContext *ctxt);
+
+/**
+ * Forward a device event to the C callback of a device monitor.
+ *
+* @param arg - pointer to the DeviceMonitorBinding of the monitor
+* @param arrived - true when a device was plugged in, false when removed
+ */
+static void forward_device_event(void *arg, bool arrived);
+
+// A device monitor with the C callback it reports to
+struct DeviceMonitorBinding {
+	DeviceMonitor monitor;
+	SwrngDeviceEventCallback callback;
+	void *arg;
+};
+
 //
 // Static functions
 //
@@ -64,6 +96,49 @@ static bool is_context_valid(const SwrngContext *ctxt) {
 	return true;
 }
 
+/**
+ * Validate conditioner context.
+ *
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @return true - if context has valid markers
+ */
+static bool is_conditioner_context_valid(const SwrngConditionerContext *ctxt) {
+	if (ctxt == nullptr
+			|| ctxt->sig_begin != s_ctxt_sig_begin
+			|| ctxt->sig_end != s_ctxt_sig_end
+			|| ctxt->ctxt == nullptr) {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Validate device monitor context.
+ *
+* @param ctxt - pointer to SwrngDeviceMonitorContext structure
+* @return true - if context has valid markers
+ */
+static bool is_monitor_context_valid(const SwrngDeviceMonitorContext *ctxt) {
+	if (ctxt == nullptr
+			|| ctxt->sig_begin != s_ctxt_sig_begin
+			|| ctxt->sig_end != s_ctxt_sig_end
+			|| ctxt->monitor == nullptr) {
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Forward a device event to the C callback of a device monitor.
+ *
+* @param arg - pointer to the DeviceMonitorBinding of the monitor
+* @param arrived - true when a device was plugged in, false when removed
+ */
+static void forward_device_event(void *arg, bool arrived) {
+	auto binding = (DeviceMonitorBinding*) arg;
+	binding->callback(binding->arg, arrived ? 1 : 0);
+}
+
 //
 // API implementation
 //
@@ -260,6 +335,24 @@ int swrngGetDeviceList(SwrngContext *ctxt, DeviceInfoList *dev_info_list) {
 
 }
 
+/**
+* Count the SwiftRNG devices currently plugged into USB ports, without opening them.
+* Devices are numbered by swrngOpen() in the same order, including the ones already in use.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param int* device_count - pointer to the number of devices found
+* @return int - value 0 when counted successfully, otherwise the error code
+*
+*/
+int swrngGetDeviceCount(SwrngContext *ctxt, int *device_count) {
+	if (!is_context_valid(ctxt) || device_count == nullptr) {
+		return -1;
+	}
+
+	auto api = (SwiftRngApi*) ctxt->api;
+	return api->get_device_count(device_count);
+}
+
 /**
 * Retrieve SwiftRNG device model number. This call will fail when there is no SwiftRNG device
 * currently connected or when the device is already in use.
@@ -534,6 +627,22 @@ DeviceStatistics* swrngGenerateDeviceStatistics(SwrngContext *ctxt) {
 	return api->generate_device_statistics();
 }
 
+/**
+* Retrieve the live statistics of the downloads since the device was open or the statistics were reset.
+* It may be called from another thread while the device is downloading.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param stats - pointer to the structure receiving the statistics
+* @return int - 0 when the statistics were retrieved
+*/
+int swrngGetLiveStatistics(SwrngContext *ctxt, DeviceLiveStatistics *stats) {
+	if (!is_context_valid(ctxt) || stats == nullptr) {
+		return -1;
+	}
+	auto api = (SwiftRngApi*) ctxt->api;
+	return api->get_live_statistics(stats);
+}
+
 /**
 * Retrieve the last error message.
 * The caller should make a copy of the error message returned immediately after calling this function.
@@ -594,5 +703,206 @@ int swrngGetMaxRctFailuresPerBlock(SwrngContext *ctxt, uint16_t *max_rct_failure
 	return api->get_max_rct_failures_per_block(max_rct_failures_per_block);
 }
 
+/**
+* Enable the download pipeline.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param pipeline_depth - number of data block requests to keep in flight, 2 through 8
+*
+* @return int - 0 when the download pipeline was successfully enabled, otherwise the error code
+*/
+int swrngEnableDownloadPipeline(SwrngContext *ctxt, int pipeline_depth) {
+	if (!is_context_valid(ctxt)) {
+		return -1;
+	}
+
+	auto api = (SwiftRngApi*) ctxt->api;
+	return api->enable_download_pipeline(pipeline_depth);
+}
+
+/**
+* Disable the download pipeline.
+*
+* @param ctxt - pointer to SwrngContext structure
+*
+* @return int - 0 when the download pipeline was successfully disabled, otherwise the error code
+*/
+int swrngDisableDownloadPipeline(SwrngContext *ctxt) {
+	if (!is_context_valid(ctxt)) {
+		return -1;
+	}
+
+	auto api = (SwiftRngApi*) ctxt->api;
+	return api->disable_download_pipeline();
+}
+
+/**
+* Enable hashing the chunks of each data block on several threads.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param num_workers - number of threads helping the caller thread, between 1 and 16
+*
+* @return int - 0 when the post processing threads were successfully started, otherwise the error code
+*/
+int swrngEnablePostProcessingWorkers(SwrngContext *ctxt, int num_workers) {
+	if (!is_context_valid(ctxt)) {
+		return -1;
+	}
+
+	auto api = (SwiftRngApi*) ctxt->api;
+	return api->enable_post_processing_workers(num_workers);
+}
+
+/**
+* Stop the post processing threads.
+*
+* @param ctxt - pointer to SwrngContext structure
+*
+* @return int - 0 when the post processing threads were successfully stopped, otherwise the error code
+*/
+int swrngDisablePostProcessingWorkers(SwrngContext *ctxt) {
+	if (!is_context_valid(ctxt)) {
+		return -1;
+	}
+
+	auto api = (SwiftRngApi*) ctxt->api;
+	return api->disable_post_processing_workers();
+}
+
+/**
+* Set how many blocks are requested from the device at once when whole blocks are received
+* straight into the caller buffer.
+*
+* @param ctxt - pointer to SwrngContext structure
+* @param num_blocks - number of blocks per request, between 1 and 8
+*
+* @return int - 0 when the bulk request size was successfully set, otherwise the error code
+*/
+int swrngSetBulkRequestBlocks(SwrngContext *ctxt, int num_blocks) {
+	if (!is_context_valid(ctxt)) {
+		return -1;
+	}
+
+	auto api = (SwiftRngApi*) ctxt->api;
+	return api->set_bulk_request_blocks(num_blocks);
+}
+
+/**
+* Initialize SwrngConditionerContext context used for conditioning blocks of random bytes without a device.
+*
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @param serial_number - serial number stamped into the first chunk hashed with SHA-256
+* @return 0 - if context initialized successfully, -1 if context is null or memory could not be allocated
+*/
+int swrngInitializeConditionerContext(SwrngConditionerContext *ctxt, uint32_t serial_number) {
+	if (ctxt == nullptr) {
+		return -1;
+	}
+
+	memset(ctxt, 0, sizeof(SwrngConditionerContext));
+
+	auto conditioner_ctxt = new (std::nothrow) ConditionerContext();
+	if (conditioner_ctxt == nullptr) {
+		return -1;
+	}
+	conditioner_ctxt->blockSerialNumber = serial_number;
+	ctxt->ctxt = conditioner_ctxt;
+
+	// Set context signatures used for sanity check.
+	ctxt->sig_begin = s_ctxt_sig_begin;
+	ctxt->sig_end = s_ctxt_sig_end;
+
+	return 0;
+}
+
+/**
+* Destroy SwrngConditionerContext context.
+*
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @return 0 - if context destroyed successfully
+*/
+int swrngDestroyConditionerContext(SwrngConditionerContext *ctxt) {
+	if (!is_conditioner_context_valid(ctxt)) {
+		return -1;
+	}
+
+	delete (ConditionerContext*) ctxt->ctxt;
+	ctxt->ctxt = nullptr;
+	ctxt->sig_begin = 0;
+	ctxt->sig_end = 0;
+	return 0;
+}
+
+/**
+* Condition one block of SWRNG_CONDITIONER_BLOCK_SIZE random bytes with the given post processing method.
+*
+* @param ctxt - pointer to SwrngConditionerContext structure
+* @param in - pointer to SWRNG_CONDITIONER_BLOCK_SIZE raw random bytes
+* @param out - pointer to a buffer receiving SWRNG_CONDITIONER_BLOCK_SIZE conditioned bytes
+* @param post_processing_method_id - 0 for SHA256, 1 for xorshift64, 2 for SHA512
+* @return int - 0 when successful, otherwise the error code
+*/
+int swrngConditionBlock(SwrngConditionerContext *ctxt, const unsigned char *in, unsigned char *out,
+		int post_processing_method_id) {
+	if (!is_conditioner_context_valid(ctxt) || in == nullptr || out == nullptr) {
+		return -1;
+	}
+
+	auto conditioner_ctxt = (ConditionerContext*) ctxt->ctxt;
+	return EntropyConditioner::get_instance().condition_block(*conditioner_ctxt, in, out, post_processing_method_id);
+}
+
+/**
+* Start watching for SwiftRNG devices being plugged in and removed.
+*
+* @param ctxt - pointer to SwrngDeviceMonitorContext structure
+* @param callback - function invoked when a device is plugged in or removed
+* @param arg - argument passed to the callback
+* @return int - 0 when the monitor started, -1 if device events are not available on the host
+*/
+int swrngStartDeviceMonitor(SwrngDeviceMonitorContext *ctxt, SwrngDeviceEventCallback callback, void *arg) {
+	if (ctxt == nullptr || callback == nullptr) {
+		return -1;
+	}
+
+	memset(ctxt, 0, sizeof(SwrngDeviceMonitorContext));
+
+	auto binding = new (std::nothrow) DeviceMonitorBinding();
+	if (binding == nullptr) {
+		return -1;
+	}
+	binding->callback = callback;
+	binding->arg = arg;
+	if (binding->monitor.start(forward_device_event, binding) != 0) {
+		delete binding;
+		return -1;
+	}
+	ctxt->monitor = binding;
+
+	// Set context signatures used for sanity check.
+	ctxt->sig_begin = s_ctxt_sig_begin;
+	ctxt->sig_end = s_ctxt_sig_end;
+
+	return 0;
+}
+
+/**
+* Stop watching for devices and destroy the SwrngDeviceMonitorContext context.
+*
+* @param ctxt - pointer to SwrngDeviceMonitorContext structure
+* @return int - 0 when the monitor stopped successfully
+*/
+int swrngStopDeviceMonitor(SwrngDeviceMonitorContext *ctxt) {
+	if (!is_monitor_context_valid(ctxt)) {
+		return -1;
+	}
+
+	delete (DeviceMonitorBinding*) ctxt->monitor;
+	ctxt->monitor = nullptr;
+	ctxt->sig_begin = 0;
+	ctxt->sig_end = 0;
+	return 0;
+}
+
 
 }
@@ -162,48 +162,65 @@ USBSerialDevice::~USBSerialDevice() {
 
 
 #ifndef __FreeBSD__
-void USBSerialDevice::scan_available_devices() {
-	m_active_device_count = 0;
 #ifdef __linux__
-	char command[] = "/bin/ls -1l /dev/serial/by-id 2>&1 | grep -i \"TectroLabs_SwiftRNG\"";
+// Directory of the links to the serial devices, named after the device serial ids
+static const char c_device_dir[] = "/dev/serial/by-id";
 #else
-	char command[] = "/bin/ls -1a /dev/cu.usbmodemSWRNG* /dev/cu.usbmodemF* 2>&1";
+static const char c_device_dir[] = "/dev";
 #endif
-	FILE *pf = popen(command,"r");
-	if (pf == nullptr) {
+
+/**
+ * Check if a directory entry stands for a SwiftRNG serial device
+ *
+ * @param entry - the directory entry
+ * @return int - non zero for a SwiftRNG device
+ */
+static int is_swiftrng_entry(const struct dirent *entry) {
+#ifdef __linux__
+	return strcasestr(entry->d_name, "TectroLabs_SwiftRNG") != nullptr;
+#else
+	return strncmp(entry->d_name, "cu.usbmodemSWRNG", 16) == 0 || strncmp(entry->d_name, "cu.usbmodemF", 12) == 0;
+#endif
+}
+
+void USBSerialDevice::scan_available_devices() {
+	m_active_device_count = 0;
+	// Read the directory in place of listing it with a shell command, in name order as listed
+	struct dirent **entries;
+	int num_entries = scandir(c_device_dir, &entries, is_swiftrng_entry, alphasort);
+	if (num_entries < 0) {
 		return;
 	}
 
-	char line[512];
-	while (fgets(line, sizeof(line), pf) && m_active_device_count < c_max_devices) {
-#ifdef __linux__
-		char *tty = strstr(line, "ttyACM");
-		if (tty == NULL) {
+	for (int i = 0; i < num_entries; i++) {
+		char path[sizeof(c_device_dir) + sizeof(entries[i]->d_name)];
+		snprintf(path, sizeof(path), "%s/%s", c_device_dir, entries[i]->d_name);
+		free(entries[i]);
+		if (m_active_device_count >= c_max_devices) {
 			continue;
 		}
-#else
-		int cmp1  = strncmp(line, "/dev/cu.usbmodemSWRNG", 21);
-		int cmp2  = strncmp(line, "/dev/cu.usbmodemF", 17);
-		if (cmp1 != 0 && cmp2 != 0 ) {
+#ifdef __linux__
+		// The link points to the tty node, as in ../../ttyACM0
+		char link[c_max_size_device_name];
+		ssize_t link_size = readlink(path, link, sizeof(link) - 1);
+		if (link_size < 0) {
 			continue;
 		}
-		char *tty = line;
-#endif
-		auto sizeTty = (int)strlen(tty);
-		for (int i = 0; i < sizeTty; i++) {
-			if(tty[i] < 33 || tty[i] > 125) {
-				tty[i] = 0;
-			}
+		link[link_size] = '\0';
+		char *tty = strstr(link, "ttyACM");
+		if (tty == nullptr) {
+			continue;
 		}
-#ifdef __linux__
-		strcpy(c_device_names[m_active_device_count], "/dev/");
-		strcat(c_device_names[m_active_device_count], tty);
+		snprintf(c_device_names[m_active_device_count], c_max_size_device_name, "/dev/%s", tty);
 #else
-		strcpy(c_device_names[m_active_device_count], tty);
+		if (strlen(path) >= c_max_size_device_name) {
+			continue;
+		}
+		strcpy(c_device_names[m_active_device_count], path);
 #endif
 		m_active_device_count++;
 	}
-	pclose(pf);
+	free(entries);
 }
 #endif
 
@@ -0,0 +1,103 @@
+/*
+ * Xorshift64Simd.cpp
+ * Ver 1.0
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ Xorshift64 (Marsaglia's PPRNG method) post processing of several 64 bit words at once.
+
+ This code may only be used in conjunction with TectroLabs devices.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#include <PostProcessingKernels.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+ #include <immintrin.h>
+#endif
+
+namespace swiftrng {
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#if defined(__GNUC__) && !defined(__clang__)
+ // GCC reports the self initialized `undefined` vectors of its own AVX-512 intrinsics
+ #pragma GCC diagnostic ignored "-Wuninitialized"
+ #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+static const uint64_t c_xorshift64_multiplier = UINT64_C(2685821657736338717);
+
+/**
+ * Post process 4 words per iteration
+ *
+ * @param uint8_t* buffer - pointer to the words to post process in place
+ * @param int num_words - number of words in the buffer
+ * @return int - number of words processed, a multiple of 4
+ */
+__attribute__((target("avx2")))
+int xorshift64_avx2(uint8_t *buffer, int num_words) {
+	// AVX2 has no 64 bit multiply, it is composed of 32 x 32 bit products:
+	// x * m = lo(x) * lo(m) + ((hi(x) * lo(m) + lo(x) * hi(m)) << 32)
+	const __m256i mul_lo = _mm256_set1_epi64x((long long)(c_xorshift64_multiplier & 0xffffffff));
+	const __m256i mul_hi = _mm256_set1_epi64x((long long)(c_xorshift64_multiplier >> 32));
+	int i = 0;
+
+	for (; i + 4 <= num_words; i += 4) {
+		__m256i *p = (__m256i *)(buffer + i * 8);
+		__m256i x = _mm256_loadu_si256(p);
+		x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 12));
+		x = _mm256_xor_si256(x, _mm256_slli_epi64(x, 25));
+		x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 27));
+		__m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), mul_lo), _mm256_mul_epu32(x, mul_hi));
+		x = _mm256_add_epi64(_mm256_mul_epu32(x, mul_lo), _mm256_slli_epi64(cross, 32));
+		_mm256_storeu_si256(p, x);
+	}
+	return i;
+}
+
+/**
+ * Post process 8 words per iteration
+ *
+ * @param uint8_t* buffer - pointer to the words to post process in place
+ * @param int num_words - number of words in the buffer
+ * @return int - number of words processed, a multiple of 8
+ */
+__attribute__((target("avx512f,avx512dq")))
+int xorshift64_avx512(uint8_t *buffer, int num_words) {
+	const __m512i mul = _mm512_set1_epi64((long long)c_xorshift64_multiplier);
+	int i = 0;
+
+	for (; i + 8 <= num_words; i += 8) {
+		void *p = buffer + i * 8;
+		__m512i x = _mm512_loadu_si512(p);
+		x = _mm512_xor_si512(x, _mm512_srli_epi64(x, 12));
+		x = _mm512_xor_si512(x, _mm512_slli_epi64(x, 25));
+		x = _mm512_xor_si512(x, _mm512_srli_epi64(x, 27));
+		x = _mm512_mullo_epi64(x, mul);
+		_mm512_storeu_si512(p, x);
+	}
+	return i;
+}
+
+#else
+
+int xorshift64_avx2(uint8_t *, int) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+int xorshift64_avx512(uint8_t *, int) {
+	// Not available on this CPU architecture, never selected by CpuFeatures
+	return 0;
+}
+
+#endif
+
+} /* namespace swiftrng */
@@ -0,0 +1,540 @@
+/**
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ This file implements the client API of the entropy server.
+
+ */
+
+/**
+ *    @file entropy-server-api.c
+ *    @version 1.0
+ *
+ *    @brief Implements the client API of the entropy server.
+ */
+
+#include <entropy-server-api.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+static const int c_srv_conn_sig_begin = 23432;
+static const int c_srv_conn_sig_end = 68432;
+
+static const char connNotInitializedErrMsg[] = "SwrngServerConnection not initialized";
+static const char socketPathTooLongErrMsg[] = "Server socket path is too long";
+static const char requestSizeInvalidErrMsg[] = "Number of bytes requested is invalid";
+static const char serverClosedErrMsg[] = "Entropy server closed the connection";
+static const char ringInvalidErrMsg[] = "Entropy server ring is not compatible";
+
+/* Seconds to wait for a ring block before checking if the server is still running */
+static const int c_ring_wait_secs = 1;
+
+static int isConnectionInitialized(const SwrngServerConnection *conn);
+static void setErrorMessage(SwrngServerConnection *conn, const char *errMsg, int errNum);
+static int requestBytes(SwrngServerConnection *conn, uint32_t cmd, unsigned char *buffer, uint32_t length);
+static int sendAll(int fd, const void *data, size_t length);
+static int receiveAll(int fd, void *data, size_t length);
+static int receiveDescriptors(int fd, unsigned char *data, int *fds, int numFds);
+static int mapRing(SwrngServerConnection *conn, SwrngServerRing *ring, const int *fds);
+
+
+/**
+* Check if the connection context is initialized
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @return int - 1 when initialized
+*/
+static int isConnectionInitialized(const SwrngServerConnection *conn) {
+	return conn != NULL && conn->sig_begin == c_srv_conn_sig_begin && conn->sig_end == c_srv_conn_sig_end;
+}
+
+/**
+* Record an error message
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param errMsg - the error message
+* @param errNum - errno value describing the error, 0 if none
+*/
+static void setErrorMessage(SwrngServerConnection *conn, const char *errMsg, int errNum) {
+	if (errNum != 0) {
+		snprintf(conn->last_err_msg, sizeof(conn->last_err_msg), "%s: %s", errMsg, strerror(errNum));
+	} else {
+		snprintf(conn->last_err_msg, sizeof(conn->last_err_msg), "%s", errMsg);
+	}
+}
+
+/*
+* API functions
+*/
+
+int swrngInitializeServerConnection(SwrngServerConnection *conn, const char *socketPath) {
+	if (conn == NULL) {
+		return -1;
+	}
+	if (socketPath == NULL) {
+		socketPath = SWRNG_SERVER_DEFAULT_SOCKET_PATH;
+	}
+	memset(conn, 0, sizeof(SwrngServerConnection));
+	conn->fd = -1;
+	if (strlen(socketPath) >= sizeof(conn->socket_path)) {
+		setErrorMessage(conn, socketPathTooLongErrMsg, 0);
+		return -1;
+	}
+	strcpy(conn->socket_path, socketPath);
+	conn->sig_begin = c_srv_conn_sig_begin;
+	conn->sig_end = c_srv_conn_sig_end;
+	return SWRNG_SUCCESS;
+}
+
+int swrngConnectServer(SwrngServerConnection *conn) {
+	struct sockaddr_un addr;
+
+	if (!isConnectionInitialized(conn)) {
+		return -1;
+	}
+	if (conn->fd != -1) {
+		return SWRNG_SUCCESS;
+	}
+
+	conn->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (conn->fd == -1) {
+		setErrorMessage(conn, "Could not create a socket", errno);
+		return -1;
+	}
+#ifdef SO_NOSIGPIPE
+	int on = 1;
+	setsockopt(conn->fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, conn->socket_path);
+	if (connect(conn->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		setErrorMessage(conn, "Could not connect to the entropy server, is it running?", errno);
+		swrngDisconnectServer(conn);
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+void swrngDisconnectServer(SwrngServerConnection *conn) {
+	if (isConnectionInitialized(conn) && conn->fd != -1) {
+		close(conn->fd);
+		conn->fd = -1;
+	}
+}
+
+int swrngGetServerEntropy(SwrngServerConnection *conn, unsigned char *buffer, long length) {
+	long chunk;
+
+	if (!isConnectionInitialized(conn)) {
+		return -1;
+	}
+	if (buffer == NULL || length <= 0) {
+		setErrorMessage(conn, requestSizeInvalidErrMsg, 0);
+		return -1;
+	}
+	for (long total = 0; total < length; total += chunk) {
+		chunk = length - total;
+		if (chunk > SWRNG_SERVER_MAX_REPLY_BYTES) {
+			chunk = SWRNG_SERVER_MAX_REPLY_BYTES;
+		}
+		int status = requestBytes(conn, CMD_ENTROPY_RETRIEVE_ID, buffer + total, (uint32_t)chunk);
+		if (status != SWRNG_SUCCESS) {
+			return status;
+		}
+	}
+	return SWRNG_SUCCESS;
+}
+
+int swrngGetServerTestBytes(SwrngServerConnection *conn, unsigned char *buffer, long length) {
+	if (!isConnectionInitialized(conn)) {
+		return -1;
+	}
+	if (buffer == NULL || length <= 0 || length > SWRNG_SERVER_MAX_REPLY_BYTES) {
+		setErrorMessage(conn, requestSizeInvalidErrMsg, 0);
+		return -1;
+	}
+	return requestBytes(conn, CMD_DIAG_ID, buffer, (uint32_t)length);
+}
+
+int swrngGetServerDeviceSerialNumber(SwrngServerConnection *conn, DeviceSerialNumber *serialNumber) {
+	unsigned char reply[SWRNG_SERVER_SER_NUM_BYTES];
+
+	if (!isConnectionInitialized(conn) || serialNumber == NULL) {
+		return -1;
+	}
+	int status = requestBytes(conn, CMD_DEV_SER_NUM_ID, reply, sizeof(reply));
+	if (status == SWRNG_SUCCESS) {
+		int len = (int)sizeof(serialNumber->value) - 1;
+		while (len > 0 && (reply[len - 1] == ' ' || reply[len - 1] == '\0')) {
+			len--;
+		}
+		memcpy(serialNumber->value, reply, len);
+		serialNumber->value[len] = '\0';
+	}
+	return status;
+}
+
+int swrngGetServerDeviceModel(SwrngServerConnection *conn, DeviceModel *model) {
+	unsigned char reply[SWRNG_SERVER_MODEL_BYTES];
+
+	if (!isConnectionInitialized(conn) || model == NULL) {
+		return -1;
+	}
+	int status = requestBytes(conn, CMD_DEV_MODEL_ID, reply, sizeof(reply));
+	if (status == SWRNG_SUCCESS) {
+		int len = (int)sizeof(model->value) - 1;
+		while (len > 0 && (reply[len - 1] == ' ' || reply[len - 1] == '\0')) {
+			len--;
+		}
+		memcpy(model->value, reply, len);
+		model->value[len] = '\0';
+	}
+	return status;
+}
+
+int swrngGetServerDeviceVersion(SwrngServerConnection *conn, int *majorVersion, int *minorVersion) {
+	unsigned char major;
+	unsigned char minor;
+
+	if (!isConnectionInitialized(conn) || majorVersion == NULL || minorVersion == NULL) {
+		return -1;
+	}
+	int status = requestBytes(conn, CMD_DEV_MAJOR_VERSION_ID, &major, 1);
+	if (status == SWRNG_SUCCESS) {
+		status = requestBytes(conn, CMD_DEV_MINOR_VERSION_ID, &minor, 1);
+	}
+	if (status == SWRNG_SUCCESS) {
+		*majorVersion = major;
+		*minorVersion = minor;
+	}
+	return status;
+}
+
+int swrngGetServerVersion(SwrngServerConnection *conn, int *majorVersion, int *minorVersion) {
+	unsigned char major;
+	unsigned char minor;
+
+	if (!isConnectionInitialized(conn) || majorVersion == NULL || minorVersion == NULL) {
+		return -1;
+	}
+	int status = requestBytes(conn, CMD_SERV_MAJOR_VERSION_ID, &major, 1);
+	if (status == SWRNG_SUCCESS) {
+		status = requestBytes(conn, CMD_SERV_MINOR_VERSION_ID, &minor, 1);
+	}
+	if (status == SWRNG_SUCCESS) {
+		*majorVersion = major;
+		*minorVersion = minor;
+	}
+	return status;
+}
+
+int swrngAttachServerRing(SwrngServerConnection *conn, SwrngServerRing *ring) {
+	SwrngServerRequest request;
+	unsigned char reply;
+	int fds[SWRNG_SERVER_RING_NUM_FILES];
+
+	if (!isConnectionInitialized(conn) || ring == NULL) {
+		return -1;
+	}
+	memset(ring, 0, sizeof(SwrngServerRing));
+	ring->server_fd = -1;
+	if (swrngConnectServer(conn) != SWRNG_SUCCESS) {
+		return -1;
+	}
+	request.cmd = CMD_RING_ATTACH_ID;
+	request.cbReqData = sizeof(reply);
+	if (sendAll(conn->fd, &request, sizeof(request)) != SWRNG_SUCCESS) {
+		setErrorMessage(conn, "Could not send a request to the entropy server", errno);
+		swrngDisconnectServer(conn);
+		return -1;
+	}
+	int status = receiveDescriptors(conn->fd, &reply, fds, SWRNG_SERVER_RING_NUM_FILES);
+	if (status != SWRNG_SUCCESS) {
+		if (status > 0) {
+			setErrorMessage(conn, serverClosedErrMsg, 0);
+		} else {
+			setErrorMessage(conn, "Could not receive the ring from the entropy server", errno);
+		}
+		swrngDisconnectServer(conn);
+		return -1;
+	}
+	status = mapRing(conn, ring, fds);
+	for (int i = 0; i < SWRNG_SERVER_RING_NUM_FILES; i++) {
+		close(fds[i]);
+	}
+	return status;
+}
+
+void swrngDetachServerRing(SwrngServerRing *ring) {
+	if (ring == NULL) {
+		return;
+	}
+	if (ring->claims != NULL) {
+		munmap(ring->claims, sizeof(SwrngServerRingClaims));
+		ring->claims = NULL;
+	}
+	if (ring->state != NULL) {
+		munmap((void *)ring->state, sizeof(SwrngServerRingState));
+		ring->state = NULL;
+	}
+	if (ring->data != NULL) {
+		munmap((void *)ring->data, (size_t)SWRNG_SERVER_RING_BLOCK_SIZE * SWRNG_SERVER_RING_NUM_BLOCKS);
+		ring->data = NULL;
+	}
+	if (ring->server_fd != -1) {
+		close(ring->server_fd);
+		ring->server_fd = -1;
+	}
+}
+
+int swrngWaitServerRing(SwrngServerRing *ring, uint64_t blockNum) {
+	const SwrngServerRingState *state = ring->state;
+	struct timespec timeout = {c_ring_wait_secs, 0};
+	struct pollfd pfd;
+
+	__atomic_fetch_add(&ring->claims->num_data_waiters, 1, __ATOMIC_SEQ_CST);
+	uint32_t seq = __atomic_load_n(&state->data_futex, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&state->write_pos, __ATOMIC_SEQ_CST) <= blockNum) {
+		/* Waiting only reads the futex word, which works on the read-only mapping */
+		syscall(SYS_futex, &state->data_futex, FUTEX_WAIT, seq, &timeout, NULL, 0);
+	}
+	__atomic_fetch_sub(&ring->claims->num_data_waiters, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&state->write_pos, __ATOMIC_ACQUIRE) > blockNum) {
+		return SWRNG_SUCCESS;
+	}
+
+	/* Still nothing, give up if the server closed the connection */
+	pfd.fd = ring->server_fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	if (poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLHUP | POLLERR | POLLNVAL))) {
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+void swrngWakeServerRing(SwrngServerRing *ring) {
+	__atomic_fetch_add(&ring->claims->space_futex, 1, __ATOMIC_SEQ_CST);
+	syscall(SYS_futex, &ring->claims->space_futex, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+const char* swrngGetServerLastErrorMessage(SwrngServerConnection *conn) {
+	if (!isConnectionInitialized(conn)) {
+		return connNotInitializedErrMsg;
+	}
+	return conn->last_err_msg;
+}
+
+/**
+* Send a request to the server and receive the reply, connecting first if needed.
+* The connection is closed on failure, so the next request starts over with a new connection.
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param cmd - command id
+* @param buffer - pointer to the reply buffer
+* @param length - number of bytes expected in the reply
+* @return int - 0 when the reply was received
+*/
+static int requestBytes(SwrngServerConnection *conn, uint32_t cmd, unsigned char *buffer, uint32_t length) {
+	SwrngServerRequest request;
+
+	if (swrngConnectServer(conn) != SWRNG_SUCCESS) {
+		return -1;
+	}
+	request.cmd = cmd;
+	request.cbReqData = length;
+	if (sendAll(conn->fd, &request, sizeof(request)) != SWRNG_SUCCESS) {
+		setErrorMessage(conn, "Could not send a request to the entropy server", errno);
+		swrngDisconnectServer(conn);
+		return -1;
+	}
+	int status = receiveAll(conn->fd, buffer, length);
+	if (status != SWRNG_SUCCESS) {
+		if (status > 0) {
+			setErrorMessage(conn, serverClosedErrMsg, 0);
+		} else {
+			setErrorMessage(conn, "Could not receive a reply from the entropy server", errno);
+		}
+		swrngDisconnectServer(conn);
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Send all the bytes to the socket
+*
+* @param fd - socket
+* @param data - pointer to the bytes
+* @param length - number of bytes
+* @return int - 0 when sent, -1 with errno set otherwise
+*/
+static int sendAll(int fd, const void *data, size_t length) {
+	const unsigned char *bytes = (const unsigned char *)data;
+	while (length > 0) {
+		ssize_t sent = send(fd, bytes, length, MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		bytes += sent;
+		length -= (size_t)sent;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Receive the given number of bytes from the socket
+*
+* @param fd - socket
+* @param data - pointer to the receive buffer
+* @param length - number of bytes
+* @return int - 0 when received, 1 when the peer closed the connection, -1 with errno set otherwise
+*/
+static int receiveAll(int fd, void *data, size_t length) {
+	unsigned char *bytes = (unsigned char *)data;
+	while (length > 0) {
+		ssize_t received = recv(fd, bytes, length, 0);
+		if (received == 0) {
+			return 1;
+		}
+		if (received < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		bytes += received;
+		length -= (size_t)received;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Receive bytes together with file descriptors from the socket
+*
+* @param fd - socket
+* @param data - pointer to the receive buffer of one byte
+* @param fds - pointer to the array receiving the file descriptors
+* @param numFds - number of file descriptors expected, up to 2
+* @return int - 0 when received, 1 when the peer closed the connection, -1 otherwise
+*/
+static int receiveDescriptors(int fd, unsigned char *data, int *fds, int numFds) {
+	union {
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(SWRNG_SERVER_RING_NUM_FILES * sizeof(int))];
+	} control;
+	struct iovec iov;
+	struct msghdr msg;
+	ssize_t received;
+
+	iov.iov_base = data;
+	iov.iov_len = 1;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+	do {
+		received = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+	} while (received < 0 && errno == EINTR);
+	if (received == 0) {
+		return 1;
+	}
+	if (received < 0) {
+		return -1;
+	}
+
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	if (cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+		errno = EPROTO;
+		return -1;
+	}
+	int numReceived = (int)((cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+	memcpy(fds, CMSG_DATA(cmsg), numReceived * sizeof(int));
+	if (numReceived != numFds) {
+		for (int i = 0; i < numReceived; i++) {
+			close(fds[i]);
+		}
+		errno = EPROTO;
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Map the ring files received from the server and check the ring layout
+*
+* @param conn - pointer to SwrngServerConnection structure
+* @param ring - pointer to SwrngServerRing structure
+* @param fds - files of the claims, mapped read-write, of the ring state and of the blocks, mapped read-only
+* @return int - 0 when mapped
+*/
+static int mapRing(SwrngServerConnection *conn, SwrngServerRing *ring, const int *fds) {
+	size_t dataSize = (size_t)SWRNG_SERVER_RING_BLOCK_SIZE * SWRNG_SERVER_RING_NUM_BLOCKS;
+	size_t sizes[SWRNG_SERVER_RING_NUM_FILES] = {sizeof(SwrngServerRingClaims), sizeof(SwrngServerRingState), dataSize};
+	struct stat st;
+
+	for (int i = 0; i < SWRNG_SERVER_RING_NUM_FILES; i++) {
+		if (fstat(fds[i], &st) != 0 || (size_t)st.st_size < sizes[i]) {
+			setErrorMessage(conn, ringInvalidErrMsg, 0);
+			return -1;
+		}
+	}
+	void *claims = mmap(NULL, sizes[0], PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+	if (claims == MAP_FAILED) {
+		setErrorMessage(conn, "Could not map the entropy server ring", errno);
+		return -1;
+	}
+	ring->claims = (SwrngServerRingClaims *)claims;
+	void *state = mmap(NULL, sizes[1], PROT_READ, MAP_SHARED, fds[1], 0);
+	if (state == MAP_FAILED) {
+		setErrorMessage(conn, "Could not map the entropy server ring", errno);
+		swrngDetachServerRing(ring);
+		return -1;
+	}
+	ring->state = (const SwrngServerRingState *)state;
+	void *data = mmap(NULL, sizes[2], PROT_READ, MAP_SHARED, fds[2], 0);
+	if (data == MAP_FAILED) {
+		setErrorMessage(conn, "Could not map the entropy server ring", errno);
+		swrngDetachServerRing(ring);
+		return -1;
+	}
+	ring->data = (const unsigned char *)data;
+
+	if (ring->state->magic != SWRNG_SERVER_RING_MAGIC || ring->state->version != SWRNG_SERVER_RING_VERSION
+			|| ring->state->block_size != SWRNG_SERVER_RING_BLOCK_SIZE || ring->state->num_blocks != SWRNG_SERVER_RING_NUM_BLOCKS) {
+		setErrorMessage(conn, ringInvalidErrMsg, 0);
+		swrngDetachServerRing(ring);
+		return -1;
+	}
+	ring->server_fd = fcntl(conn->fd, F_DUPFD_CLOEXEC, 0);
+	if (ring->server_fd == -1) {
+		setErrorMessage(conn, "Could not duplicate the server connection", errno);
+		swrngDetachServerRing(ring);
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
@@ -26,36 +26,62 @@
 
  +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+/* For the CPU affinity of the download threads */
+#define _GNU_SOURCE
+#endif
+
 #include <swrng-cl-api.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+#include <ctype.h>
 
 /**
  * Error messages
  */
 static const char clusterAlreadyOpenErrMsg[] = "Cluster already open";
 static const char clusterNotOpenErrMsg[] = "Cluster not open";
-static const char clusterSizeInvalidErrMsg[] = "Cluster size must be between 1 and 10";
+static const char clusterSizeInvalidErrMsg[] = "Cluster size must be between 1 and 64";
 static const char clusterNotAvailableErrMsg[] =  "Failed to form a cluster, check for available SwiftRNG devices";
 static const char lowMemoryErrMsg[] =  "Cannot allocate a memory block to continue";
 static const char leakMemoryErrMsg[] = "Memory block already allocated";
 static const char ctxtNotInitializedErrMsg[] = "SwrngCLContext not initialized";
-static const char needMoreCPUsErrMsg[] = "Need more CPUs available to continue";
 static const char threadCreationErrMsg[] = "Thread creation error";
-#ifdef _WIN32
-static const char eventCreationErrMsg[] = "Event creation error";
+static const char slotInvalidErrMsg[] = "Slot number must be between 0 and 63";
+static const char cpuListInvalidErrMsg[] = "Invalid CPU list";
+static const char numaNodeInvalidErrMsg[] = "NUMA node not found or it has no CPUs";
+static const char threadAffinityErrMsg[] = "Could not set the CPU affinity of a download thread";
+#ifndef __linux__
+static const char threadAffinityNotSupportedErrMsg[] = "CPU affinity not supported on this platform";
 #endif
 
 static const char eventSynchErrMsg[] = "Event synchronization error";
 
+/* Size of each ring slot filled by a download thread */
 static const long c_out_data_buff_size = 100000L;
 
-/* Seconds to wait before starting the fail-over event after device errors are detected */
+/* Number of ring slots per device, the download threads keep working while the consumers drain the others */
+static const int c_ring_slots_per_device = 4;
+
+/* Max number of ring slots. Large clusters fill slots faster than the consumers drain them, so more slots
+ * would only hold more bytes in memory. */
+static const int c_max_ring_slots = 32;
+
+/* Weight of the latest download in the moving average of a device download rate */
+static const double c_dwnl_rate_weight = 0.125;
+
+/* Seconds to wait before looking for a device again after a device error or a failed look up */
 static const int c_cl_failover_wait_secs = 6;
 
-/* Seconds to wait before trying to re-cluster to get the preferred size */
-static const int c_cl_resize_wait_secs = 60 * 60;
+/* Seconds to wait before looking for a device again while a device just plugged in may still be getting ready */
+static const double c_cl_hotplug_retry_secs = 0.2;
+
+/* How long a device just plugged in may take to get ready, in seconds */
+static const double c_cl_hotplug_window_secs = 3;
 
-/* A cluster size beyond 10 has not been tested yet */
-static const int c_max_sl_size = 10;
+/* Max cluster size, the download threads mostly wait for their USB transfers so many of them share a CPU */
+static const int c_max_sl_size = SWRNG_CL_MAX_SIZE;
 
 /* Context sanity check markers */
 static const int c_cl_ctxt_sig_begin = 12321;
@@ -71,28 +97,75 @@ static const int c_cl_api_false = 0;
 /**
  * Declarations for local functions
  */
-static void wait_seconds(int seconds);
+static double cl_time_secs(void);
+static void update_download_rate(SwrngThreadContext *tctxt, double elapsedSecs);
 static int isContextCLInitialized(const SwrngCLContext *ctxt);
-static int isItTimeToResizeCluster(const SwrngCLContext *ctxt);
 static int initializeCLContext(SwrngCLContext *ctxt);
 static void printCLErrorMessage(SwrngCLContext *ctxt, const char* errMsg);
 static void freeAllocatedMemory(SwrngCLContext *ctxt);
 static int allocateMemory(SwrngCLContext *ctxt);
-static int getEntropyBytes(SwrngCLContext *ctxt);
+static unsigned char *allocateBufferMemory(size_t size);
+static void freeBufferMemory(unsigned char *buff, size_t size);
+static int parseCpuList(const char *cpuList, SwrngCLCpuSet *cpus);
+static int isCpuSetEmpty(const SwrngCLCpuSet *cpus);
+static int setCLThreadCpus(SwrngCLContext *ctxt, int slot, const SwrngCLCpuSet *cpus);
+#ifdef __linux__
+static void toNativeCpuSet(const SwrngCLCpuSet *cpus, cpu_set_t *nativeCpus);
+#endif
+static int getEntropyBytes(SwrngCLContext *ctxt, unsigned char *buffer, long length, long *act);
+static int waitForRingSlot(SwrngCLContext *ctxt, SwrngCLSlot *slot, uint64_t filledSeq, int *retval);
+static int publishRingSlot(SwrngCLContext *ctxt, unsigned char **data);
+static void resetRing(SwrngCLContext *ctxt);
 static int setCLPowerProfile(SwrngCLContext *ctxt, int ppNum);
+static int openCluster(SwrngCLContext *ctxt, int cluster_size);
+static int closeCluster(SwrngCLContext *ctxt);
+static int openClusterDevice(SwrngCLContext *ctxt, SwrngThreadContext *tctxt);
+static int openListedDevice(SwrngCLContext *ctxt, SwrngThreadContext *tctxt, int numDevs,
+		volatile uint64_t *nextDevNum);
+static int closeClusterDevices(SwrngCLContext *ctxt);
+static void configureClusterDevice(SwrngCLContext *ctxt, SwrngContext *devCtxt);
+static void recordDownloadError(SwrngCLContext *ctxt, int status, const char *errMsg);
+static SwrngThreadContext *findClusterDevice(SwrngCLContext *ctxt, int devIdx);
+static void addLiveStatistics(DeviceLiveStatistics *total, const DeviceLiveStatistics *stats);
+static void addLatencyHistogram(LatencyHistogram *total, const LatencyHistogram *histogram);
+static void onDeviceEvent(void *arg, int arrived);
+static int lockOpenCluster(SwrngCLContext *ctxt);
 
 static void cleanup_download_thread(void *param);
 #ifndef _WIN32
 static void *download_thread(void *th_params);
 #else
 unsigned int __stdcall download_thread(void *th_params);
-static void errorCleanUpEventsAndThreads(SwrngCLContext *ctxt, int maxIndex);
 #endif
-static void wait_complete_download_req(const SwrngThreadContext *ctxt);
-static void wait_all_complete_download_reqs(const  SwrngCLContext *ctxt);
+static void download_loop(SwrngThreadContext *tctxt);
+static void notify_event(SwrngCLEvent *event);
+static void notifyRingSlotFreed(SwrngCLContext *ctxt);
+static void cl_event_init(SwrngCLEvent *event);
+static void cl_event_destroy(SwrngCLEvent *event);
+static void cl_mutex_init(SwrngCLMutex *mutex);
+static void cl_mutex_destroy(SwrngCLMutex *mutex);
+static void cl_mutex_lock(SwrngCLMutex *mutex);
+static void cl_mutex_unlock(SwrngCLMutex *mutex);
+static void cl_cond_init(SwrngCLCond *cond);
+static void cl_cond_destroy(SwrngCLCond *cond);
+static int cl_cond_wait(SwrngCLCond *cond, SwrngCLMutex *mutex);
+static void cl_cond_timedwait(SwrngCLCond *cond, SwrngCLMutex *mutex, double secs);
+static void cl_cond_broadcast(SwrngCLCond *cond);
+static void cl_cond_signal(SwrngCLCond *cond);
+static void cl_rwlock_init(SwrngCLRWLock *lock);
+static void cl_rwlock_rdlock(SwrngCLRWLock *lock);
+static void cl_rwlock_rdunlock(SwrngCLRWLock *lock);
+static void cl_rwlock_wrlock(SwrngCLRWLock *lock);
+static void cl_rwlock_wrunlock(SwrngCLRWLock *lock);
+static uint64_t cl_atomic_load(volatile uint64_t *value);
+static void cl_atomic_store(volatile uint64_t *value, uint64_t newValue);
+static int cl_atomic_cas(volatile uint64_t *value, uint64_t *expected, uint64_t desired);
+static uint64_t cl_atomic_fetch_add(volatile uint64_t *value, uint64_t addend);
+static void suspend_download_threads(SwrngCLContext *ctxt);
+static void resume_download_threads(SwrngCLContext *ctxt);
 static int initializeCLThreads(SwrngCLContext *ctxt);
+static void stopCLThreads(SwrngCLContext *ctxt, int numThreads);
 static void unInitializeCLThreads(SwrngCLContext *ctxt);
-static void trigger_download_reqs(SwrngCLContext *ctxt);
 static int getClusterDownloadStatus(SwrngCLContext *ctxt);
 static int disableCLPostProcessing(SwrngCLContext *ctxt);
 static int disableCLStatisticalTests(SwrngCLContext *ctxt);
@@ -118,64 +191,198 @@ const char* swrngGetCLLastErrorMessage(SwrngCLContext *ctxt) {
 }
 
 /**
-* Trigger a new download requests
+* A function to retrieve the status of the latest device failure and record its error message
 *
 * @param ctxt - pointer to SwrngCLContext structure
+* @return 0 - no device failed, otherwise the error code
+*
 */
-static void trigger_download_reqs(SwrngCLContext *ctxt) {
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		ctxt->tctxts[i].dwnl_req_active = c_cl_api_true;
-#ifndef _WIN32
-		pthread_cond_signal(&ctxt->tctxts[i].dwnl_synch);
-#else
-		SetEvent(ctxt->tctxts[i].dwnl_thread_event);
-#endif
+static int getClusterDownloadStatus(SwrngCLContext *ctxt) {
+	int retval;
+
+	cl_mutex_lock(&ctxt->space_event.mutex);
+	retval = ctxt->dwnl_err_status;
+	if (retval != SWRNG_SUCCESS) {
+		strcpy(ctxt->last_err_msg, ctxt->dwnl_err_msg);
 	}
+	cl_mutex_unlock(&ctxt->space_event.mutex);
+	return retval;
 }
 
 /**
-* A function to retrieve the cluster download status
+* A function to copy random bytes out of the cluster ring. The bytes are claimed with a single atomic
+* increment of the ring read position, so concurrent callers never receive the same bytes.
+* The caller must hold the cluster lock shared. When a consumer gave up waiting, fewer bytes than asked for
+* are copied and the caller retries once the ring is discarded.
 *
 * @param ctxt - pointer to SwrngCLContext structure
+* @param unsigned char *buffer - a pointer to the data receive buffer
+* @param long length - number of bytes to copy, no more than the size of a ring slot
+* @param long *act - pointer for storing the number of bytes copied
 * @return 0 - successful operation, otherwise the error code
 *
 */
-static int getClusterDownloadStatus(SwrngCLContext *ctxt) {
-	int retval = SWRNG_SUCCESS;
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		if (ctxt->tctxts[i].dwnl_status != SWRNG_SUCCESS) {
-			retval = ctxt->tctxts[i].dwnl_status;
-			if (retval == thread_event_err_id) {
-				strcpy(ctxt->last_err_msg, eventSynchErrMsg);
+static int getEntropyBytes(SwrngCLContext *ctxt, unsigned char *buffer, long length, long *act) {
+	SwrngCLSlot *slot;
+	uint64_t pos;
+	uint64_t slotPos;
+	long offset;
+	long chunk;
+	int retval;
+
+	*act = 0;
+	pos = cl_atomic_fetch_add(&ctxt->ring_read_pos, (uint64_t)length);
+	while (*act < length) {
+		slotPos = pos / c_out_data_buff_size;
+		offset = (long)(pos % c_out_data_buff_size);
+		chunk = c_out_data_buff_size - offset;
+		if (chunk > length - *act) {
+			chunk = length - *act;
+		}
+		slot = &ctxt->ring_slots[slotPos % ctxt->ring_num_slots];
+		if (cl_atomic_load(&slot->seq) != slotPos + 1
+				&& waitForRingSlot(ctxt, slot, slotPos + 1, &retval) == c_cl_api_false) {
+			/* The rest of the claim is never copied out, the ring gets discarded */
+			return retval;
+		}
+		memcpy(buffer + *act, slot->data + offset, chunk);
+		*act += chunk;
+		pos += chunk;
+		if (cl_atomic_fetch_add(&slot->consumed, (uint64_t)chunk) + chunk == (uint64_t)c_out_data_buff_size) {
+			/* All slot bytes copied out, hand the slot over to the download threads for the next round */
+			cl_atomic_store(&slot->seq, slotPos + ctxt->ring_num_slots);
+			notifyRingSlotFreed(ctxt);
+		}
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Wait for a download thread to fill a ring slot. The wait stops when no device came back in time, or when
+* another consumer gave up waiting: the slots with the bytes it claimed are never handed back, so the ring
+* positions a lap past them would never be filled until the ring is discarded.
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @param slot - pointer to the ring slot
+* @param filledSeq - slot sequence number once filled for the ring position wanted
+* @param retval - pointer for storing the error code when no device came back in time, 0 when the ring gets discarded
+* @return c_cl_api_true - the slot is filled, c_cl_api_false - stopped waiting
+*
+*/
+static int waitForRingSlot(SwrngCLContext *ctxt, SwrngCLSlot *slot, uint64_t filledSeq, int *retval) {
+	unsigned long seq;
+	double noDevicesSince = 0;
+	double waitSecs;
+	int numDevices;
+	int status;
+
+	while (1) {
+		/* Remember the notification count before looking, so no notification gets missed */
+		cl_mutex_lock(&ctxt->ready_event.mutex);
+		seq = ctxt->ready_event.seq;
+		cl_mutex_unlock(&ctxt->ready_event.mutex);
+
+		if (cl_atomic_load(&slot->seq) == filledSeq) {
+			return c_cl_api_true;
+		}
+		if (cl_atomic_load(&ctxt->ring_resets_pending) > 0) {
+			*retval = SWRNG_SUCCESS;
+			return c_cl_api_false;
+		}
+
+		cl_mutex_lock(&ctxt->space_event.mutex);
+		numDevices = ctxt->actual_cluster_size;
+		status = ctxt->dwnl_err_status;
+		cl_mutex_unlock(&ctxt->space_event.mutex);
+
+		/* Wait for as long as any device is left, otherwise give the download threads some time to find one */
+		waitSecs = -1;
+		if (numDevices == 0) {
+			if (noDevicesSince == 0) {
+				noDevicesSince = cl_time_secs();
 			}
-			else {
-				strcpy(ctxt->last_err_msg, swrngGetLastErrorMessage(&ctxt->tctxts[i].ctxt));
+			waitSecs = noDevicesSince + c_cl_failover_wait_secs - cl_time_secs();
+			if (waitSecs <= 0) {
+				*retval = status != SWRNG_SUCCESS ? status : -ENODEV;
+				return c_cl_api_false;
+			}
+		} else {
+			noDevicesSince = 0;
+		}
+
+		cl_mutex_lock(&ctxt->ready_event.mutex);
+		while (ctxt->ready_event.seq == seq) {
+			if (waitSecs < 0) {
+				cl_cond_wait(&ctxt->ready_event.synch, &ctxt->ready_event.mutex);
+			} else {
+				cl_cond_timedwait(&ctxt->ready_event.synch, &ctxt->ready_event.mutex, waitSecs);
+				break;
 			}
 		}
+		cl_mutex_unlock(&ctxt->ready_event.mutex);
 	}
-	return retval;
 }
 
 /**
-* A function to retrieve random bytes from a cluster
+* Publish the random bytes of a download thread buffer to the next ring slot. The buffer is swapped
+* with the one of the slot, so the bytes are never copied.
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @param data - pointer to the filled buffer, receives the buffer to fill next on success
+* @return c_cl_api_true - bytes published, c_cl_api_false - the ring is full
+*
+*/
+static int publishRingSlot(SwrngCLContext *ctxt, unsigned char **data) {
+	SwrngCLSlot *slot;
+	unsigned char *filled;
+	uint64_t pos;
+	uint64_t seq;
+
+	pos = cl_atomic_load(&ctxt->ring_write_pos);
+	while (1) {
+		slot = &ctxt->ring_slots[pos % ctxt->ring_num_slots];
+		seq = cl_atomic_load(&slot->seq);
+		if (seq == pos) {
+			if (cl_atomic_cas(&ctxt->ring_write_pos, &pos, pos + 1)) {
+				filled = *data;
+				*data = slot->data;
+				slot->data = filled;
+				slot->consumed = 0;
+				cl_atomic_store(&slot->seq, pos + 1);
+				return c_cl_api_true;
+			}
+		} else if (seq < pos) {
+			/* The consumers have not copied out the previous round of the slot yet */
+			return c_cl_api_false;
+		} else {
+			/* Another download thread claimed the position */
+			pos = cl_atomic_load(&ctxt->ring_write_pos);
+		}
+	}
+}
+
+/**
+* Discard the random bytes in the ring. Only called when the download threads are idle
+* and no consumer holds the cluster lock.
 *
 * @param ctxt - pointer to SwrngCLContext structure
-* @return 0 - successful operation, otherwise the error code
 *
 */
-static int getEntropyBytes(SwrngCLContext *ctxt) {
-	int retval = SWRNG_SUCCESS;
-	trigger_download_reqs(ctxt);
-	wait_all_complete_download_reqs(ctxt);
-	retval = getClusterDownloadStatus(ctxt);
-	if ( retval == SWRNG_SUCCESS) {
-		ctxt->cur_out_data_buff_idx = 0;
+static void resetRing(SwrngCLContext *ctxt) {
+	for (int i = 0; i < ctxt->ring_num_slots; i++) {
+		ctxt->ring_slots[i].seq = (uint64_t)i;
+		ctxt->ring_slots[i].consumed = 0;
 	}
-	return retval;
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		ctxt->tctxts[i].spare_filled = c_cl_api_false;
+	}
+	ctxt->ring_write_pos = 0;
+	ctxt->ring_read_pos = 0;
 }
 
 /**
-* A function to retrieve random bytes from a cluster of SwiftRNG devices
+* A function to retrieve random bytes from a cluster of SwiftRNG devices.
+* It may be called concurrently from several threads, each receiving distinct random bytes.
 *
 * @param ctxt - pointer to SwrngCLContext structure
 * @param unsigned char *buffer - a pointer to the data receive buffer
@@ -184,8 +391,8 @@ static int getEntropyBytes(SwrngCLContext *ctxt) {
 *
 */
 int swrngGetCLEntropy(SwrngCLContext *ctxt, unsigned char *buffer, long length) {
-	int retval = SWRNG_SUCCESS;
-	int status;
+	int retval;
+	long chunk;
 	long act;
 	long total;
 
@@ -195,53 +402,62 @@ int swrngGetCLEntropy(SwrngCLContext *ctxt, unsigned char *buffer, long length)
 	}
 
 	total = 0;
-	do {
-		if (ctxt->cur_out_data_buff_idx >= (ctxt->actual_cluster_size * c_out_data_buff_size)) {
-
-			if (isItTimeToResizeCluster(ctxt)) {
-				ctxt->num_cl_resize_events++;
-				swrngCLClose(ctxt);
-				wait_seconds(c_cl_failover_wait_secs);
-				status = swrngCLOpen(ctxt, ctxt->cluster_size);
-				if (status != SWRNG_SUCCESS) {
-					return status;
-				}
-			}
-			retval = getEntropyBytes(ctxt);
-			if (retval != SWRNG_SUCCESS) {
-				strcpy(ctxt->tmp_err_msg, ctxt->last_err_msg);
-				status = retval;
-				/* Got en error, restart the cluster */
-				ctxt->num_cl_failover_events++;
-				swrngCLClose(ctxt);
-				wait_seconds(c_cl_failover_wait_secs);
-				retval = swrngCLOpen(ctxt, ctxt->cluster_size);
-				if (retval != SWRNG_SUCCESS) {
-					strcpy(ctxt->last_err_msg, ctxt->tmp_err_msg);
-					return status;
-				}
-				retval = getEntropyBytes(ctxt);
-			}
+	while (total < length) {
+		chunk = length - total;
+		if (chunk > c_out_data_buff_size) {
+			chunk = c_out_data_buff_size;
+		}
+		act = 0;
+		cl_rwlock_rdlock(&ctxt->cl_lock);
+		if (ctxt->is_cluster_open != c_cl_api_true) {
+			cl_rwlock_rdunlock(&ctxt->cl_lock);
+			return -ENODEV;
 		}
-		if (retval == SWRNG_SUCCESS) {
-			act = (ctxt->actual_cluster_size * c_out_data_buff_size) - ctxt->cur_out_data_buff_idx;
-			if (act > (length - total)) {
-				act = (length - total);
+		retval = getEntropyBytes(ctxt, buffer + total, chunk, &act);
+		cl_rwlock_rdunlock(&ctxt->cl_lock);
+		total += act;
+
+		if (retval != SWRNG_SUCCESS) {
+			/* No device came back in time. Discard the ring bytes claimed by the consumers that gave up,
+			 * the download threads keep looking for devices. The consumers waiting for ring slots are woken
+			 * up first, they release the cluster lock and retry after the reset. */
+			cl_atomic_fetch_add(&ctxt->ring_resets_pending, 1);
+			notify_event(&ctxt->ready_event);
+			cl_rwlock_wrlock(&ctxt->cl_lock);
+			if (ctxt->is_cluster_open == c_cl_api_true) {
+				suspend_download_threads(ctxt);
+				resume_download_threads(ctxt);
+				getClusterDownloadStatus(ctxt);
 			}
-			memcpy(buffer + total, ctxt->out_data_buff + ctxt->cur_out_data_buff_idx, act);
-			ctxt->cur_out_data_buff_idx += act;
-			total += act;
-		} else {
-			break;
+			cl_atomic_fetch_add(&ctxt->ring_resets_pending, (uint64_t)-1);
+			cl_rwlock_wrunlock(&ctxt->cl_lock);
+			return retval;
 		}
-	} while (total < length);
-#ifdef inDebugMode
-	if (total > length) {
-		fprintf(stderr, "Expected %d bytes to read and actually got %d \n", (int)length, (int)total);
 	}
-#endif
 
-	return retval;
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Take the cluster lock exclusively if the cluster is open
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @return c_cl_api_true - the cluster is open and locked, c_cl_api_false - the cluster is not open
+*
+*/
+static int lockOpenCluster(SwrngCLContext *ctxt) {
+	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
+		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
+		return c_cl_api_false;
+	}
+	cl_rwlock_wrlock(&ctxt->cl_lock);
+	if (ctxt->is_cluster_open == c_cl_api_false) {
+		/* Closed by another thread in the meantime */
+		cl_rwlock_wrunlock(&ctxt->cl_lock);
+		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
+		return c_cl_api_false;
+	}
+	return c_cl_api_true;
 }
 
 /**
@@ -261,118 +477,96 @@ int swrngInitializeCLContext(SwrngCLContext *ctxt) {
 * @return int - 0 when processed successfully
 */
 int swrngCLOpen(SwrngCLContext *ctxt, int cluster_size) {
-	SwrngContext ctxtSearch;
-	DeviceInfoList devInfoList;
-	DeviceVersion version;
+	int status;
 
 	if (isContextCLInitialized(ctxt) == c_cl_api_false) {
 		initializeCLContext(ctxt);
-	} else {
-		if (swrngIsCLOpen(ctxt) == c_cl_api_true) {
-			printCLErrorMessage(ctxt, clusterAlreadyOpenErrMsg);
-			return -1;
-		}
-		if (cluster_size <= 0 || cluster_size > c_max_sl_size) {
-			printCLErrorMessage(ctxt, clusterSizeInvalidErrMsg);
-			return -1;
-		}
 	}
+	cl_rwlock_wrlock(&ctxt->cl_lock);
+	status = openCluster(ctxt, cluster_size);
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
+	return status;
+}
 
-	ctxt->cluster_size = cluster_size;
-#ifndef _WIN32
-	int numCores = (int)sysconf(_SC_NPROCESSORS_ONLN);
-	if (numCores <= cluster_size / 2) {
-		printCLErrorMessage(ctxt, needMoreCPUsErrMsg);
+/**
+* Open SwiftRNG USB cluster. The caller must hold the cluster lock exclusively.
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @param int cluster_size - preferred cluster size
+* @return int - 0 when processed successfully
+*/
+static int openCluster(SwrngCLContext *ctxt, int cluster_size) {
+	SwrngContext ctxtSearch;
+	int status;
+
+	if (swrngIsCLOpen(ctxt) == c_cl_api_true) {
+		printCLErrorMessage(ctxt, clusterAlreadyOpenErrMsg);
 		return -1;
 	}
-#endif
-	/* Look for compatible devices for the cluster */
-	swrngInitializeContext(&ctxtSearch);
-	int retVal = swrngGetDeviceList(&ctxtSearch, &devInfoList);
-	if (retVal != SWRNG_SUCCESS) {
-		swrngDestroyContext(&ctxtSearch);
-		return retVal;
-	}
-
-	if (devInfoList.numDevs == 0) {
-		printCLErrorMessage(ctxt, clusterNotAvailableErrMsg);
-		swrngDestroyContext(&ctxtSearch);
+	if (cluster_size <= 0 || cluster_size > c_max_sl_size) {
+		printCLErrorMessage(ctxt, clusterSizeInvalidErrMsg);
 		return -1;
 	}
+	memset(&ctxt->retired_stats, 0, sizeof(ctxt->retired_stats));
 
+	ctxt->cluster_size = cluster_size;
 	if (ctxt->tctxts != NULL) {
 		printCLErrorMessage(ctxt, leakMemoryErrMsg);
-		swrngDestroyContext(&ctxtSearch);
 		return -1;
 	}
 	ctxt->tctxts = (SwrngThreadContext *)calloc(ctxt->cluster_size, sizeof(SwrngThreadContext));
 	if (ctxt->tctxts == NULL) {
 		printCLErrorMessage(ctxt, lowMemoryErrMsg);
-		swrngDestroyContext(&ctxtSearch);
 		return -1;
 	}
 
+	/* The devices are counted once, then the download threads open them concurrently */
 	ctxt->actual_cluster_size = 0;
-	for (int i = 0; i < devInfoList.numDevs && ctxt->actual_cluster_size < ctxt->cluster_size; i++) {
-		swrngInitializeContext(&ctxt->tctxts[i].ctxt);
-		retVal = swrngOpen(&ctxt->tctxts[i].ctxt, devInfoList.devInfoList[i].devNum);
-		if (retVal != SWRNG_SUCCESS) {
-			swrngDestroyContext(&ctxt->tctxts[i].ctxt);
-			continue;
-		}
-		retVal = swrngGetVersion(&ctxt->tctxts[i].ctxt, &version);
-		if (retVal != SWRNG_SUCCESS) {
-			swrngDestroyContext(&ctxt->tctxts[i].ctxt);
-			continue;
-		}
-		if (i > ctxt->actual_cluster_size) {
-			ctxt->tctxts[ctxt->actual_cluster_size].ctxt = ctxt->tctxts[i].ctxt;
-		}
-		ctxt->actual_cluster_size++;
-	}
-
-	if (ctxt->actual_cluster_size == 0) {
+	ctxt->dwnl_err_status = SWRNG_SUCCESS;
+	swrngInitializeContext(&ctxtSearch);
+	status = swrngGetDeviceCount(&ctxtSearch, &ctxt->open_num_devs);
+	swrngDestroyContext(&ctxtSearch);
+	if (status != SWRNG_SUCCESS || ctxt->open_num_devs == 0) {
 		printCLErrorMessage(ctxt, clusterNotAvailableErrMsg);
-		swrngDestroyContext(&ctxtSearch);
 		freeAllocatedMemory(ctxt);
 		return -1;
 	}
 
-	int status = allocateMemory(ctxt);
+	status = allocateMemory(ctxt);
 	if ( status != SWRNG_SUCCESS) {
-		swrngDestroyContext(&ctxtSearch);
 		freeAllocatedMemory(ctxt);
 		return status;
 	}
 
-	swrngDestroyContext(&ctxtSearch);
-
-	ctxt->cur_out_data_buff_idx = ctxt->actual_cluster_size * c_out_data_buff_size;
+	ctxt->open_next_dev_num = 0;
+	ctxt->open_pending = ctxt->cluster_size;
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		ctxt->tctxts[i].open_on_start = c_cl_api_true;
+	}
 	status = initializeCLThreads(ctxt);
 	if ( status != SWRNG_SUCCESS) {
+		closeClusterDevices(ctxt);
 		freeAllocatedMemory(ctxt);
 		return status;
 	}
 
-	if (ctxt->ppn_changed == c_cl_api_true) {
-	 	/* Ignore the error */
-		setCLPowerProfile(ctxt, ctxt->ppn_number);
+	/* Wait for the devices available now, the download threads of the empty slots keep looking for more */
+	cl_mutex_lock(&ctxt->space_event.mutex);
+	while (ctxt->open_pending > 0) {
+		cl_cond_wait(&ctxt->idle_synch, &ctxt->space_event.mutex);
 	}
+	cl_mutex_unlock(&ctxt->space_event.mutex);
 
-	if (ctxt->data_post_process_enabled == c_cl_api_false) {
-		/* Ignore any error */
-		disableCLPostProcessing(ctxt);
-	} else {
-		if (ctxt->post_processing_method_id != -1) {
-			/* Ignore the error */
-			enableCLPostProcessing(ctxt, ctxt->post_processing_method_id);
-		}
+	if (ctxt->actual_cluster_size == 0) {
+		printCLErrorMessage(ctxt, clusterNotAvailableErrMsg);
+		unInitializeCLThreads(ctxt);
+		freeAllocatedMemory(ctxt);
+		return -1;
 	}
 
-	if (ctxt->stat_tests_enabled == c_cl_api_false) {
-		/* Ignore any error */
-		disableCLStatisticalTests(ctxt);
-	}
+	/* Without device events the empty slots still find the devices plugged in, only later */
+	ctxt->dev_monitor_running = swrngStartDeviceMonitor(&ctxt->dev_monitor, onDeviceEvent, ctxt) == SWRNG_SUCCESS
+			? c_cl_api_true : c_cl_api_false;
 
 	ctxt->cl_start_time_secs = time(NULL);
 	ctxt->is_cluster_open = c_cl_api_true;
@@ -380,6 +574,105 @@ int swrngCLOpen(SwrngCLContext *ctxt, int cluster_size) {
 	return SWRNG_SUCCESS;
 }
 
+/**
+ * Open the first available device that is not in use yet and configure it with the cluster settings
+ *
+ * @param ctxt - pointer to SwrngCLContext structure
+ * @param tctxt - pointer to the SwrngThreadContext structure of an empty slot
+ * @return int - 0 when a device was open
+ */
+static int openClusterDevice(SwrngCLContext *ctxt, SwrngThreadContext *tctxt) {
+	SwrngContext ctxtSearch;
+	volatile uint64_t nextDevNum = 0;
+	int numDevs;
+	int retVal;
+
+	swrngInitializeContext(&ctxtSearch);
+	retVal = swrngGetDeviceCount(&ctxtSearch, &numDevs);
+	swrngDestroyContext(&ctxtSearch);
+	if (retVal != SWRNG_SUCCESS) {
+		return retVal;
+	}
+	return openListedDevice(ctxt, tctxt, numDevs, &nextDevNum);
+}
+
+/**
+ * Open the first device not in use yet among the devices counted, trying the device numbers claimed from a counter
+ * in turn, and configure it with the cluster settings
+ *
+ * @param ctxt - pointer to SwrngCLContext structure
+ * @param tctxt - pointer to the SwrngThreadContext structure of an empty slot
+ * @param numDevs - number of devices counted
+ * @param nextDevNum - pointer to the next device number to try, shared by the threads opening devices concurrently
+ * @return int - 0 when a device was open
+ */
+static int openListedDevice(SwrngCLContext *ctxt, SwrngThreadContext *tctxt, int numDevs,
+		volatile uint64_t *nextDevNum) {
+	DeviceVersion version;
+	uint64_t devNum;
+	int retVal;
+
+	/* Devices used by the other slots fail to open */
+	while ((devNum = cl_atomic_fetch_add(nextDevNum, 1)) < (uint64_t)numDevs) {
+		swrngInitializeContext(&tctxt->ctxt);
+		retVal = swrngOpen(&tctxt->ctxt, (int)devNum);
+		if (retVal == SWRNG_SUCCESS) {
+			retVal = swrngGetVersion(&tctxt->ctxt, &version);
+		}
+		if (retVal == SWRNG_SUCCESS) {
+			configureClusterDevice(ctxt, &tctxt->ctxt);
+			tctxt->dwnl_rate = 0;
+			return SWRNG_SUCCESS;
+		}
+		swrngDestroyContext(&tctxt->ctxt);
+	}
+	return -1;
+}
+
+/**
+ * Apply the power profile, post processing and statistical tests settings of the cluster to a device
+ *
+ * @param ctxt - pointer to SwrngCLContext structure
+ * @param devCtxt - pointer to the SwrngContext structure of the device
+ */
+static void configureClusterDevice(SwrngCLContext *ctxt, SwrngContext *devCtxt) {
+	/* Ignore any error */
+	if (ctxt->ppn_changed == c_cl_api_true) {
+		swrngSetPowerProfile(devCtxt, ctxt->ppn_number);
+	}
+	if (ctxt->data_post_process_enabled == c_cl_api_false) {
+		swrngDisablePostProcessing(devCtxt);
+	} else if (ctxt->post_processing_method_id != -1) {
+		swrngEnablePostProcessing(devCtxt, ctxt->post_processing_method_id);
+	}
+	if (ctxt->stat_tests_enabled == c_cl_api_false) {
+		swrngDisableStatisticalTests(devCtxt);
+	}
+}
+
+/**
+ * Close the devices of all slots
+ *
+ * @param ctxt - pointer to SwrngCLContext structure
+ * @return int - 0 when processed successfully
+ */
+static int closeClusterDevices(SwrngCLContext *ctxt) {
+	int retVal = SWRNG_SUCCESS;
+	int status;
+
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		if (ctxt->tctxts[i].dev_open == c_cl_api_true) {
+			status = swrngDestroyContext(&ctxt->tctxts[i].ctxt);
+			if (status != SWRNG_SUCCESS) {
+				retVal = status;
+			}
+			ctxt->tctxts[i].dev_open = c_cl_api_false;
+		}
+	}
+	ctxt->actual_cluster_size = 0;
+	return retVal;
+}
+
 /**
  * Initialize cluster threads
  *
@@ -389,94 +682,95 @@ int swrngCLOpen(SwrngCLContext *ctxt, int cluster_size) {
 static int initializeCLThreads(SwrngCLContext *ctxt) {
 	int status = SWRNG_SUCCESS;
 
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		ctxt->tctxts[i].destroy_dwnl_thread_req = c_cl_api_false;
-		ctxt->tctxts[i].dwnl_req_active = c_cl_api_false;
-		ctxt->tctxts[i].dwnl_status = SWRNG_SUCCESS;
-		ctxt->tctxts[i].thread_device_data_buffer = ctxt->out_data_buff + (i * c_out_data_buff_size);
+	cl_event_init(&ctxt->ready_event);
+	cl_event_init(&ctxt->space_event);
+	cl_cond_init(&ctxt->idle_synch);
+	cl_cond_init(&ctxt->full_synch);
+	cl_mutex_init(&ctxt->probe_mutex);
+	resetRing(ctxt);
+
+	/* A thread for each slot, including the empty ones */
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		SwrngThreadContext *tctxt = &ctxt->tctxts[i];
+		tctxt->destroy_dwnl_thread_req = c_cl_api_false;
+		tctxt->dwnl_req_active = c_cl_api_false;
+		tctxt->dwnl_suspended = c_cl_api_false;
+		tctxt->dwnl_status = tctxt->dev_open == c_cl_api_true ? SWRNG_SUCCESS : -ENODEV;
+		tctxt->next_probe_secs = tctxt->open_on_start == c_cl_api_true ? 0 : cl_time_secs() + c_cl_failover_wait_secs;
+		tctxt->hotplug_deadline_secs = 0;
+		tctxt->cl_ctxt = ctxt;
 #ifndef _WIN32
-		pthread_mutex_init(&ctxt->tctxts[i].dwnl_mutex, NULL);
-		pthread_cond_init(&ctxt->tctxts[i].dwnl_synch, NULL);
-		int rc = pthread_create(&ctxt->tctxts[i].dwnl_thread, NULL, download_thread, (void*)&ctxt->tctxts[i]);
-		if (rc != 0) {
-			void *th_retval;
-			pthread_mutex_destroy(&ctxt->tctxts[i].dwnl_mutex);
-			pthread_cond_destroy(&ctxt->tctxts[i].dwnl_synch);
-			printCLErrorMessage(ctxt, threadCreationErrMsg);
-			for (int j = 0; j < i; j++) {
-				ctxt->tctxts[j].destroy_dwnl_thread_req = c_cl_api_true;
-				pthread_cond_signal(&ctxt->tctxts[j].dwnl_synch);
-				pthread_join(ctxt->tctxts[j].dwnl_thread, &th_retval);
-				pthread_mutex_destroy(&ctxt->tctxts[j].dwnl_mutex);
-				pthread_cond_destroy(&ctxt->tctxts[j].dwnl_synch);
-
-			}
-			return -1;
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+#ifdef __linux__
+		/* Start the thread on its CPUs, so the memory it touches first is allocated on their NUMA node */
+		if (isCpuSetEmpty(&ctxt->thread_cpus[i]) == c_cl_api_false) {
+			cpu_set_t cpus;
+			toNativeCpuSet(&ctxt->thread_cpus[i], &cpus);
+			pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
 		}
+#endif
+		int rc = pthread_create(&tctxt->dwnl_thread, &attr, download_thread, (void*)tctxt);
+		pthread_attr_destroy(&attr);
+		if (rc != 0) {
+			/* EINVAL when none of the thread CPUs is available */
+			printCLErrorMessage(ctxt, rc == EINVAL ? threadAffinityErrMsg : threadCreationErrMsg);
 #else
-		ctxt->tctxts[i].dwnl_thread_event = CreateEvent(NULL, FALSE, FALSE, TEXT("Thread Wakeup Event"));
-		if (ctxt->tctxts[i].dwnl_thread_event == NULL) {
-			printCLErrorMessage(ctxt, eventCreationErrMsg);
-			errorCleanUpEventsAndThreads(ctxt, i);
-			return -1;
-		}
-		ctxt->tctxts[i].dwnl_thread = (HANDLE)_beginthreadex(0, 0, &download_thread, (void*)&ctxt->tctxts[i], CREATE_SUSPENDED, 0);
-		if (ctxt->tctxts[i].dwnl_thread == NULL) {
-			CloseHandle(ctxt->tctxts[i].dwnl_thread_event);
+		tctxt->dwnl_thread = (HANDLE)_beginthreadex(0, 0, &download_thread, (void*)tctxt, 0, 0);
+		if (tctxt->dwnl_thread == NULL) {
 			printCLErrorMessage(ctxt, threadCreationErrMsg);
-			errorCleanUpEventsAndThreads(ctxt, i);
+#endif
+			stopCLThreads(ctxt, i);
 			return -1;
 		}
-		ResumeThread(ctxt->tctxts[i].dwnl_thread);
-#endif
 	}
 
 	return status;
 }
 
-#ifdef _WIN32
-/**
-* Clean up all previous threads and events 
-*
-* @param ctxt - pointer to SwrngCLContext structure
-* @param maxIndex - upper bound of threads and events to close
-*/
-static void errorCleanUpEventsAndThreads(SwrngCLContext *ctxt, int maxIndex) {
-	for (int j = 0; j < maxIndex; j++) {
-		ctxt->tctxts[j].destroy_dwnl_thread_req = c_cl_api_true;
-		SetEvent(ctxt->tctxts[j].dwnl_thread_event);
-		WaitForSingleObject(ctxt->tctxts[j].dwnl_thread, INFINITE);
-		CloseHandle(ctxt->tctxts[j].dwnl_thread);
-		CloseHandle(ctxt->tctxts[j].dwnl_thread_event);
-	}
-}
-#endif
-
 /**
- * Shutdown and clean up all threads
+ * Shutdown and clean up the first threads of the cluster
  *
  * @param ctxt - pointer to SwrngCLContext structure
+ * @param numThreads - number of threads to shut down
  */
-static void unInitializeCLThreads(SwrngCLContext *ctxt) {
+static void stopCLThreads(SwrngCLContext *ctxt, int numThreads) {
 #ifndef _WIN32
 	void *th_retval;
 #endif
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		wait_complete_download_req(&ctxt->tctxts[i]);
+	/* The threads stop once their device operations in progress complete */
+	cl_mutex_lock(&ctxt->space_event.mutex);
+	for (int i = 0; i < numThreads; i++) {
 		ctxt->tctxts[i].destroy_dwnl_thread_req = c_cl_api_true;
+	}
+	cl_cond_broadcast(&ctxt->space_event.synch);
+	cl_cond_broadcast(&ctxt->full_synch);
+	cl_mutex_unlock(&ctxt->space_event.mutex);
+
+	for (int i = 0; i < numThreads; i++) {
+		SwrngThreadContext *tctxt = &ctxt->tctxts[i];
 #ifndef _WIN32
-		pthread_cond_signal(&ctxt->tctxts[i].dwnl_synch);
-		pthread_join(ctxt->tctxts[i].dwnl_thread, &th_retval);
-		pthread_mutex_destroy(&ctxt->tctxts[i].dwnl_mutex);
-		pthread_cond_destroy(&ctxt->tctxts[i].dwnl_synch);
+		pthread_join(tctxt->dwnl_thread, &th_retval);
 #else
-		SetEvent(ctxt->tctxts[i].dwnl_thread_event);
-		WaitForSingleObject(ctxt->tctxts[i].dwnl_thread, INFINITE);
-		CloseHandle(ctxt->tctxts[i].dwnl_thread);
-		CloseHandle(ctxt->tctxts[i].dwnl_thread_event);
+		WaitForSingleObject(tctxt->dwnl_thread, INFINITE);
+		CloseHandle(tctxt->dwnl_thread);
 #endif
-		ctxt->tctxts[i].dwnl_req_active = c_cl_api_false;
+		tctxt->dwnl_req_active = c_cl_api_false;
 	}
+	cl_mutex_destroy(&ctxt->probe_mutex);
+	cl_cond_destroy(&ctxt->full_synch);
+	cl_cond_destroy(&ctxt->idle_synch);
+	cl_event_destroy(&ctxt->space_event);
+	cl_event_destroy(&ctxt->ready_event);
+}
+
+/**
+ * Shutdown and clean up all threads
+ *
+ * @param ctxt - pointer to SwrngCLContext structure
+ */
+static void unInitializeCLThreads(SwrngCLContext *ctxt) {
+	stopCLThreads(ctxt, ctxt->cluster_size);
 }
 
 /**
@@ -486,24 +780,37 @@ static void unInitializeCLThreads(SwrngCLContext *ctxt) {
  * @return int - 0 when processed successfully
  */
 int swrngCLClose(SwrngCLContext *ctxt) {
-
-	int retVal = SWRNG_SUCCESS;
 	int status;
 
+	if (lockOpenCluster(ctxt) == c_cl_api_false) {
+		return -1;
+	}
+	status = closeCluster(ctxt);
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
+	return status;
+}
+
+/**
+ * Close the cluster if open. The caller must hold the cluster lock exclusively.
+ *
+ * @param ctxt - pointer to SwrngCLContext structure
+ * @return int - 0 when processed successfully
+ */
+static int closeCluster(SwrngCLContext *ctxt) {
+	int retVal;
+
 	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
 		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
 		return -1;
 	}
 
+	if (ctxt->dev_monitor_running == c_cl_api_true) {
+		swrngStopDeviceMonitor(&ctxt->dev_monitor);
+		ctxt->dev_monitor_running = c_cl_api_false;
+	}
 	unInitializeCLThreads(ctxt);
 
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		/* Ignore the previous error */
-		status = swrngDestroyContext(&ctxt->tctxts[i].ctxt);
-		if (status != SWRNG_SUCCESS) {
-			retVal = status;
-		}
-	}
+	retVal = closeClusterDevices(ctxt);
 
 	freeAllocatedMemory(ctxt);
 	strcpy(ctxt->last_err_msg, "");
@@ -527,7 +834,8 @@ int swrngGetCLSize(const SwrngCLContext *ctxt) {
 
 /**
 * Retrieve number of cluster fail-over events. That number will be incremented each
-* time the cluster is trying to recover as a result of device errors.
+* time a device fails and is dropped from the cluster. The other devices keep serving
+* while the failed one is looked for again in the background.
 * @param ctxt - pointer to SwrngCLContext structure
 * @return - number of cluster fail-over events
 */
@@ -540,7 +848,7 @@ long swrngGetCLFailoverEventCount(const SwrngCLContext *ctxt) {
 
 /**
 * Retrieve number of cluster resize attempts. That number will be incremented each
-* time the cluster is trying to resize to reach the preferred size.
+* time the cluster is looking for a device in the background to reach the preferred size.
 * @param ctxt - pointer to SwrngCLContext structure
 * @return - number of cluster resize attempts
 */
@@ -554,26 +862,196 @@ long swrngGetCLResizeAttemptCount(const SwrngCLContext *ctxt) {
 
 
 /**
-* Allocated memory resources
+* Find the thread context of an open cluster device. Called with `space_event.mutex` held.
 *
 * @param ctxt - pointer to SwrngCLContext structure
-* @return int - 0 when processed successfully
+* @param devIdx - device index, 0 through swrngGetCLSize() - 1
+* @return - pointer to the thread context of the device, NULL if the device index is invalid
 */
-static int allocateMemory(SwrngCLContext *ctxt) {
-	int status = SWRNG_SUCCESS;
-
-	if (ctxt->out_data_buff != NULL) {
-		status = -1;
+static SwrngThreadContext *findClusterDevice(SwrngCLContext *ctxt, int devIdx) {
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		if (ctxt->tctxts[i].dev_open == c_cl_api_true && devIdx-- == 0) {
+			return &ctxt->tctxts[i];
+		}
 	}
+	return NULL;
+}
 
-	if (status != SWRNG_SUCCESS) {
-		printCLErrorMessage(ctxt, leakMemoryErrMsg);
-		return -1;
-	}
+/**
+* Retrieve the measured download rate of a cluster device, a moving average over its recent downloads.
+* The devices share the work, so each one contributes random bytes in proportion to its rate.
+* @param ctxt - pointer to SwrngCLContext structure
+* @param devIdx - device index, 0 through swrngGetCLSize() - 1
+* @return - download rate in bytes per second, 0 if not measured yet or the device index is invalid
+*/
+double swrngGetCLDeviceDownloadRate(SwrngCLContext *ctxt, int devIdx) {
+	SwrngThreadContext *tctxt;
+	double rate = 0;
 
-	ctxt->out_data_buff = (unsigned char *)calloc(ctxt->actual_cluster_size, c_out_data_buff_size);
-	if (ctxt->out_data_buff == NULL) {
-		status = -1;
+	if (swrngIsCLOpen(ctxt) != c_cl_api_true) {
+		return 0;
+	}
+	cl_rwlock_rdlock(&ctxt->cl_lock);
+	if (ctxt->is_cluster_open == c_cl_api_true) {
+		cl_mutex_lock(&ctxt->space_event.mutex);
+		tctxt = findClusterDevice(ctxt, devIdx);
+		if (tctxt != NULL) {
+			rate = tctxt->dwnl_rate;
+		}
+		cl_mutex_unlock(&ctxt->space_event.mutex);
+	}
+	cl_rwlock_rdunlock(&ctxt->cl_lock);
+	return rate;
+}
+
+/**
+* Retrieve the number of random bytes a cluster device contributed since the cluster opened
+* @param ctxt - pointer to SwrngCLContext structure
+* @param devIdx - device index, 0 through swrngGetCLSize() - 1
+* @return - number of bytes contributed, 0 if the device index is invalid
+*/
+uint64_t swrngGetCLDeviceByteCount(SwrngCLContext *ctxt, int devIdx) {
+	SwrngThreadContext *tctxt;
+	uint64_t count = 0;
+
+	if (swrngIsCLOpen(ctxt) != c_cl_api_true) {
+		return 0;
+	}
+	cl_rwlock_rdlock(&ctxt->cl_lock);
+	if (ctxt->is_cluster_open == c_cl_api_true) {
+		cl_mutex_lock(&ctxt->space_event.mutex);
+		tctxt = findClusterDevice(ctxt, devIdx);
+		if (tctxt != NULL) {
+			count = tctxt->dwnl_bytes;
+		}
+		cl_mutex_unlock(&ctxt->space_event.mutex);
+	}
+	cl_rwlock_rdunlock(&ctxt->cl_lock);
+	return count;
+}
+
+/**
+* Retrieve the live statistics of a cluster device. The device is looked up with `space_event.mutex` held,
+* so it cannot be dropped meanwhile, its statistics are read without waiting for the download in progress.
+* @param ctxt - pointer to SwrngCLContext structure
+* @param devIdx - device index, 0 through swrngGetCLSize() - 1
+* @param stats - pointer to the structure receiving the statistics
+* @return int - 0 when the statistics were retrieved, -1 if the device index is invalid
+*/
+int swrngGetCLDeviceLiveStatistics(SwrngCLContext *ctxt, int devIdx, DeviceLiveStatistics *stats) {
+	SwrngThreadContext *tctxt;
+	int status = -1;
+
+	if (stats == NULL || swrngIsCLOpen(ctxt) != c_cl_api_true) {
+		return -1;
+	}
+	cl_rwlock_rdlock(&ctxt->cl_lock);
+	if (ctxt->is_cluster_open == c_cl_api_true) {
+		cl_mutex_lock(&ctxt->space_event.mutex);
+		tctxt = findClusterDevice(ctxt, devIdx);
+		if (tctxt != NULL) {
+			status = swrngGetLiveStatistics(&tctxt->ctxt, stats);
+		}
+		cl_mutex_unlock(&ctxt->space_event.mutex);
+	}
+	cl_rwlock_rdunlock(&ctxt->cl_lock);
+	return status;
+}
+
+/**
+* Retrieve the live statistics of the cluster, the totals of its current devices and of the devices dropped since it opened
+* @param ctxt - pointer to SwrngCLContext structure
+* @param stats - pointer to the structure receiving the statistics
+* @return int - 0 when the statistics were retrieved
+*/
+int swrngGetCLLiveStatistics(SwrngCLContext *ctxt, DeviceLiveStatistics *stats) {
+	DeviceLiveStatistics devStats;
+	int status = -1;
+
+	if (stats == NULL || swrngIsCLOpen(ctxt) != c_cl_api_true) {
+		return -1;
+	}
+	cl_rwlock_rdlock(&ctxt->cl_lock);
+	if (ctxt->is_cluster_open == c_cl_api_true) {
+		cl_mutex_lock(&ctxt->space_event.mutex);
+		*stats = ctxt->retired_stats;
+		for (int i = 0; i < ctxt->cluster_size; i++) {
+			if (ctxt->tctxts[i].dev_open == c_cl_api_true
+					&& swrngGetLiveStatistics(&ctxt->tctxts[i].ctxt, &devStats) == SWRNG_SUCCESS) {
+				addLiveStatistics(stats, &devStats);
+			}
+		}
+		cl_mutex_unlock(&ctxt->space_event.mutex);
+		status = SWRNG_SUCCESS;
+	}
+	cl_rwlock_rdunlock(&ctxt->cl_lock);
+	return status;
+}
+
+/**
+* Add the live statistics of a device to the totals
+*
+* @param total - pointer to the totals
+* @param stats - pointer to the statistics of the device
+*/
+static void addLiveStatistics(DeviceLiveStatistics *total, const DeviceLiveStatistics *stats) {
+	total->numBytes += stats->numBytes;
+	total->numBlocks += stats->numBlocks;
+	total->numRetries += stats->numRetries;
+	total->numTimeouts += stats->numTimeouts;
+	total->numRctFailures += stats->numRctFailures;
+	total->numAptFailures += stats->numAptFailures;
+	total->bytesPerSec += stats->bytesPerSec;
+	addLatencyHistogram(&total->usbLatency, &stats->usbLatency);
+	addLatencyHistogram(&total->healthTestLatency, &stats->healthTestLatency);
+	addLatencyHistogram(&total->conditioningLatency, &stats->conditioningLatency);
+}
+
+/**
+* Add a latency histogram to the totals
+*
+* @param total - pointer to the total histogram
+* @param histogram - pointer to the histogram added
+*/
+static void addLatencyHistogram(LatencyHistogram *total, const LatencyHistogram *histogram) {
+	total->count += histogram->count;
+	total->totalNanos += histogram->totalNanos;
+	if (histogram->maxNanos > total->maxNanos) {
+		total->maxNanos = histogram->maxNanos;
+	}
+	for (int i = 0; i < SWRNG_LATENCY_BUCKETS; i++) {
+		total->buckets[i] += histogram->buckets[i];
+	}
+}
+
+/**
+* Allocated memory resources
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @return int - 0 when processed successfully
+*/
+static int allocateMemory(SwrngCLContext *ctxt) {
+	int status = SWRNG_SUCCESS;
+
+	if (ctxt->out_data_buff != NULL) {
+		status = -1;
+	}
+
+	if (status != SWRNG_SUCCESS) {
+		printCLErrorMessage(ctxt, leakMemoryErrMsg);
+		return -1;
+	}
+
+	/* A slot buffer for each ring slot plus a spare one for each download thread */
+	ctxt->ring_num_slots = ctxt->cluster_size * c_ring_slots_per_device;
+	if (ctxt->ring_num_slots > c_max_ring_slots) {
+		ctxt->ring_num_slots = c_max_ring_slots;
+	}
+	ctxt->out_data_buff_size = ((size_t)ctxt->ring_num_slots + ctxt->cluster_size) * c_out_data_buff_size;
+	ctxt->out_data_buff = allocateBufferMemory(ctxt->out_data_buff_size);
+	ctxt->ring_slots = (SwrngCLSlot *)calloc((size_t)ctxt->ring_num_slots, sizeof(SwrngCLSlot));
+	if (ctxt->out_data_buff == NULL || ctxt->ring_slots == NULL) {
+		status = -1;
 	}
 
 	if (status != SWRNG_SUCCESS) {
@@ -581,6 +1059,13 @@ static int allocateMemory(SwrngCLContext *ctxt) {
 		return -1;
 	}
 
+	for (int i = 0; i < ctxt->ring_num_slots; i++) {
+		ctxt->ring_slots[i].data = ctxt->out_data_buff + (size_t)i * c_out_data_buff_size;
+	}
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		ctxt->tctxts[i].spare_buffer = ctxt->out_data_buff + ((size_t)ctxt->ring_num_slots + i) * c_out_data_buff_size;
+	}
+
 	return SWRNG_SUCCESS;
 }
 
@@ -592,9 +1077,13 @@ static int allocateMemory(SwrngCLContext *ctxt) {
 static void freeAllocatedMemory(SwrngCLContext *ctxt) {
 	if (ctxt != NULL) {
 		if (ctxt->out_data_buff != NULL) {
-			free(ctxt->out_data_buff);
+			freeBufferMemory(ctxt->out_data_buff, ctxt->out_data_buff_size);
 			ctxt->out_data_buff = NULL;
 		}
+		if (ctxt->ring_slots != NULL) {
+			free(ctxt->ring_slots);
+			ctxt->ring_slots = NULL;
+		}
 		if (ctxt->tctxts != NULL) {
 			free(ctxt->tctxts);
 			ctxt->tctxts = NULL;
@@ -602,6 +1091,37 @@ static void freeAllocatedMemory(SwrngCLContext *ctxt) {
 	}
 }
 
+/**
+* Allocate zeroed memory for the ring slots and the download thread buffers. On Linux the pages are fresh
+* and not touched yet, so each one is allocated on the NUMA node of the download thread writing to it first.
+*
+* @param size - number of bytes to allocate
+* @return pointer to the memory allocated, NULL if out of memory
+*/
+static unsigned char *allocateBufferMemory(size_t size) {
+#ifdef __linux__
+	void *buff = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	return buff == MAP_FAILED ? NULL : (unsigned char *)buff;
+#else
+	return (unsigned char *)calloc(size, 1);
+#endif
+}
+
+/**
+* Free the memory allocated with allocateBufferMemory()
+*
+* @param buff - pointer to the memory
+* @param size - number of bytes allocated
+*/
+static void freeBufferMemory(unsigned char *buff, size_t size) {
+#ifdef __linux__
+	munmap(buff, size);
+#else
+	(void)size;
+	free(buff);
+#endif
+}
+
 /**
 * Check to see if the cluster context has been initialized
 *
@@ -630,6 +1150,7 @@ static int initializeCLContext(SwrngCLContext *ctxt) {
 		ctxt->data_post_process_enabled = c_cl_api_true;
 		ctxt->stat_tests_enabled = c_cl_api_true;
 		ctxt->post_processing_method_id = -1;
+		cl_rwlock_init(&ctxt->cl_lock);
 		return SWRNG_SUCCESS;
 	}
 	return -1;
@@ -672,10 +1193,8 @@ static void printCLErrorMessage(SwrngCLContext *ctxt, const char* errMsg) {
 static void cleanup_download_thread(void *param) {
 	SwrngThreadContext *ctxt = (SwrngThreadContext *)param;
 	if (ctxt != NULL) {
-#ifndef _WIN32
-		pthread_mutex_unlock(&ctxt->dwnl_mutex);
-#endif
 		ctxt->dwnl_req_active = c_cl_api_false;
+		cl_mutex_unlock(&ctxt->cl_ctxt->space_event.mutex);
 	}
 }
 
@@ -686,122 +1205,489 @@ static void cleanup_download_thread(void *param) {
 
 #ifndef _WIN32
 static void *download_thread(void *th_params) {
-
-	int rc;
-	time_t start;
-	struct timespec timeout;
 	SwrngThreadContext *tctxt = (SwrngThreadContext *)th_params;
 
 	pthread_cleanup_push(cleanup_download_thread, tctxt)
-
-	rc = pthread_mutex_lock(&tctxt->dwnl_mutex);
-	if (rc) {
-		pthread_exit(NULL);
-	}
-
-	int inLoop = 1;
-	while (inLoop) {
-		start = time(NULL);
-		timeout.tv_sec = start + 1;
-		timeout.tv_nsec = 0;
-		rc = pthread_cond_timedwait(&tctxt->dwnl_synch, &tctxt->dwnl_mutex, &timeout);
-		switch (rc) {
-		case 0:
-		case ETIMEDOUT:
-			if (tctxt->destroy_dwnl_thread_req == c_cl_api_true) {
-				inLoop = 0;
-			} else {
-				if (tctxt->dwnl_req_active == c_cl_api_true) {
-					tctxt->dwnl_status = swrngGetEntropy(&tctxt->ctxt, tctxt->thread_device_data_buffer, c_out_data_buff_size);
-					tctxt->dwnl_req_active = c_cl_api_false;
-				}
-			}
-			break;
-		default:
-			tctxt->dwnl_status = thread_event_err_id;
-			tctxt->dwnl_req_active = c_cl_api_false;
-			if (tctxt->destroy_dwnl_thread_req == c_cl_api_true) {
-				inLoop = 0;
-			}
-		}
-	}
-
-	pthread_exit(NULL);
+	download_loop(tctxt);
 	pthread_cleanup_pop(0);
+	return NULL;
 }
 #endif
 
 #ifdef _WIN32
 unsigned int __stdcall download_thread(void *th_params) {
-	SwrngThreadContext *tctxt = (SwrngThreadContext *)th_params;
-	DWORD dwWaitResult;
+	download_loop((SwrngThreadContext *)th_params);
+	return 0;
+}
+#endif
 
-	while (1) {
-		dwWaitResult = WaitForSingleObject(tctxt->dwnl_thread_event, 1);
-		switch (dwWaitResult) {
-		case WAIT_OBJECT_0:
-		case WAIT_TIMEOUT:
-			if (tctxt->destroy_dwnl_thread_req == c_cl_api_true) {
-				return 0;
+/**
+* Keep downloading random bytes from the device and publishing them to the cluster ring, sleep while the ring
+* is full. When the device fails it is closed and the thread looks for another device from time to time, or right
+* away when a device is plugged in, like the threads of the slots left empty when the cluster opened.
+* Only returns when the thread is marked for destruction.
+*
+* @param tctxt - pointer to SwrngThreadContext structure
+*/
+static void download_loop(SwrngThreadContext *tctxt) {
+	SwrngCLContext *ctxt = tctxt->cl_ctxt;
+	SwrngCLEvent *space = &ctxt->space_event;
+	char errMsg[sizeof(ctxt->dwnl_err_msg)];
+	DeviceLiveStatistics devStats;
+	unsigned long seq;
+	int status;
+	int published;
+	double elapsedSecs;
+	double now;
+
+	/* Touch the spare buffer before anything else does, so it is allocated on the NUMA node of the thread */
+	memset(tctxt->spare_buffer, 0, c_out_data_buff_size);
+
+	cl_mutex_lock(&space->mutex);
+	while (tctxt->destroy_dwnl_thread_req == c_cl_api_false) {
+		if (tctxt->dwnl_suspended == c_cl_api_true) {
+			if (cl_cond_wait(&space->synch, &space->mutex) != 0) {
+				recordDownloadError(ctxt, thread_event_err_id, eventSynchErrMsg);
+			}
+			continue;
+		}
+
+		if (tctxt->dev_open == c_cl_api_false) {
+			now = cl_time_secs();
+			if (now < tctxt->next_probe_secs) {
+				cl_cond_timedwait(&space->synch, &space->mutex, tctxt->next_probe_secs - now);
+				continue;
+			}
+			tctxt->dwnl_req_active = c_cl_api_true;
+			if (tctxt->open_on_start == c_cl_api_true) {
+				/* The threads claim distinct devices, so they open them all at once */
+				cl_mutex_unlock(&space->mutex);
+				status = openListedDevice(ctxt, tctxt, ctxt->open_num_devs, &ctxt->open_next_dev_num);
+				cl_mutex_lock(&space->mutex);
+				tctxt->open_on_start = c_cl_api_false;
+				ctxt->open_pending--;
 			} else {
-				if (tctxt->dwnl_req_active == c_cl_api_true) {
-					tctxt->dwnl_status = swrngGetEntropy(&tctxt->ctxt, tctxt->thread_device_data_buffer, c_out_data_buff_size);
-					tctxt->dwnl_req_active = c_cl_api_false;
-				}
+				/* Look for a device for the slot, one slot at a time so the slots do not compete for the same device */
+				ctxt->num_cl_resize_events++;
+				cl_mutex_unlock(&space->mutex);
+				cl_mutex_lock(&ctxt->probe_mutex);
+				status = openClusterDevice(ctxt, tctxt);
+				cl_mutex_unlock(&ctxt->probe_mutex);
+				cl_mutex_lock(&space->mutex);
 			}
-			break;
-		default:
-			tctxt->dwnl_status = thread_event_err_id;
 			tctxt->dwnl_req_active = c_cl_api_false;
-			if (tctxt->destroy_dwnl_thread_req == c_cl_api_true) {
-				return 0;
+			cl_cond_broadcast(&ctxt->idle_synch);
+			if (status == SWRNG_SUCCESS) {
+				tctxt->dev_open = c_cl_api_true;
+				tctxt->dwnl_status = SWRNG_SUCCESS;
+				ctxt->actual_cluster_size++;
+				notify_event(&ctxt->ready_event);
+			} else {
+				now = cl_time_secs();
+				tctxt->next_probe_secs = now + (now < tctxt->hotplug_deadline_secs
+						? c_cl_hotplug_retry_secs : c_cl_failover_wait_secs);
+			}
+			continue;
+		}
+
+		/* Work without holding the lock so the other threads and the consumers keep going */
+		tctxt->dwnl_req_active = c_cl_api_true;
+		seq = space->seq;
+		cl_mutex_unlock(&space->mutex);
+		status = SWRNG_SUCCESS;
+		published = c_cl_api_false;
+		elapsedSecs = 0;
+		if (tctxt->spare_filled == c_cl_api_false) {
+			elapsedSecs = cl_time_secs();
+			status = swrngGetEntropy(&tctxt->ctxt, tctxt->spare_buffer, c_out_data_buff_size);
+			elapsedSecs = cl_time_secs() - elapsedSecs;
+			tctxt->spare_filled = status == SWRNG_SUCCESS ? c_cl_api_true : c_cl_api_false;
+		}
+		if (status != SWRNG_SUCCESS) {
+			/* Drop the device, the other devices keep serving the consumers */
+			strncpy(errMsg, swrngGetLastErrorMessage(&tctxt->ctxt), sizeof(errMsg) - 1);
+			errMsg[sizeof(errMsg) - 1] = '\0';
+		} else if (tctxt->spare_filled == c_cl_api_true) {
+			published = publishRingSlot(ctxt, &tctxt->spare_buffer);
+			if (published == c_cl_api_true) {
+				tctxt->spare_filled = c_cl_api_false;
+			}
+		}
+		cl_mutex_lock(&space->mutex);
+		if (status != SWRNG_SUCCESS) {
+			/* Keep the statistics of the device in the cluster totals, the readers no longer find it once closed */
+			tctxt->dev_open = c_cl_api_false;
+			ctxt->actual_cluster_size--;
+			if (swrngGetLiveStatistics(&tctxt->ctxt, &devStats) == SWRNG_SUCCESS) {
+				devStats.bytesPerSec = 0;
+				addLiveStatistics(&ctxt->retired_stats, &devStats);
+			}
+			cl_mutex_unlock(&space->mutex);
+			swrngDestroyContext(&tctxt->ctxt);
+			cl_mutex_lock(&space->mutex);
+		}
+		tctxt->dwnl_req_active = c_cl_api_false;
+		cl_cond_broadcast(&ctxt->idle_synch);
+
+		if (status == SWRNG_SUCCESS && elapsedSecs > 0) {
+			update_download_rate(tctxt, elapsedSecs);
+		}
+
+		if (status != SWRNG_SUCCESS) {
+			tctxt->dwnl_status = status;
+			tctxt->next_probe_secs = cl_time_secs() + c_cl_failover_wait_secs;
+			ctxt->num_cl_failover_events++;
+			recordDownloadError(ctxt, status, errMsg);
+		} else if (published == c_cl_api_true) {
+			tctxt->dwnl_bytes += (uint64_t)c_out_data_buff_size;
+			notify_event(&ctxt->ready_event);
+		} else {
+			/* The ring is full, sleep until a consumer frees a slot */
+			while (space->seq == seq && tctxt->destroy_dwnl_thread_req == c_cl_api_false
+					&& tctxt->dwnl_suspended == c_cl_api_false) {
+				if (cl_cond_wait(&ctxt->full_synch, &space->mutex) != 0) {
+					recordDownloadError(ctxt, thread_event_err_id, eventSynchErrMsg);
+					break;
+				}
 			}
 		}
 	}
+	cl_mutex_unlock(&space->mutex);
+}
+
+/**
+* Device monitor callback, wakes up the download threads of the empty slots to look for the device plugged in.
+* A device removed is dropped by its download thread as soon as its transfer in progress fails.
+*
+* @param arg - pointer to SwrngCLContext structure
+* @param arrived - 1 when a device was plugged in, 0 when removed
+*/
+static void onDeviceEvent(void *arg, int arrived) {
+	SwrngCLContext *ctxt = (SwrngCLContext *)arg;
+	double now;
+
+	if (arrived == 0) {
+		return;
+	}
+	cl_mutex_lock(&ctxt->space_event.mutex);
+	now = cl_time_secs();
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		SwrngThreadContext *tctxt = &ctxt->tctxts[i];
+		if (tctxt->dev_open == c_cl_api_false) {
+			tctxt->next_probe_secs = now;
+			tctxt->hotplug_deadline_secs = now + c_cl_hotplug_window_secs;
+		}
+	}
+	cl_cond_broadcast(&ctxt->space_event.synch);
+	cl_mutex_unlock(&ctxt->space_event.mutex);
+}
+
+/**
+* Record a download thread error for the consumers and wake them up to check the cluster devices.
+* Called with `space_event.mutex` held.
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @param status - the error code
+* @param errMsg - pointer to the error message
+*/
+static void recordDownloadError(SwrngCLContext *ctxt, int status, const char *errMsg) {
+	ctxt->dwnl_err_status = status;
+	strncpy(ctxt->dwnl_err_msg, errMsg, sizeof(ctxt->dwnl_err_msg) - 1);
+	ctxt->dwnl_err_msg[sizeof(ctxt->dwnl_err_msg) - 1] = '\0';
+	notify_event(&ctxt->ready_event);
 }
-#endif
 
 /**
-* Wait for download request to complete
+* Fold the rate of the latest download into the moving average of the device download rate.
+* Called with `space_event.mutex` held.
 *
-* @param ctxt - pointer to SwrngThreadContext structure
-* @return c_cl_api_true - context initialized
+* @param tctxt - pointer to SwrngThreadContext structure
+* @param elapsedSecs - how long the latest download took
 */
-static void wait_complete_download_req(const SwrngThreadContext *ctxt) {
-	while(ctxt->dwnl_req_active == c_cl_api_true) {
+static void update_download_rate(SwrngThreadContext *tctxt, double elapsedSecs) {
+	double rate = c_out_data_buff_size / elapsedSecs;
+	if (tctxt->dwnl_rate == 0) {
+		tctxt->dwnl_rate = rate;
+	} else {
+		tctxt->dwnl_rate += (rate - tctxt->dwnl_rate) * c_dwnl_rate_weight;
+	}
+}
+
+/**
+* Wake up all threads waiting for an event
+*
+* @param event - pointer to the event
+*/
+static void notify_event(SwrngCLEvent *event) {
+	cl_mutex_lock(&event->mutex);
+	event->seq++;
+	cl_cond_broadcast(&event->synch);
+	cl_mutex_unlock(&event->mutex);
+}
+
+/**
+* Wake up one download thread waiting for a free ring slot, waking all of them would only have
+* the others find the ring full again
+*
+* @param ctxt - pointer to SwrngCLContext structure
+*/
+static void notifyRingSlotFreed(SwrngCLContext *ctxt) {
+	cl_mutex_lock(&ctxt->space_event.mutex);
+	ctxt->space_event.seq++;
+	cl_cond_signal(&ctxt->full_synch);
+	cl_mutex_unlock(&ctxt->space_event.mutex);
+}
+
+static void cl_event_init(SwrngCLEvent *event) {
+	cl_mutex_init(&event->mutex);
+	cl_cond_init(&event->synch);
+	event->seq = 0;
+}
+
+static void cl_event_destroy(SwrngCLEvent *event) {
+	cl_cond_destroy(&event->synch);
+	cl_mutex_destroy(&event->mutex);
+}
+
+/**
+* Portable mutex and condition variable operations
+*/
+static void cl_mutex_init(SwrngCLMutex *mutex) {
+#ifndef _WIN32
+	pthread_mutex_init(mutex, NULL);
+#else
+	InitializeCriticalSection(mutex);
+#endif
+}
+
+static void cl_mutex_destroy(SwrngCLMutex *mutex) {
 #ifndef _WIN32
-		sched_yield();
-		usleep(50);
+	pthread_mutex_destroy(mutex);
 #else
-		Sleep(0);
+	DeleteCriticalSection(mutex);
 #endif
+}
+
+static void cl_mutex_lock(SwrngCLMutex *mutex) {
+#ifndef _WIN32
+	pthread_mutex_lock(mutex);
+#else
+	EnterCriticalSection(mutex);
+#endif
+}
+
+static void cl_mutex_unlock(SwrngCLMutex *mutex) {
+#ifndef _WIN32
+	pthread_mutex_unlock(mutex);
+#else
+	LeaveCriticalSection(mutex);
+#endif
+}
+
+static void cl_cond_init(SwrngCLCond *cond) {
+#ifndef _WIN32
+	pthread_cond_init(cond, NULL);
+#else
+	InitializeConditionVariable(cond);
+#endif
+}
+
+static void cl_cond_destroy(SwrngCLCond *cond) {
+#ifndef _WIN32
+	pthread_cond_destroy(cond);
+#else
+	(void)cond;
+#endif
+}
+
+/* Returns 0 when woken up, otherwise the error code */
+static int cl_cond_wait(SwrngCLCond *cond, SwrngCLMutex *mutex) {
+#ifndef _WIN32
+	return pthread_cond_wait(cond, mutex);
+#else
+	return SleepConditionVariableCS(cond, mutex, INFINITE) ? 0 : -1;
+#endif
+}
+
+/* Returns when woken up or after `secs` seconds */
+static void cl_cond_timedwait(SwrngCLCond *cond, SwrngCLMutex *mutex, double secs) {
+#ifndef _WIN32
+	struct timespec ts;
+	long long nsecs;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	nsecs = ts.tv_nsec + (long long)(secs * 1e9);
+	ts.tv_sec += (time_t)(nsecs / 1000000000LL);
+	ts.tv_nsec = (long)(nsecs % 1000000000LL);
+	pthread_cond_timedwait(cond, mutex, &ts);
+#else
+	SleepConditionVariableCS(cond, mutex, (DWORD)(secs * 1000));
+#endif
+}
+
+static void cl_cond_broadcast(SwrngCLCond *cond) {
+#ifndef _WIN32
+	pthread_cond_broadcast(cond);
+#else
+	WakeAllConditionVariable(cond);
+#endif
+}
+
+static void cl_cond_signal(SwrngCLCond *cond) {
+#ifndef _WIN32
+	pthread_cond_signal(cond);
+#else
+	WakeConditionVariable(cond);
+#endif
+}
+
+/**
+* Portable reader-writer lock operations. Writers are preferred so that a fail-over or
+* a reconfiguration is not held off by consumers that keep coming back for more bytes.
+*/
+static void cl_rwlock_init(SwrngCLRWLock *lock) {
+#ifndef _WIN32
+	pthread_rwlockattr_t attr;
+	pthread_rwlockattr_init(&attr);
+#if defined(__GLIBC__)
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+	pthread_rwlock_init(lock, &attr);
+	pthread_rwlockattr_destroy(&attr);
+#else
+	InitializeSRWLock(lock);
+#endif
+}
+
+static void cl_rwlock_rdlock(SwrngCLRWLock *lock) {
+#ifndef _WIN32
+	pthread_rwlock_rdlock(lock);
+#else
+	AcquireSRWLockShared(lock);
+#endif
+}
+
+static void cl_rwlock_rdunlock(SwrngCLRWLock *lock) {
+#ifndef _WIN32
+	pthread_rwlock_unlock(lock);
+#else
+	ReleaseSRWLockShared(lock);
+#endif
+}
+
+static void cl_rwlock_wrlock(SwrngCLRWLock *lock) {
+#ifndef _WIN32
+	pthread_rwlock_wrlock(lock);
+#else
+	AcquireSRWLockExclusive(lock);
+#endif
+}
+
+static void cl_rwlock_wrunlock(SwrngCLRWLock *lock) {
+#ifndef _WIN32
+	pthread_rwlock_unlock(lock);
+#else
+	ReleaseSRWLockExclusive(lock);
+#endif
+}
+
+/**
+* Portable atomic operations on the ring positions and slot sequence numbers
+*/
+static uint64_t cl_atomic_load(volatile uint64_t *value) {
+#ifndef _WIN32
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+	return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)value, 0, 0);
+#endif
+}
+
+static void cl_atomic_store(volatile uint64_t *value, uint64_t newValue) {
+#ifndef _WIN32
+	__atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+#else
+	InterlockedExchange64((volatile LONG64 *)value, (LONG64)newValue);
+#endif
+}
+
+/* Returns c_cl_api_true when swapped, otherwise stores the current value in `expected` */
+static int cl_atomic_cas(volatile uint64_t *value, uint64_t *expected, uint64_t desired) {
+#ifndef _WIN32
+	return __atomic_compare_exchange_n(value, expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+			? c_cl_api_true : c_cl_api_false;
+#else
+	LONG64 prev = InterlockedCompareExchange64((volatile LONG64 *)value, (LONG64)desired, (LONG64)*expected);
+	if ((uint64_t)prev == *expected) {
+		return c_cl_api_true;
+	}
+	*expected = (uint64_t)prev;
+	return c_cl_api_false;
+#endif
+}
+
+static uint64_t cl_atomic_fetch_add(volatile uint64_t *value, uint64_t addend) {
+#ifndef _WIN32
+	return __atomic_fetch_add(value, addend, __ATOMIC_ACQ_REL);
+#else
+	return (uint64_t)InterlockedExchangeAdd64((volatile LONG64 *)value, (LONG64)addend);
+#endif
+}
+
+/**
+* Wait for the device operations in progress to complete and keep the download threads idle
+* so the cluster devices can be reconfigured. The random bytes already in the ring are discarded.
+* The caller must hold the cluster lock exclusively.
+*
+* @param ctxt - pointer to SwrngCLContext structure
+*/
+static void suspend_download_threads(SwrngCLContext *ctxt) {
+	cl_mutex_lock(&ctxt->space_event.mutex);
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		ctxt->tctxts[i].dwnl_suspended = c_cl_api_true;
+	}
+	cl_cond_broadcast(&ctxt->space_event.synch);
+	cl_cond_broadcast(&ctxt->full_synch);
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		while (ctxt->tctxts[i].dwnl_req_active == c_cl_api_true) {
+			cl_cond_wait(&ctxt->idle_synch, &ctxt->space_event.mutex);
+		}
 	}
+	resetRing(ctxt);
+	/* The threads woken up above may only get to run after being resumed, they must not wait for the ring again */
+	ctxt->space_event.seq++;
+	cl_mutex_unlock(&ctxt->space_event.mutex);
 }
 
 /**
-* Wait for all download requests to complete
+* Let the download threads suspended with `suspend_download_threads` fill the ring again
 *
 * @param ctxt - pointer to SwrngCLContext structure
-* @return c_cl_api_true - context initialized
 */
-static void wait_all_complete_download_reqs(const SwrngCLContext *ctxt) {
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		wait_complete_download_req(&ctxt->tctxts[i]);
+static void resume_download_threads(SwrngCLContext *ctxt) {
+	cl_mutex_lock(&ctxt->space_event.mutex);
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		ctxt->tctxts[i].dwnl_suspended = c_cl_api_false;
 	}
+	cl_cond_broadcast(&ctxt->space_event.synch);
+	cl_mutex_unlock(&ctxt->space_event.mutex);
 }
 
 /**
- * A function to wait for specific seconds
- * @param int seconds - how many bytes expected to receive
+ * A function to read a monotonic clock
+ * @return double - seconds since an unspecified starting point
  *
  */
-static void wait_seconds(int seconds) {
-	time_t start;
-	time_t end;
-	start = time(NULL);
-	do {
-		end = time(NULL);
-	} while(end - start < seconds);
+static double cl_time_secs(void) {
+#ifndef _WIN32
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#else
+	LARGE_INTEGER counter;
+	LARGE_INTEGER frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#endif
 }
 
 /**
@@ -814,14 +1700,13 @@ static void wait_seconds(int seconds) {
 *
 */
 int swrngEnableCLPostProcessing(SwrngCLContext *ctxt, int pp_method_id) {
-	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
-		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
+	if (lockOpenCluster(ctxt) == c_cl_api_false) {
 		return -1;
 	}
 
 	/* Ignore any error */
 	enableCLPostProcessing(ctxt, pp_method_id);
-	ctxt->post_processing_method_id = pp_method_id;
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
 
 	return SWRNG_SUCCESS;
 }
@@ -838,14 +1723,13 @@ int swrngEnableCLPostProcessing(SwrngCLContext *ctxt, int pp_method_id) {
 */
 int swrngDisableCLPostProcessing(SwrngCLContext *ctxt) {
 
-	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
-		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
+	if (lockOpenCluster(ctxt) == c_cl_api_false) {
 		return -1;
 	}
 
 	/* Ignore any error */
 	disableCLPostProcessing(ctxt);
-	ctxt->data_post_process_enabled = c_cl_api_false;
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
 
 	return SWRNG_SUCCESS;
 }
@@ -861,14 +1745,13 @@ int swrngDisableCLPostProcessing(SwrngCLContext *ctxt) {
 *
 */
 int swrngDisableCLStatisticalTests(SwrngCLContext *ctxt) {
-	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
-		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
+	if (lockOpenCluster(ctxt) == c_cl_api_false) {
 		return -1;
 	}
 
 	/* Ignore any error */
 	disableCLStatisticalTests(ctxt);
-	ctxt->stat_tests_enabled = c_cl_api_false;
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
 
 	return SWRNG_SUCCESS;
 }
@@ -883,9 +1766,15 @@ int swrngDisableCLStatisticalTests(SwrngCLContext *ctxt) {
 */
 static int disableCLPostProcessing(SwrngCLContext *ctxt) {
 	int status = SWRNG_SUCCESS;
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		status = swrngDisablePostProcessing(&ctxt->tctxts[i].ctxt);
+	suspend_download_threads(ctxt);
+	/* Record the setting while suspended, the devices found later are configured with it */
+	ctxt->data_post_process_enabled = c_cl_api_false;
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		if (ctxt->tctxts[i].dev_open == c_cl_api_true) {
+			status = swrngDisablePostProcessing(&ctxt->tctxts[i].ctxt);
+		}
 	}
+	resume_download_threads(ctxt);
 	return status;
 }
 
@@ -898,9 +1787,15 @@ static int disableCLPostProcessing(SwrngCLContext *ctxt) {
 */
 static int disableCLStatisticalTests(SwrngCLContext *ctxt) {
 	int status = SWRNG_SUCCESS;
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		status = swrngDisableStatisticalTests(&ctxt->tctxts[i].ctxt);
+	suspend_download_threads(ctxt);
+	/* Record the setting while suspended, the devices found later are configured with it */
+	ctxt->stat_tests_enabled = c_cl_api_false;
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		if (ctxt->tctxts[i].dev_open == c_cl_api_true) {
+			status = swrngDisableStatisticalTests(&ctxt->tctxts[i].ctxt);
+		}
 	}
+	resume_download_threads(ctxt);
 	return status;
 }
 
@@ -915,9 +1810,16 @@ static int disableCLStatisticalTests(SwrngCLContext *ctxt) {
 */
 static int enableCLPostProcessing(SwrngCLContext *ctxt, int postProcessingMethodId) {
 	int status = SWRNG_SUCCESS;
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		status = swrngEnablePostProcessing(&ctxt->tctxts[i].ctxt, postProcessingMethodId);
+	suspend_download_threads(ctxt);
+	/* Record the setting while suspended, the devices found later are configured with it */
+	ctxt->data_post_process_enabled = c_cl_api_true;
+	ctxt->post_processing_method_id = postProcessingMethodId;
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		if (ctxt->tctxts[i].dev_open == c_cl_api_true) {
+			status = swrngEnablePostProcessing(&ctxt->tctxts[i].ctxt, postProcessingMethodId);
+		}
 	}
+	resume_download_threads(ctxt);
 	return status;
 }
 
@@ -930,14 +1832,13 @@ static int enableCLPostProcessing(SwrngCLContext *ctxt, int postProcessingMethod
 *
 */
 int swrngEnableCLStatisticaTests(SwrngCLContext *ctxt) {
-	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
-		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
+	if (lockOpenCluster(ctxt) == c_cl_api_false) {
 		return -1;
 	}
 
 	/* Ignore any error */
 	enableCLStatisticalTests(ctxt);
-	ctxt->stat_tests_enabled = c_cl_api_true;
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
 
 	return SWRNG_SUCCESS;
 }
@@ -952,12 +1853,204 @@ int swrngEnableCLStatisticaTests(SwrngCLContext *ctxt) {
 */
 static int enableCLStatisticalTests(SwrngCLContext *ctxt) {
 	int status = SWRNG_SUCCESS;
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		status = swrngEnableStatisticalTests(&ctxt->tctxts[i].ctxt);
+	suspend_download_threads(ctxt);
+	/* Record the setting while suspended, the devices found later are configured with it */
+	ctxt->stat_tests_enabled = c_cl_api_true;
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		if (ctxt->tctxts[i].dev_open == c_cl_api_true) {
+			status = swrngEnableStatisticalTests(&ctxt->tctxts[i].ctxt);
+		}
+	}
+	resume_download_threads(ctxt);
+	return status;
+}
+
+/**
+* Pin the download thread of a cluster slot to a set of CPUs
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @param slot - slot number, 0 through the cluster size - 1
+* @param cpuList - CPU numbers and ranges separated by commas, NULL to run on any CPU
+* @return int - 0 when processed successfully
+*/
+int swrngSetCLThreadCpus(SwrngCLContext *ctxt, int slot, const char *cpuList) {
+	SwrngCLCpuSet cpus;
+
+	if (isContextCLInitialized(ctxt) == c_cl_api_false) {
+		return -1;
+	}
+	memset(&cpus, 0, sizeof(cpus));
+	if (cpuList != NULL && parseCpuList(cpuList, &cpus) != SWRNG_SUCCESS) {
+		printCLErrorMessage(ctxt, cpuListInvalidErrMsg);
+		return -1;
+	}
+	return setCLThreadCpus(ctxt, slot, &cpus);
+}
+
+/**
+* Pin the download thread of a cluster slot to the CPUs of a NUMA node
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @param slot - slot number, 0 through the cluster size - 1
+* @param numaNode - NUMA node number, -1 to run on any CPU
+* @return int - 0 when processed successfully
+*/
+int swrngSetCLThreadNumaNode(SwrngCLContext *ctxt, int slot, int numaNode) {
+	SwrngCLCpuSet cpus;
+
+	if (isContextCLInitialized(ctxt) == c_cl_api_false) {
+		return -1;
+	}
+	memset(&cpus, 0, sizeof(cpus));
+#ifdef __linux__
+	if (numaNode >= 0) {
+		char path[64];
+		char cpuList[4096];
+		size_t len = 0;
+
+		/* Empty for a node with memory only */
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", numaNode);
+		FILE *file = fopen(path, "r");
+		if (file != NULL) {
+			len = fread(cpuList, 1, sizeof(cpuList) - 1, file);
+			fclose(file);
+		}
+		cpuList[len] = '\0';
+		if (parseCpuList(cpuList, &cpus) != SWRNG_SUCCESS || isCpuSetEmpty(&cpus) == c_cl_api_true) {
+			printCLErrorMessage(ctxt, numaNodeInvalidErrMsg);
+			return -1;
+		}
+	}
+#endif
+	return setCLThreadCpus(ctxt, slot, &cpus);
+}
+
+/**
+* Record the CPUs of a slot download thread and move the thread to them when the cluster is open
+*
+* @param ctxt - pointer to SwrngCLContext structure
+* @param slot - slot number
+* @param cpus - pointer to the CPU set, an empty set to run on any CPU
+* @return int - 0 when processed successfully
+*/
+static int setCLThreadCpus(SwrngCLContext *ctxt, int slot, const SwrngCLCpuSet *cpus) {
+#ifndef __linux__
+	(void)slot;
+	(void)cpus;
+	printCLErrorMessage(ctxt, threadAffinityNotSupportedErrMsg);
+	return -1;
+#else
+	cpu_set_t nativeCpus;
+	int status = SWRNG_SUCCESS;
+
+	if (slot < 0 || slot >= c_max_sl_size) {
+		printCLErrorMessage(ctxt, slotInvalidErrMsg);
+		return -1;
+	}
+	cl_rwlock_wrlock(&ctxt->cl_lock);
+	if (ctxt->is_cluster_open == c_cl_api_true && slot < ctxt->cluster_size) {
+		/* The memory the thread touched already stays on its NUMA node */
+		toNativeCpuSet(cpus, &nativeCpus);
+		if (pthread_setaffinity_np(ctxt->tctxts[slot].dwnl_thread, sizeof(nativeCpus), &nativeCpus) != 0) {
+			printCLErrorMessage(ctxt, threadAffinityErrMsg);
+			status = -1;
+		}
 	}
+	if (status == SWRNG_SUCCESS) {
+		ctxt->thread_cpus[slot] = *cpus;
+	}
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
 	return status;
+#endif
 }
 
+/**
+* Parse a list of CPU numbers and ranges separated by commas, in the format of the Linux
+* cpulist files, for example "0-3,8"
+*
+* @param cpuList - the list, an empty list gives an empty set
+* @param cpus - pointer to the CPU set receiving the CPUs
+* @return int - 0 when parsed successfully
+*/
+static int parseCpuList(const char *cpuList, SwrngCLCpuSet *cpus) {
+	const char *p = cpuList;
+	char *end;
+	long first;
+	long last;
+
+	memset(cpus, 0, sizeof(*cpus));
+	while (isspace((unsigned char)*p)) {
+		p++;
+	}
+	while (*p != '\0') {
+		if (!isdigit((unsigned char)*p)) {
+			return -1;
+		}
+		first = strtol(p, &end, 10);
+		last = first;
+		p = end;
+		if (*p == '-') {
+			p++;
+			if (!isdigit((unsigned char)*p)) {
+				return -1;
+			}
+			last = strtol(p, &end, 10);
+			p = end;
+		}
+		if (first > last || last >= SWRNG_CL_MAX_CPUS) {
+			return -1;
+		}
+		for (long cpu = first; cpu <= last; cpu++) {
+			cpus->bits[cpu / 64] |= (uint64_t)1 << (cpu % 64);
+		}
+		if (*p == ',') {
+			p++;
+			continue;
+		}
+		while (isspace((unsigned char)*p)) {
+			p++;
+		}
+		if (*p != '\0') {
+			return -1;
+		}
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+* Check if a CPU set is empty
+*
+* @param cpus - pointer to the CPU set
+* @return c_cl_api_true - the set is empty and stands for any CPU
+*/
+static int isCpuSetEmpty(const SwrngCLCpuSet *cpus) {
+	for (int i = 0; i < SWRNG_CL_MAX_CPUS / 64; i++) {
+		if (cpus->bits[i] != 0) {
+			return c_cl_api_false;
+		}
+	}
+	return c_cl_api_true;
+}
+
+#ifdef __linux__
+/**
+* Convert a CPU set to the native one, an empty set to all CPUs
+*
+* @param cpus - pointer to the CPU set
+* @param nativeCpus - pointer to the native CPU set receiving the CPUs
+*/
+static void toNativeCpuSet(const SwrngCLCpuSet *cpus, cpu_set_t *nativeCpus) {
+	int anyCpu = isCpuSetEmpty(cpus);
+
+	CPU_ZERO(nativeCpus);
+	for (int cpu = 0; cpu < SWRNG_CL_MAX_CPUS && cpu < CPU_SETSIZE; cpu++) {
+		if (anyCpu == c_cl_api_true || ((cpus->bits[cpu / 64] >> (cpu % 64)) & 1) != 0) {
+			CPU_SET(cpu, nativeCpus);
+		}
+	}
+}
+#endif
+
 /**
 * Set power profile for each device in the cluster
 *
@@ -968,15 +2061,13 @@ static int enableCLStatisticalTests(SwrngCLContext *ctxt) {
 */
 int swrngSetCLPowerProfile(SwrngCLContext *ctxt, int ppNum) {
 
-	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
-		printCLErrorMessage(ctxt, clusterNotOpenErrMsg);
+	if (lockOpenCluster(ctxt) == c_cl_api_false) {
 		return -1;
 	}
 
 	/* Ignore the error */
 	setCLPowerProfile(ctxt, ppNum);
-	ctxt->ppn_changed = c_cl_api_true;
-	ctxt->ppn_number = ppNum;
+	cl_rwlock_wrunlock(&ctxt->cl_lock);
 
 	return SWRNG_SUCCESS;
 }
@@ -991,33 +2082,19 @@ int swrngSetCLPowerProfile(SwrngCLContext *ctxt, int ppNum) {
 */
 static int setCLPowerProfile(SwrngCLContext *ctxt, int ppNum) {
 	int status = SWRNG_SUCCESS;
-	for (int i = 0; i < ctxt->actual_cluster_size; i++) {
-		status = swrngSetPowerProfile(&ctxt->tctxts[i].ctxt, ppNum);
+	suspend_download_threads(ctxt);
+	/* Record the setting while suspended, the devices found later are configured with it */
+	ctxt->ppn_changed = c_cl_api_true;
+	ctxt->ppn_number = ppNum;
+	for (int i = 0; i < ctxt->cluster_size; i++) {
+		if (ctxt->tctxts[i].dev_open == c_cl_api_true) {
+			status = swrngSetPowerProfile(&ctxt->tctxts[i].ctxt, ppNum);
+		}
 	}
+	resume_download_threads(ctxt);
 	return status;
 }
 
-/**
-* Check to see if it is the time to re-size the cluster to preferred size
-*
-* @param ctxt - pointer to SwrngCLContext structure
-* @return c_cl_api_true - it is time to resize the cluster
-*
-*/
-static int isItTimeToResizeCluster(const SwrngCLContext *ctxt) {
-	if (swrngIsCLOpen(ctxt) == c_cl_api_false) {
-		return c_cl_api_false;
-	}
-
-	time_t now = time(NULL);
-	if (now - ctxt->cl_start_time_secs > c_cl_resize_wait_secs &&
-			ctxt->actual_cluster_size < ctxt->cluster_size) {
-		/* Time to try re-sizing the cluster */
-		return c_cl_api_true;
-	}
-	return c_cl_api_false;
-}
-
 /**
 * Call this function to enable printing error messages to the error stream
 * @param ctxt - pointer to SwrngCLContext structure
@@ -0,0 +1,321 @@
+/**
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ This file implements the parts shared by the daemons serving random bytes from a cluster of SwiftRNG devices.
+
+ */
+
+/**
+ *    @file swrng-cl-daemon.c
+ *    @version 1.0
+ *
+ *    @brief Implements the cluster settings, the cluster recovery and the prefetching for the cluster daemons.
+ */
+
+#include <swrng-cl-daemon.h>
+
+static const int c_cl_daemon_true = 1;
+static const int c_cl_daemon_false = 0;
+
+static void *prefetchRun(void *arg);
+
+/**
+* Parse cluster size if specified
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param idx - pointer to the current parameter number
+* @param argc - number of parameters
+* @param argv - parameters
+* @return int - 1 when parsed, 0 when not specified, -1 when invalid
+*/
+static int parseClusterSize(SwrngCLDaemon *dmn, int *idx, int argc, char **argv) {
+	if (strcmp("-cs", argv[*idx]) != 0 && strcmp("--cluster-size", argv[*idx]) != 0) {
+		return 0;
+	}
+	if (swrngValidateCLDaemonArgumentCount(dmn, ++(*idx), argc) == c_cl_daemon_false) {
+		return -1;
+	}
+	dmn->cl_size = atoi(argv[(*idx)++]);
+	if (dmn->cl_size < 1 || dmn->cl_size > SWRNG_CL_MAX_SIZE) {
+		fprintf(stderr, "Cluster size must be between 1 and %d\n", SWRNG_CL_MAX_SIZE);
+		return -1;
+	}
+	return 1;
+}
+
+/**
+* Parse power profile number if specified
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param idx - pointer to the current parameter number
+* @param argc - number of parameters
+* @param argv - parameters
+* @return int - 1 when parsed, 0 when not specified, -1 when invalid
+*/
+static int parsePowerProfileNum(SwrngCLDaemon *dmn, int *idx, int argc, char **argv) {
+	if (strcmp("-ppn", argv[*idx]) != 0 && strcmp("--power-profile-number", argv[*idx]) != 0) {
+		return 0;
+	}
+	if (swrngValidateCLDaemonArgumentCount(dmn, ++(*idx), argc) == c_cl_daemon_false) {
+		return -1;
+	}
+	dmn->pp_num = atoi(argv[(*idx)++]);
+	if (dmn->pp_num < 0 || dmn->pp_num > 9) {
+		fprintf(stderr, "Power profile number invalid, must be between 0 and 9\n");
+		return -1;
+	}
+	return 1;
+}
+
+/**
+* Parse post processing method if specified
+*
+* @param dmn - pointer to SwrngCLDaemon structure
+* @param idx - pointer to the current parameter number
+* @param argc - number of parameters
+* @param argv - parameters
+* @return int - 1 when parsed, 0 when not specified, -1 when invalid
+*/
+static int parsePostProcessingMethod(SwrngCLDaemon *dmn, int *idx, int argc, char **argv) {
+	if (strcmp("-ppm", argv[*idx]) != 0 && strcmp("--post-processing-method", argv[*idx]) != 0) {
+		return 0;
+	}
+	if (swrngValidateCLDaemonArgumentCount(dmn, ++(*idx), argc) == c_cl_daemon_false) {
+		return -1;
+	}
+	dmn->pp_method = argv[(*idx)++];
+	if (strcmp("SHA256", dmn->pp_method) == 0) {
+		dmn->pp_method_id = 0;
+	} else if (strcmp("SHA512", dmn->pp_method) == 0) {
+		dmn->pp_method_id = 2;
+	} else if (strcmp("xorshift64", dmn->pp_method) == 0) {
+		dmn->pp_method_id = 1;
+	} else {
+		fprintf(stderr, "Invalid post processing method: %s \n", dmn->pp_method);
+		return -1;
+	}
+	return 1;
+}
+
+/*
+* API functions
+*/
+
+int swrngInitializeCLDaemon(SwrngCLDaemon *dmn, void (*displayUsage)(void)) {
+	memset(dmn, 0, sizeof(SwrngCLDaemon));
+	dmn->cl_size = 2;
+	dmn->pp_num = 9;
+	dmn->post_processing_enabled = c_cl_daemon_true;
+	dmn->statistical_tests_enabled = c_cl_daemon_true;
+	dmn->display_usage = displayUsage;
+	pthread_mutex_init(&dmn->cluster_mutex, NULL);
+	pthread_mutex_init(&dmn->prefetch_mutex, NULL);
+	pthread_cond_init(&dmn->prefetch_space_cond, NULL);
+	int status = swrngInitializeCLContext(&dmn->cxt);
+	if (status != SWRNG_SUCCESS) {
+		fprintf(stderr, "Could not initialize context\n");
+	}
+	return status;
+}
+
+int swrngValidateCLDaemonArgumentCount(SwrngCLDaemon *dmn, int curIdx, int actArgumentCount) {
+	if (curIdx >= actArgumentCount) {
+		fprintf(stderr, "\nMissing command line arguments\n\n");
+		if (dmn->display_usage != NULL) {
+			dmn->display_usage();
+		}
+		return c_cl_daemon_false;
+	}
+	return c_cl_daemon_true;
+}
+
+int swrngParseCLDaemonArgument(SwrngCLDaemon *dmn, int *idx, int argc, char **argv) {
+	if (strcmp("-dpp", argv[*idx]) == 0 || strcmp("--disable-post-processing", argv[*idx]) == 0) {
+		(*idx)++;
+		dmn->post_processing_enabled = c_cl_daemon_false;
+		return 1;
+	}
+	if (strcmp("-dst", argv[*idx]) == 0 || strcmp("--disable-statistical-tests", argv[*idx]) == 0) {
+		(*idx)++;
+		dmn->statistical_tests_enabled = c_cl_daemon_false;
+		return 1;
+	}
+	int status = parsePostProcessingMethod(dmn, idx, argc, argv);
+	if (status == 0) {
+		status = parseClusterSize(dmn, idx, argc, argv);
+	}
+	if (status == 0) {
+		status = parsePowerProfileNum(dmn, idx, argc, argv);
+	}
+	return status;
+}
+
+int swrngOpenCLDaemonCluster(SwrngCLDaemon *dmn, int reportErrors) {
+	int status = swrngCLOpen(&dmn->cxt, dmn->cl_size);
+	if (status != SWRNG_SUCCESS) {
+		if (reportErrors == c_cl_daemon_true) {
+			fprintf(stderr, "Cannot open device cluster: %s\n", swrngGetCLLastErrorMessage(&dmn->cxt));
+		}
+		swrngCLClose(&dmn->cxt);
+		return status;
+	}
+
+	if (dmn->statistical_tests_enabled == c_cl_daemon_false) {
+		status = swrngDisableCLStatisticalTests(&dmn->cxt);
+		if (status != SWRNG_SUCCESS) {
+			fprintf(stderr, "Cannot disable statistical tests, error code %d\n", status);
+			swrngCLClose(&dmn->cxt);
+			return status;
+		}
+	}
+	if (dmn->post_processing_enabled == c_cl_daemon_false) {
+		status = swrngDisableCLPostProcessing(&dmn->cxt);
+		if (status != SWRNG_SUCCESS) {
+			fprintf(stderr, "Cannot disable post processing, error code %d\n", status);
+			swrngCLClose(&dmn->cxt);
+			return status;
+		}
+	} else if (dmn->pp_method != NULL) {
+		status = swrngEnableCLPostProcessing(&dmn->cxt, dmn->pp_method_id);
+		if (status != SWRNG_SUCCESS) {
+			fprintf(stderr, "Cannot enable processing method, error code %d\n", status);
+			swrngCLClose(&dmn->cxt);
+			return status;
+		}
+	}
+
+	status = swrngSetCLPowerProfile(&dmn->cxt, dmn->pp_num);
+	if (status != SWRNG_SUCCESS) {
+		fprintf(stderr, "Cannot set cluster power profile, error code %d\n", status);
+		swrngCLClose(&dmn->cxt);
+		return status;
+	}
+	return SWRNG_SUCCESS;
+}
+
+int swrngRetrieveCLDaemonBytes(SwrngCLDaemon *dmn, unsigned char *dst, long length) {
+	while (swrngIsCLDaemonStopRequested(dmn) == c_cl_daemon_false) {
+		pthread_mutex_lock(&dmn->cluster_mutex);
+		int generation = dmn->cluster_generation;
+		pthread_mutex_unlock(&dmn->cluster_mutex);
+
+		int status = swrngGetCLEntropy(&dmn->cxt, dst, length);
+		if (status == SWRNG_SUCCESS) {
+			return SWRNG_SUCCESS;
+		}
+
+		pthread_mutex_lock(&dmn->cluster_mutex);
+		if (generation == dmn->cluster_generation) {
+			fprintf(stderr, "Cannot retrieve random bytes, error code %d, waiting for devices\n", status);
+			swrngCLClose(&dmn->cxt);
+			while (swrngIsCLDaemonStopRequested(dmn) == c_cl_daemon_false
+					&& swrngOpenCLDaemonCluster(dmn, c_cl_daemon_false) != SWRNG_SUCCESS) {
+				sleep(SWRNG_CL_DAEMON_REOPEN_WAIT_SECS);
+			}
+			if (swrngIsCLOpen(&dmn->cxt) == c_cl_daemon_true) {
+				printf("Device cluster open again, cluster size: %d\n", swrngGetCLSize(&dmn->cxt));
+			}
+			dmn->cluster_generation++;
+		}
+		pthread_mutex_unlock(&dmn->cluster_mutex);
+	}
+	return -1;
+}
+
+int swrngStartCLDaemonPrefetch(SwrngCLDaemon *dmn, size_t buffSize, size_t chunkSize,
+		SwrngCLDaemonBytesAdded bytesAdded, void *arg) {
+	dmn->prefetch_buff = (unsigned char *)malloc(buffSize);
+	if (dmn->prefetch_buff == NULL) {
+		fprintf(stderr, "Could not allocate the prefetch buffer\n");
+		return -1;
+	}
+	dmn->prefetch_buff_size = buffSize;
+	dmn->prefetch_chunk_size = chunkSize;
+	dmn->bytes_added = bytesAdded;
+	dmn->bytes_added_arg = arg;
+	if (pthread_create(&dmn->prefetch_thread, NULL, prefetchRun, dmn) != 0) {
+		fprintf(stderr, "Could not create the prefetch thread\n");
+		free(dmn->prefetch_buff);
+		dmn->prefetch_buff = NULL;
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+void swrngStopCLDaemonPrefetch(SwrngCLDaemon *dmn) {
+	pthread_mutex_lock(&dmn->prefetch_mutex);
+	dmn->prefetch_stopped = c_cl_daemon_true;
+	pthread_cond_signal(&dmn->prefetch_space_cond);
+	pthread_mutex_unlock(&dmn->prefetch_mutex);
+	pthread_join(dmn->prefetch_thread, NULL);
+}
+
+size_t swrngTakeCLDaemonBytes(SwrngCLDaemon *dmn, unsigned char *dst, size_t length) {
+	size_t head = dmn->prefetch_head;
+	size_t cnt = length < dmn->prefetch_available ? length : dmn->prefetch_available;
+	if (cnt == 0) {
+		return 0;
+	}
+
+	size_t first = dmn->prefetch_buff_size - head < cnt ? dmn->prefetch_buff_size - head : cnt;
+	memcpy(dst, dmn->prefetch_buff + head, first);
+	memcpy(dst + first, dmn->prefetch_buff, cnt - first);
+
+	dmn->prefetch_head = (head + cnt) % dmn->prefetch_buff_size;
+	dmn->prefetch_available -= cnt;
+	if (dmn->prefetch_buff_size - dmn->prefetch_available >= dmn->prefetch_chunk_size) {
+		pthread_cond_signal(&dmn->prefetch_space_cond);
+	}
+	return cnt;
+}
+
+void swrngRequestCLDaemonStop(SwrngCLDaemon *dmn) {
+	__atomic_store_n(&dmn->stop_requested, 1, __ATOMIC_RELAXED);
+}
+
+int swrngIsCLDaemonStopRequested(SwrngCLDaemon *dmn) {
+	return __atomic_load_n(&dmn->stop_requested, __ATOMIC_RELAXED) != 0 ? c_cl_daemon_true : c_cl_daemon_false;
+}
+
+/**
+* Prefetch thread, keeps the prefetch buffer filled with random bytes from the cluster
+*
+* @param arg - pointer to SwrngCLDaemon structure
+* @return NULL
+*/
+static void *prefetchRun(void *arg) {
+	SwrngCLDaemon *dmn = (SwrngCLDaemon *)arg;
+	size_t tail;
+
+	pthread_mutex_lock(&dmn->prefetch_mutex);
+	while (dmn->prefetch_stopped == c_cl_daemon_false) {
+		if (dmn->prefetch_buff_size - dmn->prefetch_available < dmn->prefetch_chunk_size) {
+			pthread_cond_wait(&dmn->prefetch_space_cond, &dmn->prefetch_mutex);
+			continue;
+		}
+		// The free space past the tail is not read by the daemon, it is filled without holding the lock
+		tail = dmn->prefetch_tail;
+		pthread_mutex_unlock(&dmn->prefetch_mutex);
+
+		if (swrngRetrieveCLDaemonBytes(dmn, dmn->prefetch_buff + tail, (long)dmn->prefetch_chunk_size) != SWRNG_SUCCESS) {
+			pthread_mutex_lock(&dmn->prefetch_mutex);
+			break;
+		}
+
+		pthread_mutex_lock(&dmn->prefetch_mutex);
+		dmn->prefetch_tail = (tail + dmn->prefetch_chunk_size) % dmn->prefetch_buff_size;
+		dmn->prefetch_available += dmn->prefetch_chunk_size;
+		if (dmn->bytes_added != NULL) {
+			pthread_mutex_unlock(&dmn->prefetch_mutex);
+			dmn->bytes_added(dmn->bytes_added_arg);
+			pthread_mutex_lock(&dmn->prefetch_mutex);
+		}
+	}
+	pthread_mutex_unlock(&dmn->prefetch_mutex);
+	return NULL;
+}
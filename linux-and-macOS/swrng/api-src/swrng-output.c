@@ -0,0 +1,262 @@
+/**
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This file may only be used in conjunction with TectroLabs devices.
+
+ This file implements the API for writing downloaded random bytes out to a file, a named pipe or the standard output.
+
+ */
+
+/**
+ *    @file swrng-output.c
+ *    @version 1.0
+ *
+ *    @brief Implements writing random bytes out without copying them more than needed.
+ */
+
+/* Needed for vmsplice(), F_SETPIPE_SZ and O_DIRECT */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <swrng-output.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/stat.h>
+#else
+#include <io.h>
+#endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/uio.h>
+#endif
+
+#ifdef __linux__
+/* Pipe capacity asked for, the default max size of a pipe for unprivileged processes */
+static const int c_pipe_size_bytes = 1024 * 1024;
+
+/**
+ * Open a pipe or a regular file for writing without a file stream
+ *
+ * @param out - pointer to SwrngOutput structure
+ * @param pathName - file path name, ignored when writing to the standard output
+ * @param toStandardOutput - 1 for writing to the standard output
+ * @return int - 0 when opened, -1 when a file stream must be used
+ */
+static int openFastOutput(SwrngOutput *out, const char *pathName, int toStandardOutput) {
+	struct stat st;
+	int exists = toStandardOutput == 1 ? 0 : stat(pathName, &st) == 0;
+
+	if (toStandardOutput == 1) {
+		if (fstat(STDOUT_FILENO, &st) != 0 || !S_ISFIFO(st.st_mode)) {
+			return -1;
+		}
+		out->fd = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+		out->mode = SWRNG_OUTPUT_PIPE;
+	} else if (exists && S_ISFIFO(st.st_mode)) {
+		out->fd = open(pathName, O_WRONLY | O_CLOEXEC);
+		out->mode = SWRNG_OUTPUT_PIPE;
+	} else if (exists ? S_ISREG(st.st_mode) : errno == ENOENT) {
+		// Fails with EINVAL when the file system does not support O_DIRECT
+		out->fd = open(pathName, O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT | O_CLOEXEC, 0666);
+		out->mode = SWRNG_OUTPUT_DIRECT;
+	} else {
+		return -1;
+	}
+
+	if (out->fd == -1) {
+		out->mode = SWRNG_OUTPUT_STREAM;
+		return -1;
+	}
+	if (out->mode == SWRNG_OUTPUT_PIPE && fcntl(out->fd, F_GETPIPE_SZ) < c_pipe_size_bytes) {
+		// Fewer wake ups of the reader, the current size is kept when not allowed
+		fcntl(out->fd, F_SETPIPE_SZ, c_pipe_size_bytes);
+	}
+	return 0;
+}
+
+/**
+ * Write bytes to a file descriptor, retrying until all are written
+ *
+ * @param fd - file descriptor
+ * @param bytes - pointer to the bytes
+ * @param length - number of bytes to write
+ * @return int - 0 when written successfully
+ */
+static int writeFully(int fd, const unsigned char *bytes, size_t length) {
+	size_t written = 0;
+
+	while (written < length) {
+		ssize_t cnt = write(fd, bytes + written, length - written);
+		if (cnt < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EINVAL && (fcntl(fd, F_GETFL) & O_DIRECT) != 0) {
+				// The file system needs a larger alignment, continue without O_DIRECT
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+				continue;
+			}
+			return -1;
+		}
+		written += (size_t)cnt;
+	}
+	return 0;
+}
+
+/**
+ * Hand the whole pages of the output buffer over to the pipe and copy the rest
+ *
+ * @param out - pointer to SwrngOutput structure
+ * @param length - number of bytes to write
+ * @return int - 0 when written successfully
+ */
+static int spliceOutput(SwrngOutput *out, size_t length) {
+	size_t alignedLength = length - length % out->pageSize;
+	size_t spliced = 0;
+	struct iovec iov;
+
+	while (spliced < alignedLength) {
+		iov.iov_base = out->buffer + spliced;
+		iov.iov_len = alignedLength - spliced;
+		ssize_t cnt = vmsplice(out->fd, &iov, 1, SPLICE_F_GIFT);
+		if (cnt < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		spliced += (size_t)cnt;
+	}
+
+	if (alignedLength > 0) {
+		/*
+		 * The pipe keeps referencing the gifted pages until the reader is done with them, possibly
+		 * after moving them on to another pipe. The buffer is given new pages, so the bytes written
+		 * are never replaced by the next ones while still being read.
+		 */
+		madvise(out->buffer, alignedLength, MADV_DONTNEED);
+	}
+	return writeFully(out->fd, out->buffer + alignedLength, length - alignedLength);
+}
+#endif
+
+/**
+* Open the output for writing random bytes, truncating a regular file
+*
+* @param out - pointer to SwrngOutput structure
+* @param pathName - file path name, ignored when writing to the standard output
+* @param toStandardOutput - 1 for writing to the standard output
+* @param maxLength - max number of bytes written at once
+* @return int - 0 when opened successfully
+*/
+int swrngOpenOutput(SwrngOutput *out, const char *pathName, int toStandardOutput, size_t maxLength) {
+	memset(out, 0, sizeof(SwrngOutput));
+	out->fd = -1;
+	out->mode = SWRNG_OUTPUT_STREAM;
+#ifdef _WIN32
+	out->pageSize = 4096;
+#else
+	out->pageSize = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+
+	// Room for one more byte, rounded up to whole pages
+	out->bufferSize = (maxLength + out->pageSize) / out->pageSize * out->pageSize;
+#ifdef _WIN32
+	out->buffer = (unsigned char *)malloc(out->bufferSize);
+#else
+	if (posix_memalign((void **)&out->buffer, out->pageSize, out->bufferSize) != 0) {
+		out->buffer = NULL;
+	}
+#endif
+	if (out->buffer == NULL) {
+		return -1;
+	}
+
+#ifdef __linux__
+	if (openFastOutput(out, pathName, toStandardOutput) == 0) {
+		return 0;
+	}
+#endif
+
+	if (toStandardOutput == 1) {
+#ifdef _WIN32
+		_setmode(_fileno(stdout), _O_BINARY);
+		out->file = fdopen(_dup(fileno(stdout)), "wb");
+#else
+		out->file = fdopen(dup(fileno(stdout)), "wb");
+#endif
+	} else {
+		out->file = fopen(pathName, "wb");
+	}
+	if (out->file == NULL) {
+		free(out->buffer);
+		out->buffer = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+* Retrieve the buffer to fill before calling swrngWriteOutput(). It has room for one byte past
+* the max number of bytes written at once. Its content is not preserved by swrngWriteOutput().
+*
+* @param out - pointer to SwrngOutput structure
+* @return unsigned char* - the buffer
+*/
+unsigned char* swrngGetOutputBuffer(SwrngOutput *out) {
+	return out->buffer;
+}
+
+/**
+* Write bytes out from the beginning of the output buffer
+*
+* @param out - pointer to SwrngOutput structure
+* @param length - number of bytes to write, up to the max number of bytes set when opening
+* @return int - 0 when written successfully
+*/
+int swrngWriteOutput(SwrngOutput *out, size_t length) {
+#ifdef __linux__
+	if (out->mode == SWRNG_OUTPUT_PIPE) {
+		return spliceOutput(out, length);
+	}
+	if (out->mode == SWRNG_OUTPUT_DIRECT) {
+		if (length % out->pageSize != 0) {
+			// Only the last write may not be aligned, as O_DIRECT requires
+			fcntl(out->fd, F_SETFL, fcntl(out->fd, F_GETFL) & ~O_DIRECT);
+		}
+		return writeFully(out->fd, out->buffer, length);
+	}
+#endif
+	return fwrite(out->buffer, 1, length, out->file) == length ? 0 : -1;
+}
+
+/**
+* Close the output and release the buffer
+*
+* @param out - pointer to SwrngOutput structure
+*/
+void swrngCloseOutput(SwrngOutput *out) {
+	if (out->buffer == NULL) {
+		return;
+	}
+	if (out->file != NULL) {
+		fclose(out->file);
+		out->file = NULL;
+	}
+#ifndef _WIN32
+	if (out->fd != -1) {
+		close(out->fd);
+		out->fd = -1;
+	}
+#endif
+	free(out->buffer);
+	out->buffer = NULL;
+}
@@ -0,0 +1,838 @@
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This program is used for interacting with a cluster of SwiftRNG devices for the purpose of
+ downloading and distributing true random bytes to local processes over a Unix domain socket.
+
+ This program requires the libusb-1.0 library when communicating with any SwiftRNG device. Please read the provided
+ documentation for libusb-1.0 installation details.
+
+ This program uses libusb-1.0 (directly or indirectly) which is distributed under the terms of the GNU Lesser General
+ Public License as published by the Free Software Foundation. For more information, please visit: http://libusb.info
+
+ This program may only be used in conjunction with TectroLabs devices.
+
+ This program may require 'sudo' permissions when running on Linux.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*
+ * entropy-cl-server.c
+ * Ver. 1.0
+ *
+ * A prefetch thread keeps a buffer filled with random bytes from the cluster, while a single epoll
+ * event loop accepts the clients, reads their requests and writes the replies without blocking.
+ * Clients asking for more random bytes than prefetched wait in turn until the prefetch thread adds more.
+ * A ring thread keeps the shared memory ring filled, the clients attached to it do not involve the event loop.
+ */
+#include "entropy-cl-server.h"
+
+/**
+ * Display usage message
+ *
+ */
+static void displayUsage(void) {
+	printf("*********************************************************************************\n");
+	printf("                   SwiftRNG entropy-cl-server Ver 1.0  \n");
+	printf("*********************************************************************************\n");
+	printf("NAME\n");
+	printf("     entropy-cl-server - An application server for distributing random bytes \n");
+	printf("              downloaded from a cluster of SwiftRNG devices \n");
+	printf("SYNOPSIS\n");
+	printf("     entropy-cl-server <options>\n");
+	printf("\n");
+	printf("DESCRIPTION\n");
+	printf("     entropy-cl-server downloads random bytes from one or more Hardware (True) \n");
+	printf("     Random Number Generator SwiftRNG devices and distributes them to \n");
+	printf("     consumer applications using a Unix domain socket. The applications may\n");
+	printf("     also attach a shared memory ring for retrieving the random bytes directly.\n");
+	printf("\n");
+	printf("OPTIONS\n");
+	printf("     Operation modifiers:\n");
+	printf("\n");
+	printf("     -cs NUMBER, --cluster-size NUMBER\n");
+	printf("           Preferred number (between 1 and 64) of devices in a cluster.\n");
+	printf("           Default value is 2\n");
+	printf("\n");
+	printf("     -mc NUMBER, --max-clients NUMBER\n");
+	printf("          How many clients may be connected at the same time (default: %d)\n", DEFAULT_MAX_CLIENTS);
+	printf("          Valid values are integers from 1 to %d \n", MAX_CLIENTS);
+	printf("\n");
+	printf("     -ppn NUMBER, --power-profile-number NUMBER\n");
+	printf("           Device power profile NUMBER, 0 (lowest) to 9 (highest - default)\n");
+	printf("\n");
+	printf("     -ppm METHOD, --post-processing-method METHOD\n");
+	printf("           SwiftRNG post processing method: SHA256, SHA512 or xorshift64\n");
+	printf("           Skip this option for using default method\n");
+	printf("\n");
+	printf("     -dpp, --disable-post-processing\n");
+	printf("           Disable post processing of random data for devices with version 1.2+\n");
+	printf("\n");
+	printf("     -dst, --disable-statistical-tests\n");
+	printf("           Disable 'Repetition Count' and 'Adaptive Proportion' tests.\n");
+	printf("\n");
+	printf("     -sp PATH, --socket-path PATH\n");
+	printf("           Use a custom socket PATH (default: %s)\n", SWRNG_SERVER_DEFAULT_SOCKET_PATH);
+	printf("           Only the user and the group of the server may connect\n");
+	printf("\n");
+	printf("     -sg GROUP, --socket-group GROUP\n");
+	printf("           Let the members of GROUP connect to the socket\n");
+	printf("\n");
+	printf("     -rg GROUP, --ring-group GROUP\n");
+	printf("           Let the clients running with GROUP as their primary group attach\n");
+	printf("           the shared memory ring, besides root and the user of the server.\n");
+	printf("           Every attached client can read every byte in the ring\n");
+	printf("\n");
+	printf("EXAMPLES:\n");
+	printf("     To start the server using two SwiftRNG devices:\n");
+	printf("           entropy-cl-server -cs 2\n");
+	printf("     To start the server with post processing disabled for distributing RAW device data:\n");
+	printf("           entropy-cl-server -cs 2 -dpp\n");
+	printf("     To start the server using a custom socket path:\n");
+	printf("           entropy-cl-server -cs 2 -sp /var/run/swiftrng.sock\n");
+	printf("     To let the members of group 'swiftrng' retrieve random bytes over the socket:\n");
+	printf("           entropy-cl-server -cs 2 -sg swiftrng\n");
+	printf("\n");
+}
+
+/**
+ * Parse max number of clients if specified
+ *
+ * @param int idx - current parameter number
+ * @param int argc - number of parameters
+ * @param char ** argv - parameters
+ * @return int - 0 when successfully parsed
+ */
+static int parseMaxClients(int idx, int argc, char **argv) {
+	if (idx < argc) {
+		if (strcmp("-mc", argv[idx]) == 0 || strcmp("--max-clients", argv[idx]) == 0) {
+			if (swrngValidateCLDaemonArgumentCount(&dmn, ++idx, argc) == val_false) {
+				return -1;
+			}
+			maxClients = atoi(argv[idx++]);
+			if (maxClients < 1 || maxClients > MAX_CLIENTS) {
+				fprintf(stderr, "Max clients parameter is invalid, must be an integer between 1 and %d\n", MAX_CLIENTS);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * Look up a group by name or number
+ *
+ * @param name - group name or number
+ * @param gid - pointer to the group id found
+ * @return int - 0 when found
+ */
+static int parseGroup(const char *name, gid_t *gid) {
+	struct group *grp = getgrnam(name);
+	char *end;
+
+	if (grp != NULL) {
+		*gid = grp->gr_gid;
+		return 0;
+	}
+	unsigned long num = strtoul(name, &end, 10);
+	if (*name == '\0' || *end != '\0' || num >= (unsigned long)(gid_t)-1) {
+		fprintf(stderr, "Group not found: %s\n", name);
+		return -1;
+	}
+	*gid = (gid_t)num;
+	return 0;
+}
+
+/**
+ * Parse command line parameters
+ *
+ * @param int argc
+ * @param char** argv
+ * @return int - 0 when run successfully
+ */
+static int processArguments(int argc, char **argv) {
+	int idx = 1;
+	while (idx < argc) {
+		int status = swrngParseCLDaemonArgument(&dmn, &idx, argc, argv);
+		if (status == -1) {
+			return -1;
+		} else if (status == 1) {
+			continue;
+		}
+		if (strcmp("-sp", argv[idx]) == 0 || strcmp("--socket-path", argv[idx]) == 0) {
+			if (swrngValidateCLDaemonArgumentCount(&dmn, ++idx, argc) == val_false) {
+				return -1;
+			}
+			socketPath = argv[idx++];
+			if (strlen(socketPath) >= sizeof(((struct sockaddr_un *)0)->sun_path)) {
+				fprintf(stderr, "Socket path is too long: %s\n", socketPath);
+				return -1;
+			}
+		} else if (strcmp("-sg", argv[idx]) == 0 || strcmp("--socket-group", argv[idx]) == 0) {
+			if (swrngValidateCLDaemonArgumentCount(&dmn, ++idx, argc) == val_false) {
+				return -1;
+			}
+			if (parseGroup(argv[idx++], &socketGid) == -1) {
+				return -1;
+			}
+		} else if (strcmp("-rg", argv[idx]) == 0 || strcmp("--ring-group", argv[idx]) == 0) {
+			if (swrngValidateCLDaemonArgumentCount(&dmn, ++idx, argc) == val_false) {
+				return -1;
+			}
+			if (parseGroup(argv[idx++], &ringGid) == -1) {
+				return -1;
+			}
+		} else if (parseMaxClients(idx, argc, argv) == -1) {
+			return -1;
+		} else {
+			// Could not handle the argument, skip to the next one
+			++idx;
+		}
+	}
+
+	return processServer();
+}
+
+/**
+ * Retrieve the information of the first device, before the cluster opens the devices
+ *
+ * @return int - 0 when run successfully
+ */
+static int retrieveDeviceInfo(void) {
+	SwrngContext hcxt;
+	DeviceInfoList dil;
+
+	swrngInitializeContext(&hcxt);
+	int status = swrngGetDeviceList(&hcxt, &dil);
+	swrngDestroyContext(&hcxt);
+	if (status != SWRNG_SUCCESS) {
+		fprintf(stderr, "Could not generate device info list, status: %d\n", status);
+		return status;
+	}
+	if (dil.numDevs == 0) {
+		fprintf(stderr, "There are currently no SwiftRNG devices available\n");
+		return -1;
+	}
+	devInfo = dil.devInfoList[0];
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Signal handler requesting the server to stop
+ *
+ * @param sig - signal number
+ */
+static void handleStopSignal(int sig) {
+	int savedErrno = errno;
+	(void)sig;
+	swrngRequestCLDaemonStop(&dmn);
+	errno = savedErrno;
+}
+
+/**
+ * Create the socket listening for clients, replacing a socket left over by a previous run.
+ * Only the user and the group of the socket may connect.
+ *
+ * @return int - 0 when run successfully
+ */
+static int createListenSocket(void) {
+	struct sockaddr_un addr;
+	struct stat st;
+
+	if (strcmp(socketPath, SWRNG_SERVER_DEFAULT_SOCKET_PATH) == 0 && mkdir(SWRNG_SERVER_DEFAULT_SOCKET_DIR, 0755) != 0
+			&& errno != EEXIST) {
+		fprintf(stderr, "Could not create %s: %s\n", SWRNG_SERVER_DEFAULT_SOCKET_DIR, strerror(errno));
+		return -1;
+	}
+	if (lstat(socketPath, &st) == 0 && S_ISSOCK(st.st_mode)) {
+		unlink(socketPath);
+	}
+
+	listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listenFd == -1) {
+		perror("Could not create the server socket");
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socketPath);
+
+	// Nobody else may connect before the group and the permissions are set
+	mode_t mask = umask(0177);
+	int status = bind(listenFd, (struct sockaddr *)&addr, sizeof(addr));
+	umask(mask);
+	if (status != 0) {
+		fprintf(stderr, "Could not bind the server socket to %s: %s\n", socketPath, strerror(errno));
+		return -1;
+	}
+	if ((socketGid != (gid_t)-1 && chown(socketPath, (uid_t)-1, socketGid) != 0) || chmod(socketPath, 0660) != 0
+			|| listen(listenFd, SOMAXCONN) != 0) {
+		perror("Could not set up the server socket");
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Called by the prefetch thread after adding random bytes, wakes up the event loop
+ *
+ * @param arg - not used
+ */
+static void notifyBytesAdded(void *arg) {
+	uint64_t one = 1;
+	(void)arg;
+	if (write(prefetchEventFd, &one, sizeof(one)) < 0) {
+		// The counter is already signaled
+	}
+}
+
+/**
+ * Create the shared memory ring. The files are sealed, so the clients cannot resize them.
+ * The ring state and the blocks are also sealed against writing once mapped by the server,
+ * the clients may only write to the claims.
+ *
+ * @return int - 0 when run successfully
+ */
+static int createRing(void) {
+	size_t sizes[SWRNG_SERVER_RING_NUM_FILES] = {sizeof(SwrngServerRingClaims), sizeof(SwrngServerRingState),
+			(size_t)SWRNG_SERVER_RING_BLOCK_SIZE * SWRNG_SERVER_RING_NUM_BLOCKS};
+	const char *names[SWRNG_SERVER_RING_NUM_FILES] = {"swiftrng-ring-claims", "swiftrng-ring-state", "swiftrng-ring-data"};
+	void *maps[SWRNG_SERVER_RING_NUM_FILES];
+
+	for (int i = 0; i < SWRNG_SERVER_RING_NUM_FILES; i++) {
+		ringFds[i] = memfd_create(names[i], MFD_CLOEXEC | MFD_ALLOW_SEALING);
+		if (ringFds[i] == -1 || ftruncate(ringFds[i], sizes[i]) != 0) {
+			perror("Could not create the shared memory ring");
+			return -1;
+		}
+		maps[i] = mmap(NULL, sizes[i], PROT_READ | PROT_WRITE, MAP_SHARED, ringFds[i], 0);
+		if (maps[i] == MAP_FAILED) {
+			perror("Could not map the shared memory ring");
+			return -1;
+		}
+		int seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+		if (i > 0) {
+			seals |= F_SEAL_FUTURE_WRITE;
+		}
+		if (fcntl(ringFds[i], F_ADD_SEALS, seals) != 0) {
+			perror("Could not seal the shared memory ring");
+			return -1;
+		}
+	}
+
+	ringClaims = (SwrngServerRingClaims *)maps[0];
+	ringState = (SwrngServerRingState *)maps[1];
+	ringData = (unsigned char *)maps[2];
+	ringState->magic = SWRNG_SERVER_RING_MAGIC;
+	ringState->version = SWRNG_SERVER_RING_VERSION;
+	ringState->block_size = SWRNG_SERVER_RING_BLOCK_SIZE;
+	ringState->num_blocks = SWRNG_SERVER_RING_NUM_BLOCKS;
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Ring thread, keeps the shared memory ring filled with random bytes from the cluster.
+ * A block is overwritten only when the clients claimed the bytes of the block after it,
+ * which leaves a block of slack for the clients still copying the bytes they claimed.
+ *
+ * @param arg - not used
+ * @return NULL
+ */
+static void *ringRun(void *arg) {
+	const uint64_t blockSize = SWRNG_SERVER_RING_BLOCK_SIZE;
+	struct timespec timeout = {SWRNG_CL_DAEMON_REOPEN_WAIT_SECS, 0};
+	uint64_t writePos = 0;
+	(void)arg;
+
+	while (swrngIsCLDaemonStopRequested(&dmn) == val_false) {
+		if (writePos >= __atomic_load_n(&ringClaims->claim_pos, __ATOMIC_SEQ_CST) / blockSize + SWRNG_SERVER_RING_NUM_BLOCKS - 1) {
+			// The ring is full, wait for the clients with a timeout for checking if stopping
+			__atomic_store_n(&ringState->space_waiter, 1, __ATOMIC_SEQ_CST);
+			uint32_t seq = __atomic_load_n(&ringClaims->space_futex, __ATOMIC_SEQ_CST);
+			if (writePos >= __atomic_load_n(&ringClaims->claim_pos, __ATOMIC_SEQ_CST) / blockSize + SWRNG_SERVER_RING_NUM_BLOCKS - 1) {
+				syscall(SYS_futex, &ringClaims->space_futex, FUTEX_WAIT, seq, &timeout, NULL, 0);
+			}
+			__atomic_store_n(&ringState->space_waiter, 0, __ATOMIC_SEQ_CST);
+			continue;
+		}
+
+		uint64_t slot = writePos % SWRNG_SERVER_RING_NUM_BLOCKS;
+		__atomic_store_n(&ringState->block_seq[slot], 0, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (swrngRetrieveCLDaemonBytes(&dmn, ringData + slot * blockSize, (long)blockSize) != SWRNG_SUCCESS) {
+			break;
+		}
+		__atomic_store_n(&ringState->block_seq[slot], writePos + 1, __ATOMIC_RELEASE);
+		writePos++;
+		__atomic_store_n(&ringState->write_pos, writePos, __ATOMIC_SEQ_CST);
+		__atomic_fetch_add(&ringState->data_futex, 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&ringClaims->num_data_waiters, __ATOMIC_SEQ_CST) > 0) {
+			syscall(SYS_futex, &ringState->data_futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Start the server and run the event loop until stopped by a signal
+ *
+ * @return int - 0 when run successfully
+ */
+static int processServer(void) {
+	struct epoll_event ev;
+	struct epoll_event events[MAX_EPOLL_EVENTS];
+	struct sigaction sa;
+	uint64_t cnt;
+	int status;
+
+	if (retrieveDeviceInfo() != SWRNG_SUCCESS) {
+		return -1;
+	}
+	status = swrngOpenCLDaemonCluster(&dmn, val_true);
+	if (status != SWRNG_SUCCESS) {
+		return status;
+	}
+
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	prefetchEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epollFd == -1 || prefetchEventFd == -1) {
+		fprintf(stderr, "Could not allocate the server resources\n");
+		swrngCLClose(&dmn.cxt);
+		return -1;
+	}
+	if (createRing() != SWRNG_SUCCESS || createListenSocket() != SWRNG_SUCCESS) {
+		swrngCLClose(&dmn.cxt);
+		return -1;
+	}
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.ptr = &listenFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+	ev.data.ptr = &prefetchEventFd;
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, prefetchEventFd, &ev);
+
+	// Stop on these signals, interrupting epoll_wait()
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handleStopSignal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);
+
+	if (swrngStartCLDaemonPrefetch(&dmn, PREFETCH_BUFF_SIZE, SWRNG_SERVER_MAX_REPLY_BYTES, notifyBytesAdded, NULL)
+			!= SWRNG_SUCCESS) {
+		swrngCLClose(&dmn.cxt);
+		unlink(socketPath);
+		return -1;
+	}
+	int ringStarted = pthread_create(&ringThread, NULL, ringRun, NULL) == 0 ? val_true : val_false;
+	if (ringStarted == val_false) {
+		fprintf(stderr, "Could not create the ring thread\n");
+		swrngRequestCLDaemonStop(&dmn);
+	}
+
+	printf("Entropy server started using a cluster of %d devices, post processing: '%s', statistical tests %s, on socket: %s\n",
+			swrngGetCLSize(&dmn.cxt), dmn.post_processing_enabled == val_false ? "none"
+					: (dmn.pp_method != NULL ? dmn.pp_method : "default"),
+			dmn.statistical_tests_enabled == val_true ? "enabled" : "disabled", socketPath);
+
+	while (swrngIsCLDaemonStopRequested(&dmn) == val_false) {
+		int numEvents = epoll_wait(epollFd, events, MAX_EPOLL_EVENTS, -1);
+		for (int i = 0; i < numEvents; i++) {
+			if (events[i].data.ptr == &listenFd) {
+				acceptClients();
+			} else if (events[i].data.ptr == &prefetchEventFd) {
+				if (read(prefetchEventFd, &cnt, sizeof(cnt)) > 0) {
+					serveWaitingClients();
+				}
+			} else {
+				handleClientEvent((ClientInst *)events[i].data.ptr, events[i].events);
+			}
+		}
+		releaseClosedClients();
+	}
+
+	printf("Stopping entropy server\n");
+	swrngStopCLDaemonPrefetch(&dmn);
+	if (ringStarted == val_true) {
+		pthread_join(ringThread, NULL);
+	}
+	close(listenFd);
+	unlink(socketPath);
+	swrngCLClose(&dmn.cxt);
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Accept the clients connecting, the connections over the limit are closed right away
+ */
+static void acceptClients(void) {
+	int fd;
+
+	while ((fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) != -1) {
+		ClientInst *client = NULL;
+		if (numClients < maxClients) {
+			client = (ClientInst *)malloc(sizeof(ClientInst));
+		}
+		if (client == NULL) {
+			close(fd);
+			continue;
+		}
+		memset(client, 0, offsetof(ClientInst, reply));
+		client->fd = fd;
+		client->state = READING_STATE;
+		client->nextWaiting = NULL;
+		numClients++;
+		if (watchClient(client, EPOLLIN) != SWRNG_SUCCESS) {
+			closeClient(client);
+		}
+	}
+}
+
+/**
+ * Add or change the events watched for a client
+ *
+ * @param client - pointer to the client
+ * @param events - epoll events, 0 for watching only for errors and hang ups
+ * @return int - 0 when run successfully
+ */
+static int watchClient(ClientInst *client, uint32_t events) {
+	struct epoll_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = events;
+	ev.data.ptr = client;
+	if (epoll_ctl(epollFd, EPOLL_CTL_MOD, client->fd, &ev) == 0) {
+		return SWRNG_SUCCESS;
+	}
+	return epoll_ctl(epollFd, EPOLL_CTL_ADD, client->fd, &ev);
+}
+
+/**
+ * Close the connection of a client. The client is released after the current batch of epoll events,
+ * which may still hold events of it.
+ *
+ * @param client - pointer to the client
+ */
+static void closeClient(ClientInst *client) {
+	if (client->state == CLOSED_STATE) {
+		return;
+	}
+	if (client->state == WAITING_STATE) {
+		ClientInst **link = &waitingHead;
+		ClientInst *prev = NULL;
+		while (*link != client) {
+			prev = *link;
+			link = &(*link)->nextWaiting;
+		}
+		*link = client->nextWaiting;
+		if (waitingTail == client) {
+			waitingTail = prev;
+		}
+	}
+	close(client->fd);
+	client->state = CLOSED_STATE;
+	client->nextWaiting = closedHead;
+	closedHead = client;
+	numClients--;
+}
+
+/**
+ * Release the clients closed while handling the last batch of epoll events
+ */
+static void releaseClosedClients(void) {
+	while (closedHead != NULL) {
+		ClientInst *client = closedHead;
+		closedHead = client->nextWaiting;
+		free(client);
+	}
+}
+
+/**
+ * Handle the epoll events of a client
+ *
+ * @param client - pointer to the client
+ * @param events - epoll events received
+ */
+static void handleClientEvent(ClientInst *client, uint32_t events) {
+	if (client->state == CLOSED_STATE) {
+		return;
+	}
+	if (events & (EPOLLERR | EPOLLHUP)) {
+		closeClient(client);
+	} else if (client->state == READING_STATE && (events & EPOLLIN)) {
+		readRequest(client);
+	} else if (client->state == WRITING_STATE && (events & EPOLLOUT)) {
+		writeReply(client);
+	}
+}
+
+/**
+ * Read the request of a client, processing it once complete
+ *
+ * @param client - pointer to the client
+ */
+static void readRequest(ClientInst *client) {
+	ssize_t cnt = recv(client->fd, (unsigned char *)&client->request + client->cbRead,
+			sizeof(SwrngServerRequest) - client->cbRead, 0);
+	if (cnt == 0 || (cnt < 0 && errno != EAGAIN && errno != EINTR)) {
+		closeClient(client);
+		return;
+	}
+	if (cnt > 0) {
+		client->cbRead += (size_t)cnt;
+		if (client->cbRead == sizeof(SwrngServerRequest)) {
+			processRequest(client);
+		}
+	}
+}
+
+/**
+ * Process the request of a client. Random bytes are served from the prefetch buffer,
+ * the client waits in turn if there are not enough of them.
+ *
+ * @param client - pointer to the client
+ */
+static void processRequest(ClientInst *client) {
+	if (client->request.cbReqData == 0 || client->request.cbReqData > SWRNG_SERVER_MAX_REPLY_BYTES) {
+		closeClient(client);
+		return;
+	}
+	client->cbFilled = 0;
+	client->cbWritten = 0;
+
+	if (client->request.cmd == CMD_ENTROPY_RETRIEVE_ID) {
+		// Stop reading from the client until it is served
+		client->state = WAITING_STATE;
+		if (watchClient(client, 0) != SWRNG_SUCCESS) {
+			client->state = READING_STATE;
+			closeClient(client);
+			return;
+		}
+		if (waitingTail == NULL) {
+			waitingHead = client;
+		} else {
+			waitingTail->nextWaiting = client;
+		}
+		waitingTail = client;
+		client->nextWaiting = NULL;
+		serveWaitingClients();
+		return;
+	}
+	if (client->request.cmd == CMD_RING_ATTACH_ID) {
+		if (isRingAllowed(client) == val_false) {
+			closeClient(client);
+			return;
+		}
+		sendRingDescriptors(client);
+		return;
+	}
+
+	if (fillReply(client) != SWRNG_SUCCESS) {
+		closeClient(client);
+		return;
+	}
+	client->state = WRITING_STATE;
+	writeReply(client);
+}
+
+/**
+ * Check if a client may attach the shared memory ring. Every attached client can read every byte
+ * in the ring, so it is handed out only to root, the user of the server and the ring group.
+ *
+ * @param client - pointer to the client
+ * @return int - 1 when allowed
+ */
+static int isRingAllowed(ClientInst *client) {
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+
+	if (getsockopt(client->fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) {
+		return val_false;
+	}
+	if (cred.uid == 0 || cred.uid == geteuid() || (ringGid != (gid_t)-1 && cred.gid == ringGid)) {
+		return val_true;
+	}
+	fprintf(stderr, "Shared memory ring refused to process %d of user %u\n", (int)cred.pid, (unsigned)cred.uid);
+	return val_false;
+}
+
+/**
+ * Send the files of the shared memory ring to a client, with a reply of one byte
+ *
+ * @param client - pointer to the client
+ */
+static void sendRingDescriptors(ClientInst *client) {
+	union {
+		struct cmsghdr hdr;
+		char buf[CMSG_SPACE(sizeof(ringFds))];
+	} control;
+	unsigned char reply = 0;
+	struct iovec iov;
+	struct msghdr msg;
+
+	if (client->request.cbReqData != sizeof(reply)) {
+		closeClient(client);
+		return;
+	}
+	iov.iov_base = &reply;
+	iov.iov_len = sizeof(reply);
+	memset(&msg, 0, sizeof(msg));
+	memset(&control, 0, sizeof(control));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+	struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(ringFds));
+	memcpy(CMSG_DATA(cmsg), ringFds, sizeof(ringFds));
+
+	// A single byte always fits in the socket buffer of a client waiting for the reply
+	if (sendmsg(client->fd, &msg, MSG_NOSIGNAL) != sizeof(reply)) {
+		closeClient(client);
+		return;
+	}
+	client->cbRead = 0;
+}
+
+/**
+ * Fill the reply of a request other than retrieving random bytes
+ *
+ * @param client - pointer to the client
+ * @return int - 0 when run successfully
+ */
+static int fillReply(ClientInst *client) {
+	uint32_t len = client->request.cbReqData;
+	unsigned char testCounter = 0;
+	const char *pos;
+
+	memset(client->reply, 0, len);
+	switch (client->request.cmd) {
+	case CMD_DIAG_ID:
+		for (uint32_t t = 0; t < len; t++) {
+			client->reply[t] = testCounter++;
+		}
+		break;
+	case CMD_DEV_SER_NUM_ID:
+		memset(client->reply, ' ', len < SWRNG_SERVER_SER_NUM_BYTES ? len : SWRNG_SERVER_SER_NUM_BYTES);
+		memcpy(client->reply, devInfo.sn.value, len < strlen(devInfo.sn.value) ? len : strlen(devInfo.sn.value));
+		break;
+	case CMD_DEV_MODEL_ID:
+		memset(client->reply, ' ', len < SWRNG_SERVER_MODEL_BYTES ? len : SWRNG_SERVER_MODEL_BYTES);
+		memcpy(client->reply, devInfo.dm.value, len < strlen(devInfo.dm.value) ? len : strlen(devInfo.dm.value));
+		break;
+	case CMD_DEV_MAJOR_VERSION_ID:
+		// The version is formatted as 'V1.2'
+		if (strchr(devInfo.dv.value, '.') == NULL) {
+			return -1;
+		}
+		client->reply[0] = (unsigned char)atoi(devInfo.dv.value + 1);
+		break;
+	case CMD_DEV_MINOR_VERSION_ID:
+		pos = strchr(devInfo.dv.value, '.');
+		if (pos == NULL) {
+			return -1;
+		}
+		client->reply[0] = (unsigned char)atoi(pos + 1);
+		break;
+	case CMD_SERV_MAJOR_VERSION_ID:
+		client->reply[0] = (unsigned char)serverMajorVersion;
+		break;
+	case CMD_SERV_MINOR_VERSION_ID:
+		client->reply[0] = (unsigned char)serverMinorVersion;
+		break;
+	default:
+		// The noise sources cannot be read while the cluster is downloading
+		fprintf(stderr, "Invalid command received: %u \n", client->request.cmd);
+		return -1;
+	}
+	client->cbFilled = len;
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Fill the replies of the waiting clients in turn with the prefetched random bytes
+ */
+static void serveWaitingClients(void) {
+	while (waitingHead != NULL) {
+		ClientInst *client = waitingHead;
+		pthread_mutex_lock(&dmn.prefetch_mutex);
+		client->cbFilled += swrngTakeCLDaemonBytes(&dmn, client->reply + client->cbFilled,
+				client->request.cbReqData - client->cbFilled);
+		pthread_mutex_unlock(&dmn.prefetch_mutex);
+		if (client->cbFilled < client->request.cbReqData) {
+			return;
+		}
+		waitingHead = client->nextWaiting;
+		if (waitingHead == NULL) {
+			waitingTail = NULL;
+		}
+		client->state = WRITING_STATE;
+		writeReply(client);
+	}
+}
+
+/**
+ * Write as much of the reply of a client as the socket takes, waiting for the socket to be writable
+ * for the rest. The next request is read once the reply is written.
+ *
+ * @param client - pointer to the client
+ */
+static void writeReply(ClientInst *client) {
+	while (client->cbWritten < client->cbFilled) {
+		ssize_t cnt = send(client->fd, client->reply + client->cbWritten, client->cbFilled - client->cbWritten,
+				MSG_NOSIGNAL);
+		if (cnt < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno != EAGAIN || watchClient(client, EPOLLOUT) != SWRNG_SUCCESS) {
+				closeClient(client);
+			}
+			return;
+		}
+		client->cbWritten += (size_t)cnt;
+	}
+	client->state = READING_STATE;
+	client->cbRead = 0;
+	if (watchClient(client, EPOLLIN) != SWRNG_SUCCESS) {
+		closeClient(client);
+	}
+}
+
+/**
+ * Process command line arguments
+ *
+ * @param int argc - number of parameters
+ * @param char ** argv - parameters
+ * @return int - 0 when run successfully
+ */
+static int process(int argc, char **argv) {
+	int status = swrngInitializeCLDaemon(&dmn, displayUsage);
+	if (status != SWRNG_SUCCESS) {
+		return status;
+	}
+	if (argc == 1) {
+		displayUsage();
+		return -1;
+	}
+	return processArguments(argc, argv);
+}
+
+/**
+ * Main entry
+ *
+ * @param int argc - number of parameters
+ * @param char ** argv - parameters
+ *
+ */
+int main(int argc, char **argv) {
+	setbuf(stdout, NULL);
+	return process(argc, argv);
+}
@@ -0,0 +1,173 @@
+/*
+ * entropy-cl-server.h
+ * Ver. 1.0
+ *
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This program is used for interacting with a cluster of SwiftRNG devices for the purpose of
+ downloading and distributing true random bytes to local processes over a Unix domain socket.
+
+ This program requires the libusb-1.0 library when communicating with any SwiftRNG device. Please read the provided
+ documentation for libusb-1.0 installation details.
+
+ This program uses libusb-1.0 (directly or indirectly) which is distributed under the terms of the GNU Lesser General
+ Public License as published by the Free Software Foundation. For more information, please visit: http://libusb.info
+
+ This program may only be used in conjunction with TectroLabs devices.
+
+ This program may require 'sudo' permissions when running on Linux.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef ENTROPY_CL_SERVER_H_
+#define ENTROPY_CL_SERVER_H_
+
+/* Needed for accept4() and memfd_create() */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <swrng-cl-daemon.h>
+#include <entropy-server-api.h>
+#include <stddef.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <limits.h>
+#include <grp.h>
+
+#define DEFAULT_MAX_CLIENTS 256
+#define MAX_CLIENTS 65536
+#define MAX_EPOLL_EVENTS 64
+
+/* Sealing a memory file against writing, except through the mappings made before (Linux 5.1+) */
+#ifndef F_SEAL_FUTURE_WRITE
+#define F_SEAL_FUTURE_WRITE 0x0010
+#endif
+
+/* Number of bytes prefetched from the cluster, a multiple of the max request size */
+#define PREFETCH_BUFF_SIZE (SWRNG_SERVER_MAX_REPLY_BYTES * 40)
+
+#define READING_STATE 0
+#define WAITING_STATE 1
+#define WRITING_STATE 2
+#define CLOSED_STATE 3
+
+/*
+ * Structures
+ */
+
+typedef struct ClientInst {
+	int fd;
+	int state;
+
+	/* Request received and how many of its bytes were read so far */
+	SwrngServerRequest request;
+	size_t cbRead;
+
+	/* Reply, how many bytes of it are filled and how many were sent */
+	unsigned char reply[SWRNG_SERVER_MAX_REPLY_BYTES];
+	size_t cbFilled;
+	size_t cbWritten;
+
+	/* Next client waiting for random bytes, or the next closed client to release */
+	struct ClientInst *nextWaiting;
+} ClientInst;
+
+static const int val_true = 1;
+static const int val_false = 0;
+
+static const char serverMajorVersion = 1;
+static const char serverMinorVersion = 0;
+
+/**
+ * Variables
+ */
+
+/* Path of the server socket (a command line argument) */
+static const char *socketPath = SWRNG_SERVER_DEFAULT_SOCKET_PATH;
+
+/* Group allowed to connect to the server socket, -1 for the group of the server (a command line argument) */
+static gid_t socketGid = (gid_t)-1;
+
+/* Group allowed to attach the shared memory ring besides root and the user of the server, -1 for none (a command line argument) */
+static gid_t ringGid = (gid_t)-1;
+
+/* Max number of clients connected at the same time (a command line argument) */
+static int maxClients = DEFAULT_MAX_CLIENTS;
+
+/* The cluster with its settings and the prefetch buffer, drained by the event loop */
+static SwrngCLDaemon dmn;
+
+/* Information of the first device, served to the clients asking for the device serial number, model and version */
+static DeviceInfo devInfo;
+
+static int listenFd = -1;
+static int epollFd = -1;
+
+/* Signaled by the prefetch thread when random bytes were added */
+static int prefetchEventFd = -1;
+
+static int numClients = 0;
+
+/* Clients waiting for random bytes, served in turn */
+static ClientInst *waitingHead = NULL;
+static ClientInst *waitingTail = NULL;
+
+/* Clients closed while handling a batch of epoll events, released after the batch */
+static ClientInst *closedHead = NULL;
+
+/*
+ * The shared memory ring, filled by the ring thread and drained by the clients directly.
+ * The clients receive the file of the claims and the sealed files of the ring state and of the blocks.
+ */
+static SwrngServerRingState *ringState = NULL;
+static SwrngServerRingClaims *ringClaims = NULL;
+static unsigned char *ringData = NULL;
+static int ringFds[SWRNG_SERVER_RING_NUM_FILES] = {-1, -1, -1};
+static pthread_t ringThread;
+
+/**
+ * Function Declarations
+ */
+
+static void displayUsage(void);
+static int process(int argc, char **argv);
+static int processArguments(int argc, char **argv);
+static int parseMaxClients(int idx, int argc, char **argv);
+static int parseGroup(const char *name, gid_t *gid);
+static int retrieveDeviceInfo(void);
+static int processServer(void);
+static int createListenSocket(void);
+static void handleStopSignal(int sig);
+static void notifyBytesAdded(void *arg);
+static int createRing(void);
+static void *ringRun(void *arg);
+static int isRingAllowed(ClientInst *client);
+static void sendRingDescriptors(ClientInst *client);
+static void acceptClients(void);
+static void closeClient(ClientInst *client);
+static void releaseClosedClients(void);
+static void handleClientEvent(ClientInst *client, uint32_t events);
+static void readRequest(ClientInst *client);
+static void processRequest(ClientInst *client);
+static int fillReply(ClientInst *client);
+static void serveWaitingClients(void);
+static void writeReply(ClientInst *client);
+static int watchClient(ClientInst *client, uint32_t events);
+
+#endif /* ENTROPY_CL_SERVER_H_ */
@@ -0,0 +1,112 @@
+/*
+ * sample-server.c
+ * Ver. 1.0
+ *
+ * @brief This is a sample C program that demonstrates how to retrieve random bytes from
+ * a running 'entropy-cl-server' using 'entropy-server-api' API for C language.
+ *
+ */
+#include <stdio.h>
+#include <entropy-server-api.h>
+
+#define BYTE_BUFF_SIZE (10)
+#define DEC_BUFF_SIZE (10)
+
+/* Allocate memory for random bytes */
+unsigned char random_byte[BYTE_BUFF_SIZE];
+
+/* Allocate memory for random integers */
+unsigned int random_int[DEC_BUFF_SIZE];
+
+/****************
+ * Main entry
+ ****************/
+int main() {
+	int i;
+	double d;
+	unsigned int ui;
+	int major;
+	int minor;
+	DeviceModel model;
+	SwrngServerConnection conn;
+	SwrngServerRing ring;
+
+	printf("-------------------------------------------------------------------------------------------\n");
+	printf("------------ Sample C program for retrieving random bytes from the entropy server ---------\n");
+	printf("-------------------------------------------------------------------------------------------\n");
+
+	/* Initialize the connection using the default socket path */
+	if (swrngInitializeServerConnection(&conn, NULL) != SWRNG_SUCCESS) {
+		printf("Could not initialize connection\n");
+		return 1;
+	}
+
+	/* Connect to the server */
+	if (swrngConnectServer(&conn) != SWRNG_SUCCESS) {
+		printf("%s\n", swrngGetServerLastErrorMessage(&conn));
+		return 1;
+	}
+
+	if (swrngGetServerVersion(&conn, &major, &minor) != SWRNG_SUCCESS
+			|| swrngGetServerDeviceModel(&conn, &model) != SWRNG_SUCCESS) {
+		printf("%s\n", swrngGetServerLastErrorMessage(&conn));
+		swrngDisconnectServer(&conn);
+		return 1;
+	}
+
+	printf("\nConnected to entropy server version %d.%d using %s devices\n\n", major, minor, model.value);
+
+	/* Retrieve random bytes from the server */
+	if (swrngGetServerEntropy(&conn, random_byte, BYTE_BUFF_SIZE) != SWRNG_SUCCESS) {
+		printf("%s\n", swrngGetServerLastErrorMessage(&conn));
+		swrngDisconnectServer(&conn);
+		return 1;
+	}
+
+	printf("*** Generating %d random bytes ***\n", BYTE_BUFF_SIZE);
+	/* Print random bytes */
+	for (i = 0; i < BYTE_BUFF_SIZE; i++) {
+		printf("random byte %d -> %d\n", i, (int)random_byte[i]);
+	}
+
+	/* Retrieve random integers from the server */
+	if (swrngGetServerEntropy(&conn, (unsigned char*)random_int, DEC_BUFF_SIZE * sizeof(unsigned int)) != SWRNG_SUCCESS) {
+		printf("%s\n", swrngGetServerLastErrorMessage(&conn));
+		swrngDisconnectServer(&conn);
+		return 1;
+	}
+
+	printf("\n*** Generating %d random numbers between 0 and 1 with 5 decimals  ***\n", DEC_BUFF_SIZE);
+	/* Print random numbers */
+	for (i = 0; i < DEC_BUFF_SIZE; i++) {
+		ui = random_int[i] % 99999;
+		d = (double)ui / 100000.0;
+		printf("random number -> %lf\n", d);
+	}
+
+	/* Attach the shared memory ring for retrieving random bytes without a request to the server */
+	if (swrngAttachServerRing(&conn, &ring) != SWRNG_SUCCESS) {
+		printf("%s\n", swrngGetServerLastErrorMessage(&conn));
+		swrngDisconnectServer(&conn);
+		return 1;
+	}
+
+	if (swrngGetServerRingEntropy(&ring, random_byte, BYTE_BUFF_SIZE) != SWRNG_SUCCESS) {
+		printf("Entropy server stopped\n");
+		swrngDetachServerRing(&ring);
+		swrngDisconnectServer(&conn);
+		return 1;
+	}
+
+	printf("\n*** Generating %d random bytes using the shared memory ring ***\n", BYTE_BUFF_SIZE);
+	/* Print random bytes */
+	for (i = 0; i < BYTE_BUFF_SIZE; i++) {
+		printf("random byte %d -> %d\n", i, (int)random_byte[i]);
+	}
+
+	printf("\n");
+	swrngDetachServerRing(&ring);
+	swrngDisconnectServer(&conn);
+	return 0;
+
+}
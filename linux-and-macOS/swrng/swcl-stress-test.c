@@ -0,0 +1,501 @@
+/*
+ * swcl-stress-test.c
+ * Ver. 1.0
+ *
+ * @brief This program stress tests the cluster API with a cluster of the max size made of simulated devices
+ * and many concurrent consumers. The simulated devices replace the SwiftRNG device API at link time, so it does not
+ * need any SwiftRNG device.
+ *
+ * Each simulated device fills its downloads with 64-bit words holding the device number and a counter.
+ * The consumers verify that every word is delivered exactly once and in order while some devices fail
+ * and are replaced by devices plugged in during the test.
+ *
+ * All the devices are then unplugged for longer than the cluster waits for a device to come back, and one
+ * device is plugged in again while more consumers than ring slots wait for random bytes. Each of them must
+ * receive random bytes again, the consumers giving up must not leave the others waiting forever.
+ */
+
+#include <swrng-cl-api.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Number of threads retrieving random bytes from the cluster */
+#define NUM_CONSUMERS (8)
+
+/* Max number of bytes a consumer retrieves at once, the requests are multiples of 8 bytes */
+#define MAX_REQUEST_BYTES (64 * 1024)
+
+/* How long the consumers run */
+#define TEST_DURATION_SECS (5)
+
+/* Number of devices available for replacing the failing ones */
+#define NUM_SPARE_DEVICES (4)
+
+/* Number of devices that fail during the test and the number of downloads after which they fail */
+#define NUM_FAILING_DEVICES (2)
+#define FAIL_AFTER_DOWNLOADS (40)
+
+/* Time a simulated device takes for each download */
+#define DOWNLOAD_DELAY_USECS (2000)
+
+#define MAX_DEVICES (SWRNG_CL_MAX_SIZE + NUM_SPARE_DEVICES)
+
+/* Number of consumers waiting while no device is plugged in, more than the max number of ring slots */
+#define NUM_WAITING_CONSUMERS (40)
+
+/* Number of bytes the waiting consumers retrieve at once, the size of a ring slot */
+#define WAITING_REQUEST_BYTES (100000)
+
+/* Delay between starting each waiting consumer, so they give up waiting at different times */
+#define WAITING_CONSUMER_DELAY_USECS (100000)
+
+/* How long after the first waiting consumer starts to plug a device in again, past the cluster fail-over wait */
+#define REPLUG_AFTER_SECS (7)
+
+/* How long the waiting consumers may take to receive random bytes from the device plugged in again */
+#define RECOVERY_TIMEOUT_SECS (20)
+
+/**
+ * A simulated device
+ */
+typedef struct {
+	/* 1 - used by a cluster slot, 0 - otherwise */
+	int open;
+
+	/* 1 - the device failed and was unplugged, 0 - otherwise */
+	int unplugged;
+
+	/* Number of downloads after which the device fails, -1 if it never fails */
+	long fail_after;
+
+	long num_downloads;
+
+	/* Counter of the next word the device generates */
+	uint64_t next_counter;
+} SimDevice;
+
+/**
+ * What the consumers received from a simulated device
+ */
+typedef struct {
+	uint64_t num_words;
+	uint64_t max_counter;
+	uint64_t counter_sum;
+} DeviceTally;
+
+static SimDevice simDevices[MAX_DEVICES];
+static int numSimDevices;
+static int numSimFailures;
+static pthread_mutex_t simMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static SwrngDeviceEventCallback monitorCallback;
+static void *monitorCallbackArg;
+
+static SwrngCLContext clCtxt;
+static DeviceTally tallies[MAX_DEVICES];
+static volatile int stopConsumers;
+static volatile int consumerFailed;
+
+/* Number of successful requests of each waiting consumer */
+static volatile long waitingSuccesses[NUM_WAITING_CONSUMERS];
+
+/**
+ * Simulated SwiftRNG device API, only the functions used by the cluster API
+ */
+
+int swrngInitializeContext(SwrngContext *ctxt) {
+	ctxt->api = NULL;
+	return SWRNG_SUCCESS;
+}
+
+int swrngDestroyContext(SwrngContext *ctxt) {
+	SimDevice *dev = (SimDevice *)ctxt->api;
+
+	if (dev != NULL) {
+		pthread_mutex_lock(&simMutex);
+		dev->open = 0;
+		pthread_mutex_unlock(&simMutex);
+		ctxt->api = NULL;
+	}
+	return SWRNG_SUCCESS;
+}
+
+int swrngGetDeviceCount(SwrngContext *ctxt, int *device_count) {
+	(void)ctxt;
+	*device_count = numSimDevices;
+	return SWRNG_SUCCESS;
+}
+
+int swrngOpen(SwrngContext *ctxt, int dev_num) {
+	int status = -1;
+
+	pthread_mutex_lock(&simMutex);
+	if (dev_num >= 0 && dev_num < numSimDevices && !simDevices[dev_num].open && !simDevices[dev_num].unplugged) {
+		simDevices[dev_num].open = 1;
+		ctxt->api = &simDevices[dev_num];
+		status = SWRNG_SUCCESS;
+	}
+	pthread_mutex_unlock(&simMutex);
+	return status;
+}
+
+int swrngGetVersion(SwrngContext *ctxt, DeviceVersion *version) {
+	(void)ctxt;
+	strcpy(version->value, "V1.2");
+	return SWRNG_SUCCESS;
+}
+
+int swrngGetEntropy(SwrngContext *ctxt, unsigned char *buffer, long length) {
+	SimDevice *dev = (SimDevice *)ctxt->api;
+	uint64_t word;
+
+	if (dev == NULL) {
+		return -1;
+	}
+	usleep(DOWNLOAD_DELAY_USECS);
+	if (dev->fail_after >= 0 && dev->num_downloads >= dev->fail_after) {
+		pthread_mutex_lock(&simMutex);
+		if (!dev->unplugged) {
+			dev->unplugged = 1;
+			numSimFailures++;
+		}
+		pthread_mutex_unlock(&simMutex);
+		return -EIO;
+	}
+	for (long i = 0; i + 8 <= length; i += 8) {
+		word = ((uint64_t)(dev - simDevices + 1) << 48) | dev->next_counter++;
+		memcpy(buffer + i, &word, 8);
+	}
+	dev->num_downloads++;
+	return SWRNG_SUCCESS;
+}
+
+const char* swrngGetLastErrorMessage(SwrngContext *ctxt) {
+	(void)ctxt;
+	return "Simulated device failure";
+}
+
+int swrngGetLiveStatistics(SwrngContext *ctxt, DeviceLiveStatistics *stats) {
+	(void)ctxt;
+	memset(stats, 0, sizeof(DeviceLiveStatistics));
+	return SWRNG_SUCCESS;
+}
+
+int swrngSetPowerProfile(SwrngContext *ctxt, int power_profile_number) {
+	(void)ctxt;
+	(void)power_profile_number;
+	return SWRNG_SUCCESS;
+}
+
+int swrngEnablePostProcessing(SwrngContext *ctxt, int post_processing_method_id) {
+	(void)ctxt;
+	(void)post_processing_method_id;
+	return SWRNG_SUCCESS;
+}
+
+int swrngDisablePostProcessing(SwrngContext *ctxt) {
+	(void)ctxt;
+	return SWRNG_SUCCESS;
+}
+
+int swrngEnableStatisticalTests(SwrngContext *ctxt) {
+	(void)ctxt;
+	return SWRNG_SUCCESS;
+}
+
+int swrngDisableStatisticalTests(SwrngContext *ctxt) {
+	(void)ctxt;
+	return SWRNG_SUCCESS;
+}
+
+int swrngStartDeviceMonitor(SwrngDeviceMonitorContext *ctxt, SwrngDeviceEventCallback callback, void *arg) {
+	(void)ctxt;
+	pthread_mutex_lock(&simMutex);
+	monitorCallback = callback;
+	monitorCallbackArg = arg;
+	pthread_mutex_unlock(&simMutex);
+	return SWRNG_SUCCESS;
+}
+
+int swrngStopDeviceMonitor(SwrngDeviceMonitorContext *ctxt) {
+	(void)ctxt;
+	pthread_mutex_lock(&simMutex);
+	monitorCallback = NULL;
+	pthread_mutex_unlock(&simMutex);
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Report the failed devices as plugged in again, the replacements are the spare devices
+ *
+ * @param int *numReported - number of device failures already reported
+ */
+static void reportReplacedDevices(int *numReported) {
+	pthread_mutex_lock(&simMutex);
+	while (*numReported < numSimFailures && monitorCallback != NULL) {
+		(*numReported)++;
+		monitorCallback(monitorCallbackArg, 1);
+	}
+	pthread_mutex_unlock(&simMutex);
+}
+
+/**
+ * Record the words received by a consumer, each device's words must arrive in order
+ *
+ * @param const uint64_t *words - words received
+ * @param long numWords - number of words received
+ * @param uint64_t *lastCounters - per device counter of the last word received by the consumer plus 1
+ * @return 0 - successful or -1 on failure
+ */
+static int tallyWords(const uint64_t *words, long numWords, uint64_t *lastCounters) {
+	for (long i = 0; i < numWords; i++) {
+		uint64_t devIdx = (words[i] >> 48) - 1;
+		uint64_t counter = words[i] & 0xFFFFFFFFFFFFULL;
+		if (devIdx >= (uint64_t)numSimDevices) {
+			fprintf(stderr, "*FAILED*, received a word not generated by any device: %016llx\n",
+					(unsigned long long)words[i]);
+			return -1;
+		}
+		if (counter + 1 <= lastCounters[devIdx]) {
+			fprintf(stderr, "*FAILED*, device %d word %llu received after word %llu\n", (int)devIdx,
+					(unsigned long long)counter, (unsigned long long)(lastCounters[devIdx] - 1));
+			return -1;
+		}
+		lastCounters[devIdx] = counter + 1;
+
+		DeviceTally *tally = &tallies[devIdx];
+		__atomic_fetch_add(&tally->num_words, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&tally->counter_sum, counter, __ATOMIC_RELAXED);
+		uint64_t maxCounter = __atomic_load_n(&tally->max_counter, __ATOMIC_RELAXED);
+		while (counter > maxCounter && !__atomic_compare_exchange_n(&tally->max_counter, &maxCounter, counter,
+				1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		}
+	}
+	return 0;
+}
+
+/**
+ * Consumer thread, retrieves random bytes in requests of varying sizes until stopped
+ */
+static void *consumerRun(void *arg) {
+	static __thread uint64_t words[MAX_REQUEST_BYTES / 8];
+	uint64_t lastCounters[MAX_DEVICES];
+	unsigned int seed = (unsigned int)(uintptr_t)arg + 1;
+	DeviceLiveStatistics stats;
+
+	memset(lastCounters, 0, sizeof(lastCounters));
+	while (!stopConsumers && !consumerFailed) {
+		long numWords = 1 + rand_r(&seed) % (MAX_REQUEST_BYTES / 8);
+		int status = swrngGetCLEntropy(&clCtxt, (unsigned char *)words, numWords * 8);
+		if (status != SWRNG_SUCCESS) {
+			fprintf(stderr, "*FAILED*, consumer error %d: %s\n", status, swrngGetCLLastErrorMessage(&clCtxt));
+			consumerFailed = 1;
+			break;
+		}
+		if (tallyWords(words, numWords, lastCounters) != 0) {
+			consumerFailed = 1;
+			break;
+		}
+		if (rand_r(&seed) % 64 == 0 && swrngGetCLLiveStatistics(&clCtxt, &stats) != SWRNG_SUCCESS) {
+			fprintf(stderr, "*FAILED*, could not retrieve the cluster statistics\n");
+			consumerFailed = 1;
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Waiting consumer thread, retrieves a ring slot worth of random bytes at a time until stopped.
+ * The requests fail while no device is plugged in.
+ */
+static void *waitingConsumerRun(void *arg) {
+	static __thread unsigned char bytes[WAITING_REQUEST_BYTES];
+	int idx = (int)(uintptr_t)arg;
+
+	usleep((useconds_t)idx * WAITING_CONSUMER_DELAY_USECS);
+	while (!stopConsumers) {
+		if (swrngGetCLEntropy(&clCtxt, bytes, WAITING_REQUEST_BYTES) == SWRNG_SUCCESS) {
+			__atomic_fetch_add(&waitingSuccesses[idx], 1, __ATOMIC_RELAXED);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Unplug all the devices for longer than the cluster fail-over wait while consumers wait for random bytes,
+ * then plug one device in again. Every waiting consumer must receive random bytes again.
+ *
+ * @return 0 - successful or -1 on failure, the consumers may still be running on failure
+ */
+static int testAllDevicesGone(void) {
+	pthread_t consumers[NUM_WAITING_CONSUMERS];
+	long successes[NUM_WAITING_CONSUMERS];
+	SimDevice *replugged = &simDevices[0];
+	static unsigned char drained[WAITING_REQUEST_BYTES];
+
+	printf("All devices gone, %d waiting consumers ------------ ", NUM_WAITING_CONSUMERS);
+	fflush(stdout);
+
+	pthread_mutex_lock(&simMutex);
+	for (int i = 0; i < numSimDevices; i++) {
+		simDevices[i].fail_after = 0;
+		simDevices[i].unplugged = 1;
+	}
+	pthread_mutex_unlock(&simMutex);
+	// The download threads find their device gone only once the ring has room for their downloads
+	while (swrngGetCLSize(&clCtxt) > 0) {
+		swrngGetCLEntropy(&clCtxt, drained, WAITING_REQUEST_BYTES);
+	}
+
+	stopConsumers = 0;
+	for (int i = 0; i < NUM_WAITING_CONSUMERS; i++) {
+		if (pthread_create(&consumers[i], NULL, waitingConsumerRun, (void *)(uintptr_t)i) != 0) {
+			printf("*FAILED*, could not start the consumers\n");
+			return -1;
+		}
+	}
+	sleep(REPLUG_AFTER_SECS);
+
+	pthread_mutex_lock(&simMutex);
+	for (int i = 0; i < NUM_WAITING_CONSUMERS; i++) {
+		successes[i] = __atomic_load_n(&waitingSuccesses[i], __ATOMIC_RELAXED);
+	}
+	replugged->fail_after = -1;
+	replugged->unplugged = 0;
+	if (monitorCallback != NULL) {
+		monitorCallback(monitorCallbackArg, 1);
+	}
+	pthread_mutex_unlock(&simMutex);
+
+	time_t end = time(NULL) + RECOVERY_TIMEOUT_SECS;
+	int numRecovered = 0;
+	while (numRecovered < NUM_WAITING_CONSUMERS && time(NULL) < end) {
+		usleep(100000);
+		numRecovered = 0;
+		for (int i = 0; i < NUM_WAITING_CONSUMERS; i++) {
+			if (__atomic_load_n(&waitingSuccesses[i], __ATOMIC_RELAXED) > successes[i]) {
+				numRecovered++;
+			}
+		}
+	}
+	if (numRecovered < NUM_WAITING_CONSUMERS) {
+		printf("*FAILED*, %d of %d consumers still waiting %d seconds after a device came back\n",
+				NUM_WAITING_CONSUMERS - numRecovered, NUM_WAITING_CONSUMERS, RECOVERY_TIMEOUT_SECS);
+		return -1;
+	}
+
+	stopConsumers = 1;
+	for (int i = 0; i < NUM_WAITING_CONSUMERS; i++) {
+		pthread_join(consumers[i], NULL);
+	}
+	printf("SUCCESS\n");
+	return 0;
+}
+
+/**
+ * Check that each device's words were received exactly once and none is missing before the last one received
+ *
+ * @return 0 - successful or -1 on failure
+ */
+static int verifyTallies(void) {
+	uint64_t totalWords = 0;
+
+	for (int i = 0; i < numSimDevices; i++) {
+		DeviceTally *tally = &tallies[i];
+		if (tally->num_words == 0) {
+			continue;
+		}
+		uint64_t expectedSum = tally->max_counter * (tally->max_counter + 1) / 2;
+		if (tally->num_words != tally->max_counter + 1 || tally->counter_sum != expectedSum) {
+			fprintf(stderr, "*FAILED*, device %d: %llu words received up to word %llu\n", i,
+					(unsigned long long)tally->num_words, (unsigned long long)tally->max_counter);
+			return -1;
+		}
+		totalWords += tally->num_words;
+	}
+	printf("%llu MB received, ", (unsigned long long)(totalWords * 8 / 1000000));
+	return 0;
+}
+
+/**
+ * Main entry
+ * @return int 0 - successful or error code
+ */
+int main(void) {
+	pthread_t consumers[NUM_CONSUMERS];
+	int numReported = 0;
+	int clusterSize = SWRNG_CL_MAX_SIZE;
+	int status = 0;
+
+	numSimDevices = clusterSize + NUM_SPARE_DEVICES;
+	for (int i = 0; i < numSimDevices; i++) {
+		simDevices[i].fail_after = -1;
+	}
+	for (int i = 0; i < NUM_FAILING_DEVICES && i < clusterSize; i++) {
+		simDevices[i * clusterSize / NUM_FAILING_DEVICES].fail_after = FAIL_AFTER_DOWNLOADS;
+	}
+
+	printf("Cluster of %2d devices, %d consumers ------------ ", clusterSize, NUM_CONSUMERS);
+	fflush(stdout);
+
+	swrngInitializeCLContext(&clCtxt);
+	if (swrngCLOpen(&clCtxt, clusterSize) != SWRNG_SUCCESS) {
+		printf("*FAILED*, err: %s\n", swrngGetCLLastErrorMessage(&clCtxt));
+		return -1;
+	}
+
+	for (int i = 0; i < NUM_CONSUMERS; i++) {
+		if (pthread_create(&consumers[i], NULL, consumerRun, (void *)(uintptr_t)i) != 0) {
+			printf("*FAILED*, could not start the consumers\n");
+			return -1;
+		}
+	}
+
+	// Keep running past the test duration until the failing devices failed and were replaced
+	time_t end = time(NULL) + TEST_DURATION_SECS;
+	while (!consumerFailed && time(NULL) < end + RECOVERY_TIMEOUT_SECS && (time(NULL) < end
+			|| numSimFailures < NUM_FAILING_DEVICES
+			|| swrngGetCLSize(&clCtxt) != clusterSize)) {
+		usleep(100000);
+		reportReplacedDevices(&numReported);
+	}
+	stopConsumers = 1;
+	for (int i = 0; i < NUM_CONSUMERS; i++) {
+		pthread_join(consumers[i], NULL);
+	}
+
+	int finalClusterSize = swrngGetCLSize(&clCtxt);
+	long numFailovers = swrngGetCLFailoverEventCount(&clCtxt);
+
+	if (consumerFailed) {
+		return -1;
+	}
+	if (verifyTallies() != 0) {
+		return -1;
+	}
+	if (numFailovers != numSimFailures || numSimFailures != NUM_FAILING_DEVICES) {
+		printf("*FAILED*, %ld fail-over events for %d device failures\n", numFailovers, numSimFailures);
+		return -1;
+	}
+	if (finalClusterSize != clusterSize) {
+		printf("*FAILED*, cluster size %d after replacing the failed devices\n", finalClusterSize);
+		return -1;
+	}
+	printf("SUCCESS\n");
+
+	if (testAllDevicesGone() != 0) {
+		return -1;
+	}
+	swrngCLClose(&clCtxt);
+	for (int i = 0; i < numSimDevices; i++) {
+		if (simDevices[i].open) {
+			status = -1;
+		}
+	}
+	if (status != 0) {
+		printf("*FAILED*, devices left open after closing the cluster\n");
+		return -1;
+	}
+	return 0;
+}
@@ -33,6 +33,43 @@ static time_t end;
 static long l;
 
 
+/**
+ * Calculate the mean of the latencies recorded in a histogram
+ * @return mean latency in microseconds, 0 if none recorded
+ */
+double meanLatencyMicros(const LatencyHistogram *histogram) {
+	if (histogram->count == 0) {
+		return 0;
+	}
+	return (double)histogram->totalNanos / (double)histogram->count / 1000.0;
+}
+
+/**
+ * Print the measured download rate of each cluster device, its share of the random bytes
+ * and how long each download stage takes per data block
+ */
+void printDeviceRates() {
+	DeviceLiveStatistics stats;
+	uint64_t total = 0;
+	for (int i = 0; i < swrngGetCLSize(&ctxt); i++) {
+		total += swrngGetCLDeviceByteCount(&ctxt, i);
+	}
+	if (total == 0) {
+		total = 1;
+	}
+	for (int i = 0; i < swrngGetCLSize(&ctxt); i++) {
+		printf("    Device %2d -------------------- %8.2f Mbits/sec, %5.1f%% of bytes\n", i,
+				swrngGetCLDeviceDownloadRate(&ctxt, i) / 1000.0 / 1000.0 * 8.0,
+				swrngGetCLDeviceByteCount(&ctxt, i) * 100.0 / total);
+		if (swrngGetCLDeviceLiveStatistics(&ctxt, i, &stats) == SWRNG_SUCCESS) {
+			printf("      per block: USB %8.1f us, tests %6.1f us, conditioning %6.1f us, %llu retries, %llu timeouts\n",
+					meanLatencyMicros(&stats.usbLatency), meanLatencyMicros(&stats.healthTestLatency),
+					meanLatencyMicros(&stats.conditioningLatency),
+					(unsigned long long)stats.numRetries, (unsigned long long)stats.numTimeouts);
+		}
+	}
+}
+
 /**
  * Run performance test using current post processing method
  * @return 0 - if successful, error otherwise
@@ -66,6 +103,7 @@ int runPerfTest() {
 	double downloadSpeed = (SAMPLES * NUM_BLOCKS) / totalTime / 1000.0 / 1000.0 * 8.0;
 
 	printf("%3.2f Mbits/sec\n", downloadSpeed);
+	printDeviceRates();
 	return SWRNG_SUCCESS;
 }
 
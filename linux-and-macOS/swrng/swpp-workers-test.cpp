@@ -0,0 +1,198 @@
+/*
+ * swpp-workers-test.cpp
+ * Ver. 1.0
+ *
+ * @brief This program verifies the SwiftRngApi post processing threads against hashing on the caller thread.
+ * It feeds known data blocks straight to the post processing logic, so it does not need a SwiftRNG device.
+ *
+ */
+
+#include <SwiftRngApi.h>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace swiftrng {
+
+/**
+ * Exposes the post processing of data blocks that runs without a device
+ */
+class PostProcessingTestApi : public SwiftRngApi {
+public:
+	using SwiftRngApi::sha256_initializeSerialNumber;
+	using SwiftRngApi::hash_block_chunks;
+	using SwiftRngApi::alloc_block_buffer;
+	using SwiftRngApi::free_block_buffer;
+	using SwiftRngApi::set_post_processing_method;
+	using SwiftRngApi::get_block_serial_number;
+	using SwiftRngApi::get_pp_pending;
+};
+
+class PostProcessingWorkersTest {
+public:
+	PostProcessingWorkersTest();
+	~PostProcessingWorkersTest();
+	int run();
+
+private:
+	// Number of post processing threads to test with
+	static const int c_num_workers {3};
+
+	// How many times the threads are restarted
+	static const int c_num_restarts {20};
+
+	// Time given to restarted threads to pick up a data block handed off to the previous threads
+	static const int c_restart_wait_msecs {20};
+
+	// Serial number of the first data block hashed with SHA-256
+	static const uint32_t c_serial_number {0x5A17C0DE};
+
+	PostProcessingTestApi m_api;
+	char *m_src {nullptr};
+	char *m_dst {nullptr};
+	char *m_expected {nullptr};
+	char *m_saved {nullptr};
+
+	void fill_block(char *block, uint64_t seed) const;
+	int expect_same(const char *actual, const char *expected, const char *what, int method_id, int restart) const;
+	int run_method(int method_id);
+};
+
+PostProcessingWorkersTest::PostProcessingWorkersTest() {
+	m_src = m_api.alloc_block_buffer();
+	m_dst = m_api.alloc_block_buffer();
+	m_expected = m_api.alloc_block_buffer();
+	m_saved = m_api.alloc_block_buffer();
+}
+
+PostProcessingWorkersTest::~PostProcessingWorkersTest() {
+	m_api.free_block_buffer(m_src);
+	m_api.free_block_buffer(m_dst);
+	m_api.free_block_buffer(m_expected);
+	m_api.free_block_buffer(m_saved);
+}
+
+/**
+ * Fill a raw data block with a xorshift64 sequence
+ *
+ * @param char *block - data block to fill
+ * @param uint64_t seed - first value of the sequence, not zero
+ */
+void PostProcessingWorkersTest::fill_block(char *block, uint64_t seed) const {
+	uint64_t value = seed;
+	for (int i = 0; i + 8 <= EntropyConditioner::c_block_size_bytes; i += 8) {
+		value ^= value << 13;
+		value ^= value >> 7;
+		value ^= value << 17;
+		std::memcpy(block + i, &value, 8);
+	}
+}
+
+/**
+ * Compare a hashed data block with the expected one
+ *
+ * @return 0 - the blocks match, -1 otherwise
+ */
+int PostProcessingWorkersTest::expect_same(const char *actual, const char *expected, const char *what,
+		int method_id, int restart) const {
+	if (std::memcmp(actual, expected, EntropyConditioner::c_block_size_bytes) != 0) {
+		std::cerr << "*FAILED*, method id " << method_id << ", restart " << restart << ": " << what << std::endl;
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Hash a data block with the post processing threads after each restart of the threads and compare it
+ * with hashing on the caller thread. The data block handed off before a restart is changed while
+ * the threads are stopped, so hashing it again after the restart shows up in the destination.
+ *
+ * @param int method_id - SHA-256 or SHA-512 post processing method id
+ * @return 0 - successful or -1 on failure
+ */
+int PostProcessingWorkersTest::run_method(int method_id) {
+	m_api.set_post_processing_method(method_id);
+	m_api.disable_post_processing_workers();
+
+	if (m_api.enable_post_processing_workers(c_num_workers) != SWRNG_SUCCESS) {
+		std::cerr << "*FAILED*, could not start the post processing threads" << std::endl;
+		return -1;
+	}
+
+	for (int restart = 0; restart < c_num_restarts; restart++) {
+		uint32_t serial_number = c_serial_number + (uint32_t)restart * 1000;
+
+		// Hash on the caller thread only
+		m_api.disable_post_processing_workers();
+		fill_block(m_src, 0x9E3779B97F4A7C15ULL + restart);
+		m_api.sha256_initializeSerialNumber(serial_number);
+		m_api.hash_block_chunks(m_src, m_expected);
+
+		// Hash the same block with the post processing threads
+		m_api.enable_post_processing_workers(c_num_workers);
+		m_api.sha256_initializeSerialNumber(serial_number);
+		m_api.hash_block_chunks(m_src, m_dst);
+		if (expect_same(m_dst, m_expected, "hashed block differs from the caller thread", method_id, restart) != 0) {
+			return -1;
+		}
+		if (m_api.get_block_serial_number() != serial_number
+				+ (method_id == EntropyConditioner::c_sha256_method_id ? (uint32_t)EntropyConditioner::c_sha256_num_chunks : 0)) {
+			std::cerr << "*FAILED*, method id " << method_id << ", restart " << restart
+					<< ": unexpected block serial number" << std::endl;
+			return -1;
+		}
+
+		// Restart the threads with a different block in the source of the last hand off
+		std::memcpy(m_saved, m_dst, EntropyConditioner::c_block_size_bytes);
+		m_api.disable_post_processing_workers();
+		fill_block(m_src, 0xD1B54A32D192ED03ULL + restart);
+		m_api.enable_post_processing_workers(c_num_workers);
+		std::this_thread::sleep_for(std::chrono::milliseconds(c_restart_wait_msecs));
+		if (expect_same(m_dst, m_saved, "block hashed before the restart was overwritten", method_id, restart) != 0) {
+			return -1;
+		}
+		if (m_api.get_pp_pending() != 0) {
+			std::cerr << "*FAILED*, method id " << method_id << ", restart " << restart
+					<< ": " << m_api.get_pp_pending() << " shares pending after the restart" << std::endl;
+			return -1;
+		}
+	}
+	m_api.disable_post_processing_workers();
+	return 0;
+}
+
+/**
+ * Run the test with SHA-256 and SHA-512 post processing
+ *
+ * @return 0 - successful or -1 on failure
+ */
+int PostProcessingWorkersTest::run() {
+	if (m_src == nullptr || m_dst == nullptr || m_expected == nullptr || m_saved == nullptr) {
+		std::cerr << "*FAILED*, could not allocate the data blocks" << std::endl;
+		return -1;
+	}
+	if (run_method(EntropyConditioner::c_sha256_method_id) != 0) {
+		return -1;
+	}
+	return run_method(EntropyConditioner::c_sha512_method_id);
+}
+
+} /* namespace swiftrng */
+
+/**
+ * Main entry
+ * @return int 0 - successful or error code
+ */
+int main() {
+	swiftrng::PostProcessingWorkersTest test;
+
+	std::cout << "Post processing threads ------------------------- ";
+	std::cout.flush();
+	if (test.run() != 0) {
+		return -1;
+	}
+	std::cout << "SUCCESS" << std::endl;
+	return 0;
+}
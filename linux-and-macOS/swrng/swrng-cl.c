@@ -109,7 +109,7 @@ static void display_usage(void) {
 	printf("           bytes (continuous download)\n");
 	printf("\n");
 	printf("     -cs NUMBER, --cluster-size NUMBER\n");
-	printf("           Preferred number (between 1 and 10) of devices in a cluster.\n");
+	printf("           Preferred number (between 1 and 64) of devices in a cluster.\n");
 	printf("           Default value is 2\n");
 
 	printf("\n");
@@ -125,6 +125,12 @@ static void display_usage(void) {
 	printf("\n");
 	printf("     -dst, --disable-statistical-tests\n");
 	printf("           Disable 'Repetition Count' and 'Adaptive Proportion' tests.\n");
+#ifdef __linux__
+	printf("\n");
+	printf("     -nn LIST, --numa-nodes LIST\n");
+	printf("           Comma separated LIST of NUMA nodes to run the device download\n");
+	printf("           threads on, the threads of the devices take the nodes in turn\n");
+#endif
 	printf("\n");
 	printf("EXAMPLES:\n");
 	printf("     It may require system admin permissions to run this utility on Linux or OSX.\n");
@@ -139,6 +145,11 @@ static void display_usage(void) {
 	printf("     To download 12 MB of true random bytes to 'rnd.bin' file using \n");
 	printf("           lowest power consumption and slowest download speed\n");
 	printf("           swrng-cl  -dd -fn rnd.bin -nb 12000000 -ppn 0\n");
+#ifdef __linux__
+	printf("     To download 12 MB of true random bytes to 'rnd.bin' file using a cluster \n");
+	printf("     of 4 devices spread over NUMA nodes 0 and 1\n");
+	printf("           swrng-cl  -dd -fn rnd.bin -nb 12000000 -cs 4 -nn 0,1\n");
+#endif
 #ifdef __linux__
 	printf("     To feed Kernel /dev/random entropy pool using a cluster of 2 devices.\n");
 	printf("           ./swrng -fep\n");
@@ -178,8 +189,8 @@ static int parseClusterSize(int idx, int argc, char **argv) {
 				return -1;
 			}
 			cl_size = atoi(argv[idx++]);
-			if (cl_size < 0 || cl_size > 10) {
-				fprintf(stderr, "Cluster size must be between 1 and 10\n");
+			if (cl_size < 0 || cl_size > 64) {
+				fprintf(stderr, "Cluster size must be between 1 and 64\n");
 				return -1;
 			}
 		}
@@ -213,6 +224,56 @@ static int parsePowerProfileNum(int idx, int argc, char **argv) {
 	return 0;
 }
 
+#ifdef __linux__
+/**
+ * Parse the NUMA nodes of the download threads if specified
+ *
+ * @param int idx - current parameter number
+ * @param int argc - number of parameters
+ * @param char ** argv - parameters
+ * @return int - 0 when successfully parsed
+ */
+static int parseNumaNodes(int idx, int argc, char **argv) {
+	if (idx < argc) {
+		if (strcmp("-nn", argv[idx]) == 0 || strcmp("--numa-nodes",
+				argv[idx]) == 0) {
+			if (validate_argument_count(++idx, argc) == val_false) {
+				return -1;
+			}
+			numa_nodes = argv[idx++];
+			if (strspn(numa_nodes, "0123456789,") != strlen(numa_nodes) || numa_nodes[0] == ','
+					|| numa_nodes[0] == '\0' || numa_nodes[strlen(numa_nodes) - 1] == ','
+					|| strstr(numa_nodes, ",,") != NULL) {
+				fprintf(stderr, "Invalid list of NUMA nodes: %s\n", numa_nodes);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * Pin the download thread of each cluster slot to the CPUs of a NUMA node from the list, in turn
+ *
+ * @return int - 0 when run successfully
+ */
+static int setThreadNumaNodes(void) {
+	const char *node = numa_nodes;
+	char *end;
+
+	for (int slot = 0; slot < cl_size; slot++) {
+		int status = swrngSetCLThreadNumaNode(&cxt, slot, (int)strtol(node, &end, 10));
+		if (status != SWRNG_SUCCESS) {
+			fprintf(stderr, " Cannot use NUMA node %d: %s ... ", (int)strtol(node, NULL, 10),
+					swrngGetCLLastErrorMessage(&cxt));
+			return status;
+		}
+		node = *end == ',' ? end + 1 : numa_nodes;
+	}
+	return SWRNG_SUCCESS;
+}
+#endif
+
 /**
  * Parse arguments for extracting command line parameters
  *
@@ -279,6 +340,10 @@ static int process_arguments(int argc, char **argv) {
 				return -1;
 			} else if (parsePowerProfileNum(idx, argc, argv) == -1) {
 				return -1;
+#ifdef __linux__
+			} else if (parseNumaNodes(idx, argc, argv) == -1) {
+				return -1;
+#endif
 			} else {
 				/* Could not handle the argument, skip to the next one */
 				++idx;
@@ -293,21 +358,21 @@ static int process_arguments(int argc, char **argv) {
  *
  */
 static void closeHandle() {
-	if (p_output_file != NULL) {
-		fclose(p_output_file);
-		p_output_file = NULL;
-	}
+	swrngCloseOutput(&output);
 }
 
 /**
- * Write bytes out to the file
+ * Write bytes out to the file from the output buffer
  *
- * @param const uint8_t* bytes - pointer to the byte array
  * @param uint32_t num_bytes - number of bytes to write
+ * @return int - 0 when written successfully
  */
-static void write_bytes(const uint8_t *bytes, uint32_t num_bytes) {
-	FILE *handle = p_output_file;
-	fwrite(bytes, 1, num_bytes, handle);
+static int write_bytes(uint32_t num_bytes) {
+	if (swrngWriteOutput(&output, num_bytes) != 0) {
+		fprintf(stderr, "Cannot write %u bytes to file: %s\n", num_bytes, file_path_name);
+		return -1;
+	}
+	return SWRNG_SUCCESS;
 }
 
 /**
@@ -317,8 +382,11 @@ static void write_bytes(const uint8_t *bytes, uint32_t num_bytes) {
  */
 static int handle_download_request(void) {
 
-	/* Add one extra byte of storage for the status byte */
-	uint8_t receiveByteBuffer[SWRNG_BUFF_FILE_SIZE_BYTES + 1];
+#ifdef __linux__
+	if (numa_nodes != NULL && setThreadNumaNodes() != SWRNG_SUCCESS) {
+		return -1;
+	}
+#endif
 
 	int status = swrngCLOpen(&cxt, cl_size);
 	if (status != SWRNG_SUCCESS) {
@@ -368,54 +436,55 @@ static int handle_download_request(void) {
 		return -1;
 	}
 
-	if (is_output_to_standard_output == val_true) {
-#ifdef _WIN32
-		_setmode(_fileno(stdout), _O_BINARY);
-		p_output_file = fdopen(_dup(fileno(stdout)), "wb");
-#else
-		p_output_file = fdopen(dup(fileno(stdout)), "wb");
-#endif
-	} else {
-		p_output_file = fopen(file_path_name, "wb");
-	}
-	if (p_output_file == NULL) {
+	if (swrngOpenOutput(&output, file_path_name, is_output_to_standard_output, SWRNG_BULK_BUFF_FILE_SIZE_BYTES) != 0) {
 		fprintf(stderr, "Cannot open file: %s in write mode\n", file_path_name);
 		swrngCLClose(&cxt);
 		return -1;
 	}
 
+	/* The output buffer has one extra byte of storage for the status byte */
+	uint8_t *receiveByteBuffer = swrngGetOutputBuffer(&output);
+
 	while (num_gen_bytes == -1) {
 		/* Infinite loop for downloading unlimited random bytes */
-		status = swrngGetCLEntropy(&cxt, receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		status = swrngGetCLEntropy(&cxt, receiveByteBuffer, SWRNG_BULK_BUFF_FILE_SIZE_BYTES);
 		if (status != SWRNG_SUCCESS) {
 			fprintf(
 					stderr,
 					"Failed to receive %d bytes for unlimited download, error code %d. ",
-					SWRNG_BUFF_FILE_SIZE_BYTES, status);
+					SWRNG_BULK_BUFF_FILE_SIZE_BYTES, status);
 			closeHandle();
 			swrngCLClose(&cxt);
 			return status;
 		}
-		write_bytes(receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		if (write_bytes(SWRNG_BULK_BUFF_FILE_SIZE_BYTES) != SWRNG_SUCCESS) {
+			closeHandle();
+			swrngCLClose(&cxt);
+			return -1;
+		}
 	}
 
 	/* Calculate number of complete random byte chunks to download */
-	int64_t numCompleteChunks = num_gen_bytes / SWRNG_BUFF_FILE_SIZE_BYTES;
+	int64_t numCompleteChunks = num_gen_bytes / SWRNG_BULK_BUFF_FILE_SIZE_BYTES;
 
 	/* Calculate number of bytes in the last incomplete chunk */
-	uint32_t chunkRemaindBytes = (uint32_t)(num_gen_bytes % SWRNG_BUFF_FILE_SIZE_BYTES);
+	uint32_t chunkRemaindBytes = (uint32_t)(num_gen_bytes % SWRNG_BULK_BUFF_FILE_SIZE_BYTES);
 
 	/* Process each chunk */
 	for (int64_t chunkNum = 0; chunkNum < numCompleteChunks; chunkNum++) {
-		status = swrngGetCLEntropy(&cxt, receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		status = swrngGetCLEntropy(&cxt, receiveByteBuffer, SWRNG_BULK_BUFF_FILE_SIZE_BYTES);
 		if (status != SWRNG_SUCCESS) {
 			fprintf(stderr, "Failed to receive %d bytes, error code %d. ",
-					SWRNG_BUFF_FILE_SIZE_BYTES, status);
+					SWRNG_BULK_BUFF_FILE_SIZE_BYTES, status);
 			closeHandle();
 			swrngCLClose(&cxt);
 			return status;
 		}
-		write_bytes(receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		if (write_bytes(SWRNG_BULK_BUFF_FILE_SIZE_BYTES) != SWRNG_SUCCESS) {
+			closeHandle();
+			swrngCLClose(&cxt);
+			return -1;
+		}
 	}
 
 	if (chunkRemaindBytes > 0) {
@@ -430,7 +499,11 @@ static int handle_download_request(void) {
 			swrngCLClose(&cxt);
 			return status;
 		}
-		write_bytes(receiveByteBuffer, chunkRemaindBytes);
+		if (write_bytes(chunkRemaindBytes) != SWRNG_SUCCESS) {
+			closeHandle();
+			swrngCLClose(&cxt);
+			return -1;
+		}
 	}
 
 	closeHandle();
@@ -497,6 +570,45 @@ static int process(int argc, char **argv) {
 /* ............. */
 #ifdef __linux__
 /* ............. */
+/**
+ * Read an integer parameter of the kernel random number generator
+ *
+ * @param const char *pathName - parameter file path name
+ * @param int defaultValue - value to return when the parameter cannot be read
+ * @return int - parameter value
+ */
+static int readKernelRandomParam(const char *pathName, int defaultValue) {
+	int value;
+	FILE *paramFile = fopen(pathName, "r");
+	if (paramFile == NULL) {
+		return defaultValue;
+	}
+	if (fscanf(paramFile, "%d", &value) != 1 || value <= 0) {
+		value = defaultValue;
+	}
+	fclose(paramFile);
+	return value;
+}
+
+/**
+ * Top up the prefetch buffer with random bytes from the cluster
+ *
+ * @return int - 0 when run successfully
+ */
+static int prefetchPoolEntropy(void) {
+	int addBytes = KERNEL_ENTROPY_PREFETCH_SIZE_BYTES - prefetchCount;
+	if (addBytes < KERNEL_ENTROPY_POOL_SIZE_BYTES) {
+		return SWRNG_SUCCESS;
+	}
+	int status = swrngGetCLEntropy(&cxt, prefetchBuff + prefetchCount, addBytes);
+	if (status != SWRNG_SUCCESS) {
+		fprintf(stderr, "Failed to receive %d bytes for feeding entropy pool, error code %d. ", addBytes, status);
+		return status;
+	}
+	prefetchCount += addBytes;
+	return SWRNG_SUCCESS;
+}
+
 /**
  * Feed Kernel entropy pool with true random bytes
  *
@@ -527,35 +639,72 @@ static int feedKernelEntropyPool() {
 		return result;
 	}
 
+	/* The kernel signals POLLOUT when the amount of entropy drops below the wakeup threshold */
+	int poolSizeBits = readKernelRandomParam(KERNEL_ENTROPY_POOL_SIZE_PARAM, KERNEL_ENTROPY_POOL_SIZE_BYTES * 8);
+	int wakeupThresholdBits = readKernelRandomParam(KERNEL_ENTROPY_WAKEUP_THRESHOLD_PARAM, poolSizeBits / 2);
+	if (wakeupThresholdBits > poolSizeBits) {
+		wakeupThresholdBits = poolSizeBits;
+	}
+
 	printf("Feeding the kernel %s entropy pool. Initial amount of entropy bits in the pool: %d ...\n", KERNEL_ENTROPY_POOL_NAME, entropyAvailable);
 
+	struct pollfd pfd;
+	pfd.fd = rndout;
+	pfd.events = POLLOUT;
+
 	/* Infinite loop for feeding kernel entropy pool */
 	while(val_true) {
-		/* Check to see if we need more entropy, feed the pool if the current level is below 2048 bits */
+		/* Download ahead so that feeding the pool never waits for the cluster */
+		status = prefetchPoolEntropy();
+		if (status != SWRNG_SUCCESS) {
+			swrngCLClose(&cxt);
+			close(rndout);
+			return status;
+		}
+
+		/*
+		 * Sleep until the kernel asks for entropy. Newer kernels never do once the pool is initialized,
+		 * the timeout lets the pool level be checked every so often for those.
+		 */
+		pfd.revents = 0;
+		result = poll(&pfd, 1, KERNEL_ENTROPY_POLL_TIMEOUT_MSECS);
+		if (result < 0 && errno != EINTR) {
+			printf("Cannot wait for the entropy pool, error: %d\n", errno);
+			swrngCLClose(&cxt);
+			close(rndout);
+			return result;
+		}
+
 		ioctl(rndout, RNDGETENTCNT, &entropyAvailable);
-		if (entropyAvailable < (KERNEL_ENTROPY_POOL_SIZE_BYTES * 8) / 2) {
-			int addMoreBytes = KERNEL_ENTROPY_POOL_SIZE_BYTES - (entropyAvailable >> 3);
-			status = swrngGetCLEntropy(&cxt, entropy.data, addMoreBytes);
-			if(status != SWRNG_SUCCESS) {
-				fprintf(stderr, "Failed to receive %d bytes for feeding entropy pool, error code %d. ", addMoreBytes, status);
-				swrngCLClose(&cxt);
-				return status;
-			}
-			entropy.buf_size = addMoreBytes;
-			/* Estimate the amount of entropy */
-			entropy.entropy_count = entropyAvailable + (addMoreBytes << 3);
-			/* Push the entropy out to the pool */
-			result = ioctl(rndout, RNDADDENTROPY, &entropy);
-			if (result < 0) {
-				printf("Cannot add more entropy to the pool, error: %d\n", result);
-				swrngCLClose(&cxt);
-				close(rndout);
-				return result;
-			}
-			usleep(10);
-		} else {
-			usleep(30);
+		if (!(pfd.revents & POLLOUT) && entropyAvailable >= wakeupThresholdBits) {
+			pfd.events = POLLOUT;
+			continue;
+		}
+
+		/* Top the pool up in one batch sized from the deficit */
+		int addMoreBytes = (poolSizeBits - entropyAvailable + 7) >> 3;
+		if (addMoreBytes > KERNEL_ENTROPY_POOL_SIZE_BYTES) {
+			addMoreBytes = KERNEL_ENTROPY_POOL_SIZE_BYTES;
+		}
+		if (addMoreBytes <= 0) {
+			/* The pool is full while POLLOUT is still signaled, only rely on the timeout until the level drops */
+			pfd.events = 0;
+			continue;
+		}
+		prefetchCount -= addMoreBytes;
+		memcpy(entropy.data, prefetchBuff + prefetchCount, addMoreBytes);
+		entropy.buf_size = addMoreBytes;
+		/* Estimate the amount of entropy */
+		entropy.entropy_count = addMoreBytes << 3;
+		/* Push the entropy out to the pool */
+		result = ioctl(rndout, RNDADDENTROPY, &entropy);
+		if (result < 0) {
+			printf("Cannot add more entropy to the pool, error: %d\n", result);
+			swrngCLClose(&cxt);
+			close(rndout);
+			return result;
 		}
+		pfd.events = POLLOUT;
 	}
 
 }
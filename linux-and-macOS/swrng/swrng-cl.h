@@ -30,6 +30,7 @@
 #define SWRNG_H_
 
 #include <swrng-cl-api.h>
+#include <swrng-output.h>
 #ifndef _WIN32
 #include <unistd.h>
 #else
@@ -43,14 +44,24 @@
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/random.h>
+#include <poll.h>
+#include <errno.h>
 
 #define KERNEL_ENTROPY_POOL_SIZE_BYTES 512
 #define KERNEL_ENTROPY_POOL_NAME "/dev/random"
+#define KERNEL_ENTROPY_POOL_SIZE_PARAM "/proc/sys/kernel/random/poolsize"
+#define KERNEL_ENTROPY_WAKEUP_THRESHOLD_PARAM "/proc/sys/kernel/random/write_wakeup_threshold"
 
-#endif
+/* Random bytes downloaded ahead of feeding the entropy pool */
+#define KERNEL_ENTROPY_PREFETCH_SIZE_BYTES (KERNEL_ENTROPY_POOL_SIZE_BYTES * 8)
+
+/* Maximum time to wait for the kernel to ask for entropy before checking the pool level anyway */
+#define KERNEL_ENTROPY_POLL_TIMEOUT_MSECS (10000)
 
+#endif
 
-#define SWRNG_BUFF_FILE_SIZE_BYTES (10000 * 10)
+/* Random bytes per cluster request and per file write, a whole number of memory pages */
+#define SWRNG_BULK_BUFF_FILE_SIZE_BYTES (16000 * 64)
 
 
 /*
@@ -90,7 +101,7 @@ static int cl_size = 2;
 static int pp_num = 9;
 
 /* Output file handle */
-static FILE *p_output_file = NULL;
+static SwrngOutput output;
 
 static int is_output_to_standard_output;
 static SwrngContext hcxt;
@@ -106,6 +117,13 @@ static int statisticalTestsEnabled;
 /* A variable for checking the amount of the entropy available in the kernel pool */
 static int entropyAvailable;
 Entropy entropy;
+
+/* Random bytes prefetched from the device for feeding the kernel entropy pool */
+static unsigned char prefetchBuff[KERNEL_ENTROPY_PREFETCH_SIZE_BYTES];
+static int prefetchCount = 0;
+
+/* Comma separated NUMA nodes for the cluster download threads, NULL to run them on any CPU */
+static char *numa_nodes = NULL;
 #endif
 
 /**
@@ -119,11 +137,15 @@ static int process_arguments(int argc, char **argv);
 static int validate_argument_count(int curIdx, int act_argument_count);
 static int process_download_request(void);
 static int handle_download_request(void);
-static void write_bytes(const uint8_t *bytes, uint32_t num_bytes);
+static int write_bytes(uint32_t num_bytes);
 
 
 #ifdef __linux__
 static int feedKernelEntropyPool();
+static int readKernelRandomParam(const char *pathName, int defaultValue);
+static int prefetchPoolEntropy(void);
+static int parseNumaNodes(int idx, int argc, char **argv);
+static int setThreadNumaNodes(void);
 #endif
 
 #endif /* SWRNG_H_ */
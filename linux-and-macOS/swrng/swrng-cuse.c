@@ -0,0 +1,662 @@
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This program is used for interacting with a cluster of SwiftRNG devices for the purpose of
+ serving true random bytes through a character device created with CUSE (character device in user space).
+
+ This program requires the libusb-1.0 library when communicating with any SwiftRNG device. Please read the provided
+ documentation for libusb-1.0 installation details.
+
+ This program uses libusb-1.0 (directly or indirectly) which is distributed under the terms of the GNU Lesser General
+ Public License as published by the Free Software Foundation. For more information, please visit: http://libusb.info
+
+ This program may only be used in conjunction with TectroLabs devices.
+
+ This program requires 'sudo' permissions for opening /dev/cuse.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*
+ * swrng-cuse.c
+ * Ver. 1.0
+ *
+ * The kernel forwards the open(), read() and poll() calls made on the device to this program as requests
+ * read from /dev/cuse, using the FUSE protocol. Several worker threads read and serve the requests, so readers
+ * are served concurrently. A prefetch thread keeps a buffer filled with random bytes from the cluster.
+ * The read requests asking for more random bytes than prefetched wait in turn, without holding up a worker,
+ * until the prefetch thread adds more and replies to them.
+ */
+#include "swrng-cuse.h"
+
+/**
+ * Display usage message
+ *
+ */
+static void displayUsage(void) {
+	printf("*********************************************************************************\n");
+	printf("                   SwiftRNG swrng-cuse Ver 1.0  \n");
+	printf("*********************************************************************************\n");
+	printf("NAME\n");
+	printf("     swrng-cuse - A character device for reading random bytes \n");
+	printf("              downloaded from a cluster of SwiftRNG devices \n");
+	printf("SYNOPSIS\n");
+	printf("     swrng-cuse <options>\n");
+	printf("\n");
+	printf("DESCRIPTION\n");
+	printf("     swrng-cuse downloads random bytes from one or more Hardware (True) \n");
+	printf("     Random Number Generator SwiftRNG devices and serves them through the \n");
+	printf("     /dev/%s character device, using CUSE (character device in user space).\n", DEFAULT_DEVICE_NAME);
+	printf("     Requires the 'cuse' kernel module, load it with 'modprobe cuse' if needed.\n");
+	printf("\n");
+	printf("OPTIONS\n");
+	printf("     Operation modifiers:\n");
+	printf("\n");
+	printf("     -cs NUMBER, --cluster-size NUMBER\n");
+	printf("           Preferred number (between 1 and 64) of devices in a cluster.\n");
+	printf("           Default value is 2\n");
+	printf("\n");
+	printf("     -nt NUMBER, --number-threads NUMBER\n");
+	printf("          How many threads serve the device requests (default: %d)\n", DEFAULT_NUM_WORKERS);
+	printf("          Valid values are integers from 1 to %d \n", MAX_WORKERS);
+	printf("\n");
+	printf("     -ppn NUMBER, --power-profile-number NUMBER\n");
+	printf("           Device power profile NUMBER, 0 (lowest) to 9 (highest - default)\n");
+	printf("\n");
+	printf("     -ppm METHOD, --post-processing-method METHOD\n");
+	printf("           SwiftRNG post processing method: SHA256, SHA512 or xorshift64\n");
+	printf("           Skip this option for using default method\n");
+	printf("\n");
+	printf("     -dpp, --disable-post-processing\n");
+	printf("           Disable post processing of random data for devices with version 1.2+\n");
+	printf("\n");
+	printf("     -dst, --disable-statistical-tests\n");
+	printf("           Disable 'Repetition Count' and 'Adaptive Proportion' tests.\n");
+	printf("\n");
+	printf("     -dn NAME, --device-name NAME\n");
+	printf("           Create the device as /dev/NAME (default: %s)\n", DEFAULT_DEVICE_NAME);
+	printf("           The device is accessible by root only, unless a udev rule sets its mode\n");
+	printf("           (see 80-swiftrng-device-access.rules of the swrandom driver)\n");
+	printf("\n");
+	printf("EXAMPLES:\n");
+	printf("     To create /dev/%s using two SwiftRNG devices:\n", DEFAULT_DEVICE_NAME);
+	printf("           sudo swrng-cuse -cs 2\n");
+	printf("     To create /dev/%s with post processing disabled for serving RAW device data:\n", DEFAULT_DEVICE_NAME);
+	printf("           sudo swrng-cuse -cs 2 -dpp\n");
+	printf("\n");
+}
+
+/**
+ * Parse number of worker threads if specified
+ *
+ * @param int idx - current parameter number
+ * @param int argc - number of parameters
+ * @param char ** argv - parameters
+ * @return int - 0 when successfully parsed
+ */
+static int parseNumWorkers(int idx, int argc, char **argv) {
+	if (idx < argc) {
+		if (strcmp("-nt", argv[idx]) == 0 || strcmp("--number-threads", argv[idx]) == 0) {
+			if (swrngValidateCLDaemonArgumentCount(&dmn, ++idx, argc) == val_false) {
+				return -1;
+			}
+			numWorkers = atoi(argv[idx++]);
+			if (numWorkers < 1 || numWorkers > MAX_WORKERS) {
+				fprintf(stderr, "Number of threads is invalid, must be an integer between 1 and %d\n", MAX_WORKERS);
+				return -1;
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * Parse command line parameters
+ *
+ * @param int argc
+ * @param char** argv
+ * @return int - 0 when run successfully
+ */
+static int processArguments(int argc, char **argv) {
+	int idx = 1;
+	while (idx < argc) {
+		int status = swrngParseCLDaemonArgument(&dmn, &idx, argc, argv);
+		if (status == -1) {
+			return -1;
+		} else if (status == 1) {
+			continue;
+		}
+		if (strcmp("-dn", argv[idx]) == 0 || strcmp("--device-name", argv[idx]) == 0) {
+			if (swrngValidateCLDaemonArgumentCount(&dmn, ++idx, argc) == val_false) {
+				return -1;
+			}
+			deviceName = argv[idx++];
+			if (deviceName[0] == '\0' || strlen(deviceName) > MAX_DEVICE_NAME_LENGTH || strchr(deviceName, '/') != NULL) {
+				fprintf(stderr, "Invalid device name: %s\n", deviceName);
+				return -1;
+			}
+		} else if (parseNumWorkers(idx, argc, argv) == -1) {
+			return -1;
+		} else {
+			// Could not handle the argument, skip to the next one
+			++idx;
+		}
+	}
+
+	return processCuse();
+}
+
+/**
+ * Called by the prefetch thread after adding random bytes, serves the waiting reads
+ * and notifies the kernel for the poll handles
+ *
+ * @param arg - not used
+ */
+static void notifyBytesAdded(void *arg) {
+	uint64_t *handles = NULL;
+	size_t count = 0;
+	(void)arg;
+
+	serveWaitingReads();
+
+	pthread_mutex_lock(&dmn.prefetch_mutex);
+	if (numPollHandles > 0 && dmn.prefetch_available > 0) {
+		// The kernel polls again after being notified, scheduling new notifications if needed
+		handles = pollHandles;
+		count = numPollHandles;
+		pollHandles = NULL;
+		numPollHandles = 0;
+		maxPollHandles = 0;
+	}
+	pthread_mutex_unlock(&dmn.prefetch_mutex);
+
+	if (handles != NULL) {
+		notifyPollHandles(handles, count);
+		free(handles);
+	}
+}
+
+/**
+ * Notify the kernel that the device became readable for the poll handles
+ *
+ * @param handles - kernel poll handles
+ * @param count - number of handles
+ */
+static void notifyPollHandles(uint64_t *handles, size_t count) {
+	struct fuse_out_header out;
+	struct fuse_notify_poll_wakeup_out wakeup;
+	struct iovec iov[2];
+
+	memset(&out, 0, sizeof(out));
+	out.len = sizeof(out) + sizeof(wakeup);
+	out.error = FUSE_NOTIFY_POLL;
+	out.unique = 0;
+	iov[0].iov_base = &out;
+	iov[0].iov_len = sizeof(out);
+	iov[1].iov_base = &wakeup;
+	iov[1].iov_len = sizeof(wakeup);
+	for (size_t i = 0; i < count; i++) {
+		memset(&wakeup, 0, sizeof(wakeup));
+		wakeup.kh = handles[i];
+		if (writev(cuseFd, iov, 2) < 0) {
+			// The file polled was released already
+		}
+	}
+}
+
+/**
+ * Fill the waiting read requests in turn with the prefetched bytes and reply to the ones filled
+ */
+static void serveWaitingReads(void) {
+	PendingRead *filledHead = NULL;
+	PendingRead *filledTail = NULL;
+
+	pthread_mutex_lock(&dmn.prefetch_mutex);
+	while (waitingHead != NULL && dmn.prefetch_available > 0) {
+		PendingRead *pending = waitingHead;
+		pending->filled += swrngTakeCLDaemonBytes(&dmn, pending->data + pending->filled, pending->length - pending->filled);
+		if (pending->filled < pending->length) {
+			break;
+		}
+		waitingHead = pending->next;
+		if (waitingHead == NULL) {
+			waitingTail = NULL;
+		}
+		pending->next = NULL;
+		if (filledTail == NULL) {
+			filledHead = pending;
+		} else {
+			filledTail->next = pending;
+		}
+		filledTail = pending;
+	}
+	pthread_mutex_unlock(&dmn.prefetch_mutex);
+
+	while (filledHead != NULL) {
+		PendingRead *pending = filledHead;
+		filledHead = pending->next;
+		replyPendingRead(pending, 0);
+	}
+}
+
+/**
+ * Reply to a read request that was waiting for random bytes and release it. The bytes filled
+ * so far are returned, unless none were.
+ *
+ * @param pending - pointer to the read request, no longer in the waiting list
+ * @param error - negated errno value returned when no bytes were filled
+ */
+static void replyPendingRead(PendingRead *pending, int error) {
+	if (pending->filled > 0) {
+		sendReply(pending->unique, 0, pending->data, pending->filled);
+	} else {
+		sendReply(pending->unique, error, NULL, 0);
+	}
+	free(pending);
+}
+
+/**
+ * Open /dev/cuse and create the character device, answering the CUSE_INIT request of the kernel
+ *
+ * @return int - 0 when run successfully
+ */
+static int openCuseDevice(void) {
+	__attribute__((aligned(8))) unsigned char request[REQUEST_BUFF_SIZE];
+	struct fuse_out_header out;
+	struct cuse_init_out initOut;
+	char info[MAX_DEVICE_NAME_LENGTH + 16];
+	struct iovec iov[3];
+
+	cuseFd = open(CUSE_DEVICE_PATH, O_RDWR | O_CLOEXEC);
+	if (cuseFd == -1) {
+		fprintf(stderr, "Cannot open %s: %s, make sure the 'cuse' kernel module is loaded and you run this utility as root\n",
+				CUSE_DEVICE_PATH, strerror(errno));
+		return -1;
+	}
+
+	ssize_t cnt = read(cuseFd, request, sizeof(request));
+	const struct fuse_in_header *in = (const struct fuse_in_header *)request;
+	const struct cuse_init_in *initIn = (const struct cuse_init_in *)(request + sizeof(*in));
+	if (cnt < (ssize_t)(sizeof(*in) + sizeof(*initIn)) || in->opcode != CUSE_INIT) {
+		fprintf(stderr, "Cannot receive the CUSE initialization request\n");
+		return -1;
+	}
+	if (initIn->major != FUSE_KERNEL_VERSION) {
+		fprintf(stderr, "Unsupported CUSE protocol version %u.%u\n", initIn->major, initIn->minor);
+		return -1;
+	}
+
+	memset(&initOut, 0, sizeof(initOut));
+	initOut.major = FUSE_KERNEL_VERSION;
+	initOut.minor = initIn->minor < FUSE_KERNEL_MINOR_VERSION ? initIn->minor : FUSE_KERNEL_MINOR_VERSION;
+	initOut.max_read = CUSE_MAX_READ_BYTES;
+	initOut.max_write = CUSE_MAX_WRITE_BYTES;
+
+	// The device information is a list of null terminated 'KEY=VALUE' strings
+	int infoLength = snprintf(info, sizeof(info), "DEVNAME=%s", deviceName) + 1;
+
+	memset(&out, 0, sizeof(out));
+	out.len = sizeof(out) + sizeof(initOut) + infoLength;
+	out.unique = in->unique;
+	iov[0].iov_base = &out;
+	iov[0].iov_len = sizeof(out);
+	iov[1].iov_base = &initOut;
+	iov[1].iov_len = sizeof(initOut);
+	iov[2].iov_base = info;
+	iov[2].iov_len = infoLength;
+	if (writev(cuseFd, iov, 3) != (ssize_t)out.len) {
+		fprintf(stderr, "Cannot create /dev/%s: %s\n", deviceName, strerror(errno));
+		return -1;
+	}
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Create the device and serve the requests until stopped by a signal
+ *
+ * @return int - 0 when run successfully
+ */
+static int processCuse(void) {
+	sigset_t stopSignals;
+	int sig;
+	int numStarted = 0;
+
+	// The signals stopping the daemon are received by the main thread only, with sigwait(). They are blocked
+	// before opening the cluster, as the threads downloading from the devices inherit the signal mask.
+	sigemptyset(&stopSignals);
+	sigaddset(&stopSignals, SIGINT);
+	sigaddset(&stopSignals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stopSignals, NULL);
+
+	int status = swrngOpenCLDaemonCluster(&dmn, val_true);
+	if (status != SWRNG_SUCCESS) {
+		return status;
+	}
+
+	workers = (WorkerInst *)calloc(numWorkers, sizeof(WorkerInst));
+	if (workers == NULL) {
+		fprintf(stderr, "Could not allocate the resources\n");
+		swrngCLClose(&dmn.cxt);
+		return -1;
+	}
+	if (openCuseDevice() != SWRNG_SUCCESS) {
+		swrngCLClose(&dmn.cxt);
+		return -1;
+	}
+
+	if (swrngStartCLDaemonPrefetch(&dmn, PREFETCH_BUFF_SIZE, PREFETCH_CHUNK_SIZE, notifyBytesAdded, NULL) != SWRNG_SUCCESS) {
+		swrngCLClose(&dmn.cxt);
+		return -1;
+	}
+	for (; numStarted < numWorkers; numStarted++) {
+		if (pthread_create(&workers[numStarted].thread, NULL, workerRun, &workers[numStarted]) != 0) {
+			fprintf(stderr, "Could not create the worker threads\n");
+			kill(getpid(), SIGTERM);
+			break;
+		}
+	}
+
+	if (numStarted == numWorkers) {
+		printf("Device /dev/%s created using a cluster of %d devices, post processing: '%s', statistical tests %s, threads: %d\n",
+				deviceName, swrngGetCLSize(&dmn.cxt), dmn.post_processing_enabled == val_false ? "none"
+						: (dmn.pp_method != NULL ? dmn.pp_method : "default"),
+				dmn.statistical_tests_enabled == val_true ? "enabled" : "disabled", numWorkers);
+	}
+
+	sigwait(&stopSignals, &sig);
+	swrngRequestCLDaemonStop(&dmn);
+
+	printf("Stopping swrng-cuse\n");
+	swrngStopCLDaemonPrefetch(&dmn);
+	swrngCLClose(&dmn.cxt);
+
+	// Reply to the reads still waiting, new ones are not queued any more
+	pthread_mutex_lock(&dmn.prefetch_mutex);
+	PendingRead *pending = waitingHead;
+	waitingHead = NULL;
+	waitingTail = NULL;
+	pthread_mutex_unlock(&dmn.prefetch_mutex);
+	while (pending != NULL) {
+		PendingRead *next = pending->next;
+		replyPendingRead(pending, -EIO);
+		pending = next;
+	}
+
+	// The device is removed when the process exits and closes /dev/cuse, the workers are not joined
+	return SWRNG_SUCCESS;
+}
+
+/**
+ * Worker thread, reads the requests forwarded by the kernel and serves them
+ *
+ * @param arg - pointer to the worker
+ * @return NULL
+ */
+static void *workerRun(void *arg) {
+	WorkerInst *worker = (WorkerInst *)arg;
+
+	while (swrngIsCLDaemonStopRequested(&dmn) == val_false) {
+		ssize_t cnt = read(cuseFd, worker->request, sizeof(worker->request));
+		if (cnt < 0) {
+			if (errno == EINTR || errno == EAGAIN || errno == ENOENT) {
+				// Interrupted, or the request was aborted before it was read
+				continue;
+			}
+			if (swrngIsCLDaemonStopRequested(&dmn) == val_false) {
+				fprintf(stderr, "Cannot receive requests for /dev/%s: %s\n", deviceName, strerror(errno));
+				kill(getpid(), SIGTERM);
+			}
+			break;
+		}
+		if (cnt >= (ssize_t)sizeof(struct fuse_in_header)) {
+			handleRequest(worker, (size_t)cnt);
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Serve a request forwarded by the kernel
+ *
+ * @param worker - pointer to the worker that received the request
+ * @param length - number of bytes received
+ */
+static void handleRequest(WorkerInst *worker, size_t length) {
+	const struct fuse_in_header *in = (const struct fuse_in_header *)worker->request;
+	const unsigned char *arg = worker->request + sizeof(*in);
+	size_t argLength = length - sizeof(*in);
+
+	switch (in->opcode) {
+	case FUSE_OPEN:
+		serveOpen(in);
+		break;
+	case FUSE_READ:
+		if (argLength >= sizeof(struct fuse_read_in)) {
+			serveRead(worker, in, (const struct fuse_read_in *)arg);
+		} else {
+			sendReply(in->unique, -EINVAL, NULL, 0);
+		}
+		break;
+	case FUSE_POLL:
+		if (argLength >= sizeof(struct fuse_poll_in)) {
+			servePoll(in, (const struct fuse_poll_in *)arg);
+		} else {
+			sendReply(in->unique, -EINVAL, NULL, 0);
+		}
+		break;
+	case FUSE_INTERRUPT:
+		if (argLength >= sizeof(struct fuse_interrupt_in)) {
+			serveInterrupt(in, (const struct fuse_interrupt_in *)arg);
+		}
+		break;
+	case FUSE_RELEASE:
+	case FUSE_FLUSH:
+		sendReply(in->unique, 0, NULL, 0);
+		break;
+	case FUSE_WRITE:
+		// Read-only, same as the swrandom kernel module
+		sendReply(in->unique, -EINVAL, NULL, 0);
+		break;
+	case FUSE_IOCTL:
+		sendReply(in->unique, -ENOTTY, NULL, 0);
+		break;
+	case FUSE_FORGET:
+	case FUSE_BATCH_FORGET:
+		// Not answered
+		break;
+	default:
+		sendReply(in->unique, -ENOSYS, NULL, 0);
+		break;
+	}
+}
+
+/**
+ * Serve an open request. Any process allowed by the device permissions may open it.
+ *
+ * @param in - request header
+ */
+static void serveOpen(const struct fuse_in_header *in) {
+	struct fuse_open_out openOut;
+
+	memset(&openOut, 0, sizeof(openOut));
+	openOut.open_flags = FOPEN_DIRECT_IO | FOPEN_NONSEEKABLE;
+	sendReply(in->unique, 0, &openOut, sizeof(openOut));
+}
+
+/**
+ * Serve a read request with random bytes from the prefetch buffer. When there are not enough,
+ * the request waits in turn for the prefetch thread to add more, unless opened with O_NONBLOCK.
+ *
+ * @param worker - pointer to the worker that received the request
+ * @param in - request header
+ * @param readIn - read request
+ */
+static void serveRead(WorkerInst *worker, const struct fuse_in_header *in, const struct fuse_read_in *readIn) {
+	size_t length = readIn->size < CUSE_MAX_READ_BYTES ? readIn->size : CUSE_MAX_READ_BYTES;
+	size_t filled = 0;
+	PendingRead *pending = NULL;
+
+	pthread_mutex_lock(&dmn.prefetch_mutex);
+	// The requests already waiting are served first
+	if (waitingHead == NULL) {
+		filled = swrngTakeCLDaemonBytes(&dmn, worker->reply, length);
+	}
+	if (filled < length && (readIn->flags & O_NONBLOCK) == 0 && dmn.prefetch_stopped == val_false) {
+		pending = (PendingRead *)malloc(sizeof(PendingRead) + length);
+		if (pending != NULL) {
+			pending->unique = in->unique;
+			pending->length = length;
+			pending->filled = filled;
+			pending->next = NULL;
+			memcpy(pending->data, worker->reply, filled);
+			if (waitingTail == NULL) {
+				waitingHead = pending;
+			} else {
+				waitingTail->next = pending;
+			}
+			waitingTail = pending;
+		}
+	}
+	pthread_mutex_unlock(&dmn.prefetch_mutex);
+
+	if (pending == NULL) {
+		if (filled > 0) {
+			sendReply(in->unique, 0, worker->reply, filled);
+		} else {
+			sendReply(in->unique, (readIn->flags & O_NONBLOCK) != 0 ? -EAGAIN : -EIO, NULL, 0);
+		}
+	}
+}
+
+/**
+ * Serve a poll request. The device is readable when there are prefetched bytes, otherwise
+ * the kernel is notified when the prefetch thread adds more if it asked for that.
+ *
+ * @param in - request header
+ * @param pollIn - poll request
+ */
+static void servePoll(const struct fuse_in_header *in, const struct fuse_poll_in *pollIn) {
+	struct fuse_poll_out pollOut;
+
+	memset(&pollOut, 0, sizeof(pollOut));
+	pthread_mutex_lock(&dmn.prefetch_mutex);
+	if (dmn.prefetch_available > 0) {
+		pollOut.revents = POLLIN | POLLRDNORM;
+	} else if ((pollIn->flags & FUSE_POLL_SCHEDULE_NOTIFY) != 0) {
+		size_t i;
+		for (i = 0; i < numPollHandles && pollHandles[i] != pollIn->kh; i++) {
+		}
+		if (i == numPollHandles) {
+			if (numPollHandles == maxPollHandles) {
+				size_t newMax = maxPollHandles == 0 ? 16 : maxPollHandles * 2;
+				uint64_t *newHandles = (uint64_t *)realloc(pollHandles, newMax * sizeof(uint64_t));
+				if (newHandles != NULL) {
+					pollHandles = newHandles;
+					maxPollHandles = newMax;
+				}
+			}
+			if (numPollHandles < maxPollHandles) {
+				pollHandles[numPollHandles++] = pollIn->kh;
+			} else {
+				// Cannot notify later, let the caller read and wait for the random bytes instead
+				pollOut.revents = POLLIN | POLLRDNORM;
+			}
+		}
+	}
+	pthread_mutex_unlock(&dmn.prefetch_mutex);
+
+	sendReply(in->unique, 0, &pollOut, sizeof(pollOut));
+}
+
+/**
+ * Serve an interrupt request, replying right away to the interrupted read if it waits for random bytes.
+ * When that read was not found waiting yet, the kernel is asked to send the interrupt again.
+ *
+ * @param in - request header
+ * @param interruptIn - interrupt request
+ */
+static void serveInterrupt(const struct fuse_in_header *in, const struct fuse_interrupt_in *interruptIn) {
+	PendingRead *prev = NULL;
+	PendingRead *pending;
+
+	pthread_mutex_lock(&dmn.prefetch_mutex);
+	for (pending = waitingHead; pending != NULL && pending->unique != interruptIn->unique; pending = pending->next) {
+		prev = pending;
+	}
+	if (pending != NULL) {
+		if (prev == NULL) {
+			waitingHead = pending->next;
+		} else {
+			prev->next = pending->next;
+		}
+		if (waitingTail == pending) {
+			waitingTail = prev;
+		}
+	}
+	pthread_mutex_unlock(&dmn.prefetch_mutex);
+
+	if (pending != NULL) {
+		replyPendingRead(pending, -EINTR);
+	} else {
+		sendReply(in->unique, -EAGAIN, NULL, 0);
+	}
+}
+
+/**
+ * Send the reply of a request to the kernel
+ *
+ * @param unique - unique id of the request
+ * @param error - 0 or a negated errno value
+ * @param data - reply data, NULL when none
+ * @param length - number of reply data bytes
+ */
+static void sendReply(uint64_t unique, int error, const void *data, size_t length) {
+	struct fuse_out_header out;
+	struct iovec iov[2];
+
+	memset(&out, 0, sizeof(out));
+	out.len = sizeof(out) + length;
+	out.error = error;
+	out.unique = unique;
+	iov[0].iov_base = &out;
+	iov[0].iov_len = sizeof(out);
+	iov[1].iov_base = (void *)data;
+	iov[1].iov_len = length;
+	if (writev(cuseFd, iov, length > 0 ? 2 : 1) < 0) {
+		// The request was interrupted and aborted by the kernel
+	}
+}
+
+/**
+ * Process command line arguments
+ *
+ * @param int argc - number of parameters
+ * @param char ** argv - parameters
+ * @return int - 0 when run successfully
+ */
+static int process(int argc, char **argv) {
+	int status = swrngInitializeCLDaemon(&dmn, displayUsage);
+	if (status != SWRNG_SUCCESS) {
+		return status;
+	}
+	if (argc == 1) {
+		displayUsage();
+		return -1;
+	}
+	return processArguments(argc, argv);
+}
+
+/**
+ * Main entry
+ *
+ * @param int argc - number of parameters
+ * @param char ** argv - parameters
+ *
+ */
+int main(int argc, char **argv) {
+	setbuf(stdout, NULL);
+	return process(argc, argv);
+}
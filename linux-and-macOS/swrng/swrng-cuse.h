@@ -0,0 +1,131 @@
+/*
+ * swrng-cuse.h
+ * Ver. 1.0
+ *
+ */
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+ Copyright (C) 2014-2025 TectroLabs L.L.C. https://tectrolabs.com
+
+ THIS SOFTWARE IS PROVIDED "AS IS" WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESSED OR IMPLIED,
+ INCLUDING BUT NOT LIMITED TO THE IMPLIED WARRANTIES OF MERCHANTABILITY AND/OR FITNESS FOR A PARTICULAR PURPOSE.
+
+ This program is used for interacting with a cluster of SwiftRNG devices for the purpose of
+ serving true random bytes through a character device created with CUSE (character device in user space).
+
+ This program requires the libusb-1.0 library when communicating with any SwiftRNG device. Please read the provided
+ documentation for libusb-1.0 installation details.
+
+ This program uses libusb-1.0 (directly or indirectly) which is distributed under the terms of the GNU Lesser General
+ Public License as published by the Free Software Foundation. For more information, please visit: http://libusb.info
+
+ This program may only be used in conjunction with TectroLabs devices.
+
+ This program requires 'sudo' permissions for opening /dev/cuse.
+
+ +++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+#ifndef SWRNG_CUSE_H_
+#define SWRNG_CUSE_H_
+
+#include <swrng-cl-daemon.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <linux/fuse.h>
+
+#define CUSE_DEVICE_PATH "/dev/cuse"
+#define DEFAULT_DEVICE_NAME "swrandom-cl"
+#define MAX_DEVICE_NAME_LENGTH 64
+
+#define DEFAULT_NUM_WORKERS 2
+#define MAX_WORKERS 64
+
+/* Max number of bytes asked for by one read request, the kernel splits larger reads */
+#define CUSE_MAX_READ_BYTES (128 * 1024)
+
+/* Max number of bytes of one write request, writes are rejected */
+#define CUSE_MAX_WRITE_BYTES (4096)
+
+/* Size of the buffer receiving one request, the smallest size accepted by the kernel */
+#define REQUEST_BUFF_SIZE (FUSE_MIN_READ_BUFFER)
+
+/* Number of bytes retrieved from the cluster at once and the size of the prefetch buffer */
+#define PREFETCH_CHUNK_SIZE (100000)
+#define PREFETCH_BUFF_SIZE (PREFETCH_CHUNK_SIZE * 40)
+
+/*
+ * Structures
+ */
+
+typedef struct {
+	pthread_t thread;
+	__attribute__((aligned(8))) unsigned char request[REQUEST_BUFF_SIZE];
+	unsigned char reply[CUSE_MAX_READ_BYTES];
+} WorkerInst;
+
+/* A read request waiting for random bytes, with the bytes filled so far */
+typedef struct PendingRead {
+	uint64_t unique;
+	size_t length;
+	size_t filled;
+	struct PendingRead *next;
+	unsigned char data[];
+} PendingRead;
+
+static const int val_true = 1;
+static const int val_false = 0;
+
+/**
+ * Variables
+ */
+
+/* Name of the device created in /dev (a command line argument) */
+static const char *deviceName = DEFAULT_DEVICE_NAME;
+
+/* Number of threads serving the requests (a command line argument) */
+static int numWorkers = DEFAULT_NUM_WORKERS;
+
+/*
+ * The cluster with its settings and the prefetch buffer, drained by the workers.
+ * The waiting reads and the poll handles are also guarded by the prefetch lock.
+ */
+static SwrngCLDaemon dmn;
+
+static int cuseFd = -1;
+static WorkerInst *workers = NULL;
+
+/* Read requests waiting for random bytes, served in turn by the prefetch thread */
+static PendingRead *waitingHead = NULL;
+static PendingRead *waitingTail = NULL;
+
+/* Kernel poll handles to notify when random bytes are added */
+static uint64_t *pollHandles = NULL;
+static size_t numPollHandles = 0;
+static size_t maxPollHandles = 0;
+
+/**
+ * Function Declarations
+ */
+
+static void displayUsage(void);
+static int process(int argc, char **argv);
+static int processArguments(int argc, char **argv);
+static int parseNumWorkers(int idx, int argc, char **argv);
+static void notifyBytesAdded(void *arg);
+static void notifyPollHandles(uint64_t *handles, size_t count);
+static void serveWaitingReads(void);
+static void replyPendingRead(PendingRead *pending, int error);
+static int openCuseDevice(void);
+static int processCuse(void);
+static void *workerRun(void *arg);
+static void handleRequest(WorkerInst *worker, size_t length);
+static void serveOpen(const struct fuse_in_header *in);
+static void serveRead(WorkerInst *worker, const struct fuse_in_header *in, const struct fuse_read_in *readIn);
+static void servePoll(const struct fuse_in_header *in, const struct fuse_poll_in *pollIn);
+static void serveInterrupt(const struct fuse_in_header *in, const struct fuse_interrupt_in *interruptIn);
+static void sendReply(uint64_t unique, int error, const void *data, size_t length);
+
+#endif /* SWRNG_CUSE_H_ */
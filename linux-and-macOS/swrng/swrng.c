@@ -312,21 +312,21 @@ static int process_arguments(int argc, char **argv) {
  *
  */
 static void close_handle(void) {
-	if (p_output_file != NULL) {
-		fclose(p_output_file);
-		p_output_file = NULL;
-	}
+	swrngCloseOutput(&output);
 }
 
 /**
- * Write bytes out to the file
+ * Write bytes out to the file from the output buffer
  *
- * @param const uint8_t* bytes - pointer to the byte array
  * @param uint32_t num_bytes - number of bytes to write
+ * @return int - 0 when written successfully
  */
-static void write_bytes(const uint8_t *bytes, uint32_t num_bytes) {
-	FILE *handle = p_output_file;
-	fwrite(bytes, 1, num_bytes, handle);
+static int write_bytes(uint32_t num_bytes) {
+	if (swrngWriteOutput(&output, num_bytes) != 0) {
+		fprintf(stderr, "Cannot write %u bytes to file: %s\n", num_bytes, file_path_name);
+		return -1;
+	}
+	return SWRNG_SUCCESS;
 }
 
 /**
@@ -336,8 +336,6 @@ static void write_bytes(const uint8_t *bytes, uint32_t num_bytes) {
  */
 static int handle_download_request(void) {
 
-	/* Add one extra byte of storage for the status byte */
-	uint8_t receiveByteBuffer[SWRNG_BUFF_FILE_SIZE_BYTES + 1];
 	swrngResetStatistics(&ctxt);
 
 	int status = swrngOpen(&ctxt, device_num);
@@ -420,6 +418,14 @@ static int handle_download_request(void) {
 	}
 
 
+	status = swrngSetBulkRequestBlocks(&ctxt, SWRNG_BULK_REQUEST_BLOCKS);
+	if (status != SWRNG_SUCCESS) {
+		fprintf(stderr, " Cannot set bulk request size, error code %d ... ",
+				status);
+		swrngClose(&ctxt);
+		return status;
+	}
+
 	status = swrngSetPowerProfile(&ctxt, pp_num);
 	if (status != SWRNG_SUCCESS) {
 		fprintf(stderr, " Cannot set device power profile, error code %d ... ",
@@ -434,63 +440,62 @@ static int handle_download_request(void) {
 		return -1;
 	}
 
-	if (is_output_to_standard_output == val_true) {
-#ifdef _WIN32
-		_setmode(_fileno(stdout), _O_BINARY);
-		p_output_file = fdopen(_dup(fileno(stdout)), "wb");
-#else
-		p_output_file = fdopen(dup(fileno(stdout)), "wb");
-#endif
-
-	} else {
-		p_output_file = fopen(file_path_name, "wb");
-	}
-	if (p_output_file == NULL) {
+	if (swrngOpenOutput(&output, file_path_name, is_output_to_standard_output, SWRNG_BULK_BUFF_FILE_SIZE_BYTES) != 0) {
 		fprintf(stderr, "Cannot open file: %s in write mode\n", file_path_name);
 		swrngClose(&ctxt);
 		return -1;
 	}
 
+	/* The output buffer has one extra byte of storage for the status byte */
+	uint8_t *receiveByteBuffer = swrngGetOutputBuffer(&output);
 
 	swrngResetStatistics(&ctxt);
 
 	while (num_gen_bytes == -1) {
 		/* Infinite loop for downloading unlimited random bytes */
-		status = swrngGetEntropy(&ctxt, receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		status = swrngGetEntropyEx(&ctxt, receiveByteBuffer, SWRNG_BULK_BUFF_FILE_SIZE_BYTES);
 		if (status != SWRNG_SUCCESS) {
 			fprintf(
 					stderr,
 					"Failed to receive %d bytes for unlimited download, error code %d. ",
-					SWRNG_BUFF_FILE_SIZE_BYTES, status);
+					SWRNG_BULK_BUFF_FILE_SIZE_BYTES, status);
 			close_handle();
 			swrngClose(&ctxt);
 			return status;
 		}
-		write_bytes(receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		if (write_bytes(SWRNG_BULK_BUFF_FILE_SIZE_BYTES) != SWRNG_SUCCESS) {
+			close_handle();
+			swrngClose(&ctxt);
+			return -1;
+		}
 	}
 
 	/* Calculate number of complete random byte chunks to download */
-	int64_t numCompleteChunks = num_gen_bytes / SWRNG_BUFF_FILE_SIZE_BYTES;
+	int64_t numCompleteChunks = num_gen_bytes / SWRNG_BULK_BUFF_FILE_SIZE_BYTES;
 
 	/* Calculate number of bytes in the last incomplete chunk */
-	uint32_t chunkRemaindBytes = (uint32_t)(num_gen_bytes % SWRNG_BUFF_FILE_SIZE_BYTES);
+	uint32_t chunkRemaindBytes = (uint32_t)(num_gen_bytes % SWRNG_BULK_BUFF_FILE_SIZE_BYTES);
 
 	/* Process each chunk */
 	for (int64_t chunkNum = 0; chunkNum < numCompleteChunks; chunkNum++) {
-		status = swrngGetEntropy(&ctxt, receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		status = swrngGetEntropyEx(&ctxt, receiveByteBuffer, SWRNG_BULK_BUFF_FILE_SIZE_BYTES);
 		if (status != SWRNG_SUCCESS) {
 			fprintf(stderr, "Failed to receive %d bytes, error code %d. ",
-					SWRNG_BUFF_FILE_SIZE_BYTES, status);
+					SWRNG_BULK_BUFF_FILE_SIZE_BYTES, status);
 			close_handle();
 			swrngClose(&ctxt);
 			return status;
 		}
-		write_bytes(receiveByteBuffer, SWRNG_BUFF_FILE_SIZE_BYTES);
+		if (write_bytes(SWRNG_BULK_BUFF_FILE_SIZE_BYTES) != SWRNG_SUCCESS) {
+			close_handle();
+			swrngClose(&ctxt);
+			return -1;
+		}
 	}
 
 	if (chunkRemaindBytes > 0) {
 		/* Process incomplete chunk */
-		status = swrngGetEntropy(&ctxt, receiveByteBuffer, chunkRemaindBytes);
+		status = swrngGetEntropyEx(&ctxt, receiveByteBuffer, chunkRemaindBytes);
 		if (status != SWRNG_SUCCESS) {
 			fprintf(
 					stderr,
@@ -500,7 +505,11 @@ static int handle_download_request(void) {
 			swrngClose(&ctxt);
 			return status;
 		}
-		write_bytes(receiveByteBuffer, chunkRemaindBytes);
+		if (write_bytes(chunkRemaindBytes) != SWRNG_SUCCESS) {
+			close_handle();
+			swrngClose(&ctxt);
+			return -1;
+		}
 	}
 
 	close_handle();
@@ -569,6 +578,45 @@ static int process(int argc, char **argv) {
 /* ............. */
 #ifdef __linux__
 /* ............. */
+/**
+ * Read an integer parameter of the kernel random number generator
+ *
+ * @param const char *path_name - parameter file path name
+ * @param int default_value - value to return when the parameter cannot be read
+ * @return int - parameter value
+ */
+static int read_kernel_random_param(const char *path_name, int default_value) {
+	int value;
+	FILE *param_file = fopen(path_name, "r");
+	if (param_file == NULL) {
+		return default_value;
+	}
+	if (fscanf(param_file, "%d", &value) != 1 || value <= 0) {
+		value = default_value;
+	}
+	fclose(param_file);
+	return value;
+}
+
+/**
+ * Top up the prefetch buffer with random bytes from the device
+ *
+ * @return int - 0 when run successfully
+ */
+static int prefetch_pool_entropy(void) {
+	int add_bytes = KERNEL_ENTROPY_PREFETCH_SIZE_BYTES - prefetch_count;
+	if (add_bytes < KERNEL_ENTROPY_POOL_SIZE_BYTES) {
+		return SWRNG_SUCCESS;
+	}
+	int status = swrngGetEntropy(&ctxt, prefetch_buff + prefetch_count, add_bytes);
+	if (status != SWRNG_SUCCESS) {
+		fprintf(stderr, "Failed to receive %d bytes for feeding entropy pool, error code %d. ", add_bytes, status);
+		return status;
+	}
+	prefetch_count += add_bytes;
+	return SWRNG_SUCCESS;
+}
+
 /**
  * Feed Kernel entropy pool with true random bytes
  *
@@ -599,35 +647,72 @@ static int feed_kernel_entropy_pool(void) {
 		return result;
 	}
 
+	/* The kernel signals POLLOUT when the amount of entropy drops below the wakeup threshold */
+	int pool_size_bits = read_kernel_random_param(KERNEL_ENTROPY_POOL_SIZE_PARAM, KERNEL_ENTROPY_POOL_SIZE_BYTES * 8);
+	int wakeup_threshold_bits = read_kernel_random_param(KERNEL_ENTROPY_WAKEUP_THRESHOLD_PARAM, pool_size_bits / 2);
+	if (wakeup_threshold_bits > pool_size_bits) {
+		wakeup_threshold_bits = pool_size_bits;
+	}
+
 	printf("Feeding the kernel %s entropy pool. Initial amount of entropy bits in the pool: %d ...\n", KERNEL_ENTROPY_POOL_NAME, entropyAvailable);
 
+	struct pollfd pfd;
+	pfd.fd = rndout;
+	pfd.events = POLLOUT;
+
 	/* Infinite loop for feeding kernel entropy pool */
 	while(val_true) {
-		/* Check to see if we need more entropy, feed the pool if the current level is below 2048 bits */
+		/* Download ahead so that feeding the pool never waits for the device */
+		status = prefetch_pool_entropy();
+		if (status != SWRNG_SUCCESS) {
+			swrngDestroyContext(&ctxt);
+			close(rndout);
+			return status;
+		}
+
+		/*
+		 * Sleep until the kernel asks for entropy. Newer kernels never do once the pool is initialized,
+		 * the timeout lets the pool level be checked every so often for those.
+		 */
+		pfd.revents = 0;
+		result = poll(&pfd, 1, KERNEL_ENTROPY_POLL_TIMEOUT_MSECS);
+		if (result < 0 && errno != EINTR) {
+			printf("Cannot wait for the entropy pool, error: %d\n", errno);
+			swrngDestroyContext(&ctxt);
+			close(rndout);
+			return result;
+		}
+
 		ioctl(rndout, RNDGETENTCNT, &entropyAvailable);
-		if (entropyAvailable < (KERNEL_ENTROPY_POOL_SIZE_BYTES * 8) / 2) {
-			int addMoreBytes = KERNEL_ENTROPY_POOL_SIZE_BYTES - (entropyAvailable >> 3);
-			status = swrngGetEntropy(&ctxt, entropy.data, addMoreBytes);
-			if(status != SWRNG_SUCCESS) {
-				fprintf(stderr, "Failed to receive %d bytes for feeding entropy pool, error code %d. ", addMoreBytes, status);
-				swrngDestroyContext(&ctxt);
-				return status;
-			}
-			entropy.buf_size = addMoreBytes;
-			/* Estimate the amount of entropy */
-			entropy.entropy_count = entropyAvailable + (addMoreBytes << 3);
-			/* Push the entropy out to the pool */
-			result = ioctl(rndout, RNDADDENTROPY, &entropy);
-			if (result < 0) {
-				printf("Cannot add more entropy to the pool, error: %d\n", result);
-				swrngDestroyContext(&ctxt);
-				close(rndout);
-				return result;
-			}
-			usleep(10);
-		} else {
-			usleep(30);
+		if (!(pfd.revents & POLLOUT) && entropyAvailable >= wakeup_threshold_bits) {
+			pfd.events = POLLOUT;
+			continue;
+		}
+
+		/* Top the pool up in one batch sized from the deficit */
+		int add_more_bytes = (pool_size_bits - entropyAvailable + 7) >> 3;
+		if (add_more_bytes > KERNEL_ENTROPY_POOL_SIZE_BYTES) {
+			add_more_bytes = KERNEL_ENTROPY_POOL_SIZE_BYTES;
+		}
+		if (add_more_bytes <= 0) {
+			/* The pool is full while POLLOUT is still signaled, only rely on the timeout until the level drops */
+			pfd.events = 0;
+			continue;
+		}
+		prefetch_count -= add_more_bytes;
+		memcpy(entropy.data, prefetch_buff + prefetch_count, add_more_bytes);
+		entropy.buf_size = add_more_bytes;
+		/* Estimate the amount of entropy */
+		entropy.entropy_count = add_more_bytes << 3;
+		/* Push the entropy out to the pool */
+		result = ioctl(rndout, RNDADDENTROPY, &entropy);
+		if (result < 0) {
+			printf("Cannot add more entropy to the pool, error: %d\n", result);
+			swrngDestroyContext(&ctxt);
+			close(rndout);
+			return result;
 		}
+		pfd.events = POLLOUT;
 	}
 
 }
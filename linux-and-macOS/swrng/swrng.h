@@ -30,6 +30,7 @@
 #define SWRNG_H_
 
 #include <swrngapi.h>
+#include <swrng-output.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -45,15 +46,29 @@
 
 #define SWRNG_BUFF_FILE_SIZE_BYTES (10000 * 10)
 
+/* Whole device blocks per download request and per file write */
+#define SWRNG_BULK_REQUEST_BLOCKS (4)
+#define SWRNG_BULK_BUFF_FILE_SIZE_BYTES (16000 * 64)
+
 
 #ifdef __linux__
 #include <stdlib.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <linux/random.h>
+#include <poll.h>
+#include <errno.h>
 
 #define KERNEL_ENTROPY_POOL_SIZE_BYTES 512
 #define KERNEL_ENTROPY_POOL_NAME "/dev/random"
+#define KERNEL_ENTROPY_POOL_SIZE_PARAM "/proc/sys/kernel/random/poolsize"
+#define KERNEL_ENTROPY_WAKEUP_THRESHOLD_PARAM "/proc/sys/kernel/random/write_wakeup_threshold"
+
+/* Random bytes downloaded ahead of feeding the entropy pool */
+#define KERNEL_ENTROPY_PREFETCH_SIZE_BYTES (KERNEL_ENTROPY_POOL_SIZE_BYTES * 8)
+
+/* Maximum time to wait for the kernel to ask for entropy before checking the pool level anyway */
+#define KERNEL_ENTROPY_POLL_TIMEOUT_MSECS (10000)
 #endif
 
 /*
@@ -95,7 +110,7 @@ static int device_num;
 static int pp_num = 9;
 
 /* Output file handle */
-static FILE *p_output_file = NULL;
+static SwrngOutput output;
 
 static int is_output_to_standard_output;
 static SwrngContext ctxt;
@@ -112,6 +127,10 @@ static int emb_corr_method_id;
 /* A variable for checking the amount of the entropy available in the kernel pool */
 int entropyAvailable;
 Entropy entropy;
+
+/* Random bytes prefetched from the device for feeding the kernel entropy pool */
+static unsigned char prefetch_buff[KERNEL_ENTROPY_PREFETCH_SIZE_BYTES];
+static int prefetch_count = 0;
 #endif
 
 /**
@@ -126,13 +145,15 @@ static int validate_argument_count(int curIdx, int act_argument_count);
 static int parse_device_num(int idx, int argc, char **argv);
 static int process_download_request(void);
 static int handle_download_request(void);
-static void write_bytes(const uint8_t *bytes, uint32_t num_bytes);
+static int write_bytes(uint32_t num_bytes);
 static int parse_pp_num(int idx, int argc, char **argv);
 static void close_handle(void);
 static void initialize(void);
 
 #ifdef __linux__
 static int feed_kernel_entropy_pool();
+static int read_kernel_random_param(const char *path_name, int default_value);
+static int prefetch_pool_entropy(void);
 #endif
 
 #endif /* SWRNG_H_ */